@@ -27,8 +27,8 @@ function(OPENEXR_DEFINE_LIBRARY libname)
                           PRIVATE cxx_std_${OPENEXR_CXX_STANDARD}
                           INTERFACE cxx_std_11 )
 
-  # we are embedding libdeflate
-  target_include_directories(${objlib} PRIVATE ${EXR_DEFLATE_INCLUDE_DIR})
+  # we are embedding libdeflate and zstd
+  target_include_directories(${objlib} PRIVATE ${EXR_DEFLATE_INCLUDE_DIR} ${EXR_ZSTD_INCLUDE_DIR})
 
   if(OPENEXR_CURLIB_PRIV_EXPORT AND BUILD_SHARED_LIBS)
     target_compile_definitions(${objlib} PRIVATE ${OPENEXR_CURLIB_PRIV_EXPORT})
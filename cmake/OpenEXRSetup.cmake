@@ -48,6 +48,11 @@ option(OPENEXR_USE_DEFAULT_VISIBILITY "Makes the compile use default visibility
 # object (if you enable this) that contains member to avoid double allocations
 option(OPENEXR_ENABLE_LARGE_STACK "Enables code to take advantage of large stack support"     OFF)
 
+# Stores the frame buffer slice, channel list and header attribute maps
+# in a sorted vector instead of a std::map. This changes the ABI of the
+# library, and references to map entries no longer survive an insert.
+option(OPENEXR_ENABLE_FLAT_MAPS "Uses sorted vectors for the frame buffer, channel and attribute maps (changes the ABI)"     OFF)
+
 ########################
 ## Build related options
 
@@ -225,6 +230,70 @@ else()
   set(EXR_DEFLATE_SOURCES)
 endif()
 
+#######################################
+# Find or install zstd
+#######################################
+
+option(OPENEXR_ENABLE_ZSTD "Enables ZSTD_COMPRESSION, using an installed or internal zstd" ON)
+option(OPENEXR_FORCE_INTERNAL_ZSTD "Force using an internal zstd" OFF)
+set(OPENEXR_ZSTD_REPO "https://github.com/facebook/zstd.git" CACHE STRING "Repo path for zstd source")
+set(OPENEXR_ZSTD_TAG "v1.5.6" CACHE STRING "Tag to use for zstd source repo")
+
+set(OPENEXR_HAVE_ZSTD OFF)
+
+if(OPENEXR_ENABLE_ZSTD AND NOT OPENEXR_FORCE_INTERNAL_ZSTD)
+  include(FindPkgConfig)
+  pkg_check_modules(zstd IMPORTED_TARGET GLOBAL libzstd)
+  if (zstd_FOUND)
+    message(STATUS "Using libzstd from ${zstd_LINK_LIBRARIES}")
+  endif()
+endif()
+
+if(NOT OPENEXR_ENABLE_ZSTD)
+  message(STATUS "zstd disabled, ZSTD_COMPRESSION will not be available")
+elseif(NOT TARGET PkgConfig::zstd AND NOT zstd_FOUND)
+  if(OPENEXR_FORCE_INTERNAL_ZSTD)
+    message(STATUS "zstd forced internal, installing from ${OPENEXR_ZSTD_REPO} (${OPENEXR_ZSTD_TAG})")
+  else()
+    message(STATUS "zstd was not found, installing from ${OPENEXR_ZSTD_REPO} (${OPENEXR_ZSTD_TAG})")
+  endif()
+  include(FetchContent)
+  FetchContent_Declare(Zstd
+    GIT_REPOSITORY "${OPENEXR_ZSTD_REPO}"
+    GIT_TAG "${OPENEXR_ZSTD_TAG}"
+    GIT_SHALLOW ON
+    )
+
+  FetchContent_GetProperties(Zstd)
+  if(NOT Zstd_POPULATED)
+    FetchContent_Populate(Zstd)
+  endif()
+
+  # As with libdeflate, embed the (single threaded, no legacy format)
+  # sources into exrcore, the symbols are kept hidden through
+  # EXR_ZSTD_DEFINITIONS
+  file(GLOB EXR_ZSTD_SOURCES
+    ${zstd_SOURCE_DIR}/lib/common/*.c
+    ${zstd_SOURCE_DIR}/lib/compress/*.c
+    ${zstd_SOURCE_DIR}/lib/decompress/*.c)
+  set(EXR_ZSTD_INCLUDE_DIR ${zstd_SOURCE_DIR}/lib)
+  set(EXR_ZSTD_DEFINITIONS ZSTD_DISABLE_ASM ZSTD_LEGACY_SUPPORT=0 "ZSTDLIB_VISIBLE=" "ZSTDERRORLIB_VISIBLE=")
+  set(EXR_ZSTD_LIB)
+  set(OPENEXR_HAVE_ZSTD ON)
+else()
+  set(EXR_ZSTD_INCLUDE_DIR)
+  set(EXR_ZSTD_DEFINITIONS)
+  set(EXR_ZSTD_LIB ${zstd_LIBRARIES})
+  # set EXR_ZSTD_LDFLAGS for OpenEXR.pc.in for static build
+  if (BUILD_SHARED_LIBS)
+    set(EXR_ZSTD_LDFLAGS "")
+  else()
+    set(EXR_ZSTD_LDFLAGS "-l${zstd_LIBRARIES}")
+  endif()
+  set(EXR_ZSTD_SOURCES)
+  set(OPENEXR_HAVE_ZSTD ON)
+endif()
+
 #######################################
 # Find or install Imath
 #######################################
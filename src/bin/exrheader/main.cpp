@@ -65,6 +65,12 @@ printCompression (Compression c)
 
         case DWAB_COMPRESSION: cout << "dwa, medium scanline blocks"; break;
 
+        case PIZ4_COMPRESSION: cout << "piz, 4 huffman streams"; break;
+
+        case ZSTD_COMPRESSION: cout << "zstd, multi-scanline blocks"; break;
+
+        case LZ4_COMPRESSION: cout << "lz4, multi-scanline blocks"; break;
+
         default: cout << int (c); break;
     }
 }
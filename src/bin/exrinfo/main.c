@@ -100,6 +100,8 @@ process_stdin (int verbose, int allmeta, int strict)
 
     if (strict) cinit.flags |= EXR_CONTEXT_FLAG_STRICT_HEADER;
 
+    cinit.flags |= EXR_CONTEXT_FLAG_HEADER_ONLY | EXR_CONTEXT_FLAG_HEADER_ARENA;
+
 #ifdef _WIN32
     _setmode (_fileno (stdin), _O_BINARY);
 #endif
@@ -127,6 +129,8 @@ process_file (const char* filename, int verbose, int allmeta, int strict)
 
     if (strict) cinit.flags |= EXR_CONTEXT_FLAG_STRICT_HEADER;
 
+    cinit.flags |= EXR_CONTEXT_FLAG_HEADER_ONLY | EXR_CONTEXT_FLAG_HEADER_ARENA;
+
     rv = exr_start_read (&e, filename, &cinit);
 
     if (rv == EXR_ERR_SUCCESS)
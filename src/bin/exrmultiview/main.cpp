@@ -51,8 +51,8 @@ usageMessage (ostream& stream, const char* program_name, bool verbose = false)
             "Options:\n"
             "\n"
             "  -z x          sets the data compression method to x\n"
-            "                (none/rle/zip/piz/pxr24/b44/b44a/dwaa/dwab,\n"
-            "                default is piz)\n"
+            "                (none/rle/zip/piz/piz4/pxr24/b44/b44a/dwaa/dwab/\n"
+            "                zstd/lz4, default is piz)\n"
             "\n"
             "  -v            verbose mode\n"
             "\n"
@@ -105,6 +105,18 @@ getCompression (const string& str)
     {
         c = DWAB_COMPRESSION;
     }
+    else if (str == "piz4" || str == "PIZ4")
+    {
+        c = PIZ4_COMPRESSION;
+    }
+    else if (str == "zstd" || str == "ZSTD")
+    {
+        c = ZSTD_COMPRESSION;
+    }
+    else if (str == "lz4" || str == "LZ4")
+    {
+        c = LZ4_COMPRESSION;
+    }
     else
     {
         std::stringstream e;
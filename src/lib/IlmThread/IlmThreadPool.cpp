@@ -15,6 +15,10 @@
 #include "IlmThreadSemaphore.h"
 
 #include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <limits>
 #include <memory>
 #include <mutex>
@@ -147,6 +151,7 @@ public:
     int  numThreads () const override;
     void setNumThreads (int count) override;
     void addTask (Task* task) override;
+    void addTasks (Task* const* tasks, int count) override;
 
     void finish () override;
 
@@ -224,6 +229,21 @@ DefaultThreadPoolProvider::addTask (Task* task)
     _data->_taskSemaphore.post ();
 }
 
+void
+DefaultThreadPoolProvider::addTasks (Task* const* tasks, int count)
+{
+    if (count <= 0) return;
+
+    {
+        std::lock_guard<std::mutex> taskLock (_data->_taskMutex);
+
+        _data->_tasks.insert (_data->_tasks.end (), tasks, tasks + count);
+    }
+
+    for (int t = 0; t < count; ++t)
+        _data->_taskSemaphore.post ();
+}
+
 void
 DefaultThreadPoolProvider::finish ()
 {
@@ -325,6 +345,685 @@ DefaultThreadPoolProvider::threadLoop (
     }
 }
 
+//
+// class WorkStealingThreadPoolProvider
+//
+// Every worker owns a Chase-Lev deque which only it pushes to and
+// takes from, newest task first, while idle workers steal the
+// oldest tasks from the other end.  Tasks added by threads outside
+// the pool cannot go onto a deque, so they are spread over bounded
+// lock-free per-worker inboxes instead.  Tasks added by a worker,
+// e.g. from Task::execute, go onto that worker's own deque.
+//
+
+// keeps the hot atomics of neighbouring workers on separate
+// cache lines
+static constexpr size_t kCacheLineSize = 64;
+
+class WorkStealingDeque
+{
+public:
+    WorkStealingDeque () : _top (0), _bottom (0)
+    {
+        _arrays.emplace_back (new Array (256));
+        _array = _arrays.back ().get ();
+    }
+
+    WorkStealingDeque (const WorkStealingDeque&)            = delete;
+    WorkStealingDeque& operator= (const WorkStealingDeque&) = delete;
+    WorkStealingDeque (WorkStealingDeque&&)                 = delete;
+    WorkStealingDeque& operator= (WorkStealingDeque&&)      = delete;
+
+    // owner only
+    void push (Task* task)
+    {
+        int64_t b = _bottom.load (std::memory_order_relaxed);
+        int64_t t = _top.load (std::memory_order_acquire);
+        Array*  a = _array.load (std::memory_order_relaxed);
+
+        if (b - t > a->mask) a = grow (a, t, b);
+
+        a->put (b, task);
+        std::atomic_thread_fence (std::memory_order_release);
+        _bottom.store (b + 1, std::memory_order_relaxed);
+    }
+
+    // owner only, newest task first
+    Task* take ()
+    {
+        int64_t b = _bottom.load (std::memory_order_relaxed) - 1;
+        Array*  a = _array.load (std::memory_order_relaxed);
+        _bottom.store (b, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        int64_t t = _top.load (std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            _bottom.store (b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Task* task = a->get (b);
+        if (t == b)
+        {
+            // last task, race any thieves for it
+            if (!_top.compare_exchange_strong (
+                    t,
+                    t + 1,
+                    std::memory_order_seq_cst,
+                    std::memory_order_relaxed))
+                task = nullptr;
+            _bottom.store (b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    // any thread, oldest task first
+    Task* steal ()
+    {
+        int64_t t = _top.load (std::memory_order_acquire);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        int64_t b = _bottom.load (std::memory_order_acquire);
+
+        if (t >= b) return nullptr;
+
+        Array* a    = _array.load (std::memory_order_acquire);
+        Task*  task = a->get (t);
+        if (!_top.compare_exchange_strong (
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return task;
+    }
+
+private:
+    struct Array
+    {
+        explicit Array (int64_t size)
+            : mask (size - 1), slots (new std::atomic<Task*>[size])
+        {}
+
+        Task* get (int64_t i) const
+        {
+            return slots[i & mask].load (std::memory_order_relaxed);
+        }
+
+        void put (int64_t i, Task* task)
+        {
+            slots[i & mask].store (task, std::memory_order_relaxed);
+        }
+
+        int64_t                              mask;
+        std::unique_ptr<std::atomic<Task*>[]> slots;
+    };
+
+    Array* grow (Array* a, int64_t t, int64_t b)
+    {
+        // thieves may still be reading the old array, so it is
+        // retired rather than freed until the deque goes away
+        Array* na = new Array ((a->mask + 1) * 2);
+        _arrays.emplace_back (na);
+        for (int64_t i = t; i < b; ++i)
+            na->put (i, a->get (i));
+        _array.store (na, std::memory_order_release);
+        return na;
+    }
+
+    std::atomic<int64_t> _top;
+    char                 _pad0[kCacheLineSize - sizeof (std::atomic<int64_t>)];
+    std::atomic<int64_t> _bottom;
+    std::atomic<Array*>  _array;
+
+    std::vector<std::unique_ptr<Array>> _arrays; // owner only
+};
+
+//
+// Bounded multi-producer / multi-consumer FIFO, after Dmitry
+// Vyukov's queue: each cell carries a sequence number telling
+// producers and consumers whose turn it is.
+//
+class WorkStealingInbox
+{
+public:
+    static constexpr size_t kCapacity = 1024;
+
+    WorkStealingInbox () : _enqueuePos (0), _dequeuePos (0)
+    {
+        for (size_t i = 0; i < kCapacity; ++i)
+        {
+            _cells[i].sequence.store (i, std::memory_order_relaxed);
+            _cells[i].task = nullptr;
+        }
+    }
+
+    WorkStealingInbox (const WorkStealingInbox&)            = delete;
+    WorkStealingInbox& operator= (const WorkStealingInbox&) = delete;
+    WorkStealingInbox (WorkStealingInbox&&)                 = delete;
+    WorkStealingInbox& operator= (WorkStealingInbox&&)      = delete;
+
+    // returns false if the inbox is full
+    bool push (Task* task)
+    {
+        Cell*  cell;
+        size_t pos = _enqueuePos.load (std::memory_order_relaxed);
+        for (;;)
+        {
+            cell        = &_cells[pos & (kCapacity - 1)];
+            size_t seq  = cell->sequence.load (std::memory_order_acquire);
+            intptr_t df = (intptr_t) seq - (intptr_t) pos;
+            if (df == 0)
+            {
+                if (_enqueuePos.compare_exchange_weak (
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (df < 0)
+                return false;
+            else
+                pos = _enqueuePos.load (std::memory_order_relaxed);
+        }
+        cell->task = task;
+        cell->sequence.store (pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    Task* pop ()
+    {
+        Cell*  cell;
+        size_t pos = _dequeuePos.load (std::memory_order_relaxed);
+        for (;;)
+        {
+            cell        = &_cells[pos & (kCapacity - 1)];
+            size_t seq  = cell->sequence.load (std::memory_order_acquire);
+            intptr_t df = (intptr_t) seq - (intptr_t) (pos + 1);
+            if (df == 0)
+            {
+                if (_dequeuePos.compare_exchange_weak (
+                        pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (df < 0)
+                return nullptr;
+            else
+                pos = _dequeuePos.load (std::memory_order_relaxed);
+        }
+        Task* task = cell->task;
+        cell->sequence.store (pos + kCapacity, std::memory_order_release);
+        return task;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Task*               task;
+    };
+
+    std::atomic<size_t> _enqueuePos;
+    char                _pad0[kCacheLineSize - sizeof (std::atomic<size_t>)];
+    std::atomic<size_t> _dequeuePos;
+    char                _pad1[kCacheLineSize - sizeof (std::atomic<size_t>)];
+    Cell                _cells[kCapacity];
+};
+
+struct WorkStealingWorker
+{
+    WorkStealingDeque _deque;
+    char              _pad0[kCacheLineSize];
+    WorkStealingInbox _inbox;
+    char              _pad1[kCacheLineSize];
+};
+
+struct WorkStealingThreadPoolData
+{
+    explicit WorkStealingThreadPoolData (int count)
+        : _workers (static_cast<size_t> (count))
+        , _nextInbox (0)
+        , _sleeping (0)
+        , _wakeEpoch (0)
+        , _hasOverflow (false)
+        , _submitting (0)
+        , _stopping (false)
+    {
+        for (auto& w: _workers)
+            w.reset (new WorkStealingWorker);
+    }
+
+    std::vector<std::unique_ptr<WorkStealingWorker>> _workers;
+    std::vector<std::thread>                         _threads;
+
+    std::atomic<unsigned> _nextInbox; // round robin for outside tasks
+
+    std::atomic<int>        _sleeping;  // workers about to or asleep
+    std::atomic<uint64_t>   _wakeEpoch; // bumped to wake sleepers
+    std::mutex              _sleepMutex;
+    std::condition_variable _sleepCond;
+
+    // only used when every inbox is full
+    std::atomic<bool> _hasOverflow;
+    std::mutex        _overflowMutex;
+    std::deque<Task*> _overflow;
+
+    std::atomic<int>  _submitting; // threads in the middle of addTasks
+    std::atomic<bool> _stopping;
+
+    inline bool stopped () const
+    {
+        return _stopping.load (std::memory_order_relaxed);
+    }
+};
+
+// which pool, if any, the current thread is a worker of
+struct WorkStealingThreadState
+{
+    const WorkStealingThreadPoolData* data;
+    size_t                            index;
+};
+
+static thread_local WorkStealingThreadState tWorkStealingState = {
+    nullptr, 0};
+
+class WorkStealingThreadPoolProvider : public ThreadPoolProvider
+{
+public:
+    WorkStealingThreadPoolProvider (int count);
+    WorkStealingThreadPoolProvider (const WorkStealingThreadPoolProvider&) =
+        delete;
+    WorkStealingThreadPoolProvider&
+    operator= (const WorkStealingThreadPoolProvider&) = delete;
+    WorkStealingThreadPoolProvider (WorkStealingThreadPoolProvider&&) =
+        delete;
+    WorkStealingThreadPoolProvider&
+    operator= (WorkStealingThreadPoolProvider&&) = delete;
+    ~WorkStealingThreadPoolProvider () override;
+
+    int  numThreads () const override;
+    void setNumThreads (int count) override;
+    void addTask (Task* task) override;
+    void addTasks (Task* const* tasks, int count) override;
+
+    void finish () override;
+
+private:
+    void lockedFinish ();
+    void lockedStart (int count);
+
+    static void  wake (WorkStealingThreadPoolData& data, int count);
+    static Task* findTask (WorkStealingThreadPoolData& data, size_t self);
+    static void  drain (WorkStealingThreadPoolData& data);
+    static void
+    threadLoop (std::shared_ptr<WorkStealingThreadPoolData> data, size_t self);
+
+    std::mutex                                  _threadMutex;
+    std::shared_ptr<WorkStealingThreadPoolData> _data;
+    std::atomic<int>                            _threadCount;
+};
+
+WorkStealingThreadPoolProvider::WorkStealingThreadPoolProvider (int count)
+    : _threadCount (0)
+{
+    std::lock_guard<std::mutex> lock (_threadMutex);
+    lockedStart (count);
+}
+
+WorkStealingThreadPoolProvider::~WorkStealingThreadPoolProvider ()
+{
+    finish ();
+}
+
+int
+WorkStealingThreadPoolProvider::numThreads () const
+{
+    return _threadCount.load ();
+}
+
+void
+WorkStealingThreadPoolProvider::setNumThreads (int count)
+{
+    // the deques are sized by the thread count, so restart the
+    // workers rather than adding to / removing from them
+    std::lock_guard<std::mutex> lock (_threadMutex);
+
+    lockedFinish ();
+    lockedStart (count);
+}
+
+void
+WorkStealingThreadPoolProvider::addTask (Task* task)
+{
+    addTasks (&task, 1);
+}
+
+void
+WorkStealingThreadPoolProvider::addTasks (Task* const* tasks, int count)
+{
+    if (count <= 0) return;
+
+    //
+    // setNumThreads and finish swap out the data under _threadMutex,
+    // which we cannot take here as a worker may be adding tasks while
+    // they wait for it, so hold on to a reference instead. Once the
+    // data is stopping, tasks may no longer be picked up, and are
+    // run here, as when there are no workers at all.
+    //
+    std::shared_ptr<WorkStealingThreadPoolData> d = std::atomic_load (&_data);
+
+    if (d) d->_submitting.fetch_add (1);
+
+    if (!d || d->_workers.empty () || d->_stopping.load ())
+    {
+        if (d) d->_submitting.fetch_sub (1);
+
+        for (int t = 0; t < count; ++t)
+            handleProcessTask (tasks[t]);
+        return;
+    }
+
+    WorkStealingThreadPoolData& data = *d;
+
+    if (tWorkStealingState.data == &data)
+    {
+        WorkStealingDeque& deque =
+            data._workers[tWorkStealingState.index]->_deque;
+
+        for (int t = 0; t < count; ++t)
+            deque.push (tasks[t]);
+    }
+    else
+    {
+        size_t n     = data._workers.size ();
+        size_t start = data._nextInbox.fetch_add (
+            static_cast<unsigned> (count), std::memory_order_relaxed);
+
+        for (int t = 0; t < count; ++t)
+        {
+            size_t i = 0;
+
+            for (; i < n; ++i)
+            {
+                WorkStealingInbox& inbox =
+                    data._workers[(start + t + i) % n]->_inbox;
+                if (inbox.push (tasks[t])) break;
+            }
+
+            if (i == n)
+            {
+                std::lock_guard<std::mutex> lock (data._overflowMutex);
+                data._overflow.push_back (tasks[t]);
+                data._hasOverflow.store (true, std::memory_order_release);
+            }
+        }
+    }
+
+    wake (data, count);
+
+    data._submitting.fetch_sub (1, std::memory_order_release);
+}
+
+void
+WorkStealingThreadPoolProvider::finish ()
+{
+    std::lock_guard<std::mutex> lock (_threadMutex);
+
+    lockedFinish ();
+}
+
+void
+WorkStealingThreadPoolProvider::lockedStart (int count)
+{
+    auto data = std::make_shared<WorkStealingThreadPoolData> (count);
+
+    data->_threads.reserve (static_cast<size_t> (count));
+    for (size_t i = 0; i < static_cast<size_t> (count); ++i)
+    {
+        data->_threads.emplace_back (
+            &WorkStealingThreadPoolProvider::threadLoop, data, i);
+    }
+    std::atomic_store (&_data, data);
+    _threadCount = count;
+}
+
+void
+WorkStealingThreadPoolProvider::lockedFinish ()
+{
+    std::shared_ptr<WorkStealingThreadPoolData> data =
+        std::atomic_exchange (
+            &_data, std::shared_ptr<WorkStealingThreadPoolData> ());
+
+    if (!data) return;
+
+    {
+        std::lock_guard<std::mutex> lock (data->_sleepMutex);
+        data->_stopping = true;
+        data->_wakeEpoch.fetch_add (1);
+    }
+    data->_sleepCond.notify_all ();
+
+    for (auto& t: data->_threads)
+        t.join ();
+
+    //
+    // The workers run everything queued before they notice the stop,
+    // but addTasks calls which got in just ahead of it may still be
+    // pushing tasks, so wait for those and run whatever they left.
+    //
+    while (data->_submitting.load () > 0)
+        std::this_thread::yield ();
+    drain (*data);
+
+    _threadCount = 0;
+}
+
+void
+WorkStealingThreadPoolProvider::wake (
+    WorkStealingThreadPoolData& data, int count)
+{
+    //
+    // Pairs with the fence in threadLoop: either a worker about to
+    // sleep sees the new tasks when it looks again, or we see that
+    // it is going to sleep and wake it.
+    //
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    int sleeping = data._sleeping.load (std::memory_order_relaxed);
+    if (sleeping > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock (data._sleepMutex);
+            data._wakeEpoch.fetch_add (1, std::memory_order_relaxed);
+        }
+
+        if (count >= sleeping)
+            data._sleepCond.notify_all ();
+        else
+        {
+            for (int i = 0; i < count; ++i)
+                data._sleepCond.notify_one ();
+        }
+    }
+}
+
+Task*
+WorkStealingThreadPoolProvider::findTask (
+    WorkStealingThreadPoolData& data, size_t self)
+{
+    WorkStealingWorker& me   = *data._workers[self];
+    Task*               task = me._deque.take ();
+
+    if (!task) task = me._inbox.pop ();
+
+    size_t n = data._workers.size ();
+    for (size_t i = 1; !task && i < n; ++i)
+    {
+        WorkStealingWorker& victim = *data._workers[(self + i) % n];
+
+        task = victim._deque.steal ();
+        if (!task) task = victim._inbox.pop ();
+    }
+
+    if (!task && data._hasOverflow.load (std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock (data._overflowMutex);
+        if (!data._overflow.empty ())
+        {
+            task = data._overflow.front ();
+            data._overflow.pop_front ();
+        }
+        if (data._overflow.empty ())
+            data._hasOverflow.store (false, std::memory_order_relaxed);
+    }
+
+    return task;
+}
+
+void
+WorkStealingThreadPoolProvider::drain (WorkStealingThreadPoolData& data)
+{
+    // only once the workers are gone, so any thread may take from
+    // the deques
+    for (;;)
+    {
+        Task* task = nullptr;
+
+        for (size_t i = 0; !task && i < data._workers.size (); ++i)
+        {
+            task = data._workers[i]->_deque.steal ();
+            if (!task) task = data._workers[i]->_inbox.pop ();
+        }
+
+        if (!task)
+        {
+            std::lock_guard<std::mutex> lock (data._overflowMutex);
+            if (data._overflow.empty ()) break;
+            task = data._overflow.front ();
+            data._overflow.pop_front ();
+        }
+
+        handleProcessTask (task);
+    }
+}
+
+void
+WorkStealingThreadPoolProvider::threadLoop (
+    std::shared_ptr<WorkStealingThreadPoolData> d, size_t self)
+{
+    WorkStealingThreadPoolData& data = *d;
+
+    tWorkStealingState.data  = &data;
+    tWorkStealingState.index = self;
+
+    int idle = 0;
+    while (true)
+    {
+        Task* task = findTask (data, self);
+        if (task)
+        {
+            handleProcessTask (task);
+            idle = 0;
+            continue;
+        }
+
+        if (data.stopped ()) break;
+
+        // spin a little before paying for a sleep / wake up
+        if (++idle < 64)
+        {
+            std::this_thread::yield ();
+            continue;
+        }
+
+        uint64_t epoch = data._wakeEpoch.load (std::memory_order_acquire);
+        data._sleeping.fetch_add (1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+
+        task = findTask (data, self);
+        if (!task)
+        {
+            std::unique_lock<std::mutex> lock (data._sleepMutex);
+            while (data._wakeEpoch.load (std::memory_order_relaxed) ==
+                       epoch &&
+                   !data.stopped ())
+                data._sleepCond.wait (lock);
+        }
+        data._sleeping.fetch_sub (1, std::memory_order_relaxed);
+
+        if (task) handleProcessTask (task);
+        idle = 0;
+    }
+
+    tWorkStealingState.data = nullptr;
+}
+
+//
+// Shared by the caller of ThreadPool::parallelFor and its helper
+// tasks.  Helpers that only start once the range has been used up
+// never touch fn, so the caller may return before they have run.
+//
+struct ParallelForState
+{
+    ParallelForState (int b, int e, const std::function<void (int)>& f)
+        : next (b), end (e), remaining (int64_t (e) - int64_t (b))
+        , failed (false), fn (&f)
+    {}
+
+    void run ()
+    {
+        int64_t finished = 0;
+
+        for (int64_t i = next.fetch_add (1); i < end; i = next.fetch_add (1))
+        {
+            if (!failed.load (std::memory_order_relaxed))
+            {
+                try
+                {
+                    (*fn) (static_cast<int> (i));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock (mutex);
+                    if (!exception) exception = std::current_exception ();
+                    failed = true;
+                }
+            }
+            ++finished;
+        }
+
+        if (finished > 0 && remaining.fetch_sub (finished) == finished)
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            done.notify_all ();
+        }
+    }
+
+    void wait ()
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        while (remaining.load () > 0)
+            done.wait (lock);
+    }
+
+    std::atomic<int64_t>             next;
+    const int64_t                    end;
+    std::atomic<int64_t>             remaining;
+    std::atomic<bool>                failed;
+    const std::function<void (int)>* fn;
+
+    std::mutex              mutex;
+    std::condition_variable done;
+    std::exception_ptr      exception;
+};
+
+class ParallelForTask : public Task
+{
+public:
+    ParallelForTask (std::shared_ptr<ParallelForState> state)
+        : Task (nullptr), _state (state)
+    {}
+
+    void execute () override { _state->run (); }
+
+private:
+    std::shared_ptr<ParallelForState> _state;
+};
+
 } //namespace
 
 //
@@ -468,6 +1167,13 @@ ThreadPoolProvider::ThreadPoolProvider ()
 ThreadPoolProvider::~ThreadPoolProvider ()
 {}
 
+void
+ThreadPoolProvider::addTasks (Task* const* tasks, int count)
+{
+    for (int t = 0; t < count; ++t)
+        addTask (tasks[t]);
+}
+
 //
 // class ThreadPool
 //
@@ -556,6 +1262,24 @@ ThreadPool::setThreadProvider (ThreadPoolProvider* provider)
 #endif
 }
 
+ThreadPoolProvider*
+ThreadPool::newWorkStealingProvider (int count)
+{
+#ifdef ENABLE_THREADING
+    if (count < 0)
+        throw IEX_INTERNAL_NAMESPACE::ArgExc (
+            "Attempt to create a thread provider "
+            "with a negative number of threads.");
+
+    return new WorkStealingThreadPoolProvider (count);
+#else
+    (void) count;
+    throw IEX_INTERNAL_NAMESPACE::ArgExc (
+        "Attempt to create a thread provider on a system with threads"
+        " disabled / not available");
+#endif
+}
+
 void
 ThreadPool::addTask (Task* task)
 {
@@ -574,6 +1298,69 @@ ThreadPool::addTask (Task* task)
     }
 }
 
+void
+ThreadPool::addTasks (Task* const* tasks, int count)
+{
+    if (!tasks || count <= 0) return;
+
+#ifdef ENABLE_THREADING
+    Data::ProviderPtr p = _data->getProvider ();
+    if (p)
+    {
+        p->addTasks (tasks, count);
+        return;
+    }
+#endif
+
+    for (int t = 0; t < count; ++t)
+        handleProcessTask (tasks[t]);
+}
+
+void
+ThreadPool::parallelFor (
+    int begin, int end, const std::function<void (int)>& fn)
+{
+    if (end <= begin) return;
+
+#ifdef ENABLE_THREADING
+    Data::ProviderPtr p       = _data->getProvider ();
+    int64_t           n       = int64_t (end) - int64_t (begin);
+    int               helpers = p ? p->numThreads () : 0;
+
+    if (int64_t (helpers) > n - 1) helpers = static_cast<int> (n - 1);
+
+    if (helpers > 0)
+    {
+        auto state = std::make_shared<ParallelForState> (begin, end, fn);
+
+        std::vector<Task*> tasks;
+        tasks.reserve (static_cast<size_t> (helpers));
+        try
+        {
+            for (int t = 0; t < helpers; ++t)
+                tasks.push_back (new ParallelForTask (state));
+        }
+        catch (...)
+        {
+            for (Task* t: tasks)
+                delete t;
+            throw;
+        }
+
+        p->addTasks (tasks.data (), helpers);
+
+        state->run ();
+        state->wait ();
+
+        if (state->exception) std::rethrow_exception (state->exception);
+        return;
+    }
+#endif
+
+    for (int i = begin; i < end; ++i)
+        fn (i);
+}
+
 ThreadPool&
 ThreadPool::globalThreadPool ()
 {
@@ -592,6 +1379,12 @@ ThreadPool::addGlobalTask (Task* task)
     globalThreadPool ().addTask (task);
 }
 
+void
+ThreadPool::addGlobalTasks (Task* const* tasks, int count)
+{
+    globalThreadPool ().addTasks (tasks, count);
+}
+
 unsigned
 ThreadPool::estimateThreadCountForFileIO ()
 {
@@ -35,6 +35,8 @@
 #include "IlmThreadExport.h"
 #include "IlmThreadNamespace.h"
 
+#include <functional>
+
 ILMTHREAD_INTERNAL_NAMESPACE_HEADER_ENTER
 
 class TaskGroup;
@@ -58,11 +60,16 @@ public:
     virtual void setNumThreads (int count) = 0;
     // as in ThreadPool below
     virtual void addTask (Task* task) = 0;
-
     // Ensure that all tasks in this set are finished
     // and threads shutdown
     virtual void finish () = 0;
 
+    // as in ThreadPool below; the default implementation calls
+    // addTask for each task, providers should override it if they
+    // can queue a batch for less. Declared last to keep the vtable
+    // slots of the functions above where they were.
+    ILMTHREAD_EXPORT virtual void addTasks (Task* const* tasks, int count);
+
     // Make the provider non-copyable
     ThreadPoolProvider (const ThreadPoolProvider&) = delete;
     ThreadPoolProvider& operator= (const ThreadPoolProvider&) = delete;
@@ -130,6 +137,26 @@ public:
     //--------------------------------------------------------
     ILMTHREAD_EXPORT void setThreadProvider (ThreadPoolProvider* provider);
 
+    //--------------------------------------------------------
+    // Create a work-stealing ThreadPoolProvider with count
+    // worker threads, to hand to setThreadProvider, e.g.
+    //
+    //   ThreadPool::globalThreadPool ().setThreadProvider (
+    //       ThreadPool::newWorkStealingProvider (n));
+    //
+    // Each worker has its own task queue instead of all of
+    // them sharing a single locked one, which scales better
+    // to many threads and many small tasks.  Tasks added by a
+    // worker thread are run newest first by that worker, and
+    // idle workers take the oldest tasks from busy ones, so
+    // tasks are not executed in FIFO order.
+    //
+    // Throws an ArgExc if count is negative or threading is
+    // not available.
+    //--------------------------------------------------------
+    ILMTHREAD_EXPORT
+    static ThreadPoolProvider* newWorkStealingProvider (int count);
+
     //------------------------------------------------------------
     // Add a task for processing.  The ThreadPool can handle any
     // number of tasks regardless of the number of worker threads.
@@ -139,12 +166,34 @@ public:
 
     ILMTHREAD_EXPORT void addTask (Task* task);
 
+    //------------------------------------------------------------
+    // Add count tasks for processing at once.  Equivalent to
+    // calling addTask for each of them in turn, but the tasks are
+    // queued with a single synchronization where the thread
+    // provider supports it.
+    //------------------------------------------------------------
+
+    ILMTHREAD_EXPORT void addTasks (Task* const* tasks, int count);
+
+    //------------------------------------------------------------
+    // Call fn (i) for every i in [begin, end), spread over the
+    // worker threads, and return when all calls have finished.
+    // At most one Task per worker thread is allocated, however
+    // large the range; the calling thread works through the
+    // range as well.  If any call throws, the remaining indices
+    // are skipped and the first exception is rethrown here.
+    //------------------------------------------------------------
+
+    ILMTHREAD_EXPORT void
+    parallelFor (int begin, int end, const std::function<void (int)>& fn);
+
     //-------------------------------------------
     // Access functions for the global threadpool
     //-------------------------------------------
 
     ILMTHREAD_EXPORT static ThreadPool& globalThreadPool ();
     ILMTHREAD_EXPORT static void        addGlobalTask (Task* task);
+    ILMTHREAD_EXPORT static void addGlobalTasks (Task* const* tasks, int count);
 
     struct ILMTHREAD_HIDDEN Data;
 
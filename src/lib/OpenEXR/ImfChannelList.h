@@ -15,6 +15,7 @@
 
 #include "ImfForward.h"
 
+#include "ImfFlatMap.h"
 #include "ImfName.h"
 #include "ImfPixelType.h"
 
@@ -128,7 +129,11 @@ public:
     // Iterator-style access to existing channels
     //-------------------------------------------
 
+#ifdef OPENEXR_USE_FLAT_MAPS
+    typedef FlatMap<Name, Channel> ChannelMap;
+#else
     typedef std::map<Name, Channel> ChannelMap;
+#endif
 
     class Iterator;
     class ConstIterator;
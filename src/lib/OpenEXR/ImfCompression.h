@@ -45,6 +45,18 @@ enum IMF_EXPORT_ENUM Compression
                           // wise and faster to decode full frames
                           // than DWAA_COMPRESSION.
 
+    PIZ4_COMPRESSION = 10, // piz-based wavelet compression, with the
+                           // Huffman coded data cut in 4 streams that
+                           // can be decoded side by side
+
+    ZSTD_COMPRESSION = 11, // zstd compression of the zip predicted
+                           // data, in blocks of 32 scan lines
+
+    LZ4_COMPRESSION = 12, // lossless LZ4 compression of the values
+                          // split into byte planes, in blocks of 16
+                          // scan lines. Larger than ZIP, but much
+                          // faster to write and read
+
     NUM_COMPRESSION_METHODS // number of different compression methods
 };
 
@@ -55,6 +67,9 @@ IMF_EXPORT void setDefaultZipCompressionLevel (int level);
 /// Controls the default quality level for the DWA lossy compression
 IMF_EXPORT void setDefaultDwaCompressionLevel (float level);
 
+/// Controls the default zstd compression level used by ZSTD_COMPRESSION
+IMF_EXPORT void setDefaultZstdCompressionLevel (int level);
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
 
 #endif
@@ -13,11 +13,13 @@
 #include "ImfB44Compressor.h"
 #include "ImfCheckedArithmetic.h"
 #include "ImfDwaCompressor.h"
+#include "ImfLz4Compressor.h"
 #include "ImfNamespace.h"
 #include "ImfPizCompressor.h"
 #include "ImfPxr24Compressor.h"
 #include "ImfRleCompressor.h"
 #include "ImfZipCompressor.h"
+#include "ImfZstdCompressor.h"
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
@@ -63,7 +65,10 @@ isValidCompression (Compression c)
         case B44_COMPRESSION:
         case B44A_COMPRESSION:
         case DWAA_COMPRESSION:
-        case DWAB_COMPRESSION: return true;
+        case DWAB_COMPRESSION:
+        case PIZ4_COMPRESSION:
+        case ZSTD_COMPRESSION:
+        case LZ4_COMPRESSION: return true;
 
         default: return false;
     }
@@ -113,6 +118,10 @@ newCompressor (Compression c, size_t maxScanLineSize, const Header& hdr)
 
             return new PizCompressor (hdr, maxScanLineSize, 32);
 
+        case PIZ4_COMPRESSION:
+
+            return new PizCompressor (hdr, maxScanLineSize, 32, true);
+
         case PXR24_COMPRESSION:
 
             return new Pxr24Compressor (hdr, maxScanLineSize, 16);
@@ -141,6 +150,14 @@ newCompressor (Compression c, size_t maxScanLineSize, const Header& hdr)
                 256,
                 DwaCompressor::STATIC_HUFFMAN);
 
+        case ZSTD_COMPRESSION:
+
+            return new ZstdCompressor (hdr, maxScanLineSize, 32);
+
+        case LZ4_COMPRESSION:
+
+            return new Lz4Compressor (hdr, maxScanLineSize, 16);
+
         default: return 0;
     }
 }
@@ -156,8 +173,11 @@ numLinesInBuffer (Compression comp)
         case NO_COMPRESSION:
         case RLE_COMPRESSION:
         case ZIPS_COMPRESSION: return 1;
-        case ZIP_COMPRESSION: return 16;
-        case PIZ_COMPRESSION: return 32;
+        case ZIP_COMPRESSION:
+        case LZ4_COMPRESSION: return 16;
+        case PIZ_COMPRESSION:
+        case PIZ4_COMPRESSION:
+        case ZSTD_COMPRESSION: return 32;
         case PXR24_COMPRESSION: return 16;
         case B44_COMPRESSION:
         case B44A_COMPRESSION:
@@ -187,6 +207,10 @@ newTileCompressor (
 
             return new PizCompressor (hdr, tileLineSize, numTileLines);
 
+        case PIZ4_COMPRESSION:
+
+            return new PizCompressor (hdr, tileLineSize, numTileLines, true);
+
         case PXR24_COMPRESSION:
 
             return new Pxr24Compressor (hdr, tileLineSize, numTileLines);
@@ -215,6 +239,14 @@ newTileCompressor (
                 static_cast<int> (numTileLines),
                 DwaCompressor::STATIC_HUFFMAN);
 
+        case ZSTD_COMPRESSION:
+
+            return new ZstdCompressor (hdr, tileLineSize, numTileLines);
+
+        case LZ4_COMPRESSION:
+
+            return new Lz4Compressor (hdr, tileLineSize, numTileLines);
+
         default: return 0;
     }
 }
@@ -0,0 +1,285 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	class Context
+//	class ChunkDecoder
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfContext.h"
+
+#include "ImfHeader.h"
+#include "ImfMisc.h"
+#include "ImfStdIO.h"
+#include "ImfVersion.h"
+#include "ImfXdr.h"
+
+#include "Iex.h"
+
+#include <algorithm>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+using std::min;
+using std::string;
+
+namespace
+{
+
+int64_t
+readHeaderData (
+    exr_const_context_t         ctxt,
+    void*                       userdata,
+    void*                       buffer,
+    uint64_t                    sz,
+    uint64_t                    offset,
+    exr_stream_error_func_ptr_t error_cb)
+{
+    const string* data = static_cast<const string*> (userdata);
+
+    if (offset >= data->size ()) return 0;
+
+    uint64_t n = min (sz, static_cast<uint64_t> (data->size () - offset));
+    memcpy (buffer, data->data () + offset, n);
+    return static_cast<int64_t> (n);
+}
+
+void
+ignoreErrors (exr_const_context_t ctxt, exr_result_t code, const char* msg)
+{
+    //
+    // Errors are reported to the caller by exceptions instead.
+    //
+}
+
+exr_result_t
+handOverPackedData (exr_decode_pipeline_t* decode)
+{
+    //
+    // The packed data has already been read from the file by the
+    // caller, who owns the buffer; a zero packed_alloc_size keeps
+    // the pipeline from freeing it.  An unpacked buffer that merely
+    // aliased the previous chunk's packed data is dropped too.
+    //
+
+    if (decode->unpacked_buffer == decode->packed_buffer &&
+        decode->unpacked_alloc_size == 0)
+        decode->unpacked_buffer = nullptr;
+
+    decode->packed_buffer     = decode->decoding_user_data;
+    decode->packed_alloc_size = 0;
+    return EXR_ERR_SUCCESS;
+}
+
+} // namespace
+
+Context::Context (const Header& header, const char fileName[], bool isTiled)
+    : _ctxt (nullptr)
+{
+    StdOSStream os;
+
+    int version = EXR_VERSION;
+    if (isTiled) version |= TILED_FLAG;
+    if (usesLongNames (header)) version |= LONG_NAMES_FLAG;
+
+    Xdr::write<StreamIO> (os, MAGIC);
+    Xdr::write<StreamIO> (os, version);
+    header.writeTo (os, isTiled);
+
+    _headerData = os.str ();
+
+    exr_context_initializer_t init = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    init.user_data                 = &_headerData;
+    init.read_fn                   = &readHeaderData;
+    init.error_handler_fn          = &ignoreErrors;
+    init.flags                     = EXR_CONTEXT_FLAG_SILENT_HEADER_PARSE;
+
+    if (!fileName || fileName[0] == '\0') fileName = "<memory>";
+
+    exr_result_t rv = exr_start_read (&_ctxt, fileName, &init);
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Cannot create decoding context for file \""
+                << fileName << "\": " << exr_get_error_code_as_string (rv));
+    }
+}
+
+Context::~Context ()
+{
+    exr_finish (&_ctxt);
+}
+
+ChunkDecoder::ChunkDecoder (const Context& ctxt)
+    : _ctxt (ctxt.handle ()), _initialized (false), _unpacked (false)
+{
+    memset (&_decoder, 0, sizeof (_decoder));
+}
+
+ChunkDecoder::~ChunkDecoder ()
+{
+    if (_initialized) exr_decoding_destroy (_ctxt, &_decoder);
+}
+
+void
+ChunkDecoder::begin (const exr_chunk_info_t& cinfo)
+{
+    exr_result_t rv;
+
+    if (_initialized)
+        rv = exr_decoding_update (_ctxt, 0, &cinfo, &_decoder);
+    else
+        rv = exr_decoding_initialize (_ctxt, 0, &cinfo, &_decoder);
+
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Cannot set up decoding of pixel data: "
+                << exr_get_error_code_as_string (rv));
+    }
+
+    _initialized = true;
+    _unpacked    = false;
+
+    for (int c = 0; c < _decoder.channel_count; ++c)
+    {
+        exr_coding_channel_info_t& chan = _decoder.channels[c];
+
+        chan.decode_to_ptr          = nullptr;
+        chan.user_pixel_stride      = 0;
+        chan.user_line_stride       = 0;
+        chan.user_bytes_per_element = chan.bytes_per_element;
+        chan.user_data_type         = chan.data_type;
+    }
+}
+
+bool
+ChunkDecoder::setChannel (
+    int       c,
+    char*     ptr,
+    PixelType typeInFrameBuffer,
+    size_t    xStride,
+    size_t    yStride)
+{
+    exr_coding_channel_info_t& chan = _decoder.channels[c];
+
+    //
+    // Half to float is the only conversion that cannot round
+    // differently from copyIntoFrameBuffer().  The Core unpackers
+    // also take 32-bit strides.
+    //
+
+    PixelType typeInFile = static_cast<PixelType> (chan.data_type);
+
+    if (typeInFrameBuffer != typeInFile &&
+        !(typeInFile == HALF && typeInFrameBuffer == FLOAT))
+        return false;
+
+    if (xStride == 0 || xStride > size_t (INT32_MAX) || yStride == 0 ||
+        yStride > size_t (INT32_MAX))
+        return false;
+
+    chan.decode_to_ptr          = reinterpret_cast<uint8_t*> (ptr);
+    chan.user_pixel_stride      = static_cast<int32_t> (xStride);
+    chan.user_line_stride       = static_cast<int32_t> (yStride);
+    chan.user_data_type         = static_cast<uint16_t> (typeInFrameBuffer);
+    chan.user_bytes_per_element = (typeInFrameBuffer == HALF) ? 2 : 4;
+    return true;
+}
+
+bool
+ChunkDecoder::canUnpack () const
+{
+    int     filled     = 0;
+    bool    typeChange = false;
+    bool    sameStride = true;
+    int32_t lineStride = 0;
+
+    for (int c = 0; c < _decoder.channel_count; ++c)
+    {
+        const exr_coding_channel_info_t& chan = _decoder.channels[c];
+
+        if (!chan.decode_to_ptr) continue;
+
+        if (chan.user_data_type != chan.data_type) typeChange = true;
+
+        if (filled == 0)
+            lineStride = chan.user_line_stride;
+        else if (chan.user_line_stride != lineStride)
+            sameStride = false;
+
+        ++filled;
+    }
+
+    //
+    // The specialized half to float unpackers assume that every
+    // channel is written, and some assume one line stride for all.
+    //
+
+    if (filled == 0) return false;
+
+    if (filled == _decoder.channel_count) return sameStride;
+
+    return !typeChange;
+}
+
+void
+ChunkDecoder::run (const char packedData[], bool unpack)
+{
+    exr_result_t rv;
+
+    if (unpack && !canUnpack ())
+    {
+        for (int c = 0; c < _decoder.channel_count; ++c)
+            _decoder.channels[c].decode_to_ptr = nullptr;
+
+        unpack = false;
+    }
+
+    rv = exr_decoding_choose_default_routines (_ctxt, 0, &_decoder);
+
+    if (rv == EXR_ERR_SUCCESS)
+    {
+        _decoder.decoding_user_data = const_cast<char*> (packedData);
+        _decoder.read_fn            = &handOverPackedData;
+
+        //
+        // Chunks that are no smaller than their uncompressed size are
+        // stored raw, whatever the file's compression method.
+        //
+
+        if (_decoder.chunk.packed_size == _decoder.chunk.unpacked_size)
+            _decoder.decompress_fn = nullptr;
+
+        if (!unpack) _decoder.unpack_and_convert_fn = nullptr;
+
+        rv = exr_decoding_run (_ctxt, 0, &_decoder);
+    }
+
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Error decoding pixel data: "
+                << exr_get_error_code_as_string (rv));
+    }
+
+    _unpacked = _decoder.unpack_and_convert_fn != nullptr;
+}
+
+const char*
+ChunkDecoder::uncompressedData () const
+{
+    return static_cast<const char*> (_decoder.unpacked_buffer);
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -0,0 +1,120 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_CONTEXT_H
+#define INCLUDED_IMF_CONTEXT_H
+
+//-----------------------------------------------------------------------------
+//
+//	class Context -- an OpenEXRCore read context describing a single
+//	part whose header has already been parsed by the C++ library.
+//
+//	class ChunkDecoder -- a reusable OpenEXRCore decode pipeline for
+//	chunks whose packed data the caller has already read from the
+//	file.  The pipeline decompresses the chunk and, if the caller has
+//	pointed the channels at a frame buffer, unpacks it in place.
+//
+//	Neither class touches the input stream; the C++ library keeps
+//	doing all of its own I/O.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfForward.h"
+#include "ImfPixelType.h"
+
+#include <openexr_decode.h>
+
+#include <string>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+class Context
+{
+public:
+    //---------------------------------------------------------------
+    // Constructor -- builds a context from a serialized copy of the
+    // header.  Throws an exception if OpenEXRCore rejects the header.
+    //---------------------------------------------------------------
+
+    Context (const Header& header, const char fileName[], bool isTiled);
+    ~Context ();
+
+    Context (const Context&)            = delete;
+    Context& operator= (const Context&) = delete;
+    Context (Context&&)                 = delete;
+    Context& operator= (Context&&)      = delete;
+
+    exr_const_context_t handle () const { return _ctxt; }
+
+private:
+    std::string   _headerData;
+    exr_context_t _ctxt;
+};
+
+class ChunkDecoder
+{
+public:
+    explicit ChunkDecoder (const Context& ctxt);
+    ~ChunkDecoder ();
+
+    ChunkDecoder (const ChunkDecoder&)            = delete;
+    ChunkDecoder& operator= (const ChunkDecoder&) = delete;
+    ChunkDecoder (ChunkDecoder&&)                 = delete;
+    ChunkDecoder& operator= (ChunkDecoder&&)      = delete;
+
+    //------------------------------------------------------------
+    // Prepare the pipeline for a chunk.  All channel destinations
+    // are reset, so nothing is unpacked unless the caller calls
+    // setChannel() before run().
+    //------------------------------------------------------------
+
+    void begin (const exr_chunk_info_t& cinfo);
+
+    int channelCount () const { return _decoder.channel_count; }
+
+    //------------------------------------------------------------
+    // Point channel c, in file order, at a frame buffer slice.  ptr
+    // is the address of the chunk's first pixel.  Returns false if
+    // the Core unpackers cannot produce exactly what
+    // copyIntoFrameBuffer() would for this slice.
+    //------------------------------------------------------------
+
+    bool setChannel (
+        int       c,
+        char*     ptr,
+        PixelType typeInFrameBuffer,
+        size_t    xStride,
+        size_t    yStride);
+
+    //------------------------------------------------------------
+    // Decompress the packed data for the chunk set up by begin().
+    // If unpack is true, and the channels set with setChannel()
+    // form a layout the Core unpackers handle, the pixels are also
+    // written to the frame buffer.  Throws an exception if decoding
+    // fails.
+    //------------------------------------------------------------
+
+    void run (const char packedData[], bool unpack);
+
+    //------------------------------------------------------------
+    // Results of the last run(): the uncompressed pixel data, in
+    // Xdr format, and whether the pixels have been unpacked.
+    //------------------------------------------------------------
+
+    const char* uncompressedData () const;
+    bool        unpacked () const { return _unpacked; }
+
+private:
+    bool canUnpack () const;
+
+    exr_const_context_t   _ctxt;
+    exr_decode_pipeline_t _decoder;
+    bool                  _initialized;
+    bool                  _unpacked;
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
@@ -112,7 +112,11 @@ public:
     // Iterator-style access to existing slices
     //-----------------------------------------
 
+#ifdef OPENEXR_USE_FLAT_MAPS
+    typedef FlatMap<Name, DeepSlice> SliceMap;
+#else
     typedef std::map<Name, DeepSlice> SliceMap;
+#endif
 
     class Iterator;
     class ConstIterator;
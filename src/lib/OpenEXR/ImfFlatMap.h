@@ -0,0 +1,140 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_FLAT_MAP_H
+#define INCLUDED_IMF_FLAT_MAP_H
+
+//-----------------------------------------------------------------------------
+//
+//	class FlatMap -- an ordered map stored in a sorted vector
+//
+//	Holds the name to slice, channel and attribute maps of frame
+//	buffers, channel lists and headers.  Those are built once and
+//	then searched and iterated over many times, for instance once
+//	per tile when a frame buffer is set, so a single contiguous
+//	array is much kinder to the cache than the nodes of a std::map.
+//	Lookups accept anything that compares with the key, so finding
+//	a Name by a C string does not construct a temporary Name.
+//
+//	Iteration order is key order, as with std::map.  Unlike a
+//	std::map, inserting or erasing an element invalidates
+//	iterators and references to the other elements.
+//
+//	Those classes only use FlatMap when the library is built with
+//	OPENEXR_USE_FLAT_MAPS (the OPENEXR_ENABLE_FLAT_MAPS cmake
+//	option), since it changes their ABI and the lifetime of the
+//	references they hand out; otherwise they keep a std::map.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfNamespace.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+template <class Key, class T> class FlatMap
+{
+public:
+    typedef Key                                             key_type;
+    typedef T                                               mapped_type;
+    typedef std::pair<Key, T>                               value_type;
+    typedef typename std::vector<value_type>::iterator       iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+    typedef typename std::vector<value_type>::size_type      size_type;
+
+    iterator       begin () { return _elements.begin (); }
+    const_iterator begin () const { return _elements.begin (); }
+    iterator       end () { return _elements.end (); }
+    const_iterator end () const { return _elements.end (); }
+
+    bool      empty () const { return _elements.empty (); }
+    size_type size () const { return _elements.size (); }
+    void      reserve (size_type n) { _elements.reserve (n); }
+    void      clear () { _elements.clear (); }
+    void      swap (FlatMap& other) { _elements.swap (other._elements); }
+
+    //
+    // First element whose key is not less than key
+    //
+
+    template <class K> iterator lower_bound (const K& key)
+    {
+        return std::lower_bound (
+            _elements.begin (), _elements.end (), key, KeyLess<K> ());
+    }
+
+    template <class K> const_iterator lower_bound (const K& key) const
+    {
+        return std::lower_bound (
+            _elements.begin (), _elements.end (), key, KeyLess<K> ());
+    }
+
+    template <class K> iterator find (const K& key)
+    {
+        iterator i = lower_bound (key);
+        return (i == end () || key < i->first) ? end () : i;
+    }
+
+    template <class K> const_iterator find (const K& key) const
+    {
+        const_iterator i = lower_bound (key);
+        return (i == end () || key < i->first) ? end () : i;
+    }
+
+    //
+    // Element with the given key, inserting a default
+    // constructed value if there is none
+    //
+
+    template <class K> T& operator[] (const K& key)
+    {
+        iterator i = lower_bound (key);
+
+        if (i == end () || key < i->first)
+            i = _elements.insert (i, value_type (Key (key), T ()));
+
+        return i->second;
+    }
+
+    std::pair<iterator, bool> insert (const value_type& value)
+    {
+        iterator i = lower_bound (value.first);
+
+        if (i != end () && !(value.first < i->first))
+            return std::make_pair (i, false);
+
+        return std::make_pair (_elements.insert (i, value), true);
+    }
+
+    iterator erase (iterator i) { return _elements.erase (i); }
+    iterator erase (const_iterator i) { return _elements.erase (i); }
+
+    template <class K> size_type erase (const K& key)
+    {
+        iterator i = find (key);
+        if (i == end ()) return 0;
+
+        _elements.erase (i);
+        return 1;
+    }
+
+private:
+    template <class K> struct KeyLess
+    {
+        bool operator() (const value_type& element, const K& key) const
+        {
+            return element.first < key;
+        }
+    };
+
+    std::vector<value_type> _elements;
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
@@ -15,6 +15,7 @@
 
 #include "ImfForward.h"
 
+#include "ImfFlatMap.h"
 #include "ImfName.h"
 #include "ImfPixelType.h"
 
@@ -199,7 +200,11 @@ public:
     // Iterator-style access to existing slices
     //-----------------------------------------
 
+#ifdef OPENEXR_USE_FLAT_MAPS
+    typedef FlatMap<Name, Slice> SliceMap;
+#else
     typedef std::map<Name, Slice> SliceMap;
+#endif
 
     class Iterator;
     class ConstIterator;
@@ -70,9 +70,11 @@ struct CompressionRecord
     {
         exr_get_default_zip_compression_level(&zip_level);
         exr_get_default_dwa_compression_quality(&dwa_level);
+        exr_get_default_zstd_compression_level(&zstd_level);
     }
     int   zip_level;
     float dwa_level;
+    int   zstd_level;
 };
 // NB: This is extra complicated than one would normally write to
 // handle scenario that seems to happen on MacOS/Windows (probably
@@ -266,6 +268,12 @@ setDefaultDwaCompressionLevel (float level)
     exr_set_default_dwa_compression_quality (level);
 }
 
+void
+setDefaultZstdCompressionLevel (int level)
+{
+    exr_set_default_zstd_compression_level (level);
+}
+
 Header::Header (
     int         width,
     int         height,
@@ -708,6 +716,18 @@ Header::dwaCompressionLevel () const
     return retrieveCompressionRecord (this).dwa_level;
 }
 
+int&
+Header::zstdCompressionLevel ()
+{
+    return retrieveCompressionRecord (this).zstd_level;
+}
+
+int
+Header::zstdCompressionLevel () const
+{
+    return retrieveCompressionRecord (this).zstd_level;
+}
+
 void
 Header::setName (const string& name)
 {
@@ -1510,6 +1530,7 @@ staticInitialize ()
 
         DwaCompressor::initializeFuncs ();
         Zip::initializeFuncs ();
+        initializeCopyIntoFrameBufferFuncs ();
 
         initialized = true;
     }
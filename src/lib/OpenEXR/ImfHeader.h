@@ -18,6 +18,7 @@
 #include <Imath/ImathBox.h>
 #include <Imath/ImathVec.h>
 #include "ImfCompression.h"
+#include "ImfFlatMap.h"
 #include "ImfLineOrder.h"
 #include "ImfName.h"
 #include "ImfTileDescription.h"
@@ -197,7 +198,11 @@ public:
     // Iterator-style access to existing attributes
     //---------------------------------------------
 
+#ifdef OPENEXR_USE_FLAT_MAPS
+    typedef FlatMap<Name, Attribute*> AttributeMap;
+#else
     typedef std::map<Name, Attribute*> AttributeMap;
+#endif
 
     class Iterator;
     class ConstIterator;
@@ -285,6 +290,10 @@ public:
     float& dwaCompressionLevel ();
     IMF_EXPORT
     float dwaCompressionLevel () const;
+    IMF_EXPORT
+    int& zstdCompressionLevel ();
+    IMF_EXPORT
+    int zstdCompressionLevel () const;
 
     //-----------------------------------------------------
     // Access to required attributes for multipart files
@@ -949,6 +949,21 @@ readUInt (const char buf[4])
            ((b[2] << 16) & 0x00ff0000) | ((b[3] << 24) & 0xff000000);
 }
 
+//
+// The multi stream layout cuts nRaw values in runs of the same
+// length, with the last one shorter (or empty); stream s holds
+// the values from first on.
+//
+
+int
+hufStreamValues (int nRaw, int nStreams, int s, int& first)
+{
+    int perStream = nRaw / nStreams + (nRaw % nStreams != 0);
+
+    first = std::min (perStream * s, nRaw);
+    return std::min (perStream, nRaw - first);
+}
+
 } // namespace
 
 //
@@ -1064,4 +1079,161 @@ hufUncompress (
     }
 }
 
+int
+hufCompressStreams (const unsigned short raw[], int nRaw, char compressed[])
+{
+    if (nRaw == 0) return 0;
+
+    AutoArray<uint64_t, HUF_ENCSIZE> freq;
+
+    countFrequencies (freq, raw, nRaw);
+
+    int im = 0;
+    int iM = 0;
+    hufBuildEncTable (freq, &im, &iM);
+
+    char* tableStart = compressed + 20 + 4 * HUF_STREAMS;
+    char* tableEnd   = tableStart;
+    hufPackEncTable (freq, im, iM, &tableEnd);
+    int tableLength = tableEnd - tableStart;
+
+    char* dataStart = tableEnd;
+    int   totalBits = 0;
+
+    for (int s = 0; s < HUF_STREAMS; ++s)
+    {
+        int first;
+        int count = hufStreamValues (nRaw, HUF_STREAMS, s, first);
+        int nBits = 0;
+
+        if (count > 0) nBits = hufEncode (freq, raw + first, count, iM, dataStart);
+
+        writeUInt (compressed + 20 + 4 * s, nBits);
+        totalBits += nBits;
+        dataStart += (nBits + 7) / 8;
+    }
+
+    writeUInt (compressed, im);
+    writeUInt (compressed + 4, iM);
+    writeUInt (compressed + 8, tableLength);
+    writeUInt (compressed + 12, totalBits);
+    writeUInt (compressed + 16, HUF_STREAMS);
+
+    return dataStart - compressed;
+}
+
+void
+hufUncompressStreams (
+    const char compressed[], int nCompressed, unsigned short raw[], int nRaw)
+{
+    if (nCompressed < 20)
+    {
+        if (nRaw != 0) notEnoughData ();
+
+        return;
+    }
+
+    int im = readUInt (compressed);
+    int iM = readUInt (compressed + 4);
+    // int tableLength = readUInt (compressed + 8);
+    int totalBits = readUInt (compressed + 12);
+    int nStreams  = readUInt (compressed + 16);
+
+    if (im < 0 || im >= HUF_ENCSIZE || iM < 0 || iM >= HUF_ENCSIZE)
+        invalidTableSize ();
+
+    if (nStreams < 1 || nStreams > HUF_STREAMS ||
+        nCompressed < 20 + 4 * nStreams)
+        invalidNBits ();
+
+    int      nBits[HUF_STREAMS];
+    uint64_t nBytes  = 0;
+    uint64_t sumBits = 0;
+    bool     allLong = true;
+
+    for (int s = 0; s < nStreams; ++s)
+    {
+        nBits[s] = readUInt (compressed + 20 + 4 * s);
+        if (nBits[s] < 0) invalidNBits ();
+
+        sumBits += nBits[s];
+        nBytes += (static_cast<uint64_t> (nBits[s]) + 7) / 8;
+        if (nBits[s] <= 128) allLong = false;
+    }
+
+    if (totalBits < 0 || sumBits != static_cast<uint64_t> (totalBits))
+        invalidNBits ();
+
+    const char* ptr = compressed + 20 + 4 * nStreams;
+
+    if (ptr + nBytes > compressed + nCompressed)
+    {
+        notEnoughData ();
+        return;
+    }
+
+    //
+    // The streams are decoded one after the other, with the fast
+    // decoder if all of them are long enough for it
+    //
+
+    if (FastHufDecoder::enabled () && allLong)
+    {
+        FastHufDecoder fhd (ptr, nCompressed - (ptr - compressed), im, iM, iM);
+
+        if (ptr - compressed + nBytes > static_cast<uint64_t> (nCompressed))
+        {
+            notEnoughData ();
+            return;
+        }
+
+        for (int s = 0; s < nStreams; ++s)
+        {
+            int first;
+            int count = hufStreamValues (nRaw, nStreams, s, first);
+
+            fhd.decode ((unsigned char*) ptr, nBits[s], raw + first, count);
+            ptr += (nBits[s] + 7) / 8;
+        }
+    }
+    else
+    {
+        AutoArray<uint64_t, HUF_ENCSIZE> freq;
+        AutoArray<HufDec, HUF_DECSIZE>   hdec;
+
+        hufClearDecTable (hdec);
+
+        hufUnpackEncTable (
+            &ptr, nCompressed - (ptr - compressed), im, iM, freq);
+
+        try
+        {
+            if (nBytes > static_cast<uint64_t> (nCompressed - (ptr - compressed)))
+                invalidNBits ();
+
+            hufBuildDecTable (freq, im, iM, hdec);
+
+            for (int s = 0; s < nStreams; ++s)
+            {
+                int first;
+                int count = hufStreamValues (nRaw, nStreams, s, first);
+
+                if (count > 0)
+                    hufDecode (freq, hdec, ptr, nBits[s], iM, count, raw + first);
+                else if (nBits[s] != 0)
+                    tooMuchData ();
+
+                ptr += (nBits[s] + 7) / 8;
+            }
+        }
+        catch (...)
+        {
+            hufFreeDecTable (hdec);
+            throw;
+        }
+
+        hufFreeDecTable (hdec);
+    }
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
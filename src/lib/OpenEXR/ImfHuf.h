@@ -27,6 +27,13 @@
 //		Uncompresses the data in array c (with length nc),
 //		and stores the results in array r (with length nr).
 //
+//	hufCompressStreams (r, nr, c)
+//	hufUncompressStreams (c, nc, r, nr)
+//
+//		The same, but the data are cut in HUF_STREAMS parts,
+//		each coded into a separate bit stream, which a decoder
+//		can work on at the same time (PIZ4_COMPRESSION).
+//
 //-----------------------------------------------------------------------------
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
@@ -44,6 +51,21 @@ void hufUncompress (
     unsigned short raw[/*nRaw*/],
     int            nRaw);
 
+static const int HUF_STREAMS = 4;
+
+IMF_EXPORT
+int hufCompressStreams (
+    const unsigned short raw[/*nRaw*/],
+    int                  nRaw,
+    char                 compressed[/*2 * nRaw + 65536 + 4 * HUF_STREAMS*/]);
+
+IMF_EXPORT
+void hufUncompressStreams (
+    const char     compressed[/*nCompressed*/],
+    int            nCompressed,
+    unsigned short raw[/*nRaw*/],
+    int            nRaw);
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
 
 #endif
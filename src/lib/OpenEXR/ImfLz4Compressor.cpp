@@ -0,0 +1,242 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	class Lz4Compressor
+//
+//	The values of each channel in a scan line are split into byte
+//	planes: the first byte of every value, then the second byte of
+//	every value, and so on, which lines up the slowly changing high
+//	bytes of neighboring pixels.  The planes of all the scan lines
+//	in the block are then compressed as a single LZ4 block.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfLz4Compressor.h"
+#include "ImfChannelList.h"
+#include "ImfCheckedArithmetic.h"
+#include "ImfHeader.h"
+#include "ImfMisc.h"
+#include "ImfNamespace.h"
+
+#include <Iex.h>
+#include <Imath/ImathFun.h>
+
+#include <algorithm>
+#include <openexr_compression.h>
+
+using namespace std;
+using namespace IMATH_NAMESPACE;
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+Lz4Compressor::Lz4Compressor (
+    const Header& hdr, size_t maxScanLineSize, size_t numScanLines)
+    : Compressor (hdr)
+    , _maxScanLineSize (maxScanLineSize)
+    , _numScanLines (numScanLines)
+    , _tmpBuffer (0)
+    , _outBuffer (0)
+    , _channels (hdr.channels ())
+{
+    size_t maxInBytes = uiMult (maxScanLineSize, numScanLines);
+
+    _tmpBuffer = new char[maxInBytes];
+    _outBuffer = new char[exr_lz4_compress_max_buffer_size (maxInBytes)];
+
+    const Box2i& dataWindow = hdr.dataWindow ();
+
+    _minX = dataWindow.min.x;
+    _maxX = dataWindow.max.x;
+    _maxY = dataWindow.max.y;
+}
+
+Lz4Compressor::~Lz4Compressor ()
+{
+    delete[] _tmpBuffer;
+    delete[] _outBuffer;
+}
+
+int
+Lz4Compressor::numScanLines () const
+{
+    return _numScanLines;
+}
+
+int
+Lz4Compressor::compress (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    return compress (
+        inPtr,
+        inSize,
+        Box2i (V2i (_minX, minY), V2i (_maxX, minY + _numScanLines - 1)),
+        outPtr);
+}
+
+int
+Lz4Compressor::compressTile (
+    const char* inPtr, int inSize, Box2i range, const char*& outPtr)
+{
+    return compress (inPtr, inSize, range, outPtr);
+}
+
+int
+Lz4Compressor::uncompress (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    return uncompress (
+        inPtr,
+        inSize,
+        Box2i (V2i (_minX, minY), V2i (_maxX, minY + _numScanLines - 1)),
+        outPtr);
+}
+
+int
+Lz4Compressor::uncompressTile (
+    const char* inPtr, int inSize, Box2i range, const char*& outPtr)
+{
+    return uncompress (inPtr, inSize, range, outPtr);
+}
+
+int
+Lz4Compressor::compress (
+    const char* inPtr, int inSize, Box2i range, const char*& outPtr)
+{
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0)
+    {
+        outPtr = _outBuffer;
+        return 0;
+    }
+
+    int minX = range.min.x;
+    int maxX = min (range.max.x, _maxX);
+    int minY = range.min.y;
+    int maxY = min (range.max.y, _maxY);
+
+    const char* inEnd  = inPtr + inSize;
+    char*       tmpEnd = _tmpBuffer;
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (ChannelList::ConstIterator i = _channels.begin ();
+             i != _channels.end ();
+             ++i)
+        {
+            const Channel& c = i.channel ();
+
+            if (modp (y, c.ySampling) != 0) continue;
+
+            int n    = numSamples (c.xSampling, minX, maxX);
+            int size = pixelTypeSize (c.type);
+
+            if (inEnd - inPtr < n * size)
+                throw IEX_NAMESPACE::ArgExc ("Unexpected size of the "
+                                             "uncompressed data.");
+
+            for (int k = 0; k < size; ++k)
+                for (int j = 0; j < n; ++j)
+                    *tmpEnd++ = inPtr[j * size + k];
+
+            inPtr += n * size;
+        }
+    }
+
+    size_t tmpSize = static_cast<size_t> (tmpEnd - _tmpBuffer);
+    size_t outSize;
+
+    if (EXR_ERR_SUCCESS != exr_lz4_compress_buffer (
+                               nullptr,
+                               _tmpBuffer,
+                               tmpSize,
+                               _outBuffer,
+                               exr_lz4_compress_max_buffer_size (tmpSize),
+                               &outSize))
+    {
+        throw IEX_NAMESPACE::BaseExc ("Data compression (lz4) failed.");
+    }
+
+    outPtr = _outBuffer;
+    return outSize;
+}
+
+int
+Lz4Compressor::uncompress (
+    const char* inPtr, int inSize, Box2i range, const char*& outPtr)
+{
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0)
+    {
+        outPtr = _outBuffer;
+        return 0;
+    }
+
+    size_t tmpSize =
+        uiMult (_maxScanLineSize, static_cast<size_t> (_numScanLines));
+
+    if (EXR_ERR_SUCCESS != exr_lz4_uncompress_buffer (
+                               nullptr,
+                               inPtr,
+                               inSize,
+                               _tmpBuffer,
+                               tmpSize,
+                               &tmpSize))
+    {
+        throw IEX_NAMESPACE::InputExc ("Data decompression (lz4) failed.");
+    }
+
+    int minX = range.min.x;
+    int maxX = min (range.max.x, _maxX);
+    int minY = range.min.y;
+    int maxY = min (range.max.y, _maxY);
+
+    const char* tmpPtr   = _tmpBuffer;
+    const char* tmpEnd   = _tmpBuffer + tmpSize;
+    char*       writePtr = _outBuffer;
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (ChannelList::ConstIterator i = _channels.begin ();
+             i != _channels.end ();
+             ++i)
+        {
+            const Channel& c = i.channel ();
+
+            if (modp (y, c.ySampling) != 0) continue;
+
+            int n    = numSamples (c.xSampling, minX, maxX);
+            int size = pixelTypeSize (c.type);
+
+            if (tmpEnd - tmpPtr < n * size)
+                throw IEX_NAMESPACE::InputExc (
+                    "Error decompressing data "
+                    "(input data are shorter than expected).");
+
+            for (int k = 0; k < size; ++k)
+                for (int j = 0; j < n; ++j)
+                    writePtr[j * size + k] = *tmpPtr++;
+
+            writePtr += n * size;
+        }
+    }
+
+    if (tmpPtr != tmpEnd)
+        throw IEX_NAMESPACE::InputExc (
+            "Error decompressing data "
+            "(input data are longer than expected).");
+
+    outPtr = _outBuffer;
+    return writePtr - _outBuffer;
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -0,0 +1,78 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_LZ4_COMPRESSOR_H
+#define INCLUDED_IMF_LZ4_COMPRESSOR_H
+
+//-----------------------------------------------------------------------------
+//
+//	class Lz4Compressor -- splits each value into byte planes and
+//	compresses them with LZ4, for fast decoding
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfCompressor.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+class Lz4Compressor : public Compressor
+{
+public:
+    Lz4Compressor (
+        const Header& hdr, size_t maxScanLineSize, size_t numScanLines);
+
+    virtual ~Lz4Compressor ();
+
+    Lz4Compressor (const Lz4Compressor& other)            = delete;
+    Lz4Compressor& operator= (const Lz4Compressor& other) = delete;
+    Lz4Compressor (Lz4Compressor&& other)                 = delete;
+    Lz4Compressor& operator= (Lz4Compressor&& other)      = delete;
+
+    virtual int numScanLines () const;
+
+    virtual int
+    compress (const char* inPtr, int inSize, int minY, const char*& outPtr);
+
+    virtual int compressTile (
+        const char*            inPtr,
+        int                    inSize,
+        IMATH_NAMESPACE::Box2i range,
+        const char*&           outPtr);
+
+    virtual int
+    uncompress (const char* inPtr, int inSize, int minY, const char*& outPtr);
+
+    virtual int uncompressTile (
+        const char*            inPtr,
+        int                    inSize,
+        IMATH_NAMESPACE::Box2i range,
+        const char*&           outPtr);
+
+private:
+    int compress (
+        const char*            inPtr,
+        int                    inSize,
+        IMATH_NAMESPACE::Box2i range,
+        const char*&           outPtr);
+
+    int uncompress (
+        const char*            inPtr,
+        int                    inSize,
+        IMATH_NAMESPACE::Box2i range,
+        const char*&           outPtr);
+
+    size_t             _maxScanLineSize;
+    int                _numScanLines;
+    char*              _tmpBuffer;
+    char*              _outBuffer;
+    const ChannelList& _channels;
+    int                _minX;
+    int                _maxX;
+    int                _maxY;
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
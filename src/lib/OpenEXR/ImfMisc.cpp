@@ -20,11 +20,13 @@
 #include <ImfMisc.h>
 #include <ImfPartType.h>
 #include <ImfStdIO.h>
+#include <ImfSystemSpecific.h>
 #include <ImfTileDescription.h>
 #include <ImfXdr.h>
 
 #include <codecvt>
 #include <locale>
+#include <string.h>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
@@ -260,6 +262,290 @@ numLinesInBuffer (Compressor* compressor)
     return compressor ? compressor->numScanLines () : 1;
 }
 
+namespace
+{
+
+//
+// Specialized kernels for copyIntoFrameBuffer(), one for each
+// combination of pixel type in the file, pixel type in the frame
+// buffer and stride class: packed when the frame buffer slice is a
+// contiguous array of its pixel type (planar), strided otherwise
+// (interleaved).  The kernels are plain loops over elements of known
+// size, which the compiler vectorizes for the packed cases.  Half to
+// float, the one conversion that needs a table lookup per pixel, has
+// explicit F16C and NEON versions, selected at runtime in
+// initializeCopyIntoFrameBufferFuncs().
+//
+
+enum CopyStride
+{
+    COPY_PACKED = 0,
+    COPY_STRIDED,
+    NUM_COPY_STRIDES
+};
+
+typedef void (*CopyIntoFrameBufferFunc) (
+    const char*& readPtr, char* writePtr, size_t count, size_t xStride);
+
+template <class T>
+inline T
+loadPixel (const char* ptr)
+{
+    T v;
+    memcpy (&v, ptr, sizeof (T));
+    return v;
+}
+
+template <class T>
+inline void
+storePixel (char* ptr, const T& v)
+{
+    memcpy (ptr, &v, sizeof (T));
+}
+
+inline void
+convertPixel (unsigned int in, unsigned int& out)
+{
+    out = in;
+}
+
+inline void
+convertPixel (half in, unsigned int& out)
+{
+    out = halfToUint (in);
+}
+
+inline void
+convertPixel (float in, unsigned int& out)
+{
+    out = floatToUint (in);
+}
+
+inline void
+convertPixel (unsigned int in, half& out)
+{
+    out = uintToHalf (in);
+}
+
+inline void
+convertPixel (half in, half& out)
+{
+    out = in;
+}
+
+inline void
+convertPixel (float in, half& out)
+{
+    out = floatToHalf (in);
+}
+
+inline void
+convertPixel (unsigned int in, float& out)
+{
+    out = float (in);
+}
+
+inline void
+convertPixel (half in, float& out)
+{
+    out = float (in);
+}
+
+inline void
+convertPixel (float in, float& out)
+{
+    out = in;
+}
+
+template <class FileT, class FrameBufferT, int Stride>
+void
+copyPixels (const char*& readPtr, char* writePtr, size_t count, size_t xStride)
+{
+    const size_t stride =
+        (Stride == COPY_PACKED) ? sizeof (FrameBufferT) : xStride;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        FrameBufferT out;
+        convertPixel (loadPixel<FileT> (readPtr + i * sizeof (FileT)), out);
+        storePixel (writePtr + i * stride, out);
+    }
+    readPtr += count * sizeof (FileT);
+}
+
+template <class T>
+void
+copyPackedPixels (
+    const char*& readPtr, char* writePtr, size_t count, size_t /*xStride*/)
+{
+    memcpy (writePtr, readPtr, count * sizeof (T));
+    readPtr += count * sizeof (T);
+}
+
+#ifdef IMF_HAVE_GCC_INLINEASM_X86
+
+//
+// F16C conversion of 32 halves, unaligned source and destination.
+// As with the DWA compressor, inline asm rather than intrinsics so
+// the rest of the file can still be built without VEX.
+//
+
+void
+halfToFloat32_f16c (float* dst, const char* src)
+{
+    __asm__("vmovdqu       (%0),     %%xmm0         \n"
+            "vmovdqu   0x10(%0),     %%xmm1         \n"
+            "vmovdqu   0x20(%0),     %%xmm2         \n"
+            "vmovdqu   0x30(%0),     %%xmm3         \n"
+            "vcvtph2ps %%xmm0,       %%ymm0         \n"
+            "vcvtph2ps %%xmm1,       %%ymm1         \n"
+            "vcvtph2ps %%xmm2,       %%ymm2         \n"
+            "vcvtph2ps %%xmm3,       %%ymm3         \n"
+            "vmovups   %%ymm0,       0x00(%1)       \n"
+            "vmovups   %%ymm1,       0x20(%1)       \n"
+            "vmovups   %%ymm2,       0x40(%1)       \n"
+            "vmovups   %%ymm3,       0x60(%1)       \n"
+#    ifndef __AVX__
+            "vzeroupper                             \n"
+#    endif /* __AVX__ */
+            : /* Output  */
+            : /* Input   */ "r"(src), "r"(dst)
+#    ifndef __AVX__
+            : /* Clobber */ "%xmm0", "%xmm1", "%xmm2", "%xmm3", "memory"
+#    else
+            : /* Clobber */ "%ymm0", "%ymm1", "%ymm2", "%ymm3", "memory"
+#    endif /* __AVX__ */
+    );
+}
+
+template <int Stride>
+void
+copyHalfToFloat_f16c (
+    const char*& readPtr, char* writePtr, size_t count, size_t xStride)
+{
+    size_t i = 0;
+
+    for (; i + 32 <= count; i += 32)
+    {
+        const char* src = readPtr + i * sizeof (half);
+
+        if (Stride == COPY_PACKED)
+        {
+            halfToFloat32_f16c ((float*) (writePtr + i * sizeof (float)), src);
+        }
+        else
+        {
+            float tmp[32];
+            halfToFloat32_f16c (tmp, src);
+            for (int j = 0; j < 32; ++j)
+                storePixel (writePtr + (i + j) * xStride, tmp[j]);
+        }
+    }
+
+    readPtr += i * sizeof (half);
+    copyPixels<half, float, Stride> (
+        readPtr,
+        writePtr + i * ((Stride == COPY_PACKED) ? sizeof (float) : xStride),
+        count - i,
+        xStride);
+}
+
+#endif /* IMF_HAVE_GCC_INLINEASM_X86 */
+
+#ifdef IMF_HAVE_NEON_AARCH64
+
+template <int Stride>
+void
+copyHalfToFloat_neon (
+    const char*& readPtr, char* writePtr, size_t count, size_t xStride)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        float16x8_t h = vreinterpretq_f16_u16 (
+            vld1q_u16 ((const uint16_t*) (readPtr + i * sizeof (half))));
+        float32x4_t lo = vcvt_f32_f16 (vget_low_f16 (h));
+        float32x4_t hi = vcvt_high_f32_f16 (h);
+
+        if (Stride == COPY_PACKED)
+        {
+            float* dst = (float*) (writePtr + i * sizeof (float));
+            vst1q_f32 (dst, lo);
+            vst1q_f32 (dst + 4, hi);
+        }
+        else
+        {
+            float tmp[8];
+            vst1q_f32 (tmp, lo);
+            vst1q_f32 (tmp + 4, hi);
+            for (int j = 0; j < 8; ++j)
+                storePixel (writePtr + (i + j) * xStride, tmp[j]);
+        }
+    }
+
+    readPtr += i * sizeof (half);
+    copyPixels<half, float, Stride> (
+        readPtr,
+        writePtr + i * ((Stride == COPY_PACKED) ? sizeof (float) : xStride),
+        count - i,
+        xStride);
+}
+
+#endif /* IMF_HAVE_NEON_AARCH64 */
+
+//
+// Indexed by [typeInFile][typeInFrameBuffer][CopyStride].
+//
+
+CopyIntoFrameBufferFunc
+    copyIntoFrameBufferFuncs[NUM_PIXELTYPES][NUM_PIXELTYPES][NUM_COPY_STRIDES] = {
+        {{copyPackedPixels<unsigned int>,
+          copyPixels<unsigned int, unsigned int, COPY_STRIDED>},
+         {copyPixels<unsigned int, half, COPY_PACKED>,
+          copyPixels<unsigned int, half, COPY_STRIDED>},
+         {copyPixels<unsigned int, float, COPY_PACKED>,
+          copyPixels<unsigned int, float, COPY_STRIDED>}},
+        {{copyPixels<half, unsigned int, COPY_PACKED>,
+          copyPixels<half, unsigned int, COPY_STRIDED>},
+         {copyPackedPixels<half>, copyPixels<half, half, COPY_STRIDED>},
+         {copyPixels<half, float, COPY_PACKED>,
+          copyPixels<half, float, COPY_STRIDED>}},
+        {{copyPixels<float, unsigned int, COPY_PACKED>,
+          copyPixels<float, unsigned int, COPY_STRIDED>},
+         {copyPixels<float, half, COPY_PACKED>,
+          copyPixels<float, half, COPY_STRIDED>},
+         {copyPackedPixels<float>, copyPixels<float, float, COPY_STRIDED>}}};
+
+} // namespace
+
+void
+initializeCopyIntoFrameBufferFuncs ()
+{
+#ifdef IMF_HAVE_GCC_INLINEASM_X86
+    CpuId cpuId;
+
+    if (cpuId.avx && cpuId.f16c)
+    {
+        copyIntoFrameBufferFuncs[OPENEXR_IMF_INTERNAL_NAMESPACE::HALF]
+                                [OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT]
+                                [COPY_PACKED] = copyHalfToFloat_f16c<COPY_PACKED>;
+        copyIntoFrameBufferFuncs[OPENEXR_IMF_INTERNAL_NAMESPACE::HALF]
+                                [OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT]
+                                [COPY_STRIDED] = copyHalfToFloat_f16c<COPY_STRIDED>;
+    }
+#endif
+
+#ifdef IMF_HAVE_NEON_AARCH64
+    copyIntoFrameBufferFuncs[OPENEXR_IMF_INTERNAL_NAMESPACE::HALF]
+                            [OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT]
+                            [COPY_PACKED] = copyHalfToFloat_neon<COPY_PACKED>;
+    copyIntoFrameBufferFuncs[OPENEXR_IMF_INTERNAL_NAMESPACE::HALF]
+                            [OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT]
+                            [COPY_STRIDED] = copyHalfToFloat_neon<COPY_STRIDED>;
+#endif
+}
+
 void
 copyIntoFrameBuffer (
     const char*&       readPtr,
@@ -328,10 +614,35 @@ copyIntoFrameBuffer (
             default: throw IEX_NAMESPACE::ArgExc ("Unknown pixel data type.");
         }
     }
+    else if (
+        (format == Compressor::NATIVE || GLOBAL_SYSTEM_LITTLE_ENDIAN) &&
+        typeInFile >= 0 && typeInFile < NUM_PIXELTYPES &&
+        typeInFrameBuffer >= 0 && typeInFrameBuffer < NUM_PIXELTYPES)
+    {
+        //
+        // The line or tile buffer is in NATIVE format, or in XDR
+        // format on a little endian machine, where both have the
+        // same layout.  Copy the pixels with the kernel specialized
+        // for the pixel types and the frame buffer stride.
+        //
+
+        if (writePtr > endPtr) return;
+
+        size_t count =
+            xStride ? size_t (endPtr - writePtr) / xStride + 1 : size_t (1);
+
+        int stride = COPY_STRIDED;
+        if (xStride == size_t (pixelTypeSize (typeInFrameBuffer)))
+            stride = COPY_PACKED;
+
+        copyIntoFrameBufferFuncs[typeInFile][typeInFrameBuffer][stride] (
+            readPtr, writePtr, count, xStride);
+    }
     else if (format == Compressor::XDR)
     {
         //
-        // The line or tile buffer is in XDR format.
+        // The line or tile buffer is in XDR format, on a big
+        // endian machine.
         //
         // Convert the pixels from the file's machine-
         // independent representation, and store the
@@ -467,176 +778,7 @@ copyIntoFrameBuffer (
             default: throw IEX_NAMESPACE::ArgExc ("Unknown pixel data type.");
         }
     }
-    else
-    {
-        //
-        // The line or tile buffer is in NATIVE format.
-        // Copy the results into the frame buffer.
-        //
-
-        switch (typeInFrameBuffer)
-        {
-            case OPENEXR_IMF_INTERNAL_NAMESPACE::UINT:
-
-                switch (typeInFile)
-                {
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::UINT:
-
-                        while (writePtr <= endPtr)
-                        {
-                            for (size_t i = 0; i < sizeof (unsigned int); ++i)
-                                writePtr[i] = readPtr[i];
-
-                            readPtr += sizeof (unsigned int);
-                            writePtr += xStride;
-                        }
-                        break;
-
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::HALF:
-
-                        while (writePtr <= endPtr)
-                        {
-                            half h                    = *(half*) readPtr;
-                            *(unsigned int*) writePtr = halfToUint (h);
-                            readPtr += sizeof (half);
-                            writePtr += xStride;
-                        }
-                        break;
-
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT:
-
-                        while (writePtr <= endPtr)
-                        {
-                            float f;
-
-                            for (size_t i = 0; i < sizeof (float); ++i)
-                                ((char*) &f)[i] = readPtr[i];
-
-                            *(unsigned int*) writePtr = floatToUint (f);
-                            readPtr += sizeof (float);
-                            writePtr += xStride;
-                        }
-                        break;
-
-                    default:
-
-                        throw IEX_NAMESPACE::ArgExc (
-                            "Unknown pixel data type.");
-                }
-                break;
-
-            case OPENEXR_IMF_INTERNAL_NAMESPACE::HALF:
-
-                switch (typeInFile)
-                {
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::UINT:
-
-                        while (writePtr <= endPtr)
-                        {
-                            unsigned int ui;
-
-                            for (size_t i = 0; i < sizeof (unsigned int); ++i)
-                                ((char*) &ui)[i] = readPtr[i];
-
-                            *(half*) writePtr = uintToHalf (ui);
-                            readPtr += sizeof (unsigned int);
-                            writePtr += xStride;
-                        }
-                        break;
-
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::HALF:
-
-                        // If we're tightly packed, just memcpy
-                        if (xStride == sizeof (half))
-                        {
-                            int numBytes = endPtr - writePtr + sizeof (half);
-                            memcpy (writePtr, readPtr, numBytes);
-                            readPtr += numBytes;
-                            writePtr += numBytes;
-                        }
-                        else
-                        {
-                            while (writePtr <= endPtr)
-                            {
-                                *(half*) writePtr = *(half*) readPtr;
-                                readPtr += sizeof (half);
-                                writePtr += xStride;
-                            }
-                        }
-                        break;
-
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT:
-
-                        while (writePtr <= endPtr)
-                        {
-                            float f;
-
-                            for (size_t i = 0; i < sizeof (float); ++i)
-                                ((char*) &f)[i] = readPtr[i];
-
-                            *(half*) writePtr = floatToHalf (f);
-                            readPtr += sizeof (float);
-                            writePtr += xStride;
-                        }
-                        break;
-                    default:
-
-                        throw IEX_NAMESPACE::ArgExc (
-                            "Unknown pixel data type.");
-                }
-                break;
-
-            case OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT:
-
-                switch (typeInFile)
-                {
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::UINT:
-
-                        while (writePtr <= endPtr)
-                        {
-                            unsigned int ui;
-
-                            for (size_t i = 0; i < sizeof (unsigned int); ++i)
-                                ((char*) &ui)[i] = readPtr[i];
-
-                            *(float*) writePtr = float (ui);
-                            readPtr += sizeof (unsigned int);
-                            writePtr += xStride;
-                        }
-                        break;
-
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::HALF:
-
-                        while (writePtr <= endPtr)
-                        {
-                            half h             = *(half*) readPtr;
-                            *(float*) writePtr = float (h);
-                            readPtr += sizeof (half);
-                            writePtr += xStride;
-                        }
-                        break;
-
-                    case OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT:
-
-                        while (writePtr <= endPtr)
-                        {
-                            for (size_t i = 0; i < sizeof (float); ++i)
-                                writePtr[i] = readPtr[i];
-
-                            readPtr += sizeof (float);
-                            writePtr += xStride;
-                        }
-                        break;
-                    default:
-
-                        throw IEX_NAMESPACE::ArgExc (
-                            "Unknown pixel data type.");
-                }
-                break;
-
-            default: throw IEX_NAMESPACE::ArgExc ("Unknown pixel data type.");
-        }
-    }
+    else { throw IEX_NAMESPACE::ArgExc ("Unknown pixel data type."); }
 }
 
 void
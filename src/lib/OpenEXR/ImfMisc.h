@@ -198,6 +198,14 @@ void copyIntoFrameBuffer (
     PixelType          typeInFrameBuffer,
     PixelType          typeInFile);
 
+//
+// Select the CPU specific versions of the kernels used by
+// copyIntoFrameBuffer().  Called once, from staticInitialize().
+//
+
+IMF_EXPORT
+void initializeCopyIntoFrameBufferFuncs ();
+
 //
 // Copy a single channel of a horizontal row of pixels from an
 // input file's internal line buffer or tile buffer into a
@@ -53,6 +53,7 @@ struct MultiPartInputFile::Data : public InputStreamMutex
     int                    numThreads; // Number of threads
     bool reconstructChunkOffsetTable;  // If we should reconstruct
                                        // the offset table if it's broken.
+    bool headerOnly;                   // If only the headers are read.
     std::map<int, GenericInputFile*> _inputFiles;
     std::vector<Header>              _headers;
 
@@ -71,11 +72,16 @@ struct MultiPartInputFile::Data : public InputStreamMutex
 
     InputPartData* getPart (int partNumber);
 
-    Data (bool deleteStream, int numThreads, bool reconstructChunkOffsetTable)
+    Data (
+        bool deleteStream,
+        int  numThreads,
+        bool reconstructChunkOffsetTable,
+        bool headerOnly = false)
         : InputStreamMutex ()
         , deleteStream (deleteStream)
         , numThreads (numThreads)
         , reconstructChunkOffsetTable (reconstructChunkOffsetTable)
+        , headerOnly (headerOnly)
     {}
 
     ~Data ()
@@ -150,6 +156,59 @@ MultiPartInputFile::MultiPartInputFile (
     }
 }
 
+MultiPartInputFile::MultiPartInputFile (const char fileName[], HeaderOnlyTag)
+    : _data (new Data (true, 0, false, true))
+{
+    try
+    {
+        _data->is = new StdIFStream (fileName);
+        initialize ();
+    }
+    catch (IEX_NAMESPACE::BaseExc& e)
+    {
+        delete _data;
+
+        REPLACE_EXC (
+            e,
+            "Cannot read image file "
+            "\"" << fileName
+                 << "\". " << e.what ());
+        throw;
+    }
+    catch (...)
+    {
+        delete _data;
+        throw;
+    }
+}
+
+MultiPartInputFile::MultiPartInputFile (
+    OPENEXR_IMF_INTERNAL_NAMESPACE::IStream& is, HeaderOnlyTag)
+    : _data (new Data (false, 0, false, true))
+{
+    try
+    {
+        _data->is = &is;
+        initialize ();
+    }
+    catch (IEX_NAMESPACE::BaseExc& e)
+    {
+        delete _data;
+
+        REPLACE_EXC (
+            e,
+            "Cannot read image file "
+            "\"" << is.fileName ()
+                 << "\". " << e.what ());
+        throw;
+    }
+    catch (...)
+    {
+        delete _data;
+        throw;
+    }
+}
+
 template <class T>
 T*
 MultiPartInputFile::getInputPart (int partNumber)
@@ -424,6 +483,22 @@ MultiPartInputFile::initialize ()
         }
     }
 
+    //
+    // A header-only open stops here, and has no further use for a
+    // file it opened itself.
+    //
+
+    if (_data->headerOnly)
+    {
+        if (_data->deleteStream)
+        {
+            delete _data->is;
+            _data->is           = nullptr;
+            _data->deleteStream = false;
+        }
+        return;
+    }
+
     //
     // Create InputParts and read chunk offset tables.
     //
@@ -549,10 +624,13 @@ MultiPartInputFile::Data::chunkOffsetReconstruction (
             {
                 case DWAB_COMPRESSION: rowsizes[i] = 256; break;
                 case PIZ_COMPRESSION:
+                case PIZ4_COMPRESSION:
+                case ZSTD_COMPRESSION:
                 case B44_COMPRESSION:
                 case B44A_COMPRESSION:
                 case DWAA_COMPRESSION: rowsizes[i] = 32; break;
                 case ZIP_COMPRESSION:
+                case LZ4_COMPRESSION:
                 case PXR24_COMPRESSION: rowsizes[i] = 16; break;
                 case ZIPS_COMPRESSION:
                 case RLE_COMPRESSION:
@@ -778,6 +856,13 @@ MultiPartInputFile::Data::chunkOffsetReconstruction (
 InputPartData*
 MultiPartInputFile::Data::getPart (int partNumber)
 {
+    if (headerOnly)
+    {
+        THROW (
+            IEX_NAMESPACE::LogicExc,
+            "MultiPartInputFile::getPart called on a file opened for its "
+            "headers only");
+    }
     if (partNumber < 0 || partNumber >= (int) parts.size ())
     {
         THROW (
@@ -865,6 +950,13 @@ MultiPartInputFile::partComplete (int part) const
                 << part << " on file with " << _data->_headers.size ()
                 << " parts");
     }
+    if (_data->headerOnly)
+    {
+        THROW (
+            IEX_NAMESPACE::LogicExc,
+            "MultiPartInputFile::partComplete called on a file opened for "
+            "its headers only");
+    }
     return _data->parts[part]->completed;
 }
 
@@ -28,6 +28,26 @@ public:
         int      numThreads                  = globalThreadCount (),
         bool     reconstructChunkOffsetTable = true);
 
+    //------------------------------------------------------------
+    // Header-only open: the headers are read and checked as usual,
+    // but the chunk offset tables are not read and no part data is
+    // set up, so only parts(), header() and version() can be used.
+    // Creating a part from the file, or calling partComplete(),
+    // throws an exception.  A file opened by name is closed before
+    // the constructor returns.
+    //------------------------------------------------------------
+
+    enum HeaderOnlyTag
+    {
+        HEADER_ONLY
+    };
+
+    IMF_EXPORT
+    MultiPartInputFile (const char fileName[], HeaderOnlyTag);
+
+    IMF_EXPORT
+    MultiPartInputFile (IStream& is, HeaderOnlyTag);
+
     IMF_EXPORT
     virtual ~MultiPartInputFile ();
 
@@ -133,7 +133,10 @@ struct PizCompressor::ChannelData
 };
 
 PizCompressor::PizCompressor (
-    const Header& hdr, size_t maxScanLineSize, size_t numScanLines)
+    const Header& hdr,
+    size_t        maxScanLineSize,
+    size_t        numScanLines,
+    bool          hufStreams)
     : Compressor (hdr)
     , _maxScanLineSize (maxScanLineSize)
     , _format (XDR)
@@ -143,6 +146,7 @@ PizCompressor::PizCompressor (
     , _numChans (0)
     , _channels (hdr.channels ())
     , _channelData (0)
+    , _hufStreams (hufStreams)
 {
     // TODO: Remove this when we can change the ABI
     (void) _maxScanLineSize;
@@ -415,7 +419,10 @@ PizCompressor::compress (
     char* lengthPtr = buf;
     Xdr::write<CharPtrIO> (buf, int (0));
 
-    int length = hufCompress (_tmpBuffer, tmpBufferEnd - _tmpBuffer, buf);
+    int length =
+        _hufStreams
+            ? hufCompressStreams (_tmpBuffer, tmpBufferEnd - _tmpBuffer, buf)
+            : hufCompress (_tmpBuffer, tmpBufferEnd - _tmpBuffer, buf);
     Xdr::write<CharPtrIO> (lengthPtr, length);
 
     outPtr = _outBuffer;
@@ -536,7 +543,11 @@ PizCompressor::uncompress (
                         "(invalid array length).");
     }
 
-    hufUncompress (inPtr, length, _tmpBuffer, tmpBufferEnd - _tmpBuffer);
+    if (_hufStreams)
+        hufUncompressStreams (
+            inPtr, length, _tmpBuffer, tmpBufferEnd - _tmpBuffer);
+    else
+        hufUncompress (inPtr, length, _tmpBuffer, tmpBufferEnd - _tmpBuffer);
 
     //
     // Wavelet decoding
@@ -21,8 +21,16 @@ OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 class PizCompressor : public Compressor
 {
 public:
+    //
+    // With hufStreams set, the Huffman coded data are written
+    // in HUF_STREAMS streams (PIZ4_COMPRESSION)
+    //
+
     PizCompressor (
-        const Header& hdr, size_t maxScanLineSize, size_t numScanLines);
+        const Header& hdr,
+        size_t        maxScanLineSize,
+        size_t        numScanLines,
+        bool          hufStreams = false);
 
     virtual ~PizCompressor ();
 
@@ -79,6 +87,7 @@ private:
     int                _minX;
     int                _maxX;
     int                _maxY;
+    bool               _hufStreams;
 };
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
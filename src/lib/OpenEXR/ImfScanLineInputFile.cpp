@@ -15,6 +15,7 @@
 #include "IlmThreadSemaphore.h"
 #include "ImfChannelList.h"
 #include "ImfCompressor.h"
+#include "ImfContext.h"
 #include "ImfConvert.h"
 #include "ImfInputPartData.h"
 #include "ImfInputStreamMutex.h"
@@ -31,6 +32,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -112,6 +114,7 @@ struct LineBuffer
     int                minY;
     int                maxY;
     Compressor*        compressor;
+    ChunkDecoder*      decoder;
     Compressor::Format format;
     int                number;
     bool               hasException;
@@ -137,6 +140,7 @@ LineBuffer::LineBuffer (Compressor* comp)
     , buffer (0)
     , dataSize (0)
     , compressor (comp)
+    , decoder (0)
     , format (defaultFormat (compressor))
     , number (-1)
     , hasException (false)
@@ -149,6 +153,7 @@ LineBuffer::LineBuffer (Compressor* comp)
 LineBuffer::~LineBuffer ()
 {
     delete compressor;
+    delete decoder;
 }
 
 /// helper struct used to detect the order that the channels are stored
@@ -167,6 +172,7 @@ struct sliceOptimizationData
         yStride; ///< y-stride of channel in buffer (must be same in all channels, else order will change, which is bad)
     int xSampling; ///< channel x sampling
     int ySampling; ///< channel y sampling
+    size_t source; ///< index of the slice in the frame buffer
 
     /// we need to keep the list sorted in the order they'll be written to memory
     bool operator< (const sliceOptimizationData& other) const
@@ -175,6 +181,199 @@ struct sliceOptimizationData
     }
 };
 
+//
+// The slice tables setFrameBuffer() built for one frame buffer layout.
+// Applications that switch between a few frame buffers, for instance
+// one per texture tile size, get the tables back without rebuilding
+// them; only the base pointers are taken from the new frame buffer.
+//
+// The layout is everything in a frame buffer but the base pointers:
+// channel names, types, strides, sampling and fill values.  When the
+// optimized reading path may be used, its choice depends on how the
+// slices interleave in memory, so the distance of each base pointer
+// from the first one is part of the layout, too.
+//
+
+struct FrameBufferPlanSlice
+{
+    string    name;
+    PixelType type;
+    size_t    xStride;
+    size_t    yStride;
+    int       xSampling;
+    int       ySampling;
+    double    fillValue;
+    ptrdiff_t baseOffset; // only compared if baseSensitive is set
+};
+
+struct FrameBufferPlan
+{
+    vector<FrameBufferPlanSlice>  layout;
+    bool                          baseSensitive;
+    vector<InSliceInfo>           slices;
+    OptimizationMode              optimizationMode;
+    vector<sliceOptimizationData> optimizationData;
+
+    FrameBufferPlan (
+        const FrameBuffer&                   frameBuffer,
+        const vector<InSliceInfo>&           slices,
+        const OptimizationMode&              optimizationMode,
+        const vector<sliceOptimizationData>& optimizationData);
+
+    bool matches (const FrameBuffer& frameBuffer) const;
+
+    void apply (
+        const FrameBuffer&             frameBuffer,
+        vector<InSliceInfo>&           slices,
+        vector<sliceOptimizationData>& optimizationData) const;
+};
+
+//
+// Number of frame buffer layouts each file remembers
+//
+
+const size_t MAX_FRAME_BUFFER_PLANS = 4;
+
+inline ptrdiff_t
+baseOffset (const char* base, const char* firstBase)
+{
+    return ptrdiff_t (uintptr_t (base) - uintptr_t (firstBase));
+}
+
+FrameBufferPlan::FrameBufferPlan (
+    const FrameBuffer&                   frameBuffer,
+    const vector<InSliceInfo>&           s,
+    const OptimizationMode&              om,
+    const vector<sliceOptimizationData>& od)
+    : baseSensitive (false), slices (s), optimizationMode (om)
+{
+    const char* firstBase = 0;
+
+    for (FrameBuffer::ConstIterator j = frameBuffer.begin ();
+         j != frameBuffer.end ();
+         ++j)
+    {
+        const Slice& slice = j.slice ();
+
+        if (j == frameBuffer.begin ()) firstBase = slice.base;
+
+        FrameBufferPlanSlice p;
+        p.name       = j.name ();
+        p.type       = slice.type;
+        p.xStride    = slice.xStride;
+        p.yStride    = slice.yStride;
+        p.xSampling  = slice.xSampling;
+        p.ySampling  = slice.ySampling;
+        p.fillValue  = slice.fillValue;
+        p.baseOffset = baseOffset (slice.base, firstBase);
+        layout.push_back (p);
+    }
+
+    //
+    // Whether the optimized path was considered at all depends only
+    // on the types and sampling, which are part of the layout; only
+    // then does the memory arrangement matter.
+    //
+
+    baseSensitive = GLOBAL_SYSTEM_LITTLE_ENDIAN;
+
+    for (size_t i = 0; i < slices.size () && baseSensitive; ++i)
+    {
+        const InSliceInfo& slice = slices[i];
+
+        if (slice.xSampling != 1 || slice.ySampling != 1)
+            baseSensitive = false;
+        else if (
+            !slice.skip && (slice.typeInFrameBuffer != HALF ||
+                            (!slice.fill && slice.typeInFile != HALF)))
+            baseSensitive = false;
+    }
+
+    //
+    // The tables are stored without base pointers so that a plan
+    // does not keep pointers into memory the application may free.
+    //
+
+    for (size_t i = 0; i < slices.size (); ++i)
+        slices[i].base = 0;
+
+    for (size_t i = 0; i < od.size (); ++i)
+    {
+        optimizationData.push_back (od[i]);
+        optimizationData.back ().base = 0;
+    }
+}
+
+bool
+FrameBufferPlan::matches (const FrameBuffer& frameBuffer) const
+{
+    const char* firstBase = 0;
+    size_t      n         = 0;
+
+    for (FrameBuffer::ConstIterator j = frameBuffer.begin ();
+         j != frameBuffer.end ();
+         ++j, ++n)
+    {
+        if (n == layout.size ()) return false;
+
+        const Slice&                slice = j.slice ();
+        const FrameBufferPlanSlice& p     = layout[n];
+
+        if (n == 0) firstBase = slice.base;
+
+        //
+        // Fill values are compared bit for bit, so that a NaN fill
+        // finds its plan again.
+        //
+
+        if (slice.type != p.type || slice.xStride != p.xStride ||
+            slice.yStride != p.yStride || slice.xSampling != p.xSampling ||
+            slice.ySampling != p.ySampling ||
+            memcmp (&slice.fillValue, &p.fillValue, sizeof (double)) != 0 ||
+            strcmp (j.name (), p.name.c_str ()) != 0)
+        {
+            return false;
+        }
+
+        if (baseSensitive && baseOffset (slice.base, firstBase) != p.baseOffset)
+            return false;
+    }
+
+    return n == layout.size ();
+}
+
+void
+FrameBufferPlan::apply (
+    const FrameBuffer&             frameBuffer,
+    vector<InSliceInfo>&           s,
+    vector<sliceOptimizationData>& od) const
+{
+    vector<char*> bases;
+    bases.reserve (layout.size ());
+
+    for (FrameBuffer::ConstIterator j = frameBuffer.begin ();
+         j != frameBuffer.end ();
+         ++j)
+    {
+        bases.push_back (j.slice ().base);
+    }
+
+    //
+    // Every frame buffer slice has exactly one entry that is not
+    // skipped in the slice table, in frame buffer order.
+    //
+
+    s = slices;
+
+    for (size_t i = 0, n = 0; i < s.size (); ++i)
+        if (!s[i].skip) s[i].base = bases[n++];
+
+    od = optimizationData;
+
+    for (size_t i = 0; i < od.size (); ++i)
+        od[i].base = bases[od[i].source];
+}
+
 } // namespace
 
 struct ScanLineInputFile::Data
@@ -206,12 +405,19 @@ struct ScanLineInputFile::Data
                                        // holds
     size_t lineBufferSize;             // size of the line buffer
     int    partNumber;                 // part number
+    Context* context;                  // OpenEXRCore decoding context,
+                                       // 0 if the header is not supported
 
     bool             memoryMapped;     // if the stream is memory mapped
     OptimizationMode optimizationMode; // optimizibility of the input file
     vector<sliceOptimizationData>
         optimizationData; ///< channel ordering for optimized reading
 
+    vector<FrameBufferPlan> frameBufferPlans; // tables for recently set
+                                              // frame buffer layouts
+    uint64_t frameBufferPlanHits;             // setFrameBuffer() calls that
+    uint64_t frameBufferPlanMisses;           // found / built their tables
+
     Data (int numThreads);
     ~Data ();
 
@@ -226,7 +432,11 @@ struct ScanLineInputFile::Data
 };
 
 ScanLineInputFile::Data::Data (int numThreads)
-    : partNumber (-1), memoryMapped (false)
+    : partNumber (-1)
+    , context (0)
+    , memoryMapped (false)
+    , frameBufferPlanHits (0)
+    , frameBufferPlanMisses (0)
 {
     //
     // We need at least one lineBuffer, but if threading is used,
@@ -240,6 +450,8 @@ ScanLineInputFile::Data::~Data ()
 {
     for (size_t i = 0; i < lineBuffers.size (); i++)
         delete lineBuffers[i];
+
+    delete context;
 }
 
 inline LineBuffer*
@@ -443,6 +655,149 @@ readPixelData (
         ifd->nextLineBufferMinY = minY - ifd->linesInBuffer;
 }
 
+//
+// Point the OpenEXRCore decoder's channels at the frame buffer slices
+// for the scan lines of a line buffer.  Returns false if the frame
+// buffer layout is one that is better left to copyIntoFrameBuffer().
+//
+
+bool
+setDecodeChannels (
+    const ScanLineInputFile::Data* ifd, LineBuffer* lineBuffer, int maxY)
+{
+    ChunkDecoder* decoder = lineBuffer->decoder;
+    int           c       = 0;
+
+    for (size_t i = 0; i < ifd->slices.size (); ++i)
+    {
+        const InSliceInfo& slice = ifd->slices[i];
+
+        if (slice.fill) continue;
+
+        if (c >= decoder->channelCount ()) return false;
+
+        int channel = c++;
+
+        if (slice.skip) continue;
+
+        //
+        // Find the first scan line in the line buffer that
+        // contains samples of this channel.
+        //
+
+        int y = lineBuffer->minY;
+        int r = modp (y, slice.ySampling);
+
+        if (r != 0) y += slice.ySampling - r;
+
+        if (y > maxY) continue;
+
+        intptr_t base = reinterpret_cast<intptr_t> (slice.base);
+
+        char* ptr = reinterpret_cast<char*> (
+            base +
+            intptr_t (divp (y, slice.ySampling)) * intptr_t (slice.yStride) +
+            intptr_t (divp (ifd->minX, slice.xSampling)) *
+                intptr_t (slice.xStride));
+
+        if (!decoder->setChannel (
+                channel,
+                ptr,
+                slice.typeInFrameBuffer,
+                slice.xStride,
+                slice.yStride))
+            return false;
+    }
+
+    return true;
+}
+
+//
+// Uncompress a line buffer's pixel data, unless that has already been
+// done.  Returns true if OpenEXRCore has also unpacked the pixels for
+// scan lines [scanLineMin, scanLineMax] into the frame buffer.
+//
+
+bool
+uncompressLineBuffer (
+    ScanLineInputFile::Data* ifd,
+    LineBuffer*              lineBuffer,
+    int                      scanLineMin,
+    int                      scanLineMax,
+    bool                     unpack)
+{
+    if (lineBuffer->uncompressedData != 0) return false;
+
+    size_t uncompressedSize = 0;
+    int    maxY             = min (lineBuffer->maxY, ifd->maxY);
+
+    for (int i = lineBuffer->minY - ifd->minY; i <= maxY - ifd->minY; ++i)
+    {
+        uncompressedSize += ifd->bytesPerLine[i];
+    }
+
+    if (lineBuffer->decoder)
+    {
+        //
+        // Chunks that are no smaller than their uncompressed
+        // size are stored uncompressed.
+        //
+
+        exr_chunk_info_t cinfo;
+        memset (&cinfo, 0, sizeof (cinfo));
+
+        cinfo.idx         = lineBuffer->number;
+        cinfo.type        = EXR_STORAGE_SCANLINE;
+        cinfo.compression = static_cast<uint8_t> (ifd->header.compression ());
+        cinfo.start_x     = ifd->minX;
+        cinfo.start_y     = lineBuffer->minY;
+        cinfo.width       = ifd->maxX - ifd->minX + 1;
+        cinfo.height      = maxY - lineBuffer->minY + 1;
+        cinfo.data_offset = ifd->lineOffsets[lineBuffer->number];
+        cinfo.packed_size = min (
+            static_cast<uint64_t> (lineBuffer->dataSize),
+            static_cast<uint64_t> (uncompressedSize));
+        cinfo.unpacked_size = uncompressedSize;
+
+        lineBuffer->decoder->begin (cinfo);
+
+        unpack = unpack && scanLineMin == lineBuffer->minY &&
+                 scanLineMax == maxY &&
+                 setDecodeChannels (ifd, lineBuffer, maxY);
+
+        lineBuffer->decoder->run (lineBuffer->buffer, unpack);
+
+        lineBuffer->format           = Compressor::XDR;
+        lineBuffer->uncompressedData = lineBuffer->decoder->uncompressedData ();
+
+        return lineBuffer->decoder->unpacked ();
+    }
+
+    if (lineBuffer->compressor &&
+        static_cast<size_t> (lineBuffer->dataSize) < uncompressedSize)
+    {
+        lineBuffer->format = lineBuffer->compressor->format ();
+
+        lineBuffer->dataSize = lineBuffer->compressor->uncompress (
+            lineBuffer->buffer,
+            lineBuffer->dataSize,
+            lineBuffer->minY,
+            lineBuffer->uncompressedData);
+    }
+    else
+    {
+        //
+        // If the line is uncompressed, it's in XDR format,
+        // regardless of the compressor's output format.
+        //
+
+        lineBuffer->format           = Compressor::XDR;
+        lineBuffer->uncompressedData = lineBuffer->buffer;
+    }
+
+    return false;
+}
+
 //
 // A LineBufferTask encapsulates the task uncompressing a set of
 // scanlines (line buffer) and copying them into the frame buffer.
@@ -503,42 +858,14 @@ LineBufferTask::execute ()
     try
     {
         //
-        // Uncompress the data, if necessary
+        // Uncompress the data, if necessary.  If the line buffer
+        // holds exactly the requested scan lines, OpenEXRCore may
+        // also unpack the pixels straight into the frame buffer;
+        // only fill slices are then left to copy.
         //
 
-        if (_lineBuffer->uncompressedData == 0)
-        {
-            size_t uncompressedSize = 0;
-            int    maxY             = min (_lineBuffer->maxY, _ifd->maxY);
-
-            for (int i = _lineBuffer->minY - _ifd->minY; i <= maxY - _ifd->minY;
-                 ++i)
-            {
-                uncompressedSize += _ifd->bytesPerLine[i];
-            }
-
-            if (_lineBuffer->compressor &&
-                static_cast<size_t> (_lineBuffer->dataSize) < uncompressedSize)
-            {
-                _lineBuffer->format = _lineBuffer->compressor->format ();
-
-                _lineBuffer->dataSize = _lineBuffer->compressor->uncompress (
-                    _lineBuffer->buffer,
-                    _lineBuffer->dataSize,
-                    _lineBuffer->minY,
-                    _lineBuffer->uncompressedData);
-            }
-            else
-            {
-                //
-                // If the line is uncompressed, it's in XDR format,
-                // regardless of the compressor's output format.
-                //
-
-                _lineBuffer->format           = Compressor::XDR;
-                _lineBuffer->uncompressedData = _lineBuffer->buffer;
-            }
-        }
+        bool unpacked = uncompressLineBuffer (
+            _ifd, _lineBuffer, _scanLineMin, _scanLineMax, true);
 
         int yStart, yStop, dy;
 
@@ -581,6 +908,8 @@ LineBufferTask::execute ()
 
                 if (modp (y, slice.ySampling) != 0) continue;
 
+                if (unpacked && !slice.fill) continue;
+
                 //
                 // Find the x coordinates of the leftmost and rightmost
                 // sampled pixels (i.e. pixels within the data window
@@ -825,39 +1154,8 @@ LineBufferTaskIIF::execute ()
         // Uncompress the data, if necessary
         //
 
-        if (_lineBuffer->uncompressedData == 0)
-        {
-            size_t uncompressedSize = 0;
-            int    maxY             = min (_lineBuffer->maxY, _ifd->maxY);
-
-            for (int i = _lineBuffer->minY - _ifd->minY; i <= maxY - _ifd->minY;
-                 ++i)
-            {
-                uncompressedSize += _ifd->bytesPerLine[i];
-            }
-
-            if (_lineBuffer->compressor &&
-                static_cast<size_t> (_lineBuffer->dataSize) < uncompressedSize)
-            {
-                _lineBuffer->format = _lineBuffer->compressor->format ();
-
-                _lineBuffer->dataSize = _lineBuffer->compressor->uncompress (
-                    _lineBuffer->buffer,
-                    _lineBuffer->dataSize,
-                    _lineBuffer->minY,
-                    _lineBuffer->uncompressedData);
-            }
-            else
-            {
-                //
-                // If the line is uncompressed, it's in XDR format,
-                // regardless of the compressor's output format.
-                //
-
-                _lineBuffer->format           = Compressor::XDR;
-                _lineBuffer->uncompressedData = _lineBuffer->buffer;
-            }
-        }
+        uncompressLineBuffer (
+            _ifd, _lineBuffer, _scanLineMin, _scanLineMax, false);
 
         int yStart, yStop, dy;
 
@@ -1184,12 +1482,32 @@ ScanLineInputFile::initialize (const Header& header)
     }
 
     //
+    // Decode with OpenEXRCore if it accepts the header, otherwise
     // allocate compressor objects
     //
+
+    try
+    {
+        _data->context = new Context (
+            _data->header, _streamData->is->fileName (), false);
+    }
+    catch (...)
+    {
+        _data->context = 0;
+    }
+
     for (size_t i = 0; i < _data->lineBuffers.size (); i++)
     {
-        _data->lineBuffers[i] = new LineBuffer (
-            newCompressor (comp, maxBytesPerLine, _data->header));
+        if (_data->context)
+        {
+            _data->lineBuffers[i]          = new LineBuffer (0);
+            _data->lineBuffers[i]->decoder = new ChunkDecoder (*_data->context);
+        }
+        else
+        {
+            _data->lineBuffers[i] = new LineBuffer (
+                newCompressor (comp, maxBytesPerLine, _data->header));
+        }
     }
 
     _data->lineBufferSize = maxBytesPerLine * _data->linesInBuffer;
@@ -1421,6 +1739,27 @@ ScanLineInputFile::setFrameBuffer (const FrameBuffer& frameBuffer)
     std::lock_guard<std::mutex> lock (*_streamData);
 #endif
 
+    //
+    // Reuse the slice tables of an earlier frame buffer
+    // with the same layout if there is one.
+    //
+
+    vector<FrameBufferPlan>& plans = _data->frameBufferPlans;
+
+    for (size_t p = 0; p < plans.size (); ++p)
+    {
+        if (!plans[p].matches (frameBuffer)) continue;
+
+        plans[p].apply (frameBuffer, _data->slices, _data->optimizationData);
+        _data->optimizationMode = plans[p].optimizationMode;
+        _data->frameBuffer      = frameBuffer;
+
+        std::rotate (
+            plans.begin (), plans.begin () + p, plans.begin () + p + 1);
+        ++_data->frameBufferPlanHits;
+        return;
+    }
+
     const ChannelList& channels = _data->header.channels ();
     for (FrameBuffer::ConstIterator j = frameBuffer.begin ();
          j != frameBuffer.end ();
@@ -1464,10 +1803,11 @@ ScanLineInputFile::setFrameBuffer (const FrameBuffer& frameBuffer)
     // current offset of channel: pixel data starts at offset*width into the
     // decompressed scanline buffer
     size_t offset = 0;
+    size_t source = 0;
 
     for (FrameBuffer::ConstIterator j = frameBuffer.begin ();
          j != frameBuffer.end ();
-         ++j)
+         ++j, ++source)
     {
         while (i != channels.end () && strcmp (i.name (), j.name ()) < 0)
         {
@@ -1559,6 +1899,7 @@ ScanLineInputFile::setFrameBuffer (const FrameBuffer& frameBuffer)
             dat.yStride   = j.slice ().yStride;
             dat.xSampling = j.slice ().xSampling;
             dat.ySampling = j.slice ().ySampling;
+            dat.source    = source;
             optData.push_back (dat);
         }
 
@@ -1602,6 +1943,19 @@ ScanLineInputFile::setFrameBuffer (const FrameBuffer& frameBuffer)
     _data->frameBuffer      = frameBuffer;
     _data->slices           = slices;
     _data->optimizationData = optData;
+
+    //
+    // Remember the tables, most recently used first.
+    //
+
+    plans.insert (
+        plans.begin (),
+        FrameBufferPlan (
+            frameBuffer, slices, _data->optimizationMode, optData));
+
+    if (plans.size () > MAX_FRAME_BUFFER_PLANS) plans.pop_back ();
+
+    ++_data->frameBufferPlanMisses;
 }
 
 const FrameBuffer&
@@ -1629,6 +1983,24 @@ ScanLineInputFile::isOptimizationEnabled () const
     return _data->optimizationMode._optimizable;
 }
 
+uint64_t
+ScanLineInputFile::frameBufferPlanHits () const
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (*_streamData);
+#endif
+    return _data->frameBufferPlanHits;
+}
+
+uint64_t
+ScanLineInputFile::frameBufferPlanMisses () const
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (*_streamData);
+#endif
+    return _data->frameBufferPlanMisses;
+}
+
 void
 ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
 {
@@ -1690,19 +2062,59 @@ ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
             // for a successive task to execute the previous task which
             // used that line buffer must have completed already.
             //
+            // The tasks are handed to the thread pool in batches, to
+            // synchronize with it once per batch instead of once per
+            // line buffer.  A batch takes at most half of the line
+            // buffers, so the next batch can be read from the file
+            // while the previous one is decoded.
+            //
+            // ThreadPool::parallelFor does not fit here: the raw data
+            // is read by this thread, which holds the stream lock for
+            // the whole call, so the workers could not read it
+            // themselves. A task per line buffer lets the decoding
+            // of one overlap the reading of the next.
+            //
+
+            size_t batchSize = max<size_t> (1, _data->lineBuffers.size () / 2);
+            vector<Task*> tasks;
+            tasks.reserve (batchSize);
 
-            for (int l = start; l != stop; l += dl)
+            try
+            {
+                for (int l = start; l != stop; l += dl)
+                {
+                    tasks.push_back (newLineBufferTask (
+                        &taskGroup,
+                        _streamData,
+                        _data,
+                        l,
+                        scanLineMin,
+                        scanLineMax,
+                        _data->optimizationMode));
+
+                    if (tasks.size () == batchSize)
+                    {
+                        ThreadPool::addGlobalTasks (
+                            tasks.data (), static_cast<int> (tasks.size ()));
+                        tasks.clear ();
+                    }
+                }
+            }
+            catch (...)
             {
-                ThreadPool::addGlobalTask (newLineBufferTask (
-                    &taskGroup,
-                    _streamData,
-                    _data,
-                    l,
-                    scanLineMin,
-                    scanLineMax,
-                    _data->optimizationMode));
+                //
+                // The tasks already created hold line buffers and
+                // count towards the task group, so they must run.
+                //
+
+                ThreadPool::addGlobalTasks (
+                    tasks.data (), static_cast<int> (tasks.size ()));
+                throw;
             }
 
+            ThreadPool::addGlobalTasks (
+                tasks.data (), static_cast<int> (tasks.size ()));
+
             //
             // finish all tasks
             //
@@ -17,6 +17,8 @@
 #include "ImfGenericInputFile.h"
 #include "ImfThreading.h"
 
+#include <cstdint>
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
 class IMF_EXPORT_TYPE ScanLineInputFile : public GenericInputFile
@@ -116,6 +118,26 @@ public:
     IMF_EXPORT
     bool isOptimizationEnabled () const;
 
+    //---------------------------------------------------------------
+    // Frame buffer plan statistics:
+    //
+    // setFrameBuffer() remembers the slice tables it builds for the
+    // last few frame buffer layouts.  A layout is the channel names,
+    // types, strides, sampling and fill values of a frame buffer,
+    // but not where its pixels are, so switching back and forth
+    // between a few frame buffers does not rebuild the tables.
+    //
+    // frameBufferPlanHits() returns the number of setFrameBuffer()
+    // calls that found their layout, frameBufferPlanMisses() the
+    // number of calls that had to build new tables.
+    //
+    //---------------------------------------------------------------
+
+    IMF_EXPORT
+    uint64_t frameBufferPlanHits () const;
+    IMF_EXPORT
+    uint64_t frameBufferPlanMisses () const;
+
     //---------------------------------------------------------------
     // Read pixel data:
     //
@@ -17,6 +17,7 @@
 #include <Imath/ImathVec.h>
 #include "ImfChannelList.h"
 #include "ImfCompressor.h"
+#include "ImfContext.h"
 #include "ImfConvert.h"
 #include "ImfFrameBuffer.h"
 #include "ImfHeader.h"
@@ -35,6 +36,7 @@
 #include "ImfXdr.h"
 #include <algorithm>
 #include <assert.h>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -111,6 +113,7 @@ struct TileBuffer
     char*              buffer;
     int                dataSize;
     Compressor*        compressor;
+    ChunkDecoder*      decoder;
     Compressor::Format format;
     int                dx;
     int                dy;
@@ -139,6 +142,7 @@ TileBuffer::TileBuffer (Compressor* comp)
     , buffer (0)
     , dataSize (0)
     , compressor (comp)
+    , decoder (0)
     , format (defaultFormat (compressor))
     , dx (-1)
     , dy (-1)
@@ -154,6 +158,7 @@ TileBuffer::TileBuffer (Compressor* comp)
 TileBuffer::~TileBuffer ()
 {
     delete compressor;
+    delete decoder;
 }
 
 } // namespace
@@ -211,6 +216,9 @@ struct TiledInputFile::Data
     vector<TileBuffer*> tileBuffers;    // each holds a single tile
     size_t              tileBufferSize; // size of the tile buffers
 
+    Context* context; // OpenEXRCore decoding context,
+                      // 0 if the header is not supported
+
     bool memoryMapped; // if the stream is memory mapped
 
     InputStreamMutex* _streamData;
@@ -241,6 +249,7 @@ TiledInputFile::Data::Data (int numThreads)
     , multiPartBackwardSupport (false)
     , numThreads (numThreads)
     , multiPartFile (nullptr)
+    , context (nullptr)
     , memoryMapped (false)
     , _streamData (NULL)
     , _deleteStream (false)
@@ -261,6 +270,8 @@ TiledInputFile::Data::~Data ()
     for (size_t i = 0; i < tileBuffers.size (); i++)
         delete tileBuffers[i];
 
+    delete context;
+
     if (multiPartBackwardSupport) delete multiPartFile;
 }
 
@@ -504,6 +515,53 @@ readNextTileData (
     streamData->currentPosition += 5 * Xdr::size<int> () + dataSize;
 }
 
+//
+// Point the OpenEXRCore decoder's channels at the frame buffer slices
+// for a tile.  Returns false if the frame buffer layout is one that
+// is better left to copyIntoFrameBuffer().
+//
+
+bool
+setDecodeChannels (
+    const TiledInputFile::Data* ifd,
+    TileBuffer*                 tileBuffer,
+    const Box2i&                tileRange)
+{
+    ChunkDecoder* decoder = tileBuffer->decoder;
+    int           c       = 0;
+
+    for (size_t i = 0; i < ifd->slices.size (); ++i)
+    {
+        const TInSliceInfo& slice = ifd->slices[i];
+
+        if (slice.fill) continue;
+
+        if (c >= decoder->channelCount ()) return false;
+
+        int channel = c++;
+
+        if (slice.skip) continue;
+
+        int xOffset = slice.xTileCoords * tileRange.min.x;
+        int yOffset = slice.yTileCoords * tileRange.min.y;
+
+        intptr_t base = reinterpret_cast<intptr_t> (slice.base);
+        char*    ptr  = reinterpret_cast<char*> (
+            base + (tileRange.min.y - yOffset) * slice.yStride +
+            (tileRange.min.x - xOffset) * slice.xStride);
+
+        if (!decoder->setChannel (
+                channel,
+                ptr,
+                slice.typeInFrameBuffer,
+                slice.xStride,
+                slice.yStride))
+            return false;
+    }
+
+    return true;
+}
+
 //
 // A TileBufferTask encapsulates the task of uncompressing
 // a single tile and copying it into the frame buffer.
@@ -568,10 +626,53 @@ TileBufferTask::execute ()
         int sizeOfTile = _ifd->bytesPerPixel * numPixelsInTile;
 
         //
-        // Uncompress the data, if necessary
+        // Uncompress the data, if necessary.  OpenEXRCore also
+        // unpacks the pixels straight into the frame buffer where it
+        // can; only fill slices are then left to copy.
         //
 
-        if (_tileBuffer->compressor && _tileBuffer->dataSize < sizeOfTile)
+        bool unpacked = false;
+
+        if (_tileBuffer->decoder)
+        {
+            //
+            // Tiles that are no smaller than their uncompressed
+            // size are stored uncompressed.
+            //
+
+            exr_chunk_info_t cinfo;
+            memset (&cinfo, 0, sizeof (cinfo));
+
+            cinfo.type = EXR_STORAGE_TILED;
+            cinfo.compression =
+                static_cast<uint8_t> (_ifd->header.compression ());
+            cinfo.start_x     = tileRange.min.x;
+            cinfo.start_y     = tileRange.min.y;
+            cinfo.width       = numPixelsPerScanLine;
+            cinfo.height      = tileRange.max.y - tileRange.min.y + 1;
+            cinfo.level_x     = static_cast<uint8_t> (_tileBuffer->lx);
+            cinfo.level_y     = static_cast<uint8_t> (_tileBuffer->ly);
+            cinfo.data_offset = _ifd->tileOffsets (
+                _tileBuffer->dx,
+                _tileBuffer->dy,
+                _tileBuffer->lx,
+                _tileBuffer->ly);
+            cinfo.packed_size   = min (_tileBuffer->dataSize, sizeOfTile);
+            cinfo.unpacked_size = sizeOfTile;
+
+            _tileBuffer->decoder->begin (cinfo);
+
+            bool unpack = setDecodeChannels (_ifd, _tileBuffer, tileRange);
+
+            _tileBuffer->decoder->run (_tileBuffer->buffer, unpack);
+
+            _tileBuffer->format = Compressor::XDR;
+            _tileBuffer->uncompressedData =
+                _tileBuffer->decoder->uncompressedData ();
+
+            unpacked = _tileBuffer->decoder->unpacked ();
+        }
+        else if (_tileBuffer->compressor && _tileBuffer->dataSize < sizeOfTile)
         {
             _tileBuffer->format = _tileBuffer->compressor->format ();
 
@@ -616,6 +717,8 @@ TileBufferTask::execute ()
             {
                 const TInSliceInfo& slice = _ifd->slices[i];
 
+                if (unpacked && !slice.fill) continue;
+
                 //
                 // These offsets are used to facilitate both
                 // absolute and tile-relative pixel coordinates.
@@ -1074,17 +1177,42 @@ TiledInputFile::initialize ()
         throw IEX_NAMESPACE::ArgExc ("Tile size too large for OpenEXR format");
     }
 
+    //
+    // Decode with OpenEXRCore if it accepts the header.  Each
+    // TileBuffer keeps its decode pipeline (or, failing that, its
+    // compressor) for the lifetime of the file, so the pipelines'
+    // scratch memory is reused from tile to tile.
+    //
+
+    try
+    {
+        _data->context = new Context (
+            _data->header, _data->_streamData->is->fileName (), true);
+    }
+    catch (...)
+    {
+        _data->context = nullptr;
+    }
+
     //
     // Create all the TileBuffers and allocate their internal buffers
     //
 
     for (size_t i = 0; i < _data->tileBuffers.size (); i++)
     {
-        _data->tileBuffers[i] = new TileBuffer (newTileCompressor (
-            _data->header.compression (),
-            _data->maxBytesPerTileLine,
-            _data->tileDesc.ySize,
-            _data->header));
+        if (_data->context)
+        {
+            _data->tileBuffers[i]          = new TileBuffer (0);
+            _data->tileBuffers[i]->decoder = new ChunkDecoder (*_data->context);
+        }
+        else
+        {
+            _data->tileBuffers[i] = new TileBuffer (newTileCompressor (
+                _data->header.compression (),
+                _data->maxBytesPerTileLine,
+                _data->tileDesc.ySize,
+                _data->header));
+        }
 
         if (!_data->_streamData->is->isMemoryMapped ())
             _data->tileBuffers[i]->buffer = new char[_data->tileBufferSize];
@@ -1326,27 +1454,64 @@ TiledInputFile::readTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
             TaskGroup taskGroup;
             int       tileNumber = 0;
 
-            for (int dy = dyStart; dy != dyStop; dy += dY)
+            //
+            // The tasks are handed to the thread pool in batches of at
+            // most half of the tile buffers, and one per tile buffer
+            // rather than through ThreadPool::parallelFor, as in
+            // ScanLineInputFile::readPixels().
+            //
+
+            size_t batchSize = max<size_t> (1, _data->tileBuffers.size () / 2);
+            vector<Task*> tasks;
+            tasks.reserve (batchSize);
+
+            try
             {
-                for (int dx = dx1; dx <= dx2; dx++)
+                for (int dy = dyStart; dy != dyStop; dy += dY)
                 {
-                    if (!isValidTile (dx, dy, lx, ly))
-                        THROW (
-                            IEX_NAMESPACE::ArgExc,
-                            "Tile (" << dx << ", " << dy << ", " << lx << ","
-                                     << ly << ") is not a valid tile.");
-
-                    ThreadPool::addGlobalTask (newTileBufferTask (
-                        &taskGroup,
-                        _data->_streamData,
-                        _data,
-                        tileNumber++,
-                        dx,
-                        dy,
-                        lx,
-                        ly));
+                    for (int dx = dx1; dx <= dx2; dx++)
+                    {
+                        if (!isValidTile (dx, dy, lx, ly))
+                            THROW (
+                                IEX_NAMESPACE::ArgExc,
+                                "Tile (" << dx << ", " << dy << ", " << lx
+                                         << "," << ly
+                                         << ") is not a valid tile.");
+
+                        tasks.push_back (newTileBufferTask (
+                            &taskGroup,
+                            _data->_streamData,
+                            _data,
+                            tileNumber++,
+                            dx,
+                            dy,
+                            lx,
+                            ly));
+
+                        if (tasks.size () == batchSize)
+                        {
+                            ThreadPool::addGlobalTasks (
+                                tasks.data (),
+                                static_cast<int> (tasks.size ()));
+                            tasks.clear ();
+                        }
+                    }
                 }
             }
+            catch (...)
+            {
+                //
+                // The tasks already created hold tile buffers and
+                // count towards the task group, so they must run.
+                //
+
+                ThreadPool::addGlobalTasks (
+                    tasks.data (), static_cast<int> (tasks.size ()));
+                throw;
+            }
+
+            ThreadPool::addGlobalTasks (
+                tasks.data (), static_cast<int> (tasks.size ()));
 
             //
             // finish all tasks
@@ -14,14 +14,18 @@
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
-Zip::Zip (size_t maxRawSize, int level)
-    : _maxRawSize (maxRawSize), _tmpBuffer (0), _zipLevel (level)
+Zip::Zip (size_t maxRawSize, int level, Codec codec)
+    : _maxRawSize (maxRawSize)
+    , _tmpBuffer (0)
+    , _zipLevel (level)
+    , _codec (codec)
 {
     _tmpBuffer = new char[_maxRawSize];
 }
 
-Zip::Zip (size_t maxScanLineSize, size_t numScanLines, int level)
-    : _maxRawSize (0), _tmpBuffer (0), _zipLevel (level)
+Zip::Zip (
+    size_t maxScanLineSize, size_t numScanLines, int level, Codec codec)
+    : _maxRawSize (0), _tmpBuffer (0), _zipLevel (level), _codec (codec)
 {
     _maxRawSize = uiMult (maxScanLineSize, numScanLines);
     _tmpBuffer  = new char[_maxRawSize];
@@ -41,6 +45,7 @@ Zip::maxRawSize ()
 size_t
 Zip::maxCompressedSize ()
 {
+    if (_codec == ZSTD) return exr_zstd_compress_max_buffer_size (_maxRawSize);
     return exr_compress_max_buffer_size (_maxRawSize);
 }
 
@@ -89,17 +94,35 @@ Zip::compress (const char* raw, int rawSize, char* compressed)
     }
 
     //
-    // Compress the data using zlib
+    // Compress the data using zlib or zstd
     //
-    size_t outSize;
-    if (EXR_ERR_SUCCESS != exr_compress_buffer (
+    size_t       outSize;
+    exr_result_t rv;
+    if (_codec == ZSTD)
+        rv = exr_zstd_compress_buffer (
             nullptr,
             _zipLevel,
             _tmpBuffer,
             rawSize,
             compressed,
             maxCompressedSize (),
-            &outSize))
+            &outSize);
+    else
+        rv = exr_compress_buffer (
+            nullptr,
+            _zipLevel,
+            _tmpBuffer,
+            rawSize,
+            compressed,
+            maxCompressedSize (),
+            &outSize);
+
+    if (rv == EXR_ERR_FEATURE_NOT_IMPLEMENTED)
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "Cannot compress data, zstd support was not built in.");
+    }
+    else if (EXR_ERR_SUCCESS != rv)
     {
         throw IEX_NAMESPACE::BaseExc ("Data compression failed.");
     }
@@ -327,14 +350,31 @@ auto interleave = interleave_scalar;
 int
 Zip::uncompress (const char* compressed, int compressedSize, char* raw)
 {
-    size_t outSize = 0;
-    if (EXR_ERR_SUCCESS != exr_uncompress_buffer (
+    size_t       outSize = 0;
+    exr_result_t rv;
+    if (_codec == ZSTD)
+        rv = exr_zstd_uncompress_buffer (
+            nullptr,
+            compressed,
+            (size_t) compressedSize,
+            _tmpBuffer,
+            _maxRawSize,
+            &outSize);
+    else
+        rv = exr_uncompress_buffer (
             nullptr,
             compressed,
-            (size_t)compressedSize,
+            (size_t) compressedSize,
             _tmpBuffer,
             _maxRawSize,
-            &outSize))
+            &outSize);
+
+    if (rv == EXR_ERR_FEATURE_NOT_IMPLEMENTED)
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "Cannot uncompress data, zstd support was not built in.");
+    }
+    else if (EXR_ERR_SUCCESS != rv)
     {
         throw IEX_NAMESPACE::InputExc ("Data decompression failed.");
     }
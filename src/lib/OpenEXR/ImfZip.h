@@ -16,8 +16,22 @@ OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 class Zip
 {
 public:
-    explicit Zip (size_t rawMaxSize, int level);
-    Zip (size_t maxScanlineSize, size_t numScanLines, int level);
+    //
+    // The coder applied after the byte reordering and predictor:
+    // deflate for the ZIP compression methods, zstd for ZSTD_COMPRESSION.
+    //
+    enum Codec
+    {
+        DEFLATE,
+        ZSTD
+    };
+
+    explicit Zip (size_t rawMaxSize, int level, Codec codec = DEFLATE);
+    Zip (
+        size_t maxScanlineSize,
+        size_t numScanLines,
+        int    level,
+        Codec  codec = DEFLATE);
     ~Zip ();
 
     Zip (const Zip& other) = delete;
@@ -46,6 +60,7 @@ private:
     size_t _maxRawSize;
     char*  _tmpBuffer;
     int    _zipLevel;
+    Codec  _codec;
 };
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
@@ -0,0 +1,83 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	class ZstdCompressor
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfZstdCompressor.h"
+#include "Iex.h"
+#include "ImfHeader.h"
+#include "ImfNamespace.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+ZstdCompressor::ZstdCompressor (
+    const Header& hdr, size_t maxScanLineSize, size_t numScanLines)
+    : Compressor (hdr)
+    , _numScanLines (numScanLines)
+    , _outBuffer (0)
+    , _zip (maxScanLineSize,
+            numScanLines,
+            hdr.zstdCompressionLevel (),
+            Zip::ZSTD)
+{
+    _outBuffer = new char[_zip.maxCompressedSize ()];
+}
+
+ZstdCompressor::~ZstdCompressor ()
+{
+    delete[] _outBuffer;
+}
+
+int
+ZstdCompressor::numScanLines () const
+{
+    return _numScanLines;
+}
+
+int
+ZstdCompressor::compress (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0)
+    {
+        outPtr = _outBuffer;
+        return 0;
+    }
+
+    int outSize = _zip.compress (inPtr, inSize, _outBuffer);
+
+    outPtr = _outBuffer;
+    return outSize;
+}
+
+int
+ZstdCompressor::uncompress (
+    const char* inPtr, int inSize, int minY, const char*& outPtr)
+{
+    //
+    // Special case - empty input buffer
+    //
+
+    if (inSize == 0)
+    {
+        outPtr = _outBuffer;
+        return 0;
+    }
+
+    int outSize = _zip.uncompress (inPtr, inSize, _outBuffer);
+
+    outPtr = _outBuffer;
+    return outSize;
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
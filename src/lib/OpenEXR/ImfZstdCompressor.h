@@ -0,0 +1,51 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_ZSTD_COMPRESSOR_H
+#define INCLUDED_IMF_ZSTD_COMPRESSOR_H
+
+//-----------------------------------------------------------------------------
+//
+//	class ZstdCompressor -- performs zstd compression of the
+//	same reordered and predicted data as ZipCompressor
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfNamespace.h"
+
+#include "ImfCompressor.h"
+
+#include "ImfZip.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+class ZstdCompressor : public Compressor
+{
+public:
+    ZstdCompressor (
+        const Header& hdr, size_t maxScanLineSize, size_t numScanLines);
+
+    virtual ~ZstdCompressor ();
+
+    ZstdCompressor (const ZstdCompressor& other)            = delete;
+    ZstdCompressor& operator= (const ZstdCompressor& other) = delete;
+
+    virtual int numScanLines () const;
+
+    virtual int
+    compress (const char* inPtr, int inSize, int minY, const char*& outPtr);
+
+    virtual int
+    uncompress (const char* inPtr, int inSize, int minY, const char*& outPtr);
+
+private:
+    int   _numScanLines;
+    char* _outBuffer;
+    Zip   _zip;
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
@@ -259,7 +259,7 @@ attr_destroy (struct _internal_exr_context* ctxt, exr_attribute_t* attr)
     }
     /* we don't care about the string because they were built into the
      * allocation block of the attribute as necessary */
-    ctxt->free_fn (attr);
+    internal_exr_header_free (ctxt, attr);
     return rv;
 }
 
@@ -296,7 +296,7 @@ exr_attr_list_destroy (exr_context_t ctxt, exr_attribute_list_t* list)
                 arv = attr_destroy (pctxt, list->entries[i]);
                 if (arv != EXR_ERR_SUCCESS) rv = arv;
             }
-            pctxt->free_fn (list->entries);
+            internal_exr_header_free (pctxt, list->entries);
         }
         *list = nil;
     }
@@ -499,11 +499,11 @@ add_to_list (
     {
         size_t nsize = (size_t) (list->num_alloced) * 2;
         if ((size_t) nattrsz > nsize) nsize = (size_t) (nattrsz) + 1;
-        attrs = (exr_attribute_t**) ctxt->alloc_fn (
-            sizeof (exr_attribute_t*) * nsize * 2);
+        attrs = (exr_attribute_t**) internal_exr_header_alloc (
+            ctxt, sizeof (exr_attribute_t*) * nsize * 2);
         if (!attrs)
         {
-            ctxt->free_fn (nattr);
+            internal_exr_header_free (ctxt, nattr);
             return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
         }
 
@@ -516,7 +516,7 @@ add_to_list (
             sorted_attrs[i] = list->sorted_entries[i];
         }
 
-        if (list->entries) ctxt->free_fn (list->entries);
+        if (list->entries) internal_exr_header_free (ctxt, list->entries);
         list->entries        = attrs;
         list->sorted_entries = sorted_attrs;
     }
@@ -693,7 +693,7 @@ create_attr_block (
     else
         alignpad2 = 0;
 
-    ptr = (uint8_t*) pctxt->alloc_fn (attrblocksz);
+    ptr = (uint8_t*) internal_exr_header_alloc (pctxt, attrblocksz);
     if (!ptr) return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
 
     nattr  = (exr_attribute_t*) ptr;
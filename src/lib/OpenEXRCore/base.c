@@ -208,3 +208,23 @@ exr_get_default_dwa_compression_quality (float* q)
 {
     if (q) *q = sDefaultDwaLevel;
 }
+
+/**************************************/
+
+static int sDefaultZstdLevel = 0;
+
+void
+exr_set_default_zstd_compression_level (int l)
+{
+    if (l < -22) l = -22;
+    if (l > 22) l = 22;
+    sDefaultZstdLevel = l;
+}
+
+/**************************************/
+
+void
+exr_get_default_zstd_compression_level (int* l)
+{
+    if (l) *l = sDefaultZstdLevel;
+}
@@ -37,8 +37,8 @@ exr_attr_chlist_init (exr_context_t ctxt, exr_attr_chlist_t* clist, int nchans)
 
     if (nchans > 0)
     {
-        nlist = (exr_attr_chlist_entry_t*) pctxt->alloc_fn (
-            sizeof (*nlist) * (size_t) nchans);
+        nlist = (exr_attr_chlist_entry_t*) internal_exr_header_alloc (
+            pctxt, sizeof (*nlist) * (size_t) nchans);
         if (nlist == NULL)
             return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
     }
@@ -175,8 +175,8 @@ exr_attr_chlist_add_with_length (
     {
         int nsz = clist->num_alloced * 2;
         if (newcount > nsz) nsz = newcount + 1;
-        nlist = (exr_attr_chlist_entry_t*) pctxt->alloc_fn (
-            sizeof (*nlist) * (size_t) nsz);
+        nlist = (exr_attr_chlist_entry_t*) internal_exr_header_alloc (
+            pctxt, sizeof (*nlist) * (size_t) nsz);
         if (nlist == NULL)
         {
             exr_attr_string_destroy (ctxt, &(nent.name));
@@ -203,7 +203,7 @@ exr_attr_chlist_add_with_length (
 
     clist->num_channels = newcount;
     clist->entries      = nlist;
-    if (nlist != olist) pctxt->free_fn (olist);
+    if (nlist != olist) internal_exr_header_free (pctxt, olist);
     return EXR_ERR_SUCCESS;
 }
 
@@ -260,7 +260,7 @@ exr_attr_chlist_destroy (exr_context_t ctxt, exr_attr_chlist_t* clist)
 
         for (int i = 0; i < nc; ++i)
             exr_attr_string_destroy (ctxt, &(entries[i].name));
-        if (entries) pctxt->free_fn (entries);
+        if (entries) internal_exr_header_free (pctxt, entries);
         *clist = nil;
     }
     return EXR_ERR_SUCCESS;
@@ -11,6 +11,7 @@
 #include "internal_xdr.h"
 
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 
 /**************************************/
@@ -520,6 +521,31 @@ reconstruct_chunk_table (
     return rv;
 }
 
+/* copies the part of the table at [chunkoff, chunkoff + chunkbytes)
+ * the header parse kept, returns the number of leading bytes copied */
+static uint64_t
+copy_chunk_table_prefix (
+    const struct _internal_exr_context* ctxt,
+    void*                               ctable,
+    uint64_t                            chunkoff,
+    uint64_t                            chunkbytes)
+{
+    uint64_t prefixoff, nbytes;
+
+    if (!ctxt->chunk_table_prefix || ctxt->num_parts <= 0) return 0;
+
+    prefixoff = ctxt->parts[0]->chunk_table_offset;
+    if (chunkoff < prefixoff ||
+        chunkoff - prefixoff >= ctxt->chunk_table_prefix_size)
+        return 0;
+
+    nbytes = ctxt->chunk_table_prefix_size - (chunkoff - prefixoff);
+    if (nbytes > chunkbytes) nbytes = chunkbytes;
+    memcpy (
+        ctable, ctxt->chunk_table_prefix + (chunkoff - prefixoff), nbytes);
+    return nbytes;
+}
+
 static exr_result_t
 extract_chunk_table (
     const struct _internal_exr_context* ctxt,
@@ -533,14 +559,21 @@ extract_chunk_table (
 
     *chunkminoffset = chunkoff + chunkbytes;
 
+    if (ctxt->header_only)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_NOT_OPEN_READ,
+            "File opened for its headers only, no chunks can be read");
+
     ctable = (uint64_t*) atomic_load (
         EXR_CONST_CAST (atomic_uintptr_t*, &(part->chunk_table)));
     if (ctable == NULL)
     {
         int64_t      nread = 0;
         uintptr_t    eptr = 0, nptr = 0;
-        int          complete = 1;
-        uint64_t     maxoff   = ((uint64_t) -1);
+        int          complete    = 1;
+        uint64_t     maxoff      = ((uint64_t) -1);
+        uint64_t     prefixbytes = 0;
         exr_result_t rv;
 
         if (part->chunk_count <= 0)
@@ -561,12 +594,25 @@ extract_chunk_table (
         if (ctable == NULL)
             return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
 
-        rv = ctxt->do_read (
-            ctxt, ctable, chunkbytes, &chunkoff, &nread, EXR_MUST_READ_ALL);
-        if (rv != EXR_ERR_SUCCESS)
+        /* whatever the header parse already read of the table does
+         * not need to come from the file again */
+        prefixbytes =
+            copy_chunk_table_prefix (ctxt, ctable, chunkoff, chunkbytes);
+        chunkoff += prefixbytes;
+        if (prefixbytes < chunkbytes)
         {
-            ctxt->free_fn (ctable);
-            return rv;
+            rv = ctxt->do_read (
+                ctxt,
+                ((uint8_t*) ctable) + prefixbytes,
+                chunkbytes - prefixbytes,
+                &chunkoff,
+                &nread,
+                EXR_MUST_READ_ALL);
+            if (rv != EXR_ERR_SUCCESS)
+            {
+                ctxt->free_fn (ctable);
+                return rv;
+            }
         }
 
         if (!ctxt->disable_chunk_reconstruct)
@@ -692,9 +738,321 @@ compute_chunk_unpack_size (
 
 /**************************************/
 
-exr_result_t
-exr_read_scanline_chunk_info (
-    exr_const_context_t ctxt, int part_index, int y, exr_chunk_info_t* cinfo)
+/* With a chunk read ahead set, the leader read also fetches the
+ * start of the chunk data into one of a few slots in the context,
+ * which read_packed_range copies from instead of reading it
+ * again. Slots are claimed and published under the context mutex,
+ * the reads and copies themselves happen outside of it. */
+
+static struct _internal_exr_chunk_cache_slot*
+claim_cache_slot (const struct _internal_exr_context* pctxt)
+{
+    struct _internal_exr_context* ctxt =
+        EXR_CONST_CAST (struct _internal_exr_context*, pctxt);
+    struct _internal_exr_chunk_cache_slot* ret = NULL;
+
+    EXR_LOCK (ctxt);
+    for (int s = 0; s < EXR_CHUNK_CACHE_SLOTS; ++s)
+    {
+        struct _internal_exr_chunk_cache_slot* slot = ctxt->chunk_cache + s;
+
+        if (slot->users > 0) continue;
+        if (!ret || slot->spent > ret->spent ||
+            (slot->spent == ret->spent && slot->stamp < ret->stamp))
+            ret = slot;
+    }
+    if (ret)
+    {
+        ret->users = 1;
+        ret->size  = 0;
+        ret->spent = 0;
+    }
+    EXR_UNLOCK (ctxt);
+    return ret;
+}
+
+static void
+publish_cache_slot (
+    const struct _internal_exr_context*    pctxt,
+    struct _internal_exr_chunk_cache_slot* slot,
+    uint64_t                               offset,
+    uint64_t                               size)
+{
+    struct _internal_exr_context* ctxt =
+        EXR_CONST_CAST (struct _internal_exr_context*, pctxt);
+
+    EXR_LOCK (ctxt);
+    slot->offset = offset;
+    slot->size   = size;
+    slot->stamp  = ++(ctxt->chunk_cache_clock);
+    slot->users  = 0;
+    EXR_UNLOCK (ctxt);
+}
+
+/* copies the longest cached prefix of the range, returning its size */
+static uint64_t
+copy_from_cache (
+    const struct _internal_exr_context* pctxt,
+    void*                               out,
+    uint64_t                            offset,
+    uint64_t                            size)
+{
+    struct _internal_exr_context* ctxt =
+        EXR_CONST_CAST (struct _internal_exr_context*, pctxt);
+    struct _internal_exr_chunk_cache_slot* slot = NULL;
+    uint64_t                               ncopy;
+
+    if (pctxt->chunk_read_ahead == 0 || size == 0) return 0;
+
+    EXR_LOCK (ctxt);
+    for (int s = 0; s < EXR_CHUNK_CACHE_SLOTS; ++s)
+    {
+        struct _internal_exr_chunk_cache_slot* cur = ctxt->chunk_cache + s;
+
+        /* a slot being filled has no size yet */
+        if (cur->size > 0 && offset >= cur->offset &&
+            offset - cur->offset < cur->size)
+        {
+            slot = cur;
+            ++(slot->users);
+            break;
+        }
+    }
+    EXR_UNLOCK (ctxt);
+
+    if (!slot) return 0;
+
+    ncopy = slot->size - (offset - slot->offset);
+    if (ncopy > size) ncopy = size;
+    memcpy (out, slot->data + (offset - slot->offset), ncopy);
+
+    EXR_LOCK (ctxt);
+    --(slot->users);
+    if (offset + ncopy == slot->offset + slot->size) slot->spent = 1;
+    EXR_UNLOCK (ctxt);
+
+    return ncopy;
+}
+
+/**************************************/
+
+/* a block of the file holding the leaders of several chunks, read by
+ * exr_build_chunk_info_table so it does not need a read per chunk */
+struct priv_leader_window
+{
+    uint64_t       offset;
+    uint64_t       size;
+    const uint8_t* data;
+};
+
+static int
+copy_from_window (
+    const struct priv_leader_window* win,
+    void*                            out,
+    uint64_t                         size,
+    uint64_t*                        dataoff)
+{
+    uint64_t woff;
+
+    if (!win || !win->data || *dataoff < win->offset) return 0;
+    woff = *dataoff - win->offset;
+    if (woff > win->size || size > win->size - woff) return 0;
+
+    memcpy (out, win->data + woff, size);
+    *dataoff += size;
+    return 1;
+}
+
+/* reads the leader of chunk cidx at *dataoff, advancing it past the
+ * leader, and with a read ahead set, the chunk data following it */
+static exr_result_t
+read_chunk_leader (
+    const struct _internal_exr_context* pctxt,
+    const struct _internal_exr_part*    part,
+    const uint64_t*                     ctable,
+    int                                 cidx,
+    const struct priv_leader_window*    win,
+    void*                               leader,
+    uint64_t                            leadersz,
+    uint64_t*                           dataoff,
+    int64_t*                            nread)
+{
+    exr_result_t                           rv;
+    struct _internal_exr_chunk_cache_slot* slot;
+    uint64_t                               start = *dataoff;
+    uint64_t                               span, next;
+    int64_t                                got = -1;
+
+    if (copy_from_window (win, leader, leadersz, dataoff))
+    {
+        if (nread) *nread = (int64_t) leadersz;
+        return EXR_ERR_SUCCESS;
+    }
+
+    if (pctxt->chunk_read_ahead == 0 || pctxt->mapped_data ||
+        part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_TILED)
+        return pctxt->do_read (
+            pctxt, leader, leadersz, dataoff, nread, EXR_MUST_READ_ALL);
+
+    if (copy_from_cache (pctxt, leader, start, leadersz) == leadersz)
+    {
+        *dataoff = start + leadersz;
+        if (nread) *nread = (int64_t) leadersz;
+        return EXR_ERR_SUCCESS;
+    }
+
+    /* stop at the next chunk when the table says where it is, so a
+     * small chunk is read exactly instead of reading into its
+     * neighbor */
+    span = leadersz + pctxt->chunk_read_ahead;
+    if (cidx + 1 < part->chunk_count)
+    {
+        next = ctable[cidx + 1];
+        if (next > start && next - start < span) span = next - start;
+    }
+    if (pctxt->file_size > 0 && (uint64_t) pctxt->file_size > start &&
+        (uint64_t) pctxt->file_size - start < span)
+        span = (uint64_t) pctxt->file_size - start;
+
+    slot = (span > leadersz) ? claim_cache_slot (pctxt) : NULL;
+    if (slot && slot->alloc_size < span)
+    {
+        if (slot->data) pctxt->free_fn (slot->data);
+        slot->alloc_size = leadersz + pctxt->chunk_read_ahead;
+        slot->data       = pctxt->alloc_fn ((size_t) slot->alloc_size);
+        if (!slot->data)
+        {
+            slot->alloc_size = 0;
+            publish_cache_slot (pctxt, slot, 0, 0);
+            slot = NULL;
+        }
+    }
+
+    if (!slot)
+        return pctxt->do_read (
+            pctxt, leader, leadersz, dataoff, nread, EXR_MUST_READ_ALL);
+
+    rv = pctxt->do_read (
+        pctxt, slot->data, span, dataoff, &got, EXR_ALLOW_SHORT_READ);
+    if (rv == EXR_ERR_SUCCESS && got < (int64_t) leadersz)
+        rv = EXR_ERR_READ_IO;
+
+    if (nread) *nread = got;
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        publish_cache_slot (pctxt, slot, 0, 0);
+        return rv;
+    }
+
+    memcpy (leader, slot->data, leadersz);
+    publish_cache_slot (pctxt, slot, start, (uint64_t) got);
+
+    *dataoff = start + leadersz;
+    if (nread) *nread = (int64_t) leadersz;
+    return EXR_ERR_SUCCESS;
+}
+
+/* the rest of a deep chunk leader */
+static exr_result_t
+read_leader_bytes (
+    const struct _internal_exr_context* pctxt,
+    const struct priv_leader_window*    win,
+    void*                               out,
+    uint64_t                            size,
+    uint64_t*                           dataoff)
+{
+    if (copy_from_window (win, out, size, dataoff)) return EXR_ERR_SUCCESS;
+    return pctxt->do_read (pctxt, out, size, dataoff, NULL, EXR_MUST_READ_ALL);
+}
+
+/**************************************/
+
+/* Chunk infos are kept per part once their leader has been read and
+ * checked, so a chunk looked up again does not read the file. The
+ * table is allocated on first use and published like the chunk
+ * table. Each entry is claimed by the first thread to store it and
+ * only read once marked ready. */
+
+#define EXR_CHUNK_INFO_EMPTY 0
+#define EXR_CHUNK_INFO_WRITING 1
+#define EXR_CHUNK_INFO_READY 2
+
+struct priv_chunk_info_entry
+{
+    atomic_uintptr_t state;
+    exr_chunk_info_t info;
+};
+
+static int
+lookup_chunk_info (
+    const struct _internal_exr_part* part, int cidx, exr_chunk_info_t* cinfo)
+{
+    struct priv_chunk_info_entry* table;
+
+    table = (struct priv_chunk_info_entry*) atomic_load (
+        EXR_CONST_CAST (atomic_uintptr_t*, &(part->chunk_info_table)));
+    if (!table ||
+        atomic_load (&(table[cidx].state)) != (uintptr_t) EXR_CHUNK_INFO_READY)
+        return 0;
+
+    *cinfo = table[cidx].info;
+    return 1;
+}
+
+static void
+store_chunk_info (
+    const struct _internal_exr_context* ctxt,
+    const struct _internal_exr_part*    part,
+    const exr_chunk_info_t*             cinfo)
+{
+    struct priv_chunk_info_entry* table;
+    uintptr_t                     eptr = 0, nptr = 0;
+
+    table = (struct priv_chunk_info_entry*) atomic_load (
+        EXR_CONST_CAST (atomic_uintptr_t*, &(part->chunk_info_table)));
+    if (table == NULL)
+    {
+        size_t tablebytes =
+            sizeof (struct priv_chunk_info_entry) * (size_t) part->chunk_count;
+
+        /* only an optimization, so not an error if this fails */
+        table = (struct priv_chunk_info_entry*) ctxt->alloc_fn (tablebytes);
+        if (table == NULL) return;
+        memset (table, 0, tablebytes);
+
+        nptr = (uintptr_t) table;
+        if (!atomic_compare_exchange_strong (
+                EXR_CONST_CAST (atomic_uintptr_t*, &(part->chunk_info_table)),
+                &eptr,
+                nptr))
+        {
+            ctxt->free_fn (table);
+            table = (struct priv_chunk_info_entry*) eptr;
+        }
+    }
+
+    eptr = EXR_CHUNK_INFO_EMPTY;
+    if (atomic_compare_exchange_strong (
+            &(table[cinfo->idx].state), &eptr, EXR_CHUNK_INFO_WRITING))
+    {
+        table[cinfo->idx].info = *cinfo;
+        eptr                   = EXR_CHUNK_INFO_WRITING;
+        atomic_compare_exchange_strong (
+            &(table[cinfo->idx].state), &eptr, EXR_CHUNK_INFO_READY);
+    }
+}
+
+/**************************************/
+
+static exr_result_t
+read_scanline_chunk_info (
+    const struct _internal_exr_context* pctxt,
+    const struct _internal_exr_part*    part,
+    int                                 part_index,
+    int                                 y,
+    const struct priv_leader_window*    win,
+    exr_chunk_info_t*                   cinfo)
 {
     exr_result_t     rv;
     int              miny, cidx, rdcnt, lpc;
@@ -704,9 +1062,6 @@ exr_read_scanline_chunk_info (
     uint64_t         chunkmin, dataoff;
     exr_attr_box2i_t dw;
     uint64_t*        ctable;
-    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
-
-    if (!cinfo) return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
 
     if (part->storage_mode == EXR_STORAGE_TILED ||
         part->storage_mode == EXR_STORAGE_DEEP_TILED)
@@ -746,6 +1101,8 @@ exr_read_scanline_chunk_info (
             part->chunk_count);
     }
 
+    if (lookup_chunk_info (part, cidx, cinfo)) return EXR_ERR_SUCCESS;
+
     cinfo->idx         = cidx;
     cinfo->type        = (uint8_t) part->storage_mode;
     cinfo->compression = (uint8_t) part->comp_type;
@@ -787,13 +1144,16 @@ exr_read_scanline_chunk_info (
     /* deep has 64-bit data, so be variable about what we read */
     if (part->storage_mode != EXR_STORAGE_DEEP_SCANLINE) ++rdcnt;
 
-    rv = pctxt->do_read (
+    rv = read_chunk_leader (
         pctxt,
+        part,
+        ctable,
+        cidx,
+        win,
         data,
-        (size_t) (rdcnt) * sizeof (int32_t),
+        (uint64_t) (rdcnt) * sizeof (int32_t),
         &dataoff,
-        NULL,
-        EXR_MUST_READ_ALL);
+        NULL);
 
     if (rv != EXR_ERR_SUCCESS) return rv;
 
@@ -829,13 +1189,8 @@ exr_read_scanline_chunk_info (
 
     if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
     {
-        rv = pctxt->do_read (
-            pctxt,
-            ddata,
-            3 * sizeof (int64_t),
-            &dataoff,
-            NULL,
-            EXR_MUST_READ_ALL);
+        rv = read_leader_bytes (
+            pctxt, win, ddata, 3 * sizeof (int64_t), &dataoff);
         if (rv != EXR_ERR_SUCCESS) { return rv; }
         priv_to_native64 (ddata, 3);
 
@@ -938,20 +1293,35 @@ exr_read_scanline_chunk_info (
     if (cinfo->packed_size == 0 && cinfo->unpacked_size > 0)
         return pctxt->report_error (
             pctxt, EXR_ERR_INVALID_ARGUMENT, "Invalid packed size of 0");
+
+    store_chunk_info (pctxt, part, cinfo);
     return EXR_ERR_SUCCESS;
 }
 
+exr_result_t
+exr_read_scanline_chunk_info (
+    exr_const_context_t ctxt, int part_index, int y, exr_chunk_info_t* cinfo)
+{
+    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (!cinfo) return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    return read_scanline_chunk_info (pctxt, part, part_index, y, NULL, cinfo);
+}
+
 /**************************************/
 
-exr_result_t
-exr_read_tile_chunk_info (
-    exr_const_context_t ctxt,
-    int                 part_index,
-    int                 tilex,
-    int                 tiley,
-    int                 levelx,
-    int                 levely,
-    exr_chunk_info_t*   cinfo)
+static exr_result_t
+read_tile_chunk_info (
+    const struct _internal_exr_context* pctxt,
+    const struct _internal_exr_part*    part,
+    int                                 part_index,
+    int                                 tilex,
+    int                                 tiley,
+    int                                 levelx,
+    int                                 levely,
+    const struct priv_leader_window*    win,
+    exr_chunk_info_t*                   cinfo)
 {
     exr_result_t               rv;
     int32_t                    data[6];
@@ -964,9 +1334,6 @@ exr_read_tile_chunk_info (
     int                        tilew, tileh;
     uint64_t                   texels, unpacksize = 0;
     uint64_t*                  ctable;
-    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
-
-    if (!cinfo) return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
 
     if (part->storage_mode == EXR_STORAGE_SCANLINE ||
         part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
@@ -979,6 +1346,8 @@ exr_read_tile_chunk_info (
         pctxt, part, tilex, tiley, levelx, levely, &cidx);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
+    if (lookup_chunk_info (part, cidx, cinfo)) return EXR_ERR_SUCCESS;
+
     tiledesc = part->tiles->tiledesc;
 
     tilew = (int) (tiledesc->x_size);
@@ -1060,13 +1429,16 @@ exr_read_tile_chunk_info (
             dataoff);
     }
 
-    rv = pctxt->do_read (
+    rv = read_chunk_leader (
         pctxt,
+        part,
+        ctable,
+        cidx,
+        win,
         data,
         (uint64_t) (ntoread) * sizeof (int32_t),
         &dataoff,
-        &nread,
-        EXR_MUST_READ_ALL);
+        &nread);
     if (rv != EXR_ERR_SUCCESS)
     {
         return pctxt->print_error (
@@ -1163,13 +1535,8 @@ exr_read_tile_chunk_info (
     if (part->storage_mode == EXR_STORAGE_DEEP_TILED)
     {
         int64_t ddata[3];
-        rv = pctxt->do_read (
-            pctxt,
-            ddata,
-            3 * sizeof (int64_t),
-            &dataoff,
-            NULL,
-            EXR_MUST_READ_ALL);
+        rv = read_leader_bytes (
+            pctxt, win, ddata, 3 * sizeof (int64_t), &dataoff);
         if (rv != EXR_ERR_SUCCESS) { return rv; }
         priv_to_native64 (ddata, 3);
 
@@ -1292,26 +1659,245 @@ exr_read_tile_chunk_info (
         return pctxt->report_error (
             pctxt, EXR_ERR_INVALID_ARGUMENT, "Invalid packed size of 0");
 
+    store_chunk_info (pctxt, part, cinfo);
     return EXR_ERR_SUCCESS;
 }
 
 exr_result_t
-exr_read_chunk (
-    exr_const_context_t     ctxt,
-    int                     part_index,
-    const exr_chunk_info_t* cinfo,
-    void*                   packed_data)
+exr_read_tile_chunk_info (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int                 tilex,
+    int                 tiley,
+    int                 levelx,
+    int                 levely,
+    exr_chunk_info_t*   cinfo)
 {
-    exr_result_t                 rv;
-    uint64_t                     dataoffset, toread;
-    int64_t                      nread;
-    enum _INTERNAL_EXR_READ_MODE rmode = EXR_MUST_READ_ALL;
     EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
 
     if (!cinfo) return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
-    if (cinfo->packed_size > 0 && !packed_data)
-        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
 
+    return read_tile_chunk_info (
+        pctxt, part, part_index, tilex, tiley, levelx, levely, NULL, cinfo);
+}
+
+/**************************************/
+
+/* leaders that fit in a read of this size are fetched together */
+#define EXR_CHUNK_INFO_SCAN_SPAN (1024 * 1024)
+/* part number, tile coordinates and the three deep sizes */
+#define EXR_CHUNK_LEADER_MAX_SIZE 44
+
+struct priv_chunk_ref
+{
+    uint64_t offset;
+    int32_t  idx;
+    int32_t  x;
+    int32_t  y;
+    int32_t  level_x;
+    int32_t  level_y;
+};
+
+static int
+compare_chunk_ref (const void* a, const void* b)
+{
+    uint64_t aoff = ((const struct priv_chunk_ref*) a)->offset;
+    uint64_t boff = ((const struct priv_chunk_ref*) b)->offset;
+    if (aoff < boff) return -1;
+    if (aoff > boff) return 1;
+    return 0;
+}
+
+static exr_result_t
+collect_chunk_refs (
+    const struct _internal_exr_context* pctxt,
+    const struct _internal_exr_part*    part,
+    const uint64_t*                     ctable,
+    struct priv_chunk_ref*              refs)
+{
+    exr_result_t rv = EXR_ERR_SUCCESS;
+    int          nlx, nly;
+
+    if (part->storage_mode == EXR_STORAGE_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
+    {
+        for (int c = 0; c < part->chunk_count; ++c)
+        {
+            refs[c].offset  = ctable[c];
+            refs[c].idx     = c;
+            refs[c].x       = 0;
+            refs[c].y       = part->data_window.min.y + c * part->lines_per_chunk;
+            refs[c].level_x = 0;
+            refs[c].level_y = 0;
+        }
+        return EXR_ERR_SUCCESS;
+    }
+
+    if (!part->tiles || !part->tile_level_tile_count_x ||
+        !part->tile_level_tile_count_y)
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_MISSING_REQ_ATTR,
+            "Tile descriptor data missing or corrupt");
+
+    /* mip levels have the same x and y, so only walk the diagonal */
+    nlx = part->num_tile_levels_x;
+    nly = part->num_tile_levels_y;
+    if (EXR_GET_TILE_LEVEL_MODE ((*(part->tiles->tiledesc))) !=
+        EXR_TILE_RIPMAP_LEVELS)
+        nly = 1;
+
+    for (int ly = 0; ly < nly && rv == EXR_ERR_SUCCESS; ++ly)
+    {
+        for (int lx = 0; lx < nlx && rv == EXR_ERR_SUCCESS; ++lx)
+        {
+            int levely = (nly == 1) ? lx : ly;
+            int numx   = part->tile_level_tile_count_x[lx];
+            int numy   = part->tile_level_tile_count_y[levely];
+
+            for (int ty = 0; ty < numy && rv == EXR_ERR_SUCCESS; ++ty)
+            {
+                for (int tx = 0; tx < numx; ++tx)
+                {
+                    int32_t cidx = 0;
+
+                    rv = validate_and_compute_tile_chunk_off (
+                        pctxt, part, tx, ty, lx, levely, &cidx);
+                    if (rv != EXR_ERR_SUCCESS) break;
+
+                    refs[cidx].offset  = ctable[cidx];
+                    refs[cidx].idx     = cidx;
+                    refs[cidx].x       = tx;
+                    refs[cidx].y       = ty;
+                    refs[cidx].level_x = lx;
+                    refs[cidx].level_y = levely;
+                }
+            }
+        }
+    }
+    return rv;
+}
+
+exr_result_t
+exr_build_chunk_info_table (exr_const_context_t ctxt, int part_index)
+{
+    exr_result_t              rv, firstrv = EXR_ERR_SUCCESS;
+    uint64_t*                 ctable;
+    uint64_t                  chunkmin;
+    struct priv_chunk_ref*    refs;
+    uint8_t*                  buf = NULL;
+    struct priv_leader_window win = {0, 0, NULL};
+    exr_chunk_info_t          cinfo;
+    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    rv = extract_chunk_table (pctxt, part, &ctable, &chunkmin);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    refs = pctxt->alloc_fn (
+        sizeof (struct priv_chunk_ref) * (size_t) part->chunk_count);
+    if (!refs) return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+
+    rv = collect_chunk_refs (pctxt, part, ctable, refs);
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        pctxt->free_fn (refs);
+        return rv;
+    }
+
+    /* walk them in file order, so each read picks up the leaders of
+     * the following chunks along with the data in between */
+    qsort (
+        refs,
+        (size_t) part->chunk_count,
+        sizeof (struct priv_chunk_ref),
+        &compare_chunk_ref);
+
+    for (int i = 0; i < part->chunk_count; ++i)
+    {
+        const struct priv_chunk_ref* ref = refs + i;
+
+        if (lookup_chunk_info (part, ref->idx, &cinfo)) continue;
+
+        /* the mapping already is one big window */
+        if (!pctxt->mapped_data &&
+            (!win.data || ref->offset < win.offset ||
+             ref->offset - win.offset + EXR_CHUNK_LEADER_MAX_SIZE > win.size))
+        {
+            uint64_t end     = ref->offset + EXR_CHUNK_LEADER_MAX_SIZE;
+            uint64_t dataoff = ref->offset;
+            int64_t  nread   = 0;
+
+            for (int j = i + 1; j < part->chunk_count; ++j)
+            {
+                uint64_t nend = refs[j].offset + EXR_CHUNK_LEADER_MAX_SIZE;
+                if (nend - ref->offset > EXR_CHUNK_INFO_SCAN_SPAN) break;
+                end = nend;
+            }
+            if (pctxt->file_size > 0 && end > (uint64_t) pctxt->file_size)
+                end = (uint64_t) pctxt->file_size;
+
+            if (!buf)
+            {
+                buf = pctxt->alloc_fn (EXR_CHUNK_INFO_SCAN_SPAN);
+                if (!buf)
+                {
+                    firstrv =
+                        pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+                    break;
+                }
+            }
+
+            win.offset = ref->offset;
+            win.size   = 0;
+            win.data   = buf;
+            /* a bad offset is reported when the leader is checked */
+            if (end > ref->offset)
+            {
+                rv = pctxt->do_read (
+                    pctxt,
+                    buf,
+                    end - ref->offset,
+                    &dataoff,
+                    &nread,
+                    EXR_ALLOW_SHORT_READ);
+                if (rv != EXR_ERR_SUCCESS)
+                {
+                    firstrv = rv;
+                    break;
+                }
+                win.size = (uint64_t) nread;
+            }
+        }
+
+        if (part->storage_mode == EXR_STORAGE_SCANLINE ||
+            part->storage_mode == EXR_STORAGE_DEEP_SCANLINE)
+            rv = read_scanline_chunk_info (
+                pctxt, part, part_index, ref->y, &win, &cinfo);
+        else
+            rv = read_tile_chunk_info (
+                pctxt,
+                part,
+                part_index,
+                ref->x,
+                ref->y,
+                ref->level_x,
+                ref->level_y,
+                &win,
+                &cinfo);
+        if (rv != EXR_ERR_SUCCESS && firstrv == EXR_ERR_SUCCESS) firstrv = rv;
+    }
+
+    if (buf) pctxt->free_fn (buf);
+    pctxt->free_fn (refs);
+    return firstrv;
+}
+
+static exr_result_t
+validate_read_chunk_info (
+    const struct _internal_exr_context* pctxt,
+    const struct _internal_exr_part*    part,
+    const exr_chunk_info_t*             cinfo)
+{
     if (cinfo->idx < 0 || cinfo->idx >= part->chunk_count)
         return pctxt->print_error (
             pctxt,
@@ -1330,35 +1916,213 @@ exr_read_chunk (
             EXR_ERR_INVALID_ARGUMENT,
             "mismatched compression type for chunk block info");
 
-    dataoffset = cinfo->data_offset;
-    if (pctxt->file_size > 0 && dataoffset > (uint64_t) pctxt->file_size)
+    if (pctxt->file_size > 0 &&
+        cinfo->data_offset > (uint64_t) pctxt->file_size)
         return pctxt->print_error (
             pctxt,
             EXR_ERR_INVALID_ARGUMENT,
             "chunk block info data offset (%" PRIu64
             ") past end of file (%" PRId64 ")",
-            dataoffset,
+            cinfo->data_offset,
             pctxt->file_size);
 
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+static exr_result_t
+read_packed_range (
+    const struct _internal_exr_context* pctxt,
+    const struct _internal_exr_part*    part,
+    uint64_t                            dataoffset,
+    uint64_t                            toread,
+    void*                               packed_data)
+{
+    exr_result_t                 rv;
+    int64_t                      nread = 0;
+    enum _INTERNAL_EXR_READ_MODE rmode = EXR_MUST_READ_ALL;
+    uint64_t                     ncached;
+
+    if (toread == 0) return EXR_ERR_SUCCESS;
+
+    /* the leader read may have brought in the start of it already */
+    ncached = copy_from_cache (pctxt, packed_data, dataoffset, toread);
+    if (ncached == toread) return EXR_ERR_SUCCESS;
+    packed_data = ((uint8_t*) packed_data) + ncached;
+    dataoffset += ncached;
+    toread -= ncached;
+
     /* allow a short read if uncompressed */
     if (part->comp_type == EXR_COMPRESSION_NONE) rmode = EXR_ALLOW_SHORT_READ;
 
-    toread = cinfo->packed_size;
-    if (toread > 0)
+    rv = pctxt->do_read (pctxt, packed_data, toread, &dataoffset, &nread, rmode);
+
+    if (rmode == EXR_ALLOW_SHORT_READ && nread < (int64_t) toread)
+        memset (
+            ((uint8_t*) packed_data) + nread, 0, toread - (uint64_t) (nread));
+
+    return rv;
+}
+
+/**************************************/
+
+exr_result_t
+exr_read_chunk (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    const exr_chunk_info_t* cinfo,
+    void*                   packed_data)
+{
+    exr_result_t rv;
+    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (!cinfo) return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (cinfo->packed_size > 0 && !packed_data)
+        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    rv = validate_read_chunk_info (pctxt, part, cinfo);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    return read_packed_range (
+        pctxt, part, cinfo->data_offset, cinfo->packed_size, packed_data);
+}
+
+/**************************************/
+
+/* requested chunks closer together than this are fetched with one
+ * read, reading through the chunk leaders (and any chunks that were
+ * not asked for) in between */
+#define EXR_READ_CHUNKS_MAX_GAP 4096
+/* but a single read is not allowed to grow past this */
+#define EXR_READ_CHUNKS_MAX_SPAN (16 * 1024 * 1024)
+
+struct priv_chunk_read
+{
+    const exr_chunk_info_t* cinfo;
+    void*                   packed_data;
+};
+
+static int
+compare_chunk_read (const void* a, const void* b)
+{
+    uint64_t aoff = ((const struct priv_chunk_read*) a)->cinfo->data_offset;
+    uint64_t boff = ((const struct priv_chunk_read*) b)->cinfo->data_offset;
+    if (aoff < boff) return -1;
+    if (aoff > boff) return 1;
+    return 0;
+}
+
+exr_result_t
+exr_read_chunks (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    int                     count,
+    const exr_chunk_info_t* cinfos,
+    void* const*            packed_data)
+{
+    exr_result_t            rv = EXR_ERR_SUCCESS;
+    struct priv_chunk_read* reads;
+    uint8_t*                stage   = NULL;
+    uint64_t                stagesz = 0;
+    int                     nreads  = 0;
+    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (count < 0 || (count > 0 && (!cinfos || !packed_data)))
+        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (count == 0) return EXR_ERR_SUCCESS;
+
+    for (int i = 0; i < count; ++i)
     {
-        nread = 0;
-        rv    = pctxt->do_read (
-            pctxt, packed_data, toread, &dataoffset, &nread, rmode);
+        const exr_chunk_info_t* cinfo = cinfos + i;
 
-        if (rmode == EXR_ALLOW_SHORT_READ && nread < (int64_t) toread)
-            memset (
-                ((uint8_t*) packed_data) + nread,
-                0,
-                toread - (uint64_t) (nread));
+        if (cinfo->packed_size > 0 && !packed_data[i])
+            return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+
+        rv = validate_read_chunk_info (pctxt, part, cinfo);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+
+        if (cinfo->data_offset > UINT64_MAX - EXR_READ_CHUNKS_MAX_GAP ||
+            cinfo->packed_size >
+                UINT64_MAX - EXR_READ_CHUNKS_MAX_GAP - cinfo->data_offset)
+            return pctxt->print_error (
+                pctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "chunk block info packed size (%" PRIu64 ") invalid",
+                cinfo->packed_size);
+    }
+
+    reads = pctxt->alloc_fn (sizeof (struct priv_chunk_read) * (size_t) count);
+    if (!reads) return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (cinfos[i].packed_size == 0) continue;
+        reads[nreads].cinfo       = cinfos + i;
+        reads[nreads].packed_data = packed_data[i];
+        ++nreads;
+    }
+
+    /* the chunk infos carry the offsets from the chunk table, so
+     * sorting by those puts the requests in file order */
+    qsort (reads, (size_t) nreads, sizeof (*reads), &compare_chunk_read);
+
+    for (int i = 0, next = 0; i < nreads && rv == EXR_ERR_SUCCESS; i = next)
+    {
+        uint64_t start = reads[i].cinfo->data_offset;
+        uint64_t end   = start + reads[i].cinfo->packed_size;
+
+        for (next = i + 1; next < nreads; ++next)
+        {
+            const exr_chunk_info_t* ncinfo = reads[next].cinfo;
+            uint64_t                nend;
+
+            if (ncinfo->data_offset > end + EXR_READ_CHUNKS_MAX_GAP) break;
+
+            nend = ncinfo->data_offset + ncinfo->packed_size;
+            if (nend > end)
+            {
+                if (nend - start > EXR_READ_CHUNKS_MAX_SPAN) break;
+                end = nend;
+            }
+        }
+
+        if (next == i + 1)
+        {
+            rv = read_packed_range (
+                pctxt,
+                part,
+                start,
+                reads[i].cinfo->packed_size,
+                reads[i].packed_data);
+            continue;
+        }
+
+        if (end - start > stagesz)
+        {
+            if (stage) pctxt->free_fn (stage);
+            stagesz = end - start;
+            stage   = pctxt->alloc_fn ((size_t) stagesz);
+            if (!stage)
+            {
+                rv = pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+                break;
+            }
+        }
+
+        rv = read_packed_range (pctxt, part, start, end - start, stage);
+
+        for (int r = i; r < next && rv == EXR_ERR_SUCCESS; ++r)
+        {
+            memcpy (
+                reads[r].packed_data,
+                stage + (reads[r].cinfo->data_offset - start),
+                reads[r].cinfo->packed_size);
+        }
     }
-    else
-        rv = EXR_ERR_SUCCESS;
 
+    if (stage) pctxt->free_fn (stage);
+    pctxt->free_fn (reads);
     return rv;
 }
 
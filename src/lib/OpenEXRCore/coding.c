@@ -4,10 +4,21 @@
 */
 
 #include "internal_coding.h"
+#include "internal_cpuid.h"
 #include "internal_util.h"
 
 #include <string.h>
 
+#ifdef EXR_HAS_STD_ATOMICS
+#    include <stdatomic.h>
+#elif defined(_MSC_VER)
+#    define atomic_load(object) InterlockedOr64 ((int64_t volatile*) object, 0)
+#    define atomic_store(object, desired)                                     \
+        InterlockedExchange64 ((int64_t volatile*) object, (int64_t) desired)
+#else
+#    error OS unimplemented support for atomics
+#endif
+
 exr_result_t
 internal_coding_fill_channel_info (
     exr_coding_channel_info_t**         channels,
@@ -278,3 +289,20 @@ internal_decode_alloc_buffer (
     }
     return EXR_ERR_SUCCESS;
 }
+
+/**************************************/
+
+int
+internal_exr_x86_byte_simd (void)
+{
+    /* probe result + 1, so that 0 means not probed yet */
+    static atomic_uintptr_t probed = 0;
+    uintptr_t               simd   = atomic_load (&probed);
+
+    if (simd == 0)
+    {
+        simd = (uintptr_t) check_for_x86_byte_simd () + 1;
+        atomic_store (&probed, simd);
+    }
+    return (int) (simd - 1);
+}
@@ -5,11 +5,22 @@
 
 #include "openexr_compression.h"
 #include "openexr_base.h"
+#include "internal_compress.h"
+#include "internal_decompress.h"
+#include "internal_lz4.h"
 #include "internal_memory.h"
 #include "internal_structs.h"
 
 #include <libdeflate.h>
 
+#include "OpenEXRConfigInternal.h"
+
+#ifdef OPENEXR_HAVE_ZSTD
+/* for the custom memory allocator */
+#    define ZSTD_STATIC_LINKING_ONLY
+#    include <zstd.h>
+#endif
+
 #if (                                                                          \
     LIBDEFLATE_VERSION_MAJOR > 1 ||                                            \
     (LIBDEFLATE_VERSION_MAJOR == 1 && LIBDEFLATE_VERSION_MINOR > 18))
@@ -155,3 +166,261 @@ exr_uncompress_buffer (
     }
     return EXR_ERR_OUT_OF_MEMORY;
 }
+
+/**************************************/
+
+#ifdef OPENEXR_HAVE_ZSTD
+static void*
+zstd_alloc (void* opaque, size_t sz)
+{
+    const struct _internal_exr_context* pctxt = opaque;
+    return pctxt ? pctxt->alloc_fn (sz) : internal_exr_alloc (sz);
+}
+
+static void
+zstd_free (void* opaque, void* ptr)
+{
+    const struct _internal_exr_context* pctxt = opaque;
+    if (pctxt)
+        pctxt->free_fn (ptr);
+    else
+        internal_exr_free (ptr);
+}
+#endif
+
+/**************************************/
+
+size_t
+exr_zstd_compress_max_buffer_size (size_t in_bytes)
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    size_t r = ZSTD_compressBound (in_bytes);
+    /* too large an input is reported as an error code (or 0) */
+    if (ZSTD_isError (r) || (r == 0 && in_bytes > 0))
+        return (size_t) (SIZE_MAX);
+    return r;
+#else
+    return exr_compress_max_buffer_size (in_bytes);
+#endif
+}
+
+/**************************************/
+
+exr_result_t
+internal_exr_zstd_compress (
+    const struct _internal_exr_context* pctxt,
+    void**                              cctx,
+    int                                 level,
+    const void*                         in,
+    size_t                              in_bytes,
+    void*                               out,
+    size_t                              out_bytes_avail,
+    size_t*                             actual_out)
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    size_t outsz;
+
+    if (level == 0) exr_get_default_zstd_compression_level (&level);
+    /* still 0 picks the zstd default */
+    if (level < ZSTD_minCLevel ()) level = ZSTD_minCLevel ();
+    if (level > ZSTD_maxCLevel ()) level = ZSTD_maxCLevel ();
+
+    if (!*cctx)
+    {
+        ZSTD_customMem mem = {
+            zstd_alloc, zstd_free, EXR_CONST_CAST (void*, pctxt)};
+
+        *cctx = ZSTD_createCCtx_advanced (mem);
+        if (!*cctx) return EXR_ERR_OUT_OF_MEMORY;
+    }
+
+    /* the level is applied afresh, whatever the last chunk used */
+    outsz = ZSTD_compressCCtx (
+        (ZSTD_CCtx*) *cctx, out, out_bytes_avail, in, in_bytes, level);
+
+    if (ZSTD_isError (outsz)) return EXR_ERR_OUT_OF_MEMORY;
+    if (actual_out) *actual_out = outsz;
+    return EXR_ERR_SUCCESS;
+#else
+    (void) pctxt;
+    (void) cctx;
+    (void) level;
+    (void) in;
+    (void) in_bytes;
+    (void) out;
+    (void) out_bytes_avail;
+    (void) actual_out;
+    return EXR_ERR_FEATURE_NOT_IMPLEMENTED;
+#endif
+}
+
+/**************************************/
+
+void
+internal_exr_zstd_free_cctx (void* cctx)
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    ZSTD_freeCCtx ((ZSTD_CCtx*) cctx);
+#else
+    (void) cctx;
+#endif
+}
+
+/**************************************/
+
+exr_result_t
+internal_exr_zstd_uncompress (
+    const struct _internal_exr_context* pctxt,
+    void**                              dctx,
+    const void*                         in,
+    size_t                              in_bytes,
+    void*                               out,
+    size_t                              out_bytes_avail,
+    size_t*                             actual_out)
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    size_t outsz;
+
+    if (!*dctx)
+    {
+        ZSTD_customMem mem = {
+            zstd_alloc, zstd_free, EXR_CONST_CAST (void*, pctxt)};
+
+        *dctx = ZSTD_createDCtx_advanced (mem);
+        if (!*dctx) return EXR_ERR_OUT_OF_MEMORY;
+    }
+
+    outsz = ZSTD_decompressDCtx (
+        (ZSTD_DCtx*) *dctx, out, out_bytes_avail, in, in_bytes);
+
+    if (ZSTD_isError (outsz)) return EXR_ERR_CORRUPT_CHUNK;
+    if (actual_out) *actual_out = outsz;
+    return EXR_ERR_SUCCESS;
+#else
+    (void) pctxt;
+    (void) dctx;
+    (void) in;
+    (void) in_bytes;
+    (void) out;
+    (void) out_bytes_avail;
+    (void) actual_out;
+    return EXR_ERR_FEATURE_NOT_IMPLEMENTED;
+#endif
+}
+
+/**************************************/
+
+void
+internal_exr_zstd_free_dctx (void* dctx)
+{
+#ifdef OPENEXR_HAVE_ZSTD
+    ZSTD_freeDCtx ((ZSTD_DCtx*) dctx);
+#else
+    (void) dctx;
+#endif
+}
+
+/**************************************/
+
+exr_result_t
+exr_zstd_compress_buffer (
+    exr_const_context_t ctxt,
+    int                 level,
+    const void*         in,
+    size_t              in_bytes,
+    void*               out,
+    size_t              out_bytes_avail,
+    size_t*             actual_out)
+{
+    void*        cctx = NULL;
+    exr_result_t rv;
+
+    rv = internal_exr_zstd_compress (
+        EXR_CCTXT (ctxt),
+        &cctx,
+        level,
+        in,
+        in_bytes,
+        out,
+        out_bytes_avail,
+        actual_out);
+    internal_exr_zstd_free_cctx (cctx);
+    return rv;
+}
+
+/**************************************/
+
+exr_result_t
+exr_zstd_uncompress_buffer (
+    exr_const_context_t ctxt,
+    const void*         in,
+    size_t              in_bytes,
+    void*               out,
+    size_t              out_bytes_avail,
+    size_t*             actual_out)
+{
+    void*        dctx = NULL;
+    exr_result_t rv;
+
+    rv = internal_exr_zstd_uncompress (
+        EXR_CCTXT (ctxt),
+        &dctx,
+        in,
+        in_bytes,
+        out,
+        out_bytes_avail,
+        actual_out);
+    internal_exr_zstd_free_dctx (dctx);
+    return rv;
+}
+
+/**************************************/
+
+size_t
+exr_lz4_compress_max_buffer_size (size_t in_bytes)
+{
+    uint64_t r = internal_lz4_compress_bound ((uint64_t) in_bytes);
+    if (r < (uint64_t) in_bytes || r > (uint64_t) SIZE_MAX)
+        return (size_t) (SIZE_MAX);
+    return (size_t) r;
+}
+
+/**************************************/
+
+exr_result_t
+exr_lz4_compress_buffer (
+    exr_const_context_t ctxt,
+    const void*         in,
+    size_t              in_bytes,
+    void*               out,
+    size_t              out_bytes_avail,
+    size_t*             actual_out)
+{
+    uint64_t outsz;
+
+    (void) ctxt;
+    outsz = internal_lz4_compress (out, out_bytes_avail, in, in_bytes);
+    if (outsz == 0) return EXR_ERR_OUT_OF_MEMORY;
+    if (actual_out) *actual_out = (size_t) outsz;
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+exr_result_t
+exr_lz4_uncompress_buffer (
+    exr_const_context_t ctxt,
+    const void*         in,
+    size_t              in_bytes,
+    void*               out,
+    size_t              out_bytes_avail,
+    size_t*             actual_out)
+{
+    uint64_t     outsz;
+    exr_result_t rv;
+
+    (void) ctxt;
+    rv = internal_lz4_decompress (out, out_bytes_avail, in, in_bytes, &outsz);
+    if (rv == EXR_ERR_SUCCESS && actual_out) *actual_out = (size_t) outsz;
+    return rv;
+}
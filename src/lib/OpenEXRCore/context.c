@@ -7,12 +7,17 @@
 // define this if it hasn't been defined elsewhere
 #    define _LARGEFILE64_SOURCE
 #endif
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// for preadv2
+#    define _GNU_SOURCE
+#endif
 
 #include "openexr_config.h"
 #include "openexr_context.h"
 
 #include "openexr_part.h"
 
+#include "internal_async.h"
 #include "internal_constants.h"
 #include "internal_file.h"
 #include "backward_compatibility.h"
@@ -148,6 +153,15 @@ fill_context_data (const exr_context_initializer_t* ctxtdata)
         {
             inits.flags = ctxtdata->flags;
         }
+        if (ctxtdata->size >= sizeof (struct _exr_context_initializer_v4))
+        {
+            inits.read_async_fn = ctxtdata->read_async_fn;
+        }
+        if (ctxtdata->size >= sizeof (struct _exr_context_initializer_v5))
+        {
+            inits.chunk_read_ahead = ctxtdata->chunk_read_ahead;
+            inits.header_prefetch  = ctxtdata->header_prefetch;
+        }
     }
 
     internal_exr_update_default_handlers (&inits);
@@ -226,6 +240,8 @@ exr_finish (exr_context_t* pctxt)
 
         if (ctxt->mode != EXR_CONTEXT_READ) rv = finalize_write (ctxt, failed);
 
+        internal_exr_destroy_async_reader (ctxt);
+
         if (ctxt->destroy_fn)
             ctxt->destroy_fn (*pctxt, ctxt->user_data, failed);
 
@@ -84,9 +84,12 @@ print_attr (const exr_attribute_t* a, int verbose)
                 "b44",
                 "b44a",
                 "dwaa",
-                "dwab"};
+                "dwab",
+                "piz4",
+                "zstd",
+                "lz4"};
             printf (
-                "'%s'", (a->uc < 10 ? compressionnames[a->uc] : "<UNKNOWN>"));
+                "'%s'", (a->uc < 13 ? compressionnames[a->uc] : "<UNKNOWN>"));
             if (verbose) printf (" (0x%02X)", a->uc);
             break;
         }
@@ -0,0 +1,538 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "openexr_decode.h"
+
+#include "internal_async.h"
+#include "internal_structs.h"
+
+#include <string.h>
+
+/**************************************/
+
+struct _region_worker;
+
+struct _region_state
+{
+    exr_const_context_t                 ctxt;
+    const struct _internal_exr_context* pctxt;
+    int                                 part_index;
+    int                                 level_x;
+    int                                 level_y;
+    int                                 tiled;
+
+    exr_attr_box2i_t region;
+    int32_t          origin_x;
+    int32_t          origin_y;
+    int32_t          tile_w;
+    int32_t          tile_h;
+
+    /* the chunks overlapping the region, row by row */
+    int32_t first_cx;
+    int32_t first_cy;
+    int32_t count_x;
+    int32_t total;
+
+    /* for each channel of the part, the destination, or NULL */
+    const exr_region_channel_t** dest;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    CRITICAL_SECTION mutex;
+#    else
+    pthread_mutex_t mutex;
+#    endif
+#endif
+    int32_t next;
+    int32_t grain;
+    int     failed;
+};
+
+struct _region_worker
+{
+    struct _region_state* state;
+    exr_decode_pipeline_t decoder;
+    int                   initialized;
+    uint8_t*              scratch;
+    size_t                scratch_size;
+    exr_result_t          rv;
+};
+
+/**************************************/
+
+static int
+claim_chunks (struct _region_state* state, int32_t* first, int32_t* last)
+{
+    int ok = 0;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    EnterCriticalSection (&(state->mutex));
+#    else
+    pthread_mutex_lock (&(state->mutex));
+#    endif
+#endif
+    if (!state->failed && state->next < state->total)
+    {
+        *first = state->next;
+        *last  = state->next + state->grain;
+        if (*last > state->total) *last = state->total;
+        state->next = *last;
+        ok          = 1;
+    }
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    LeaveCriticalSection (&(state->mutex));
+#    else
+    pthread_mutex_unlock (&(state->mutex));
+#    endif
+#endif
+    return ok;
+}
+
+static void
+fail_region (struct _region_state* state)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    EnterCriticalSection (&(state->mutex));
+    state->failed = 1;
+    LeaveCriticalSection (&(state->mutex));
+#    else
+    pthread_mutex_lock (&(state->mutex));
+    state->failed = 1;
+    pthread_mutex_unlock (&(state->mutex));
+#    endif
+#else
+    state->failed = 1;
+#endif
+}
+
+/**************************************/
+
+static exr_result_t
+decode_one_chunk (struct _region_worker* w, int32_t idx)
+{
+    struct _region_state*               state = w->state;
+    const struct _internal_exr_context* pctxt = state->pctxt;
+    exr_decode_pipeline_t*              dec   = &(w->decoder);
+    exr_chunk_info_t                    cinfo;
+    exr_result_t                        rv;
+    int32_t                             cx, cy, x0, y0, x1, y1;
+    int32_t                             ix0, iy0, ix1, iy1;
+    int                                 full;
+    size_t                              need = 0, off = 0;
+
+    cx = state->first_cx + idx % state->count_x;
+    cy = state->first_cy + idx / state->count_x;
+
+    if (state->tiled)
+        rv = exr_read_tile_chunk_info (
+            state->ctxt,
+            state->part_index,
+            cx,
+            cy,
+            state->level_x,
+            state->level_y,
+            &cinfo);
+    else
+        rv = exr_read_scanline_chunk_info (
+            state->ctxt,
+            state->part_index,
+            state->origin_y + cy * state->tile_h,
+            &cinfo);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (w->initialized)
+        rv = exr_decoding_update (
+            state->ctxt, state->part_index, &cinfo, dec);
+    else
+    {
+        rv = exr_decoding_initialize (
+            state->ctxt, state->part_index, &cinfo, dec);
+        w->initialized = (rv == EXR_ERR_SUCCESS);
+    }
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    /* pixel rectangle of the chunk, and its overlap with the region */
+    if (state->tiled)
+    {
+        x0 = state->origin_x + cinfo.start_x * state->tile_w;
+        y0 = state->origin_y + cinfo.start_y * state->tile_h;
+    }
+    else
+    {
+        x0 = cinfo.start_x;
+        y0 = cinfo.start_y;
+    }
+    x1 = x0 + cinfo.width - 1;
+    y1 = y0 + cinfo.height - 1;
+
+    ix0 = x0 > state->region.min.x ? x0 : state->region.min.x;
+    iy0 = y0 > state->region.min.y ? y0 : state->region.min.y;
+    ix1 = x1 < state->region.max.x ? x1 : state->region.max.x;
+    iy1 = y1 < state->region.max.y ? y1 : state->region.max.y;
+
+    full = (ix0 == x0 && iy0 == y0 && ix1 == x1 && iy1 == y1);
+
+    /* chunks sticking out of the region are unpacked to scratch
+     * memory first, then copied */
+    for (int c = 0; c < dec->channel_count; ++c)
+    {
+        const exr_region_channel_t* d = state->dest[c];
+        if (d && !full)
+            need += ((size_t) cinfo.width) * ((size_t) cinfo.height) *
+                    (d->data_type == EXR_PIXEL_HALF ? 2 : 4);
+    }
+
+    if (need > w->scratch_size)
+    {
+        if (w->scratch) pctxt->free_fn (w->scratch);
+        w->scratch_size = 0;
+        w->scratch      = pctxt->alloc_fn (need);
+        if (!w->scratch)
+            return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+        w->scratch_size = need;
+    }
+
+    for (int c = 0; c < dec->channel_count; ++c)
+    {
+        exr_coding_channel_info_t*  chan = dec->channels + c;
+        const exr_region_channel_t* d    = state->dest[c];
+
+        if (!d)
+        {
+            chan->decode_to_ptr = NULL;
+            continue;
+        }
+
+        chan->user_data_type = d->data_type;
+        chan->user_bytes_per_element =
+            (d->data_type == EXR_PIXEL_HALF) ? 2 : 4;
+        if (full)
+        {
+            chan->decode_to_ptr =
+                d->decode_to_base +
+                ((int64_t) (x0 - state->region.min.x)) * d->pixel_stride +
+                ((int64_t) (y0 - state->region.min.y)) * d->line_stride;
+            chan->user_pixel_stride = d->pixel_stride;
+            chan->user_line_stride  = d->line_stride;
+        }
+        else
+        {
+            chan->decode_to_ptr     = w->scratch + off;
+            chan->user_pixel_stride = chan->user_bytes_per_element;
+            chan->user_line_stride =
+                cinfo.width * chan->user_bytes_per_element;
+            off += ((size_t) chan->user_line_stride) * ((size_t) cinfo.height);
+        }
+    }
+
+    rv = exr_decoding_choose_default_routines (
+        state->ctxt, state->part_index, dec);
+    if (rv == EXR_ERR_SUCCESS)
+        rv = exr_decoding_run (state->ctxt, state->part_index, dec);
+    if (rv != EXR_ERR_SUCCESS || full) return rv;
+
+    for (int c = 0; c < dec->channel_count; ++c)
+    {
+        const exr_coding_channel_info_t* chan = dec->channels + c;
+        const exr_region_channel_t*      d    = state->dest[c];
+        int32_t                          ube;
+
+        if (!d) continue;
+
+        ube = chan->user_bytes_per_element;
+        for (int32_t y = iy0; y <= iy1; ++y)
+        {
+            const uint8_t* src = chan->decode_to_ptr +
+                                 ((int64_t) (y - y0)) * chan->user_line_stride +
+                                 ((int64_t) (ix0 - x0)) * ube;
+            uint8_t* dst =
+                d->decode_to_base +
+                ((int64_t) (y - state->region.min.y)) * d->line_stride +
+                ((int64_t) (ix0 - state->region.min.x)) * d->pixel_stride;
+
+            if (d->pixel_stride == ube)
+                memcpy (dst, src, ((size_t) (ix1 - ix0 + 1)) * (size_t) ube);
+            else
+            {
+                for (int32_t x = ix0; x <= ix1; ++x)
+                {
+                    memcpy (dst, src, (size_t) ube);
+                    src += ube;
+                    dst += d->pixel_stride;
+                }
+            }
+        }
+    }
+    return rv;
+}
+
+static void
+run_region_worker (void* arg)
+{
+    struct _region_worker* w = (struct _region_worker*) arg;
+    int32_t                first, last;
+
+    while (w->rv == EXR_ERR_SUCCESS && claim_chunks (w->state, &first, &last))
+    {
+        for (int32_t i = first; i < last; ++i)
+        {
+            w->rv = decode_one_chunk (w, i);
+            if (w->rv != EXR_ERR_SUCCESS)
+            {
+                fail_region (w->state);
+                break;
+            }
+        }
+    }
+
+    if (w->initialized) exr_decoding_destroy (w->state->ctxt, &(w->decoder));
+    w->initialized = 0;
+    if (w->scratch) w->state->pctxt->free_fn (w->scratch);
+    w->scratch      = NULL;
+    w->scratch_size = 0;
+}
+
+/**************************************/
+
+static exr_result_t
+setup_region (
+    struct _region_state*               state,
+    const struct _internal_exr_context* pctxt,
+    const struct _internal_exr_part*    part,
+    int                                 level_x,
+    int                                 level_y,
+    const exr_attr_box2i_t*             region,
+    int                                 channel_count,
+    const exr_region_channel_t*         channels)
+{
+    const exr_attr_chlist_t* chlist = part->channels->chlist;
+    int32_t                  lw, lh, cw, ch;
+
+    if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_TILED)
+        return pctxt->report_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Deep data cannot be decoded to a region");
+
+    state->tiled = (part->storage_mode == EXR_STORAGE_TILED);
+    if (state->tiled)
+    {
+        if (level_x < 0 || level_x >= part->num_tile_levels_x ||
+            level_y < 0 || level_y >= part->num_tile_levels_y)
+            return pctxt->print_error (
+                pctxt,
+                EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+                "Invalid level (%d, %d) requested",
+                level_x,
+                level_y);
+        lw            = part->tile_level_tile_size_x[level_x];
+        lh            = part->tile_level_tile_size_y[level_y];
+        state->tile_w = (int32_t) part->tiles->tiledesc->x_size;
+        state->tile_h = (int32_t) part->tiles->tiledesc->y_size;
+    }
+    else
+    {
+        if (level_x != 0 || level_y != 0)
+            return pctxt->print_error (
+                pctxt,
+                EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+                "Invalid level (%d, %d) requested for scanline part",
+                level_x,
+                level_y);
+        lw            = part->data_window.max.x - part->data_window.min.x + 1;
+        lh            = part->data_window.max.y - part->data_window.min.y + 1;
+        state->tile_w = lw;
+        state->tile_h = part->lines_per_chunk;
+    }
+
+    state->origin_x = part->data_window.min.x;
+    state->origin_y = part->data_window.min.y;
+
+    if (region->min.x > region->max.x || region->min.y > region->max.y ||
+        region->min.x < state->origin_x || region->min.y < state->origin_y ||
+        ((int64_t) region->max.x) >= ((int64_t) state->origin_x) + lw ||
+        ((int64_t) region->max.y) >= ((int64_t) state->origin_y) + lh)
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+            "Region (%d, %d) - (%d, %d) is not within the data window",
+            region->min.x,
+            region->min.y,
+            region->max.x,
+            region->max.y);
+
+    for (int i = 0; i < channel_count; ++i)
+    {
+        const exr_region_channel_t* d     = channels + i;
+        int                         found = 0;
+
+        if (!d->decode_to_base) continue;
+
+        if (!d->channel_name || d->data_type > EXR_PIXEL_FLOAT)
+            return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+
+        for (int c = 0; c < chlist->num_channels; ++c)
+        {
+            const exr_attr_chlist_entry_t* e = chlist->entries + c;
+
+            if (strcmp (e->name.str, d->channel_name) != 0) continue;
+
+            if (e->x_sampling != 1 || e->y_sampling != 1)
+                return pctxt->print_error (
+                    pctxt,
+                    EXR_ERR_INVALID_ARGUMENT,
+                    "Subsampled channel '%s' cannot be decoded to a region",
+                    d->channel_name);
+
+            state->dest[c] = d;
+            found          = 1;
+        }
+
+        if (!found)
+            return pctxt->print_error (
+                pctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "No channel '%s' in part",
+                d->channel_name);
+    }
+
+    cw = state->tile_w;
+    ch = state->tile_h;
+
+    state->region   = *region;
+    state->first_cx = (region->min.x - state->origin_x) / cw;
+    state->first_cy = (region->min.y - state->origin_y) / ch;
+    state->count_x  = (region->max.x - state->origin_x) / cw + 1 -
+                     state->first_cx;
+    state->total =
+        state->count_x *
+        ((region->max.y - state->origin_y) / ch + 1 - state->first_cy);
+
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+exr_decode_region (
+    exr_const_context_t         ctxt,
+    int                         part_index,
+    int                         level_x,
+    int                         level_y,
+    const exr_attr_box2i_t*     region,
+    int                         channel_count,
+    const exr_region_channel_t* channels,
+    int                         num_threads,
+    exr_spawn_task_func_ptr_t   spawn_fn,
+    void*                       spawn_userdata)
+{
+    struct _region_state   state;
+    struct _region_worker* workers;
+    exr_result_t           rv;
+    int                    nworkers;
+    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (!region || channel_count < 0 || (channel_count > 0 && !channels))
+        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    memset (&state, 0, sizeof (state));
+    state.ctxt       = ctxt;
+    state.pctxt      = pctxt;
+    state.part_index = part_index;
+    state.level_x    = level_x;
+    state.level_y    = level_y;
+
+    state.dest = pctxt->alloc_fn (
+        sizeof (const exr_region_channel_t*) *
+        (size_t) part->channels->chlist->num_channels);
+    if (!state.dest)
+        return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+    memset (
+        state.dest,
+        0,
+        sizeof (const exr_region_channel_t*) *
+            (size_t) part->channels->chlist->num_channels);
+
+    rv = setup_region (
+        &state,
+        pctxt,
+        part,
+        level_x,
+        level_y,
+        region,
+        channel_count,
+        channels);
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        pctxt->free_fn (state.dest);
+        return rv;
+    }
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+    nworkers = num_threads > 0 ? num_threads : internal_exr_processor_count ();
+    if (nworkers > state.total) nworkers = state.total;
+#else
+    (void) num_threads;
+    nworkers = 1;
+#endif
+    if (nworkers < 1) nworkers = 1;
+
+    /* hand out a few chunks at a time, but enough batches that the
+     * workers finish at about the same time */
+    state.grain = state.total / (nworkers * 8);
+    if (state.grain < 1) state.grain = 1;
+
+    workers =
+        pctxt->alloc_fn (sizeof (struct _region_worker) * (size_t) nworkers);
+    if (!workers)
+    {
+        pctxt->free_fn (state.dest);
+        return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+    }
+    memset (workers, 0, sizeof (struct _region_worker) * (size_t) nworkers);
+    for (int i = 0; i < nworkers; ++i)
+        workers[i].state = &state;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    InitializeCriticalSection (&(state.mutex));
+#    else
+    if (pthread_mutex_init (&(state.mutex), NULL) != 0)
+    {
+        pctxt->free_fn (workers);
+        pctxt->free_fn (state.dest);
+        return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+    }
+#    endif
+#endif
+
+    /* workers which fail to start leave their chunks to the others */
+    internal_exr_run_workers (
+        pctxt,
+        workers,
+        sizeof (struct _region_worker),
+        nworkers,
+        &run_region_worker,
+        spawn_fn,
+        spawn_userdata);
+
+    rv = EXR_ERR_SUCCESS;
+    for (int i = 0; i < nworkers && rv == EXR_ERR_SUCCESS; ++i)
+        rv = workers[i].rv;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    DeleteCriticalSection (&(state.mutex));
+#    else
+    pthread_mutex_destroy (&(state.mutex));
+#    endif
+#endif
+
+    pctxt->free_fn (workers);
+    pctxt->free_fn (state.dest);
+    return rv;
+}
@@ -5,6 +5,7 @@
 
 #include "openexr_decode.h"
 
+#include "internal_async.h"
 #include "internal_coding.h"
 #include "internal_decompress.h"
 #include "internal_structs.h"
@@ -132,6 +133,77 @@ read_uncompressed_direct (exr_decode_pipeline_t* decode)
     return EXR_ERR_SUCCESS;
 }
 
+struct _internal_exr_prefetch
+{
+    internal_exr_event_t done;
+    int                  pending;
+    int                  part_index;
+    exr_chunk_info_t     chunk;
+    void*                buffer;
+    size_t               alloc_size;
+    int64_t              nread;
+};
+
+static void
+prefetch_complete (exr_const_context_t ctxt, void* request, int64_t nread)
+{
+    struct _internal_exr_prefetch* pf = request;
+
+    pf->nread = nread;
+    internal_exr_event_signal (&(pf->done));
+}
+
+static void
+wait_prefetch (struct _internal_exr_prefetch* pf)
+{
+    if (pf->pending)
+    {
+        internal_exr_event_wait (&(pf->done));
+        pf->pending = 0;
+    }
+}
+
+/* waits for any read started by exr_decoding_prefetch and, if it was
+ * for the current chunk, swaps its buffer in as the packed buffer */
+static int
+take_prefetched_chunk (
+    const struct _internal_exr_part* part, exr_decode_pipeline_t* decode)
+{
+    struct _internal_exr_prefetch* pf = decode->_prefetch;
+    void*                          prevbuf;
+    size_t                         prevsz;
+
+    if (!pf || !pf->pending) return 0;
+
+    wait_prefetch (pf);
+
+    if (pf->part_index != decode->part_index ||
+        pf->chunk.idx != decode->chunk.idx ||
+        pf->chunk.data_offset != decode->chunk.data_offset ||
+        pf->chunk.packed_size != decode->chunk.packed_size)
+        return 0;
+
+    if (pf->nread != (int64_t) pf->chunk.packed_size)
+    {
+        /* same short read allowance as exr_read_chunk, anything else
+         * is left to a regular read to report */
+        if (part->comp_type != EXR_COMPRESSION_NONE || pf->nread < 0)
+            return 0;
+        memset (
+            ((uint8_t*) pf->buffer) + pf->nread,
+            0,
+            pf->chunk.packed_size - (uint64_t) pf->nread);
+    }
+
+    prevbuf                   = decode->packed_buffer;
+    prevsz                    = decode->packed_alloc_size;
+    decode->packed_buffer     = pf->buffer;
+    decode->packed_alloc_size = pf->alloc_size;
+    pf->buffer                = prevbuf;
+    pf->alloc_size            = prevsz;
+    return 1;
+}
+
 static exr_result_t
 default_read_chunk (exr_decode_pipeline_t* decode)
 {
@@ -181,6 +253,32 @@ default_read_chunk (exr_decode_pipeline_t* decode)
                 decode->packed_sample_count_table);
         }
     }
+    else if (take_prefetched_chunk (part, decode))
+    {
+        rv = EXR_ERR_SUCCESS;
+    }
+    else if (
+        pctxt->mapped_data && decode->chunk.packed_size > 0 &&
+        decode->chunk.data_offset <= pctxt->mapped_size &&
+        decode->chunk.packed_size <=
+            pctxt->mapped_size - decode->chunk.data_offset &&
+        (part->comp_type == EXR_COMPRESSION_NONE ||
+         part->comp_type == EXR_COMPRESSION_RLE ||
+         part->comp_type == EXR_COMPRESSION_ZIPS ||
+         part->comp_type == EXR_COMPRESSION_ZIP))
+    {
+        /* these decompressors only ever read the packed data, so just
+         * point at the chunk in the file mapping instead of copying */
+        internal_decode_free_buffer (
+            decode,
+            EXR_TRANSCODE_BUFFER_PACKED,
+            &(decode->packed_buffer),
+            &(decode->packed_alloc_size));
+
+        decode->packed_buffer = EXR_CONST_CAST (
+            void*, pctxt->mapped_data + decode->chunk.data_offset);
+        rv = EXR_ERR_SUCCESS;
+    }
     else
     {
         rv = internal_decode_alloc_buffer (
@@ -263,6 +361,18 @@ decompress_data (
             rv = internal_exr_undo_dwab (
                 decode, packbufptr, packsz, unpackbufptr, unpacksz);
             break;
+        case EXR_COMPRESSION_PIZ4:
+            rv = internal_exr_undo_piz4 (
+                decode, packbufptr, packsz, unpackbufptr, unpacksz);
+            break;
+        case EXR_COMPRESSION_ZSTD:
+            rv = internal_exr_undo_zstd (
+                decode, packbufptr, packsz, unpackbufptr, unpacksz);
+            break;
+        case EXR_COMPRESSION_LZ4:
+            rv = internal_exr_undo_lz4 (
+                decode, packbufptr, packsz, unpackbufptr, unpacksz);
+            break;
         case EXR_COMPRESSION_LAST_TYPE:
         default:
             return pctxt->print_error (
@@ -685,6 +795,97 @@ exr_decoding_run (
 
 /**************************************/
 
+exr_result_t
+exr_decoding_prefetch (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    const exr_chunk_info_t* cinfo,
+    exr_decode_pipeline_t*  decode)
+{
+    exr_result_t                   rv;
+    struct _internal_exr_prefetch* pf;
+    EXR_PROMOTE_READ_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (!cinfo || !decode)
+        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    if (decode->context != ctxt || decode->part_index != part_index)
+        return pctxt->report_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid request for decoding prefetch from different context / part");
+
+    if (cinfo->type != (uint8_t) part->storage_mode ||
+        cinfo->compression != (uint8_t) part->comp_type)
+        return pctxt->report_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "mismatched chunk block info for decoding prefetch");
+
+    if (pctxt->file_size > 0 &&
+        cinfo->data_offset > (uint64_t) pctxt->file_size)
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "chunk block info data offset (%" PRIu64
+            ") past end of file (%" PRId64 ")",
+            cinfo->data_offset,
+            pctxt->file_size);
+
+    if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_TILED ||
+        cinfo->packed_size == 0 || pctxt->mapped_data)
+        return EXR_ERR_SUCCESS;
+
+    pf = decode->_prefetch;
+    if (!pf)
+    {
+        pf = pctxt->alloc_fn (sizeof (struct _internal_exr_prefetch));
+        if (!pf) return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+
+        memset (pf, 0, sizeof (struct _internal_exr_prefetch));
+        rv = internal_exr_event_init (&(pf->done));
+        if (rv != EXR_ERR_SUCCESS)
+        {
+            pctxt->free_fn (pf);
+            return pctxt->standard_error (pctxt, rv);
+        }
+        decode->_prefetch = pf;
+    }
+
+    /* only one chunk is read ahead at a time */
+    wait_prefetch (pf);
+
+    rv = internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_PACKED,
+        &(pf->buffer),
+        &(pf->alloc_size),
+        cinfo->packed_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    pf->part_index = part_index;
+    pf->chunk      = *cinfo;
+    pf->nread      = -1;
+    pf->pending    = 1;
+    internal_exr_event_reset (&(pf->done));
+
+    rv = pctxt->read_async_fn (
+        ctxt,
+        pctxt->user_data,
+        pf->buffer,
+        cinfo->packed_size,
+        cinfo->data_offset,
+        &prefetch_complete,
+        pf,
+        (exr_stream_error_func_ptr_t) pctxt->print_error);
+    if (rv != EXR_ERR_SUCCESS) pf->pending = 0;
+
+    return rv;
+}
+
+/**************************************/
+
 exr_result_t
 exr_decoding_destroy (exr_const_context_t ctxt, exr_decode_pipeline_t* decode)
 {
@@ -695,6 +896,20 @@ exr_decoding_destroy (exr_const_context_t ctxt, exr_decode_pipeline_t* decode)
         if (decode->channels != decode->_quick_chan_store)
             pctxt->free_fn (decode->channels);
 
+        if (decode->_prefetch)
+        {
+            struct _internal_exr_prefetch* pf = decode->_prefetch;
+
+            wait_prefetch (pf);
+            internal_decode_free_buffer (
+                decode,
+                EXR_TRANSCODE_BUFFER_PACKED,
+                &(pf->buffer),
+                &(pf->alloc_size));
+            internal_exr_event_destroy (&(pf->done));
+            pctxt->free_fn (pf);
+        }
+
         if (decode->unpacked_buffer == decode->packed_buffer &&
             decode->unpacked_alloc_size == 0)
             decode->unpacked_buffer = NULL;
@@ -729,6 +944,7 @@ exr_decoding_destroy (exr_const_context_t ctxt, exr_decode_pipeline_t* decode)
             EXR_TRANSCODE_BUFFER_SAMPLES,
             (void**) &(decode->sample_count_table),
             &(decode->sample_count_alloc_size));
+        internal_exr_zstd_free_dctx (decode->_zstd_dctx);
         *decode = nil;
     }
     return EXR_ERR_SUCCESS;
@@ -0,0 +1,650 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "openexr_encode.h"
+
+#include "internal_async.h"
+#include "internal_structs.h"
+
+#include <string.h>
+
+/**************************************/
+
+/* a compressed chunk waiting for the chunks before it to be written */
+struct _encode_pending
+{
+    exr_chunk_info_t cinfo;
+    void*            buffer;
+    uint64_t         bytes;
+    int              valid;
+};
+
+struct _encode_state
+{
+    exr_context_t                 ctxt;
+    struct _internal_exr_context* pctxt;
+    int                           part_index;
+    int                           level_x;
+    int                           level_y;
+    int                           tiled;
+    int                           ordered;
+
+    exr_attr_box2i_t region;
+    int32_t          origin_x;
+    int32_t          origin_y;
+    int32_t          tile_w;
+    int32_t          tile_h;
+
+    /* the chunks making up the region, row by row */
+    int32_t first_cx;
+    int32_t first_cy;
+    int32_t count_x;
+    int32_t total;
+
+    /* for each channel of the part, the source */
+    const exr_region_channel_t** src;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    CRITICAL_SECTION   mutex;
+    CONDITION_VARIABLE cond;
+#    else
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+#    endif
+#endif
+    int32_t next_claim;
+    int32_t next_write;
+    int     writing;
+    int     failed;
+
+    /* reorder buffer, holding chunk i in slot i % window */
+    struct _encode_pending* pending;
+    int32_t                 window;
+};
+
+struct _encode_worker
+{
+    struct _encode_state* state;
+    exr_encode_pipeline_t encoder;
+    int                   initialized;
+    exr_result_t          rv;
+};
+
+/**************************************/
+
+static void
+lock_state (struct _encode_state* state)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    EnterCriticalSection (&(state->mutex));
+#    else
+    pthread_mutex_lock (&(state->mutex));
+#    endif
+#else
+    (void) state;
+#endif
+}
+
+static void
+unlock_state (struct _encode_state* state)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    LeaveCriticalSection (&(state->mutex));
+#    else
+    pthread_mutex_unlock (&(state->mutex));
+#    endif
+#else
+    (void) state;
+#endif
+}
+
+/* must hold the lock */
+static void
+wait_state (struct _encode_state* state)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    SleepConditionVariableCS (&(state->cond), &(state->mutex), INFINITE);
+#    else
+    pthread_cond_wait (&(state->cond), &(state->mutex));
+#    endif
+#else
+    (void) state;
+#endif
+}
+
+/* must hold the lock */
+static void
+wake_state (struct _encode_state* state)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    WakeAllConditionVariable (&(state->cond));
+#    else
+    pthread_cond_broadcast (&(state->cond));
+#    endif
+#else
+    (void) state;
+#endif
+}
+
+/* Claims the next chunk to encode. For ordered parts, no more than
+ * window chunks may be ahead of the next one to be written, so that
+ * the reorder buffer does not grow without bound. */
+static int
+claim_chunk (struct _encode_state* state, int32_t* idx)
+{
+    int ok = 0;
+
+    lock_state (state);
+    while (!state->failed && state->next_claim < state->total)
+    {
+        if (!state->ordered ||
+            state->next_claim < state->next_write + state->window)
+        {
+            *idx = state->next_claim++;
+            ok   = 1;
+            break;
+        }
+        wait_state (state);
+    }
+    unlock_state (state);
+    return ok;
+}
+
+static void
+fail_encode (struct _encode_state* state)
+{
+    lock_state (state);
+    state->failed = 1;
+    wake_state (state);
+    unlock_state (state);
+}
+
+/**************************************/
+
+static exr_result_t
+write_one_chunk (
+    struct _encode_state*   state,
+    const exr_chunk_info_t* cinfo,
+    const void*             buffer,
+    uint64_t                bytes)
+{
+    if (state->tiled)
+        return exr_write_tile_chunk (
+            state->ctxt,
+            state->part_index,
+            cinfo->start_x,
+            cinfo->start_y,
+            cinfo->level_x,
+            cinfo->level_y,
+            buffer,
+            bytes);
+    return exr_write_scanline_chunk (
+        state->ctxt, state->part_index, cinfo->start_y, buffer, bytes);
+}
+
+static exr_result_t
+encode_one_chunk (struct _encode_worker* w, int32_t idx)
+{
+    struct _encode_state*  state = w->state;
+    exr_encode_pipeline_t* enc   = &(w->encoder);
+    exr_chunk_info_t       cinfo;
+    exr_result_t           rv;
+    int32_t                cx, cy, x0, y0;
+
+    cx = state->first_cx + idx % state->count_x;
+    cy = state->first_cy + idx / state->count_x;
+
+    if (state->tiled)
+        rv = exr_write_tile_chunk_info (
+            state->ctxt,
+            state->part_index,
+            cx,
+            cy,
+            state->level_x,
+            state->level_y,
+            &cinfo);
+    else
+        rv = exr_write_scanline_chunk_info (
+            state->ctxt,
+            state->part_index,
+            state->origin_y + cy * state->tile_h,
+            &cinfo);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (w->initialized)
+        rv = exr_encoding_update (state->ctxt, state->part_index, &cinfo, enc);
+    else
+    {
+        rv = exr_encoding_initialize (
+            state->ctxt, state->part_index, &cinfo, enc);
+        w->initialized = (rv == EXR_ERR_SUCCESS);
+    }
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (state->tiled)
+    {
+        x0 = state->origin_x + cinfo.start_x * state->tile_w;
+        y0 = state->origin_y + cinfo.start_y * state->tile_h;
+    }
+    else
+    {
+        x0 = cinfo.start_x;
+        y0 = cinfo.start_y;
+    }
+
+    /* the region is made of whole chunks, so read straight from it */
+    for (int c = 0; c < enc->channel_count; ++c)
+    {
+        exr_coding_channel_info_t*  chan = enc->channels + c;
+        const exr_region_channel_t* s    = state->src[c];
+
+        chan->user_data_type = s->data_type;
+        chan->user_bytes_per_element =
+            (s->data_type == EXR_PIXEL_HALF) ? 2 : 4;
+        chan->encode_from_ptr =
+            s->encode_from_base +
+            ((int64_t) (x0 - state->region.min.x)) * s->pixel_stride +
+            ((int64_t) (y0 - state->region.min.y)) * s->line_stride;
+        chan->user_pixel_stride = s->pixel_stride;
+        chan->user_line_stride  = s->line_stride;
+    }
+
+    rv = exr_encoding_choose_default_routines (
+        state->ctxt, state->part_index, enc);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    /* only pack and compress here, the writes are done below */
+    enc->yield_until_ready_fn = NULL;
+    enc->write_fn             = NULL;
+    rv = exr_encoding_run (state->ctxt, state->part_index, enc);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (!state->ordered)
+        return write_one_chunk (
+            state, &cinfo, enc->compressed_buffer, enc->compressed_bytes);
+
+    lock_state (state);
+    if (state->writing || idx != state->next_write)
+    {
+        /* not our turn, so leave the chunk for whoever writes the one
+         * before it, taking the buffer from the pipeline */
+        struct _encode_pending* p = state->pending + (idx % state->window);
+
+        p->cinfo  = cinfo;
+        p->buffer = enc->compressed_buffer;
+        p->bytes  = enc->compressed_bytes;
+        p->valid  = 1;
+        if (enc->compressed_buffer == enc->packed_buffer)
+        {
+            enc->packed_buffer     = NULL;
+            enc->packed_alloc_size = 0;
+        }
+        else
+            enc->compressed_alloc_size = 0;
+        enc->compressed_buffer = NULL;
+        enc->compressed_bytes  = 0;
+        unlock_state (state);
+        return EXR_ERR_SUCCESS;
+    }
+    state->writing = 1;
+    unlock_state (state);
+
+    rv = write_one_chunk (
+        state, &cinfo, enc->compressed_buffer, enc->compressed_bytes);
+
+    /* then any chunks after it which are already done */
+    lock_state (state);
+    while (rv == EXR_ERR_SUCCESS)
+    {
+        struct _encode_pending* p;
+
+        ++(state->next_write);
+        wake_state (state);
+
+        /* chunks are not claimed more than window ahead, so this
+         * slot can only be holding the next chunk */
+        p = state->pending + (state->next_write % state->window);
+        if (state->next_write >= state->total || !p->valid) break;
+
+        p->valid = 0;
+        unlock_state (state);
+        rv = write_one_chunk (state, &(p->cinfo), p->buffer, p->bytes);
+        state->pctxt->free_fn (p->buffer);
+        p->buffer = NULL;
+        lock_state (state);
+    }
+    state->writing = 0;
+    unlock_state (state);
+    return rv;
+}
+
+static void
+run_encode_worker (void* arg)
+{
+    struct _encode_worker* w = (struct _encode_worker*) arg;
+    int32_t                idx;
+
+    while (claim_chunk (w->state, &idx))
+    {
+        w->rv = encode_one_chunk (w, idx);
+        if (w->rv != EXR_ERR_SUCCESS)
+        {
+            fail_encode (w->state);
+            break;
+        }
+    }
+}
+
+/**************************************/
+
+static exr_result_t
+setup_region (
+    struct _encode_state*               state,
+    const struct _internal_exr_context* pctxt,
+    const struct _internal_exr_part*    part,
+    int                                 level_x,
+    int                                 level_y,
+    const exr_attr_box2i_t*             region,
+    int                                 channel_count,
+    const exr_region_channel_t*         channels)
+{
+    const exr_attr_chlist_t* chlist = part->channels->chlist;
+    int32_t                  lw, lh, cw, ch;
+
+    if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_TILED)
+        return pctxt->report_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Deep data cannot be encoded from a region");
+
+    state->tiled = (part->storage_mode == EXR_STORAGE_TILED);
+    if (state->tiled)
+    {
+        if (level_x < 0 || level_x >= part->num_tile_levels_x ||
+            level_y < 0 || level_y >= part->num_tile_levels_y)
+            return pctxt->print_error (
+                pctxt,
+                EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+                "Invalid level (%d, %d) requested",
+                level_x,
+                level_y);
+        lw            = part->tile_level_tile_size_x[level_x];
+        lh            = part->tile_level_tile_size_y[level_y];
+        state->tile_w = (int32_t) part->tiles->tiledesc->x_size;
+        state->tile_h = (int32_t) part->tiles->tiledesc->y_size;
+    }
+    else
+    {
+        if (level_x != 0 || level_y != 0)
+            return pctxt->print_error (
+                pctxt,
+                EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+                "Invalid level (%d, %d) requested for scanline part",
+                level_x,
+                level_y);
+        lw            = part->data_window.max.x - part->data_window.min.x + 1;
+        lh            = part->data_window.max.y - part->data_window.min.y + 1;
+        state->tile_w = lw;
+        state->tile_h = part->lines_per_chunk;
+    }
+
+    state->origin_x = part->data_window.min.x;
+    state->origin_y = part->data_window.min.y;
+    state->ordered  = (part->lineorder != EXR_LINEORDER_RANDOM_Y);
+
+    if (region->min.x > region->max.x || region->min.y > region->max.y ||
+        region->min.x < state->origin_x || region->min.y < state->origin_y ||
+        ((int64_t) region->max.x) >= ((int64_t) state->origin_x) + lw ||
+        ((int64_t) region->max.y) >= ((int64_t) state->origin_y) + lh)
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+            "Region (%d, %d) - (%d, %d) is not within the data window",
+            region->min.x,
+            region->min.y,
+            region->max.x,
+            region->max.y);
+
+    cw = state->tile_w;
+    ch = state->tile_h;
+
+    /* only whole chunks can be written */
+    if ((region->min.x - state->origin_x) % cw != 0 ||
+        (region->min.y - state->origin_y) % ch != 0 ||
+        ((region->max.x - state->origin_x + 1) % cw != 0 &&
+         ((int64_t) region->max.x) + 1 != ((int64_t) state->origin_x) + lw) ||
+        ((region->max.y - state->origin_y + 1) % ch != 0 &&
+         ((int64_t) region->max.y) + 1 != ((int64_t) state->origin_y) + lh))
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Region (%d, %d) - (%d, %d) does not fall on chunk boundaries",
+            region->min.x,
+            region->min.y,
+            region->max.x,
+            region->max.y);
+
+    for (int i = 0; i < channel_count; ++i)
+    {
+        const exr_region_channel_t* s     = channels + i;
+        int                         found = 0;
+
+        if (!s->channel_name || !s->encode_from_base ||
+            s->data_type > EXR_PIXEL_FLOAT)
+            return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+
+        for (int c = 0; c < chlist->num_channels; ++c)
+        {
+            const exr_attr_chlist_entry_t* e = chlist->entries + c;
+
+            if (strcmp (e->name.str, s->channel_name) != 0) continue;
+
+            if (e->x_sampling != 1 || e->y_sampling != 1)
+                return pctxt->print_error (
+                    pctxt,
+                    EXR_ERR_INVALID_ARGUMENT,
+                    "Subsampled channel '%s' cannot be encoded from a region",
+                    s->channel_name);
+
+            state->src[c] = s;
+            found         = 1;
+        }
+
+        if (!found)
+            return pctxt->print_error (
+                pctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "No channel '%s' in part",
+                s->channel_name);
+    }
+
+    for (int c = 0; c < chlist->num_channels; ++c)
+    {
+        if (!state->src[c])
+            return pctxt->print_error (
+                pctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Missing channel data for '%s' - must encode all channels",
+                chlist->entries[c].name.str);
+    }
+
+    state->region   = *region;
+    state->first_cx = (region->min.x - state->origin_x) / cw;
+    state->first_cy = (region->min.y - state->origin_y) / ch;
+    state->count_x  = (region->max.x - state->origin_x) / cw + 1 -
+                     state->first_cx;
+    state->total =
+        state->count_x *
+        ((region->max.y - state->origin_y) / ch + 1 - state->first_cy);
+
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+exr_encode_region (
+    exr_context_t               ctxt,
+    int                         part_index,
+    int                         level_x,
+    int                         level_y,
+    const exr_attr_box2i_t*     region,
+    int                         channel_count,
+    const exr_region_channel_t* channels,
+    int                         num_threads,
+    exr_spawn_task_func_ptr_t   spawn_fn,
+    void*                       spawn_userdata)
+{
+    struct _encode_state             state;
+    struct _encode_worker*           workers;
+    const struct _internal_exr_part* part;
+    exr_result_t                     rv;
+    int                              nworkers;
+    size_t                           nch;
+    INTERN_EXR_PROMOTE_CONTEXT_OR_ERROR (ctxt);
+
+    /* the workers take the context lock to write, so it must not be
+     * held (as it is until the header is written) */
+    if (pctxt->mode != EXR_CONTEXT_WRITING_DATA)
+    {
+        if (pctxt->mode == EXR_CONTEXT_WRITE)
+            return pctxt->standard_error (pctxt, EXR_ERR_HEADER_NOT_WRITTEN);
+        return pctxt->standard_error (pctxt, EXR_ERR_NOT_OPEN_WRITE);
+    }
+
+    if (part_index < 0 || part_index >= pctxt->num_parts)
+        return pctxt->print_error (
+            pctxt,
+            EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+            "Part index (%d) out of range",
+            part_index);
+    part = pctxt->parts[part_index];
+
+    if (!region || channel_count < 0 || (channel_count > 0 && !channels))
+        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    memset (&state, 0, sizeof (state));
+    state.ctxt       = ctxt;
+    state.pctxt      = pctxt;
+    state.part_index = part_index;
+    state.level_x    = level_x;
+    state.level_y    = level_y;
+
+    nch       = (size_t) part->channels->chlist->num_channels;
+    state.src = pctxt->alloc_fn (sizeof (const exr_region_channel_t*) * nch);
+    if (!state.src)
+        return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+    memset (state.src, 0, sizeof (const exr_region_channel_t*) * nch);
+
+    rv = setup_region (
+        &state,
+        pctxt,
+        part,
+        level_x,
+        level_y,
+        region,
+        channel_count,
+        channels);
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        pctxt->free_fn (state.src);
+        return rv;
+    }
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+    nworkers = num_threads > 0 ? num_threads : internal_exr_processor_count ();
+    if (nworkers > state.total) nworkers = state.total;
+#else
+    (void) num_threads;
+    nworkers = 1;
+#endif
+    if (nworkers < 1) nworkers = 1;
+
+    /* enough room that a slow chunk does not hold up the others */
+    state.window  = nworkers * 2;
+    state.pending = pctxt->alloc_fn (
+        sizeof (struct _encode_pending) * (size_t) state.window);
+    workers =
+        pctxt->alloc_fn (sizeof (struct _encode_worker) * (size_t) nworkers);
+    if (!state.pending || !workers)
+    {
+        if (workers) pctxt->free_fn (workers);
+        if (state.pending) pctxt->free_fn (state.pending);
+        pctxt->free_fn (state.src);
+        return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
+    }
+    memset (
+        state.pending,
+        0,
+        sizeof (struct _encode_pending) * (size_t) state.window);
+    memset (workers, 0, sizeof (struct _encode_worker) * (size_t) nworkers);
+    for (int i = 0; i < nworkers; ++i)
+        workers[i].state = &state;
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    InitializeCriticalSection (&(state.mutex));
+    InitializeConditionVariable (&(state.cond));
+#    else
+    if (pthread_mutex_init (&(state.mutex), NULL) != 0)
+        rv = EXR_ERR_OUT_OF_MEMORY;
+    else if (pthread_cond_init (&(state.cond), NULL) != 0)
+    {
+        pthread_mutex_destroy (&(state.mutex));
+        rv = EXR_ERR_OUT_OF_MEMORY;
+    }
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        pctxt->free_fn (workers);
+        pctxt->free_fn (state.pending);
+        pctxt->free_fn (state.src);
+        return pctxt->standard_error (pctxt, rv);
+    }
+#    endif
+#endif
+
+    /* workers which fail to start leave their chunks to the others */
+    internal_exr_run_workers (
+        pctxt,
+        workers,
+        sizeof (struct _encode_worker),
+        nworkers,
+        &run_encode_worker,
+        spawn_fn,
+        spawn_userdata);
+
+    /* writing the last chunk finishes the part (and maybe the file),
+     * so clean up once the workers are all done with the context */
+    for (int i = 0; i < nworkers; ++i)
+    {
+        if (rv == EXR_ERR_SUCCESS) rv = workers[i].rv;
+        if (workers[i].initialized)
+            exr_encoding_destroy (ctxt, &(workers[i].encoder));
+    }
+
+    /* after a failure, chunks may be left behind unwritten */
+    for (int32_t i = 0; i < state.window; ++i)
+    {
+        if (state.pending[i].valid) pctxt->free_fn (state.pending[i].buffer);
+    }
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    DeleteCriticalSection (&(state.mutex));
+#    else
+    pthread_cond_destroy (&(state.cond));
+    pthread_mutex_destroy (&(state.mutex));
+#    endif
+#endif
+
+    pctxt->free_fn (workers);
+    pctxt->free_fn (state.pending);
+    pctxt->free_fn (state.src);
+    return rv;
+}
@@ -54,6 +54,9 @@ default_compress_chunk (exr_encode_pipeline_t* encode)
         case EXR_COMPRESSION_B44A: rv = internal_exr_apply_b44a (encode); break;
         case EXR_COMPRESSION_DWAA: rv = internal_exr_apply_dwaa (encode); break;
         case EXR_COMPRESSION_DWAB: rv = internal_exr_apply_dwab (encode); break;
+        case EXR_COMPRESSION_PIZ4: rv = internal_exr_apply_piz4 (encode); break;
+        case EXR_COMPRESSION_ZSTD: rv = internal_exr_apply_zstd (encode); break;
+        case EXR_COMPRESSION_LZ4: rv = internal_exr_apply_lz4 (encode); break;
         case EXR_COMPRESSION_LAST_TYPE:
         default:
             return pctxt->print_error (
@@ -463,6 +466,7 @@ exr_encoding_destroy (exr_const_context_t ctxt, exr_encode_pipeline_t* encode)
             EXR_TRANSCODE_BUFFER_PACKED_SAMPLES,
             &(encode->packed_sample_count_table),
             &(encode->packed_sample_count_alloc_size));
+        internal_exr_zstd_free_cctx (encode->_zstd_cctx);
         *encode = nil;
     }
     return EXR_UNLOCK_WRITE_AND_RETURN_PCTXT (EXR_ERR_SUCCESS);
@@ -42,7 +42,7 @@ exr_attr_float_vector_init (
     *fv = nil;
     if (bytes > 0)
     {
-        fv->arr = (float*) pctxt->alloc_fn (bytes);
+        fv->arr = (float*) internal_exr_header_alloc (pctxt, bytes);
         if (fv->arr == NULL)
             return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
         fv->length     = nent;
@@ -126,7 +126,7 @@ exr_attr_float_vector_destroy (exr_context_t ctxt, exr_attr_float_vector_t* fv)
     {
         exr_attr_float_vector_t nil = {0};
         if (fv->arr && fv->alloc_size > 0)
-            pctxt->free_fn (EXR_CONST_CAST (void*, fv->arr));
+            internal_exr_header_free (pctxt, EXR_CONST_CAST (void*, fv->arr));
         *fv = nil;
     }
     return EXR_ERR_SUCCESS;
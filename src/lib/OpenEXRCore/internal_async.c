@@ -0,0 +1,774 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_async.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#    include <windows.h>
+#else
+#    include <unistd.h>
+#endif
+
+/**************************************/
+
+exr_result_t
+internal_exr_event_init (internal_exr_event_t* ev)
+{
+    ev->signaled = 0;
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    InitializeCriticalSection (&(ev->mutex));
+    InitializeConditionVariable (&(ev->cond));
+#    else
+    if (pthread_mutex_init (&(ev->mutex), NULL) != 0)
+        return EXR_ERR_OUT_OF_MEMORY;
+    if (pthread_cond_init (&(ev->cond), NULL) != 0)
+    {
+        pthread_mutex_destroy (&(ev->mutex));
+        return EXR_ERR_OUT_OF_MEMORY;
+    }
+#    endif
+#endif
+    return EXR_ERR_SUCCESS;
+}
+
+void
+internal_exr_event_destroy (internal_exr_event_t* ev)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    DeleteCriticalSection (&(ev->mutex));
+#    else
+    pthread_cond_destroy (&(ev->cond));
+    pthread_mutex_destroy (&(ev->mutex));
+#    endif
+#endif
+    ev->signaled = 0;
+}
+
+void
+internal_exr_event_reset (internal_exr_event_t* ev)
+{
+    /* only ever called when no one can be signalling */
+    ev->signaled = 0;
+}
+
+void
+internal_exr_event_signal (internal_exr_event_t* ev)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    EnterCriticalSection (&(ev->mutex));
+    ev->signaled = 1;
+    WakeAllConditionVariable (&(ev->cond));
+    LeaveCriticalSection (&(ev->mutex));
+#    else
+    pthread_mutex_lock (&(ev->mutex));
+    ev->signaled = 1;
+    pthread_cond_broadcast (&(ev->cond));
+    pthread_mutex_unlock (&(ev->mutex));
+#    endif
+#else
+    ev->signaled = 1;
+#endif
+}
+
+void
+internal_exr_event_wait (internal_exr_event_t* ev)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    EnterCriticalSection (&(ev->mutex));
+    while (!ev->signaled)
+        SleepConditionVariableCS (&(ev->cond), &(ev->mutex), INFINITE);
+    LeaveCriticalSection (&(ev->mutex));
+#    else
+    pthread_mutex_lock (&(ev->mutex));
+    while (!ev->signaled)
+        pthread_cond_wait (&(ev->cond), &(ev->mutex));
+    pthread_mutex_unlock (&(ev->mutex));
+#    endif
+#endif
+}
+
+/**************************************/
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+
+#    ifdef _WIN32
+static DWORD WINAPI
+run_thread (LPVOID arg)
+{
+    internal_exr_thread_t* t = (internal_exr_thread_t*) arg;
+    t->fn (t->data);
+    return 0;
+}
+#    else
+static void*
+run_thread (void* arg)
+{
+    internal_exr_thread_t* t = (internal_exr_thread_t*) arg;
+    t->fn (t->data);
+    return NULL;
+}
+#    endif
+
+exr_result_t
+internal_exr_start_thread (
+    internal_exr_thread_t* t, void (*fn) (void*), void* data)
+{
+    t->fn   = fn;
+    t->data = data;
+#    ifdef _WIN32
+    t->handle = CreateThread (NULL, 0, &run_thread, t, 0, NULL);
+    if (!t->handle) return EXR_ERR_OUT_OF_MEMORY;
+#    else
+    if (pthread_create (&(t->handle), NULL, &run_thread, t) != 0)
+        return EXR_ERR_OUT_OF_MEMORY;
+#    endif
+    return EXR_ERR_SUCCESS;
+}
+
+void
+internal_exr_join_thread (internal_exr_thread_t* t)
+{
+#    ifdef _WIN32
+    WaitForSingleObject (t->handle, INFINITE);
+    CloseHandle (t->handle);
+#    else
+    pthread_join (t->handle, NULL);
+#    endif
+}
+
+#endif /* ILMTHREAD_THREADING_ENABLED */
+
+int
+internal_exr_processor_count (void)
+{
+    long n = 1;
+#if defined(_WIN32)
+    SYSTEM_INFO si;
+    GetNativeSystemInfo (&si);
+    n = (long) si.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    n = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) n = 1;
+    if (n > 1024) n = 1024;
+    return (int) n;
+}
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+
+/* Shared by internal_exr_run_workers and the workers it starts. A
+ * worker handed to spawn_fn may only get to run once the call has
+ * returned (a saturated or nested application thread pool may queue
+ * it behind the task making the call), so this lives on the heap,
+ * released by whoever is last done with it, and workers which start
+ * once the calling thread has run out of work do nothing. */
+struct _internal_exr_worker_run
+{
+#    ifdef _WIN32
+    CRITICAL_SECTION mutex;
+#    else
+    pthread_mutex_t mutex;
+#    endif
+    internal_exr_event_t idle;
+
+    void (*fn) (void*);
+    uint8_t* items;
+    size_t   item_size;
+    void (*free_fn) (void*);
+
+    int refs;   /* the caller and each worker started */
+    int active; /* workers in fn */
+    int closed; /* set once the caller is done with its own item */
+};
+
+struct _internal_exr_worker
+{
+    struct _internal_exr_worker_run* run;
+    size_t                           index;
+    internal_exr_thread_t            thread;
+};
+
+static void
+lock_run (struct _internal_exr_worker_run* run)
+{
+#    ifdef _WIN32
+    EnterCriticalSection (&(run->mutex));
+#    else
+    pthread_mutex_lock (&(run->mutex));
+#    endif
+}
+
+static void
+unlock_run (struct _internal_exr_worker_run* run)
+{
+#    ifdef _WIN32
+    LeaveCriticalSection (&(run->mutex));
+#    else
+    pthread_mutex_unlock (&(run->mutex));
+#    endif
+}
+
+static void
+release_run (struct _internal_exr_worker_run* run)
+{
+    int last;
+
+    lock_run (run);
+    last = (--(run->refs) == 0);
+    unlock_run (run);
+
+    if (last)
+    {
+        internal_exr_event_destroy (&(run->idle));
+#    ifdef _WIN32
+        DeleteCriticalSection (&(run->mutex));
+#    else
+        pthread_mutex_destroy (&(run->mutex));
+#    endif
+        run->free_fn (run);
+    }
+}
+
+static void
+run_worker (void* arg)
+{
+    struct _internal_exr_worker*     w   = (struct _internal_exr_worker*) arg;
+    struct _internal_exr_worker_run* run = w->run;
+    int                              join, idle = 0;
+
+    lock_run (run);
+    join = !run->closed;
+    if (join) ++(run->active);
+    unlock_run (run);
+
+    if (join)
+    {
+        run->fn (run->items + run->item_size * w->index);
+
+        lock_run (run);
+        idle = (--(run->active) == 0 && run->closed);
+        unlock_run (run);
+    }
+
+    /* the caller holds on to run until it sees this */
+    if (idle) internal_exr_event_signal (&(run->idle));
+
+    release_run (run);
+}
+
+#endif /* ILMTHREAD_THREADING_ENABLED */
+
+void
+internal_exr_run_workers (
+    const struct _internal_exr_context* pctxt,
+    void*                               items,
+    size_t                              item_size,
+    int                                 count,
+    void (*fn) (void*),
+    exr_spawn_task_func_ptr_t spawn_fn,
+    void*                     spawn_userdata)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+    struct _internal_exr_worker_run* run     = NULL;
+    struct _internal_exr_worker*     workers = NULL;
+    int                              others  = count - 1;
+    int                              started = 0;
+    int                              busy;
+
+    if (others > 0)
+    {
+        run = pctxt->alloc_fn (
+            sizeof (struct _internal_exr_worker_run) +
+            sizeof (struct _internal_exr_worker) * (size_t) others);
+    }
+    if (!run)
+    {
+        fn (items);
+        return;
+    }
+
+    memset (run, 0, sizeof (struct _internal_exr_worker_run));
+    if (internal_exr_event_init (&(run->idle)) != EXR_ERR_SUCCESS)
+    {
+        pctxt->free_fn (run);
+        fn (items);
+        return;
+    }
+#    ifdef _WIN32
+    InitializeCriticalSection (&(run->mutex));
+#    else
+    if (pthread_mutex_init (&(run->mutex), NULL) != 0)
+    {
+        internal_exr_event_destroy (&(run->idle));
+        pctxt->free_fn (run);
+        fn (items);
+        return;
+    }
+#    endif
+    run->fn        = fn;
+    run->items     = (uint8_t*) items;
+    run->item_size = item_size;
+    run->free_fn   = pctxt->free_fn;
+    run->refs      = 1;
+
+    workers = (struct _internal_exr_worker*) (run + 1);
+    for (; started < others; ++started)
+    {
+        struct _internal_exr_worker* w = workers + started;
+        exr_result_t                 rv;
+
+        w->run   = run;
+        w->index = (size_t) (started + 1);
+
+        lock_run (run);
+        ++(run->refs);
+        unlock_run (run);
+
+        if (spawn_fn)
+            rv = spawn_fn (spawn_userdata, &run_worker, w);
+        else
+            rv = internal_exr_start_thread (&(w->thread), &run_worker, w);
+
+        if (rv != EXR_ERR_SUCCESS)
+        {
+            lock_run (run);
+            --(run->refs);
+            unlock_run (run);
+            break;
+        }
+    }
+
+    fn (items);
+
+    /* all of the work has been claimed by now, so only wait for the
+     * workers still busy with theirs */
+    lock_run (run);
+    run->closed = 1;
+    busy        = (run->active > 0);
+    unlock_run (run);
+
+    if (busy) internal_exr_event_wait (&(run->idle));
+
+    if (!spawn_fn)
+    {
+        for (int i = 0; i < started; ++i)
+            internal_exr_join_thread (&(workers[i].thread));
+    }
+
+    release_run (run);
+#else
+    (void) pctxt;
+    (void) item_size;
+    (void) count;
+    (void) spawn_fn;
+    (void) spawn_userdata;
+    fn (items);
+#endif
+}
+
+/**************************************/
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+
+struct _internal_exr_task_state
+{
+#    ifdef _WIN32
+    CRITICAL_SECTION mutex;
+#    else
+    pthread_mutex_t mutex;
+#    endif
+    int next;
+    int count;
+    void (*fn) (void*, int);
+    void* data;
+};
+
+static int
+claim_task (struct _internal_exr_task_state* state)
+{
+    int idx = -1;
+
+#    ifdef _WIN32
+    EnterCriticalSection (&(state->mutex));
+#    else
+    pthread_mutex_lock (&(state->mutex));
+#    endif
+    if (state->next < state->count) idx = state->next++;
+#    ifdef _WIN32
+    LeaveCriticalSection (&(state->mutex));
+#    else
+    pthread_mutex_unlock (&(state->mutex));
+#    endif
+    return idx;
+}
+
+static void
+run_task_worker (void* arg)
+{
+    struct _internal_exr_task_state* state =
+        *((struct _internal_exr_task_state**) arg);
+    int idx;
+
+    while ((idx = claim_task (state)) >= 0)
+        state->fn (state->data, idx);
+}
+
+#endif /* ILMTHREAD_THREADING_ENABLED */
+
+void
+internal_exr_run_tasks (
+    const struct _internal_exr_context* pctxt,
+    int                                 count,
+    void (*fn) (void*, int),
+    void*                     data,
+    exr_spawn_task_func_ptr_t spawn_fn,
+    void*                     spawn_userdata)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+    struct _internal_exr_task_state   state;
+    struct _internal_exr_task_state** workers = NULL;
+    int                               nworkers;
+
+    nworkers = internal_exr_processor_count ();
+    if (nworkers > count) nworkers = count;
+
+    if (spawn_fn && nworkers > 1)
+    {
+        workers = pctxt->alloc_fn (
+            sizeof (struct _internal_exr_task_state*) * (size_t) nworkers);
+    }
+
+    if (workers)
+    {
+        state.next  = 0;
+        state.count = count;
+        state.fn    = fn;
+        state.data  = data;
+#    ifdef _WIN32
+        InitializeCriticalSection (&(state.mutex));
+#    else
+        if (pthread_mutex_init (&(state.mutex), NULL) != 0)
+        {
+            pctxt->free_fn (workers);
+            workers = NULL;
+        }
+#    endif
+    }
+
+    if (workers)
+    {
+        for (int i = 0; i < nworkers; ++i)
+            workers[i] = &state;
+
+        /* workers which fail to start, or only start once the calling
+         * thread has claimed every task, leave them to the others,
+         * and are not waited for, so state can live on the stack */
+        internal_exr_run_workers (
+            pctxt,
+            workers,
+            sizeof (struct _internal_exr_task_state*),
+            nworkers,
+            &run_task_worker,
+            spawn_fn,
+            spawn_userdata);
+
+#    ifdef _WIN32
+        DeleteCriticalSection (&(state.mutex));
+#    else
+        pthread_mutex_destroy (&(state.mutex));
+#    endif
+        pctxt->free_fn (workers);
+        return;
+    }
+#else
+    (void) pctxt;
+    (void) spawn_fn;
+    (void) spawn_userdata;
+#endif
+    for (int i = 0; i < count; ++i)
+        fn (data, i);
+}
+
+/**************************************/
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+
+struct _internal_exr_read_request
+{
+    struct _internal_exr_read_request* next;
+
+    void*                        userdata;
+    void*                        buffer;
+    uint64_t                     sz;
+    uint64_t                     offset;
+    exr_read_complete_func_ptr_t complete_fn;
+    void*                        request;
+    exr_stream_error_func_ptr_t  error_cb;
+};
+
+struct _internal_exr_async_reader
+{
+    const struct _internal_exr_context* ctxt;
+
+#    ifdef _WIN32
+    CRITICAL_SECTION   mutex;
+    CONDITION_VARIABLE cond;
+    HANDLE             thread;
+#    else
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    pthread_t       thread;
+#    endif
+
+    struct _internal_exr_read_request* head;
+    struct _internal_exr_read_request* tail;
+    int                                stop;
+};
+
+static void
+reader_lock (struct _internal_exr_async_reader* reader)
+{
+#    ifdef _WIN32
+    EnterCriticalSection (&(reader->mutex));
+#    else
+    pthread_mutex_lock (&(reader->mutex));
+#    endif
+}
+
+static void
+reader_unlock (struct _internal_exr_async_reader* reader)
+{
+#    ifdef _WIN32
+    LeaveCriticalSection (&(reader->mutex));
+#    else
+    pthread_mutex_unlock (&(reader->mutex));
+#    endif
+}
+
+static void
+run_async_reader (struct _internal_exr_async_reader* reader)
+{
+    const struct _internal_exr_context* pctxt = reader->ctxt;
+
+    for (;;)
+    {
+        struct _internal_exr_read_request* req;
+        int64_t                            nread;
+
+        reader_lock (reader);
+        while (!reader->head && !reader->stop)
+        {
+#    ifdef _WIN32
+            SleepConditionVariableCS (
+                &(reader->cond), &(reader->mutex), INFINITE);
+#    else
+            pthread_cond_wait (&(reader->cond), &(reader->mutex));
+#    endif
+        }
+        req = reader->head;
+        if (req)
+        {
+            reader->head = req->next;
+            if (!reader->head) reader->tail = NULL;
+        }
+        reader_unlock (reader);
+
+        /* queued reads are still finished when stopping */
+        if (!req) break;
+
+        nread = pctxt->read_fn (
+            (exr_const_context_t) pctxt,
+            req->userdata,
+            req->buffer,
+            req->sz,
+            req->offset,
+            req->error_cb);
+        req->complete_fn ((exr_const_context_t) pctxt, req->request, nread);
+
+        pctxt->free_fn (req);
+    }
+}
+
+#    ifdef _WIN32
+static DWORD WINAPI
+async_reader_thread (LPVOID arg)
+{
+    run_async_reader ((struct _internal_exr_async_reader*) arg);
+    return 0;
+}
+#    else
+static void*
+async_reader_thread (void* arg)
+{
+    run_async_reader ((struct _internal_exr_async_reader*) arg);
+    return NULL;
+}
+#    endif
+
+static struct _internal_exr_async_reader*
+create_async_reader (const struct _internal_exr_context* pctxt)
+{
+    struct _internal_exr_async_reader* reader;
+#    ifndef _WIN32
+    int rv;
+#    endif
+
+    reader = pctxt->alloc_fn (sizeof (struct _internal_exr_async_reader));
+    if (!reader) return NULL;
+
+    memset (reader, 0, sizeof (struct _internal_exr_async_reader));
+    reader->ctxt = pctxt;
+
+#    ifdef _WIN32
+    InitializeCriticalSection (&(reader->mutex));
+    InitializeConditionVariable (&(reader->cond));
+    reader->thread =
+        CreateThread (NULL, 0, &async_reader_thread, reader, 0, NULL);
+    if (!reader->thread)
+    {
+        DeleteCriticalSection (&(reader->mutex));
+        pctxt->free_fn (reader);
+        return NULL;
+    }
+#    else
+    if (pthread_mutex_init (&(reader->mutex), NULL) != 0)
+    {
+        pctxt->free_fn (reader);
+        return NULL;
+    }
+    if (pthread_cond_init (&(reader->cond), NULL) != 0)
+    {
+        pthread_mutex_destroy (&(reader->mutex));
+        pctxt->free_fn (reader);
+        return NULL;
+    }
+    rv = pthread_create (&(reader->thread), NULL, &async_reader_thread, reader);
+    if (rv != 0)
+    {
+        pthread_cond_destroy (&(reader->cond));
+        pthread_mutex_destroy (&(reader->mutex));
+        pctxt->free_fn (reader);
+        return NULL;
+    }
+#    endif
+
+    return reader;
+}
+
+#endif /* ILMTHREAD_THREADING_ENABLED */
+
+/**************************************/
+
+exr_result_t
+internal_exr_queue_read (
+    exr_const_context_t          ctxt,
+    void*                        userdata,
+    void*                        buffer,
+    uint64_t                     sz,
+    uint64_t                     offset,
+    exr_read_complete_func_ptr_t complete_fn,
+    void*                        request,
+    exr_stream_error_func_ptr_t  error_cb)
+{
+    const struct _internal_exr_context* pctxt = EXR_CCTXT (ctxt);
+#ifdef ILMTHREAD_THREADING_ENABLED
+    struct _internal_exr_async_reader* reader;
+    struct _internal_exr_read_request* req;
+#endif
+
+    if (!pctxt) return EXR_ERR_MISSING_CONTEXT_ARG;
+    if (!complete_fn)
+        return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+    if (!pctxt->read_fn)
+        return pctxt->standard_error (pctxt, EXR_ERR_NOT_OPEN_READ);
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+    internal_exr_lock (pctxt);
+    if (!pctxt->async_reader)
+    {
+        EXR_CONST_CAST (struct _internal_exr_context*, pctxt)->async_reader =
+            create_async_reader (pctxt);
+    }
+    reader = pctxt->async_reader;
+    internal_exr_unlock (pctxt);
+
+    req = reader ? pctxt->alloc_fn (sizeof (struct _internal_exr_read_request))
+                 : NULL;
+    if (req)
+    {
+        req->next        = NULL;
+        req->userdata    = userdata;
+        req->buffer      = buffer;
+        req->sz          = sz;
+        req->offset      = offset;
+        req->complete_fn = complete_fn;
+        req->request     = request;
+        req->error_cb    = error_cb;
+
+        reader_lock (reader);
+        if (reader->tail)
+            reader->tail->next = req;
+        else
+            reader->head = req;
+        reader->tail = req;
+#    ifdef _WIN32
+        WakeConditionVariable (&(reader->cond));
+#    else
+        pthread_cond_signal (&(reader->cond));
+#    endif
+        reader_unlock (reader);
+        return EXR_ERR_SUCCESS;
+    }
+#endif
+
+    /* no worker to hand this to, so just read it now */
+    complete_fn (
+        ctxt,
+        request,
+        pctxt->read_fn (ctxt, userdata, buffer, sz, offset, error_cb));
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+void
+internal_exr_destroy_async_reader (struct _internal_exr_context* ctxt)
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+    struct _internal_exr_async_reader* reader = ctxt->async_reader;
+
+    if (!reader) return;
+
+    reader_lock (reader);
+    reader->stop = 1;
+#    ifdef _WIN32
+    WakeAllConditionVariable (&(reader->cond));
+#    else
+    pthread_cond_broadcast (&(reader->cond));
+#    endif
+    reader_unlock (reader);
+
+#    ifdef _WIN32
+    WaitForSingleObject (reader->thread, INFINITE);
+    CloseHandle (reader->thread);
+    DeleteCriticalSection (&(reader->mutex));
+#    else
+    pthread_join (reader->thread, NULL);
+    pthread_cond_destroy (&(reader->cond));
+    pthread_mutex_destroy (&(reader->mutex));
+#    endif
+
+    ctxt->free_fn (reader);
+    ctxt->async_reader = NULL;
+#else
+    (void) ctxt;
+#endif
+}
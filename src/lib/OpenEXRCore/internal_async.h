@@ -0,0 +1,105 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_PRIVATE_ASYNC_H
+#define OPENEXR_PRIVATE_ASYNC_H
+
+#include "internal_structs.h"
+#include "openexr_coding.h"
+
+/* A one-shot signal used to wait for an asynchronous read to
+ * complete. Without threading support, reads always complete before
+ * they are submitted, so only the flag is needed. */
+typedef struct _internal_exr_event
+{
+#ifdef ILMTHREAD_THREADING_ENABLED
+#    ifdef _WIN32
+    CRITICAL_SECTION   mutex;
+    CONDITION_VARIABLE cond;
+#    else
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+#    endif
+#endif
+    int signaled;
+} internal_exr_event_t;
+
+exr_result_t internal_exr_event_init (internal_exr_event_t* ev);
+void         internal_exr_event_destroy (internal_exr_event_t* ev);
+void         internal_exr_event_reset (internal_exr_event_t* ev);
+void         internal_exr_event_signal (internal_exr_event_t* ev);
+void         internal_exr_event_wait (internal_exr_event_t* ev);
+
+#ifdef ILMTHREAD_THREADING_ENABLED
+/* A thread running fn (data), started by internal_exr_start_thread()
+ * and waited for by internal_exr_join_thread(). */
+typedef struct _internal_exr_thread
+{
+#    ifdef _WIN32
+    HANDLE handle;
+#    else
+    pthread_t handle;
+#    endif
+    void (*fn) (void*);
+    void* data;
+} internal_exr_thread_t;
+
+exr_result_t internal_exr_start_thread (
+    internal_exr_thread_t* t, void (*fn) (void*), void* data);
+void internal_exr_join_thread (internal_exr_thread_t* t);
+#endif
+
+/* Number of processors available, at least 1 */
+int internal_exr_processor_count (void);
+
+/* Calls fn on each of the count items of item_size bytes at items,
+ * the first on the calling thread and the others through spawn_fn,
+ * or on threads started for the call if that is NULL. fn should
+ * claim its work from state shared by all of them, and only return
+ * once there is none left to claim: items which cannot be started,
+ * or whose worker only starts after fn has returned on the calling
+ * thread, are skipped. Returns once the items which did run are
+ * done, without waiting for workers which have not started yet.
+ * Without threading support, only the first item is run. */
+void internal_exr_run_workers (
+    const struct _internal_exr_context* pctxt,
+    void*                               items,
+    size_t                              item_size,
+    int                                 count,
+    void (*fn) (void*),
+    exr_spawn_task_func_ptr_t spawn_fn,
+    void*                     spawn_userdata);
+
+/* Calls fn (data, i) for each i from 0 to count - 1, in any order,
+ * spread over the calling thread and workers started through
+ * spawn_fn (at most one per processor). Runs them all on the calling
+ * thread if spawn_fn is NULL, or without threading support. Returns
+ * once all of them are done, as internal_exr_run_workers does, so
+ * data may live on the caller's stack. */
+void internal_exr_run_tasks (
+    const struct _internal_exr_context* pctxt,
+    int                                 count,
+    void (*fn) (void*, int),
+    void*                     data,
+    exr_spawn_task_func_ptr_t spawn_fn,
+    void*                     spawn_userdata);
+
+/* Serves an asynchronous read by calling the context's (blocking)
+ * read_fn on a worker thread, which is started on first use. This is
+ * the default read_async_fn for contexts with a custom read_fn. */
+exr_result_t internal_exr_queue_read (
+    exr_const_context_t          ctxt,
+    void*                        userdata,
+    void*                        buffer,
+    uint64_t                     sz,
+    uint64_t                     offset,
+    exr_read_complete_func_ptr_t complete_fn,
+    void*                        request,
+    exr_stream_error_func_ptr_t  error_cb);
+
+/* Stops the worker thread, after finishing any queued reads */
+void internal_exr_destroy_async_reader (struct _internal_exr_context* ctxt);
+
+#endif /* OPENEXR_PRIVATE_ASYNC_H */
@@ -0,0 +1,936 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_CORE_BYTE_SIMD_H
+#define OPENEXR_CORE_BYTE_SIMD_H
+
+/*
+ * Byte loops of the lossless codecs: the even / odd byte split and
+ * delta predictor shared by RLE, ZIP and DWA, the run scanning of the
+ * RLE encoder and the 4 byte shuffle of LZ4.  Each comes in a scalar
+ * version and SIMD versions that produce the same bytes.
+ *
+ * SSE2 and NEON are part of the x86_64 and aarch64 baselines and used
+ * unconditionally there.  The SSE4.1 and AVX2 versions are compiled
+ * with target attributes and chosen at run time by the caller, using
+ * check_for_x86_byte_simd.
+ *
+ * This is a header so the performance tests can time the versions
+ * against each other without going through the library.
+ */
+
+#include "internal_cpuid.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define EXR_BYTE_SIMD_SSE2 1
+#    include <emmintrin.h>
+#    if defined(__GNUC__) || defined(__clang__)
+#        define EXR_BYTE_SIMD_X86_DISPATCH 1
+#        define EXR_TARGET_SSE4_1 __attribute__ ((target ("sse4.1")))
+#        define EXR_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#        include <immintrin.h>
+#    elif defined(_MSC_VER)
+#        define EXR_BYTE_SIMD_X86_DISPATCH 1
+#        define EXR_TARGET_SSE4_1
+#        define EXR_TARGET_AVX2
+#        include <immintrin.h>
+#    endif
+#elif defined(__aarch64__)
+#    define EXR_BYTE_SIMD_NEON 1
+#    include <arm_neon.h>
+#endif
+
+/**************************************/
+
+static inline uint32_t
+exr_byte_simd_ctz (uint32_t v)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward (&idx, v);
+    return (uint32_t) idx;
+#elif defined(__GNUC__) || defined(__clang__)
+    return (uint32_t) __builtin_ctz (v);
+#else
+    uint32_t n = 0;
+    while (!(v & 1))
+    {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**************************************/
+
+/*
+ * Split even and odd bytes: the even ones go to the first
+ * (count + 1) / 2 bytes of scratch, the odd ones after them.
+ */
+
+static inline void
+exr_deinterleave_scalar (
+    uint8_t* scratch, const uint8_t* source, uint64_t count)
+{
+    uint8_t*       t1   = scratch;
+    uint8_t*       t2   = t1 + (count + 1) / 2;
+    const uint8_t* stop = source + count;
+
+    while (source < stop)
+    {
+        *(t1++) = *(source++);
+        if (source < stop) *(t2++) = *(source++);
+    }
+}
+
+/*
+ * Replace each byte but the first by its difference to the previous
+ * one, biased by 128.
+ */
+
+static inline void
+exr_predict_scalar (uint8_t* buf, uint64_t count)
+{
+    uint8_t* t    = buf + 1;
+    uint8_t* stop = buf + count;
+    int      p;
+
+    if (count < 2) return;
+
+    p = (int) buf[0];
+    while (t < stop)
+    {
+        int d = (int) (t[0]) - p + (128 + 256);
+        p     = (int) t[0];
+        t[0]  = (uint8_t) d;
+        ++t;
+    }
+}
+
+/* inverse of exr_predict_scalar */
+static inline void
+exr_reconstruct_scalar (uint8_t* buf, uint64_t count)
+{
+    uint8_t* t    = buf + 1;
+    uint8_t* stop = buf + count;
+
+    while (t < stop)
+    {
+        int d = (int) (t[-1]) + (int) (t[0]) - 128;
+        t[0]  = (uint8_t) d;
+        ++t;
+    }
+}
+
+/* inverse of exr_deinterleave_scalar */
+static inline void
+exr_interleave_scalar (uint8_t* out, const uint8_t* source, uint64_t count)
+{
+    const uint8_t* t1   = source;
+    const uint8_t* t2   = source + (count + 1) / 2;
+    uint8_t* const stop = out + count;
+
+    while (out < stop)
+    {
+        *(out++) = *(t1++);
+        if (out < stop) *(out++) = *(t2++);
+    }
+}
+
+/*
+ * Length of the run of byte c at p, at most n.
+ */
+
+static inline uint64_t
+exr_rle_run_scalar (const uint8_t* p, uint64_t n, uint8_t c)
+{
+    uint64_t i = 0;
+    while (i < n && p[i] == c)
+        ++i;
+    return i;
+}
+
+/*
+ * Index of the first of three equal bytes at p, or n if there are
+ * none starting before n.  avail is the number of readable bytes at p,
+ * at least n.
+ */
+
+static inline uint64_t
+exr_rle_literal_scalar (const uint8_t* p, uint64_t n, uint64_t avail)
+{
+    for (uint64_t i = 0; i < n; ++i)
+        if (i + 2 < avail && p[i] == p[i + 1] && p[i + 1] == p[i + 2])
+            return i;
+    return n;
+}
+
+/*
+ * Split count 4 byte values into 4 planes of count bytes, byte k of
+ * each value going to plane k.
+ */
+
+static inline void
+exr_shuffle4_scalar (uint8_t* out, const uint8_t* in, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        out[i]             = in[4 * i];
+        out[count + i]     = in[4 * i + 1];
+        out[2 * count + i] = in[4 * i + 2];
+        out[3 * count + i] = in[4 * i + 3];
+    }
+}
+
+/* inverse of exr_shuffle4_scalar */
+static inline void
+exr_unshuffle4_scalar (uint8_t* out, const uint8_t* in, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        out[4 * i]     = in[i];
+        out[4 * i + 1] = in[count + i];
+        out[4 * i + 2] = in[2 * count + i];
+        out[4 * i + 3] = in[3 * count + i];
+    }
+}
+
+/**************************************/
+
+#ifdef EXR_BYTE_SIMD_SSE2
+
+static inline void
+exr_deinterleave_sse2 (uint8_t* scratch, const uint8_t* source, uint64_t count)
+{
+    const uint64_t vCount = count / (2 * sizeof (__m128i));
+    const __m128i  mask   = _mm_set1_epi16 (0x00ff);
+    uint8_t*       t1     = scratch;
+    uint8_t*       t2     = t1 + (count + 1) / 2;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        __m128i a = _mm_loadu_si128 ((const __m128i*) source);
+        __m128i b = _mm_loadu_si128 ((const __m128i*) (source + 16));
+
+        _mm_storeu_si128 (
+            (__m128i*) t1,
+            _mm_packus_epi16 (
+                _mm_and_si128 (a, mask), _mm_and_si128 (b, mask)));
+        _mm_storeu_si128 (
+            (__m128i*) t2,
+            _mm_packus_epi16 (_mm_srli_epi16 (a, 8), _mm_srli_epi16 (b, 8)));
+
+        source += 2 * sizeof (__m128i);
+        t1 += sizeof (__m128i);
+        t2 += sizeof (__m128i);
+    }
+
+    for (uint64_t i = vCount * 2 * sizeof (__m128i); i < count; ++i)
+    {
+        if (i % 2 == 0)
+            *(t1++) = *(source++);
+        else
+            *(t2++) = *(source++);
+    }
+}
+
+/*
+ * The predictor works backwards, so every step still sees the
+ * unmodified byte before it.
+ */
+
+static inline void
+exr_predict_sse2 (uint8_t* buf, uint64_t count)
+{
+    const __m128i c = _mm_set1_epi8 (-128);
+    uint64_t      i = count;
+
+    while (i > sizeof (__m128i))
+    {
+        __m128i cur, prev;
+
+        i -= sizeof (__m128i);
+        cur  = _mm_loadu_si128 ((const __m128i*) (buf + i));
+        prev = _mm_loadu_si128 ((const __m128i*) (buf + i - 1));
+        _mm_storeu_si128 (
+            (__m128i*) (buf + i), _mm_add_epi8 (_mm_sub_epi8 (cur, prev), c));
+    }
+
+    while (i > 1)
+    {
+        --i;
+        buf[i] = (uint8_t) (buf[i] - buf[i - 1] + 128);
+    }
+}
+
+static inline void
+exr_interleave_sse2 (uint8_t* out, const uint8_t* source, uint64_t count)
+{
+    const uint64_t vCount = count / (2 * sizeof (__m128i));
+    const uint8_t* t1     = source;
+    const uint8_t* t2     = source + (count + 1) / 2;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        __m128i a = _mm_loadu_si128 ((const __m128i*) t1);
+        __m128i b = _mm_loadu_si128 ((const __m128i*) t2);
+
+        _mm_storeu_si128 ((__m128i*) out, _mm_unpacklo_epi8 (a, b));
+        _mm_storeu_si128 ((__m128i*) (out + 16), _mm_unpackhi_epi8 (a, b));
+
+        t1 += sizeof (__m128i);
+        t2 += sizeof (__m128i);
+        out += 2 * sizeof (__m128i);
+    }
+
+    for (uint64_t i = vCount * 2 * sizeof (__m128i); i < count; ++i)
+        *(out++) = (i % 2 == 0) ? *(t1++) : *(t2++);
+}
+
+static inline uint64_t
+exr_rle_run_sse2 (const uint8_t* p, uint64_t n, uint8_t c)
+{
+    const __m128i vc = _mm_set1_epi8 ((char) c);
+    uint64_t      i  = 0;
+
+    for (; i + sizeof (__m128i) <= n; i += sizeof (__m128i))
+    {
+        __m128i  v = _mm_loadu_si128 ((const __m128i*) (p + i));
+        uint32_t m = (uint32_t) _mm_movemask_epi8 (_mm_cmpeq_epi8 (v, vc));
+
+        if (m != 0xffff) return i + exr_byte_simd_ctz (~m);
+    }
+    return i + exr_rle_run_scalar (p + i, n - i, c);
+}
+
+static inline uint64_t
+exr_rle_literal_sse2 (const uint8_t* p, uint64_t n, uint64_t avail)
+{
+    uint64_t i = 0;
+
+    for (; i < n && i + sizeof (__m128i) + 2 <= avail; i += sizeof (__m128i))
+    {
+        __m128i  a = _mm_loadu_si128 ((const __m128i*) (p + i));
+        __m128i  b = _mm_loadu_si128 ((const __m128i*) (p + i + 1));
+        __m128i  c = _mm_loadu_si128 ((const __m128i*) (p + i + 2));
+        uint32_t m = (uint32_t) _mm_movemask_epi8 (
+            _mm_and_si128 (_mm_cmpeq_epi8 (a, b), _mm_cmpeq_epi8 (b, c)));
+
+        if (m != 0)
+        {
+            i += exr_byte_simd_ctz (m);
+            return i < n ? i : n;
+        }
+    }
+    if (i >= n) return n;
+    return i + exr_rle_literal_scalar (p + i, n - i, avail - i);
+}
+
+/*
+ * Two rounds of the even / odd split over 16 values move byte k of
+ * every value to plane k.
+ */
+
+static inline void
+exr_shuffle4_sse2 (uint8_t* out, const uint8_t* in, uint64_t count)
+{
+    const __m128i mask = _mm_set1_epi16 (0x00ff);
+    uint64_t      i    = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a  = _mm_loadu_si128 ((const __m128i*) (in + 4 * i));
+        __m128i b  = _mm_loadu_si128 ((const __m128i*) (in + 4 * i + 16));
+        __m128i c  = _mm_loadu_si128 ((const __m128i*) (in + 4 * i + 32));
+        __m128i d  = _mm_loadu_si128 ((const __m128i*) (in + 4 * i + 48));
+        __m128i e0 = _mm_packus_epi16 (
+            _mm_and_si128 (a, mask), _mm_and_si128 (b, mask));
+        __m128i e1 = _mm_packus_epi16 (
+            _mm_and_si128 (c, mask), _mm_and_si128 (d, mask));
+        __m128i o0 =
+            _mm_packus_epi16 (_mm_srli_epi16 (a, 8), _mm_srli_epi16 (b, 8));
+        __m128i o1 =
+            _mm_packus_epi16 (_mm_srli_epi16 (c, 8), _mm_srli_epi16 (d, 8));
+
+        _mm_storeu_si128 (
+            (__m128i*) (out + i),
+            _mm_packus_epi16 (
+                _mm_and_si128 (e0, mask), _mm_and_si128 (e1, mask)));
+        _mm_storeu_si128 (
+            (__m128i*) (out + count + i),
+            _mm_packus_epi16 (
+                _mm_and_si128 (o0, mask), _mm_and_si128 (o1, mask)));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 2 * count + i),
+            _mm_packus_epi16 (_mm_srli_epi16 (e0, 8), _mm_srli_epi16 (e1, 8)));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 3 * count + i),
+            _mm_packus_epi16 (_mm_srli_epi16 (o0, 8), _mm_srli_epi16 (o1, 8)));
+    }
+
+    for (; i < count; ++i)
+    {
+        out[i]             = in[4 * i];
+        out[count + i]     = in[4 * i + 1];
+        out[2 * count + i] = in[4 * i + 2];
+        out[3 * count + i] = in[4 * i + 3];
+    }
+}
+
+static inline void
+exr_unshuffle4_sse2 (uint8_t* out, const uint8_t* in, uint64_t count)
+{
+    uint64_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i p0 = _mm_loadu_si128 ((const __m128i*) (in + i));
+        __m128i p1 = _mm_loadu_si128 ((const __m128i*) (in + count + i));
+        __m128i p2 = _mm_loadu_si128 ((const __m128i*) (in + 2 * count + i));
+        __m128i p3 = _mm_loadu_si128 ((const __m128i*) (in + 3 * count + i));
+        __m128i e0 = _mm_unpacklo_epi8 (p0, p2);
+        __m128i e1 = _mm_unpackhi_epi8 (p0, p2);
+        __m128i o0 = _mm_unpacklo_epi8 (p1, p3);
+        __m128i o1 = _mm_unpackhi_epi8 (p1, p3);
+
+        _mm_storeu_si128 ((__m128i*) (out + 4 * i), _mm_unpacklo_epi8 (e0, o0));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 4 * i + 16), _mm_unpackhi_epi8 (e0, o0));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 4 * i + 32), _mm_unpacklo_epi8 (e1, o1));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 4 * i + 48), _mm_unpackhi_epi8 (e1, o1));
+    }
+
+    for (; i < count; ++i)
+    {
+        out[4 * i]     = in[i];
+        out[4 * i + 1] = in[count + i];
+        out[4 * i + 2] = in[2 * count + i];
+        out[4 * i + 3] = in[3 * count + i];
+    }
+}
+
+#endif /* EXR_BYTE_SIMD_SSE2 */
+
+/**************************************/
+
+#ifdef EXR_BYTE_SIMD_X86_DISPATCH
+
+/*
+ * The first byte is not biased by the predictor.  To keep the loop
+ * uniform, it is biased here and the loop removes the bias again.
+ */
+
+EXR_TARGET_SSE4_1 static inline void
+exr_reconstruct_sse4_1 (uint8_t* buf, uint64_t count)
+{
+    const uint64_t vCount      = count / sizeof (__m128i);
+    const __m128i  c           = _mm_set1_epi8 (-128);
+    const __m128i  shuffleMask = _mm_set1_epi8 (15);
+    __m128i        vPrev       = _mm_setzero_si128 ();
+    uint8_t        prev;
+
+    if (vCount == 0)
+    {
+        exr_reconstruct_scalar (buf, count);
+        return;
+    }
+
+    buf[0] += -128;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        __m128i* vBuf = (__m128i*) (buf + i * sizeof (__m128i));
+        __m128i  d    = _mm_add_epi8 (_mm_loadu_si128 (vBuf), c);
+
+        /* prefix sum of the 16 bytes */
+        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 1));
+        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 2));
+        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 4));
+        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 8));
+        d = _mm_add_epi8 (d, vPrev);
+
+        _mm_storeu_si128 (vBuf, d);
+
+        /* broadcast the last byte for the next block */
+        vPrev = _mm_shuffle_epi8 (d, shuffleMask);
+    }
+
+    prev = (uint8_t) _mm_extract_epi8 (vPrev, 15);
+    for (uint64_t i = vCount * sizeof (__m128i); i < count; ++i)
+    {
+        uint8_t d = (uint8_t) (prev + buf[i] - 128);
+        buf[i]    = d;
+        prev      = d;
+    }
+}
+
+EXR_TARGET_AVX2 static inline void
+exr_deinterleave_avx2 (uint8_t* scratch, const uint8_t* source, uint64_t count)
+{
+    const uint64_t vCount = count / (2 * sizeof (__m256i));
+    const __m256i  mask   = _mm256_set1_epi16 (0x00ff);
+    uint8_t*       t1     = scratch;
+    uint8_t*       t2     = t1 + (count + 1) / 2;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        __m256i a = _mm256_loadu_si256 ((const __m256i*) source);
+        __m256i b = _mm256_loadu_si256 ((const __m256i*) (source + 32));
+        __m256i even, odd;
+
+        /* the packs work per 128-bit lane, put the quadwords back in order */
+        even = _mm256_packus_epi16 (
+            _mm256_and_si256 (a, mask), _mm256_and_si256 (b, mask));
+        odd = _mm256_packus_epi16 (
+            _mm256_srli_epi16 (a, 8), _mm256_srli_epi16 (b, 8));
+
+        _mm256_storeu_si256 (
+            (__m256i*) t1, _mm256_permute4x64_epi64 (even, 0xd8));
+        _mm256_storeu_si256 (
+            (__m256i*) t2, _mm256_permute4x64_epi64 (odd, 0xd8));
+
+        source += 2 * sizeof (__m256i);
+        t1 += sizeof (__m256i);
+        t2 += sizeof (__m256i);
+    }
+
+    for (uint64_t i = vCount * 2 * sizeof (__m256i); i < count; ++i)
+    {
+        if (i % 2 == 0)
+            *(t1++) = *(source++);
+        else
+            *(t2++) = *(source++);
+    }
+}
+
+EXR_TARGET_AVX2 static inline void
+exr_predict_avx2 (uint8_t* buf, uint64_t count)
+{
+    const __m256i c = _mm256_set1_epi8 (-128);
+    uint64_t      i = count;
+
+    while (i > sizeof (__m256i))
+    {
+        __m256i cur, prev;
+
+        i -= sizeof (__m256i);
+        cur  = _mm256_loadu_si256 ((const __m256i*) (buf + i));
+        prev = _mm256_loadu_si256 ((const __m256i*) (buf + i - 1));
+        _mm256_storeu_si256 (
+            (__m256i*) (buf + i),
+            _mm256_add_epi8 (_mm256_sub_epi8 (cur, prev), c));
+    }
+
+    while (i > 1)
+    {
+        --i;
+        buf[i] = (uint8_t) (buf[i] - buf[i - 1] + 128);
+    }
+}
+
+EXR_TARGET_AVX2 static inline void
+exr_interleave_avx2 (uint8_t* out, const uint8_t* source, uint64_t count)
+{
+    const uint64_t vCount = count / (2 * sizeof (__m256i));
+    const uint8_t* t1     = source;
+    const uint8_t* t2     = source + (count + 1) / 2;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        __m256i a  = _mm256_loadu_si256 ((const __m256i*) t1);
+        __m256i b  = _mm256_loadu_si256 ((const __m256i*) t2);
+        __m256i lo = _mm256_unpacklo_epi8 (a, b);
+        __m256i hi = _mm256_unpackhi_epi8 (a, b);
+
+        /* the unpacks work per 128-bit lane */
+        _mm256_storeu_si256 (
+            (__m256i*) out, _mm256_permute2x128_si256 (lo, hi, 0x20));
+        _mm256_storeu_si256 (
+            (__m256i*) (out + 32), _mm256_permute2x128_si256 (lo, hi, 0x31));
+
+        t1 += sizeof (__m256i);
+        t2 += sizeof (__m256i);
+        out += 2 * sizeof (__m256i);
+    }
+
+    for (uint64_t i = vCount * 2 * sizeof (__m256i); i < count; ++i)
+        *(out++) = (i % 2 == 0) ? *(t1++) : *(t2++);
+}
+
+EXR_TARGET_AVX2 static inline uint64_t
+exr_rle_run_avx2 (const uint8_t* p, uint64_t n, uint8_t c)
+{
+    const __m256i vc = _mm256_set1_epi8 ((char) c);
+    uint64_t      i  = 0;
+
+    for (; i + sizeof (__m256i) <= n; i += sizeof (__m256i))
+    {
+        __m256i  v = _mm256_loadu_si256 ((const __m256i*) (p + i));
+        uint32_t m =
+            (uint32_t) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (v, vc));
+
+        if (m != 0xffffffff) return i + exr_byte_simd_ctz (~m);
+    }
+    return i + exr_rle_run_sse2 (p + i, n - i, c);
+}
+
+EXR_TARGET_AVX2 static inline uint64_t
+exr_rle_literal_avx2 (const uint8_t* p, uint64_t n, uint64_t avail)
+{
+    uint64_t i = 0;
+
+    for (; i < n && i + sizeof (__m256i) + 2 <= avail; i += sizeof (__m256i))
+    {
+        __m256i  a = _mm256_loadu_si256 ((const __m256i*) (p + i));
+        __m256i  b = _mm256_loadu_si256 ((const __m256i*) (p + i + 1));
+        __m256i  c = _mm256_loadu_si256 ((const __m256i*) (p + i + 2));
+        uint32_t m = (uint32_t) _mm256_movemask_epi8 (_mm256_and_si256 (
+            _mm256_cmpeq_epi8 (a, b), _mm256_cmpeq_epi8 (b, c)));
+
+        if (m != 0)
+        {
+            i += exr_byte_simd_ctz (m);
+            return i < n ? i : n;
+        }
+    }
+    if (i >= n) return n;
+    return i + exr_rle_literal_sse2 (p + i, n - i, avail - i);
+}
+
+#endif /* EXR_BYTE_SIMD_X86_DISPATCH */
+
+/**************************************/
+
+#ifdef EXR_BYTE_SIMD_NEON
+
+static inline void
+exr_deinterleave_neon (uint8_t* scratch, const uint8_t* source, uint64_t count)
+{
+    const uint64_t vCount = count / (2 * sizeof (uint8x16_t));
+    uint8_t*       t1     = scratch;
+    uint8_t*       t2     = t1 + (count + 1) / 2;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        uint8x16x2_t v = vld2q_u8 (source);
+
+        vst1q_u8 (t1, v.val[0]);
+        vst1q_u8 (t2, v.val[1]);
+
+        source += 2 * sizeof (uint8x16_t);
+        t1 += sizeof (uint8x16_t);
+        t2 += sizeof (uint8x16_t);
+    }
+
+    for (uint64_t i = vCount * 2 * sizeof (uint8x16_t); i < count; ++i)
+    {
+        if (i % 2 == 0)
+            *(t1++) = *(source++);
+        else
+            *(t2++) = *(source++);
+    }
+}
+
+static inline void
+exr_predict_neon (uint8_t* buf, uint64_t count)
+{
+    const uint8x16_t c = vdupq_n_u8 (128);
+    uint64_t         i = count;
+
+    while (i > sizeof (uint8x16_t))
+    {
+        uint8x16_t cur, prev;
+
+        i -= sizeof (uint8x16_t);
+        cur  = vld1q_u8 (buf + i);
+        prev = vld1q_u8 (buf + i - 1);
+        vst1q_u8 (buf + i, vaddq_u8 (vsubq_u8 (cur, prev), c));
+    }
+
+    while (i > 1)
+    {
+        --i;
+        buf[i] = (uint8_t) (buf[i] - buf[i - 1] + 128);
+    }
+}
+
+static inline void
+exr_reconstruct_neon (uint8_t* buf, uint64_t count)
+{
+    const uint64_t   vCount      = count / sizeof (uint8x16_t);
+    const uint8x16_t c           = vdupq_n_u8 (128);
+    const uint8x16_t shuffleMask = vdupq_n_u8 (15);
+    const uint8x16_t zero        = vdupq_n_u8 (0);
+    uint8x16_t       vPrev       = vdupq_n_u8 (0);
+    uint8_t          prev;
+
+    if (vCount == 0)
+    {
+        exr_reconstruct_scalar (buf, count);
+        return;
+    }
+
+    /* see exr_reconstruct_sse4_1 */
+    buf[0] += 128;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        uint8_t*   vBuf = buf + i * sizeof (uint8x16_t);
+        uint8x16_t d    = vaddq_u8 (vld1q_u8 (vBuf), c);
+
+        d = vaddq_u8 (d, vextq_u8 (zero, d, 16 - 1));
+        d = vaddq_u8 (d, vextq_u8 (zero, d, 16 - 2));
+        d = vaddq_u8 (d, vextq_u8 (zero, d, 16 - 4));
+        d = vaddq_u8 (d, vextq_u8 (zero, d, 16 - 8));
+        d = vaddq_u8 (d, vPrev);
+
+        vst1q_u8 (vBuf, d);
+
+        vPrev = vqtbl1q_u8 (d, shuffleMask);
+    }
+
+    prev = vgetq_lane_u8 (vPrev, 15);
+    for (uint64_t i = vCount * sizeof (uint8x16_t); i < count; ++i)
+    {
+        uint8_t d = (uint8_t) (prev + buf[i] - 128);
+        buf[i]    = d;
+        prev      = d;
+    }
+}
+
+static inline void
+exr_interleave_neon (uint8_t* out, const uint8_t* source, uint64_t count)
+{
+    const uint64_t vCount = count / (2 * sizeof (uint8x16_t));
+    const uint8_t* t1     = source;
+    const uint8_t* t2     = source + (count + 1) / 2;
+
+    for (uint64_t i = 0; i < vCount; ++i)
+    {
+        uint8x16x2_t v;
+
+        v.val[0] = vld1q_u8 (t1);
+        v.val[1] = vld1q_u8 (t2);
+        vst2q_u8 (out, v);
+
+        t1 += sizeof (uint8x16_t);
+        t2 += sizeof (uint8x16_t);
+        out += 2 * sizeof (uint8x16_t);
+    }
+
+    for (uint64_t i = vCount * 2 * sizeof (uint8x16_t); i < count; ++i)
+        *(out++) = (i % 2 == 0) ? *(t1++) : *(t2++);
+}
+
+/* first set lane of a comparison result, 16 if none */
+static inline uint64_t
+exr_neon_first_set (uint8x16_t m)
+{
+    /* narrow each byte to a nibble so the mask fits in 64 bits */
+    uint64_t bits = vget_lane_u64 (
+        vreinterpret_u64_u8 (vshrn_n_u16 (vreinterpretq_u16_u8 (m), 4)), 0);
+
+    if (bits == 0) return 16;
+#    if defined(__GNUC__) || defined(__clang__)
+    return (uint64_t) __builtin_ctzll (bits) / 4;
+#    else
+    {
+        uint64_t n = 0;
+        while (!(bits & 0xf))
+        {
+            bits >>= 4;
+            ++n;
+        }
+        return n;
+    }
+#    endif
+}
+
+static inline uint64_t
+exr_rle_run_neon (const uint8_t* p, uint64_t n, uint8_t c)
+{
+    const uint8x16_t vc = vdupq_n_u8 (c);
+    uint64_t         i  = 0;
+
+    for (; i + sizeof (uint8x16_t) <= n; i += sizeof (uint8x16_t))
+    {
+        uint64_t first =
+            exr_neon_first_set (vmvnq_u8 (vceqq_u8 (vld1q_u8 (p + i), vc)));
+
+        if (first < 16) return i + first;
+    }
+    return i + exr_rle_run_scalar (p + i, n - i, c);
+}
+
+static inline uint64_t
+exr_rle_literal_neon (const uint8_t* p, uint64_t n, uint64_t avail)
+{
+    uint64_t i = 0;
+
+    for (; i < n && i + sizeof (uint8x16_t) + 2 <= avail;
+         i += sizeof (uint8x16_t))
+    {
+        uint8x16_t a     = vld1q_u8 (p + i);
+        uint8x16_t b     = vld1q_u8 (p + i + 1);
+        uint8x16_t c     = vld1q_u8 (p + i + 2);
+        uint64_t   first = exr_neon_first_set (
+            vandq_u8 (vceqq_u8 (a, b), vceqq_u8 (b, c)));
+
+        if (first < 16)
+        {
+            i += first;
+            return i < n ? i : n;
+        }
+    }
+    if (i >= n) return n;
+    return i + exr_rle_literal_scalar (p + i, n - i, avail - i);
+}
+
+static inline void
+exr_shuffle4_neon (uint8_t* out, const uint8_t* in, uint64_t count)
+{
+    uint64_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t v = vld4q_u8 (in + 4 * i);
+
+        vst1q_u8 (out + i, v.val[0]);
+        vst1q_u8 (out + count + i, v.val[1]);
+        vst1q_u8 (out + 2 * count + i, v.val[2]);
+        vst1q_u8 (out + 3 * count + i, v.val[3]);
+    }
+
+    for (; i < count; ++i)
+    {
+        out[i]             = in[4 * i];
+        out[count + i]     = in[4 * i + 1];
+        out[2 * count + i] = in[4 * i + 2];
+        out[3 * count + i] = in[4 * i + 3];
+    }
+}
+
+static inline void
+exr_unshuffle4_neon (uint8_t* out, const uint8_t* in, uint64_t count)
+{
+    uint64_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x4_t v;
+
+        v.val[0] = vld1q_u8 (in + i);
+        v.val[1] = vld1q_u8 (in + count + i);
+        v.val[2] = vld1q_u8 (in + 2 * count + i);
+        v.val[3] = vld1q_u8 (in + 3 * count + i);
+        vst4q_u8 (out + 4 * i, v);
+    }
+
+    for (; i < count; ++i)
+    {
+        out[4 * i]     = in[i];
+        out[4 * i + 1] = in[count + i];
+        out[4 * i + 2] = in[2 * count + i];
+        out[4 * i + 3] = in[3 * count + i];
+    }
+}
+
+#endif /* EXR_BYTE_SIMD_NEON */
+
+/**************************************/
+
+/*
+ * Run length encoder, see internal_rle_compress.  The scanning
+ * routines are passed in as a selector so each instruction set gets
+ * its own copy of the loop with the calls inlined.
+ */
+
+#define EXR_RLE_MIN_RUN_LENGTH 3
+#define EXR_RLE_MAX_RUN_LENGTH 127
+
+#define EXR_RLE_COMPRESS_BODY(run_fn, literal_fn)                              \
+    int8_t*        cbuf = (int8_t*) out;                                       \
+    const uint8_t* runs = (const uint8_t*) src;                                \
+    const uint8_t* end  = runs + srcbytes;                                     \
+    const uint8_t* rune = runs + 1;                                            \
+    uint64_t       outb = 0;                                                   \
+                                                                               \
+    while (runs < end)                                                         \
+    {                                                                          \
+        uint64_t avail    = (rune < end) ? (uint64_t) (end - rune) : 0;        \
+        uint64_t curcount = run_fn (                                           \
+            rune,                                                              \
+            avail < EXR_RLE_MAX_RUN_LENGTH ? avail : EXR_RLE_MAX_RUN_LENGTH,   \
+            *runs);                                                            \
+        rune += curcount;                                                      \
+                                                                               \
+        if (curcount >= (EXR_RLE_MIN_RUN_LENGTH - 1))                          \
+        {                                                                      \
+            cbuf[outb++] = (int8_t) curcount;                                  \
+            cbuf[outb++] = (int8_t) *runs;                                     \
+                                                                               \
+            runs = rune;                                                       \
+        }                                                                      \
+        else                                                                   \
+        {                                                                      \
+            /* incompressible */                                               \
+            uint64_t n;                                                        \
+            ++curcount;                                                        \
+            avail = (rune < end) ? (uint64_t) (end - rune) : 0;                \
+            n     = EXR_RLE_MAX_RUN_LENGTH - curcount;                         \
+            n     = literal_fn (rune, avail < n ? avail : n, avail);           \
+            curcount += n;                                                     \
+            rune += n;                                                         \
+            cbuf[outb++] = (int8_t) (-((int) curcount));                       \
+            memcpy (cbuf + outb, runs, (size_t) (rune - runs));                \
+            outb += (uint64_t) (rune - runs);                                  \
+            runs = rune;                                                       \
+        }                                                                      \
+        ++rune;                                                                \
+        if (outb >= outbytes) break;                                           \
+    }                                                                          \
+    return outb
+
+static inline uint64_t
+exr_rle_compress_scalar (
+    void* out, uint64_t outbytes, const void* src, uint64_t srcbytes)
+{
+    EXR_RLE_COMPRESS_BODY (exr_rle_run_scalar, exr_rle_literal_scalar);
+}
+
+#ifdef EXR_BYTE_SIMD_SSE2
+static inline uint64_t
+exr_rle_compress_sse2 (
+    void* out, uint64_t outbytes, const void* src, uint64_t srcbytes)
+{
+    EXR_RLE_COMPRESS_BODY (exr_rle_run_sse2, exr_rle_literal_sse2);
+}
+#endif
+
+#ifdef EXR_BYTE_SIMD_X86_DISPATCH
+EXR_TARGET_AVX2 static inline uint64_t
+exr_rle_compress_avx2 (
+    void* out, uint64_t outbytes, const void* src, uint64_t srcbytes)
+{
+    EXR_RLE_COMPRESS_BODY (exr_rle_run_avx2, exr_rle_literal_avx2);
+}
+#endif
+
+#ifdef EXR_BYTE_SIMD_NEON
+static inline uint64_t
+exr_rle_compress_neon (
+    void* out, uint64_t outbytes, const void* src, uint64_t srcbytes)
+{
+    EXR_RLE_COMPRESS_BODY (exr_rle_run_neon, exr_rle_literal_neon);
+}
+#endif
+
+#endif /* OPENEXR_CORE_BYTE_SIMD_H */
@@ -107,6 +107,9 @@ exr_result_t internal_decode_alloc_buffer (
     size_t*                              cursz,
     size_t                               newsz);
 
+/* EXR_X86_SIMD_* bits (see internal_cpuid.h) of the running cpu */
+int internal_exr_x86_byte_simd (void);
+
 /**************************************/
 
 static inline float
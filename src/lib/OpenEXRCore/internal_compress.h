@@ -21,8 +21,14 @@ exr_result_t internal_exr_apply_rle (exr_encode_pipeline_t* encode);
 
 exr_result_t internal_exr_apply_zip (exr_encode_pipeline_t* encode);
 
+struct _internal_exr_part;
+/* zip level in effect for the part, taking auto-tuning into account */
+int internal_exr_zip_tuned_level (const struct _internal_exr_part* part);
+
 exr_result_t internal_exr_apply_piz (exr_encode_pipeline_t* encode);
 
+exr_result_t internal_exr_apply_piz4 (exr_encode_pipeline_t* encode);
+
 exr_result_t internal_exr_apply_pxr24 (exr_encode_pipeline_t* encode);
 
 exr_result_t internal_exr_apply_b44 (exr_encode_pipeline_t* encode);
@@ -33,4 +39,23 @@ exr_result_t internal_exr_apply_dwaa (exr_encode_pipeline_t* encode);
 
 exr_result_t internal_exr_apply_dwab (exr_encode_pipeline_t* encode);
 
+exr_result_t internal_exr_apply_zstd (exr_encode_pipeline_t* encode);
+
+struct _internal_exr_context;
+/* zstd compression with a context that is created on the first call
+ * and left in *cctx for the next, until internal_exr_zstd_free_cctx */
+exr_result_t internal_exr_zstd_compress (
+    const struct _internal_exr_context* pctxt,
+    void**                              cctx,
+    int                                 level,
+    const void*                         in,
+    size_t                              in_bytes,
+    void*                               out,
+    size_t                              out_bytes_avail,
+    size_t*                             actual_out);
+
+void internal_exr_zstd_free_cctx (void* cctx);
+
+exr_result_t internal_exr_apply_lz4 (exr_encode_pipeline_t* encode);
+
 #endif /* OPENEXR_CORE_COMPRESS_H */
@@ -125,6 +125,85 @@ check_for_x86_simd (int* f16c, int* avx, int* sse2)
 
 }
 
+/* bits returned by check_for_x86_byte_simd */
+#define EXR_X86_SIMD_SSE4_1 1
+#define EXR_X86_SIMD_AVX2 2
+#define EXR_X86_SIMD_AVX512 4
+
+/*
+ * SSE4.1, AVX2 and AVX-512 (F and BW) support, for the codec loops
+ * that pick their version at run time (SSE2 is assumed on x86_64).
+ */
+static inline int
+check_for_x86_byte_simd (void)
+{
+#if OPENEXR_ENABLE_X86_SIMD_CHECK && !defined(__e2k__)
+    int ret = 0, maxleaf;
+
+#    if defined(_WIN32)
+    int regs[4] = {0};
+
+    __cpuid (regs, 0);
+    maxleaf = regs[0];
+    if (maxleaf >= 1) __cpuidex (regs, 1, 0);
+#    else
+    unsigned int regs[4] = {0};
+
+    __get_cpuid (0, &regs[0], &regs[1], &regs[2], &regs[3]);
+    maxleaf = (int) regs[0];
+    if (maxleaf >= 1)
+        __get_cpuid (1, &regs[0], &regs[1], &regs[2], &regs[3]);
+#    endif
+    if (maxleaf < 1) return 0;
+
+    /* SSE4.1 is bit 19 of ECX */
+    if (regs[2] & (1 << 19)) ret |= EXR_X86_SIMD_SSE4_1;
+
+#    if defined(_M_X64) || defined(__x86_64__)
+    /* AVX2 needs the OS to save the ymm registers (OSXSAVE, bit 27) */
+    if (maxleaf >= 7 && (regs[2] & (1 << 27)))
+    {
+        unsigned int xcr0;
+#        if defined(_MSC_VER)
+#            if defined(OPENEXR_IMF_HAVE_GCC_INLINE_ASM_AVX)
+        xcr0 = (unsigned int) _xgetbv (0);
+#            else
+        xcr0 = 0;
+#            endif
+#        else
+        unsigned int edx;
+        __asm__ __volatile__ ("xgetbv"
+                              : /* Output  */ "=a"(xcr0), "=d"(edx)
+                              : /* Input   */ "c"(0)
+                              : /* Clobber */);
+        (void) edx;
+#        endif
+#        if defined(_WIN32)
+        __cpuidex (regs, 7, 0);
+#        else
+        __cpuid_count (7, 0, regs[0], regs[1], regs[2], regs[3]);
+#        endif
+        /* AVX2 is bit 5 of EBX */
+        if ((xcr0 & 6) == 6 && (regs[1] & (1 << 5))) ret |= EXR_X86_SIMD_AVX2;
+        /*
+         * AVX-512 F and BW are bits 16 and 30 of EBX, and also need
+         * the opmask and zmm state enabled (xcr0 bits 5 to 7)
+         */
+        if ((ret & EXR_X86_SIMD_AVX2) && (xcr0 & 0xe0) == 0xe0 &&
+            (regs[1] & (1 << 16)) && (regs[1] & (1u << 30)))
+            ret |= EXR_X86_SIMD_AVX512;
+    }
+#    endif
+    return ret;
+
+#elif defined(__AVX2__)
+    return EXR_X86_SIMD_SSE4_1 | EXR_X86_SIMD_AVX2;
+
+#else
+    return 0;
+#endif
+}
+
 static inline int
 has_native_half (void)
 {
@@ -38,6 +38,13 @@ exr_result_t internal_exr_undo_piz (
     void*                  uncompressed_data,
     uint64_t               uncompressed_size);
 
+exr_result_t internal_exr_undo_piz4 (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size);
+
 exr_result_t internal_exr_undo_pxr24 (
     exr_decode_pipeline_t* decode,
     const void*            compressed_data,
@@ -73,4 +80,32 @@ exr_result_t internal_exr_undo_dwab (
     void*                  uncompressed_data,
     uint64_t               uncompressed_size);
 
+exr_result_t internal_exr_undo_zstd (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size);
+
+struct _internal_exr_context;
+/* zstd decompression with a context that is created on the first call
+ * and left in *dctx for the next, until internal_exr_zstd_free_dctx */
+exr_result_t internal_exr_zstd_uncompress (
+    const struct _internal_exr_context* pctxt,
+    void**                              dctx,
+    const void*                         in,
+    size_t                              in_bytes,
+    void*                               out,
+    size_t                              out_bytes_avail,
+    size_t*                             actual_out);
+
+void internal_exr_zstd_free_dctx (void* dctx);
+
+exr_result_t internal_exr_undo_lz4 (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size);
+
 #endif /* OPENEXR_CORE_DECOMPRESS_H */
@@ -107,6 +107,7 @@
 
 #include "openexr_compression.h"
 
+#include "internal_async.h"
 #include "internal_cpuid.h"
 #include "internal_huf.h"
 #include "internal_structs.h"
@@ -88,6 +88,77 @@ static exr_result_t DwaCompressor_classifyChannels (DwaCompressor* me);
 
 static exr_result_t DwaCompressor_setupChannelData (DwaCompressor* me);
 
+//
+// The compressed streams of a chunk, which are uncompressed
+// independently of each other, possibly at the same time.
+//
+
+typedef struct _DwaStreams
+{
+    DwaCompressor* me;
+
+    const uint8_t* unknownBuf;
+    uint64_t       unknownCompressedSize;
+    uint64_t       unknownUncompressedSize;
+
+    const uint8_t* acBuf;
+    uint64_t       acCompressedSize;
+    uint64_t       acUncompressedCount;
+    uint64_t       acCompression;
+
+    const uint8_t* dcBuf;
+    uint64_t       dcCompressedSize;
+    uint64_t       dcUncompressedCount;
+
+    const uint8_t* rleBuf;
+    uint64_t       rleCompressedSize;
+    uint64_t       rleUncompressedSize;
+    uint64_t       rleRawSize;
+
+    exr_result_t rv[4];
+} DwaStreams;
+
+static void DwaStreams_uncompress (void* streams, int idx);
+
+//
+// Pieces of work decoding the channels of a chunk: a band of rows of
+// blocks of a LOSSY_DCT channel (or set of 3 channels), or a whole
+// RLE or UNKNOWN channel (when cd is set).
+//
+
+typedef struct _DwaDecodeTask
+{
+    DwaCompressor*  me;
+    ChannelData*    cd;
+    LossyDctDecoder decoder;
+    int             blockyBegin;
+    int             blockyEnd;
+    exr_result_t    rv;
+    uint8_t         _pad[4];
+} DwaDecodeTask;
+
+//
+// Rows of blocks (of 8 scanlines) in a LOSSY_DCT band
+//
+
+#define DWA_DECODE_BAND_BLOCKS 4
+
+static exr_result_t DwaCompressor_buildDecodeTasks (
+    DwaCompressor* me,
+    DwaDecodeTask* tasks,
+    int*           taskCount,
+    uint8_t*       packedAcBuffer,
+    uint8_t*       packedAcBufferEnd,
+    uint8_t*       packedDcBuffer,
+    uint64_t       totalDcUncompressedCount);
+
+static void DwaDecodeTask_run (void* tasks, int idx);
+
+static exr_result_t
+DwaCompressor_unpackRleChannel (DwaCompressor* me, ChannelData* cd);
+static exr_result_t
+DwaCompressor_copyUnknownChannel (DwaCompressor* me, ChannelData* cd);
+
 /**************************************/
 
 exr_result_t
@@ -869,36 +940,294 @@ DwaCompressor_uncompress (
     rv = DwaCompressor_setupChannelData (me);
 
     //
-    // Uncompress the UNKNOWN data into _planarUncBuffer[UNKNOWN]
+    // Uncompress the UNKNOWN, AC, DC and RLE data. These do not
+    // depend on each other, so may be split over several threads.
+    //
+
+    {
+        DwaStreams streams;
+
+        streams.me                      = me;
+        streams.unknownBuf              = compressedUnknownBuf;
+        streams.unknownCompressedSize   = unknownCompressedSize;
+        streams.unknownUncompressedSize = unknownUncompressedSize;
+        streams.acBuf                   = compressedAcBuf;
+        streams.acCompressedSize        = acCompressedSize;
+        streams.acUncompressedCount     = totalAcUncompressedCount;
+        streams.acCompression           = acCompression;
+        streams.dcBuf                   = compressedDcBuf;
+        streams.dcCompressedSize        = dcCompressedSize;
+        streams.dcUncompressedCount     = totalDcUncompressedCount;
+        streams.rleBuf                  = compressedRleBuf;
+        streams.rleCompressedSize       = rleCompressedSize;
+        streams.rleUncompressedSize     = rleUncompressedSize;
+        streams.rleRawSize              = rleRawSize;
+
+        internal_exr_run_tasks (
+            EXR_CCTXT (me->_decode->context),
+            4,
+            &DwaStreams_uncompress,
+            &streams,
+            me->_decode->spawn_fn,
+            me->_decode->spawn_userdata);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            if (streams.rv[i] != EXR_ERR_SUCCESS) return streams.rv[i];
+        }
+    }
+
+    //
+    // Determine the start of each row in the output buffer
+    //
+    for (int c = 0; c < me->_numChannels; ++c)
+    {
+        me->_channelData[c].processed = 0;
+    }
+
+    for (int y = me->_min[1]; y <= me->_max[1]; ++y)
+    {
+        for (int c = 0; c < me->_numChannels; ++c)
+        {
+            ChannelData*               cd   = &(me->_channelData[c]);
+            exr_coding_channel_info_t* chan = cd->chan;
+
+            if ((y % chan->y_samples) != 0) continue;
+
+            rv = DctCoderChannelData_push_row (
+                me->alloc_fn, me->free_fn, &(cd->_dctData), outBufferEnd);
+            if (rv != EXR_ERR_SUCCESS) return rv;
+
+            outBufferEnd += chan->width * chan->bytes_per_element;
+        }
+    }
+
+    //
+    // With somewhere to spawn tasks, decode bands of rows of each
+    // LOSSY_DCT channel and each of the other channels separately.
+    // Finding where each band starts in the AC data is a serial walk
+    // over it, so only worth it with more than one processor.
+    //
+
+    if (me->_decode->spawn_fn && internal_exr_processor_count () > 1)
+    {
+        DwaDecodeTask* tasks;
+        int            taskCount = 0;
+        uint8_t*       packedAcEnd =
+            packedAcBufferEnd + totalAcUncompressedCount * sizeof (uint16_t);
+
+        rv = DwaCompressor_buildDecodeTasks (
+            me,
+            NULL,
+            &taskCount,
+            packedAcBufferEnd,
+            packedAcEnd,
+            packedDcBufferEnd,
+            totalDcUncompressedCount);
+        if (rv != EXR_ERR_SUCCESS || taskCount == 0) return rv;
+
+        tasks = me->alloc_fn (sizeof (DwaDecodeTask) * (size_t) taskCount);
+        if (!tasks) return EXR_ERR_OUT_OF_MEMORY;
+        memset (tasks, 0, sizeof (DwaDecodeTask) * (size_t) taskCount);
+
+        rv = DwaCompressor_buildDecodeTasks (
+            me,
+            tasks,
+            &taskCount,
+            packedAcBufferEnd,
+            packedAcEnd,
+            packedDcBufferEnd,
+            totalDcUncompressedCount);
+
+        if (rv == EXR_ERR_SUCCESS)
+        {
+            internal_exr_run_tasks (
+                EXR_CCTXT (me->_decode->context),
+                taskCount,
+                &DwaDecodeTask_run,
+                tasks,
+                me->_decode->spawn_fn,
+                me->_decode->spawn_userdata);
+
+            for (int t = 0; t < taskCount && rv == EXR_ERR_SUCCESS; ++t)
+                rv = tasks[t].rv;
+        }
+
+        me->free_fn (tasks);
+        return rv;
+    }
+
+    //
+    // Setup to decode each block of 3 channels that need to
+    // be handled together
+    //
+
+    for (int csc = 0; csc < me->_numCscChannelSets; ++csc)
+    {
+        LossyDctDecoder decoder;
+        CscChannelSet*  cset = &(me->_cscChannelSets[csc]);
+
+        int rChan = cset->idx[0];
+        int gChan = cset->idx[1];
+        int bChan = cset->idx[2];
+
+        if (me->_channelData[rChan].compression != LOSSY_DCT ||
+            me->_channelData[gChan].compression != LOSSY_DCT ||
+            me->_channelData[bChan].compression != LOSSY_DCT)
+        {
+            return EXR_ERR_CORRUPT_CHUNK;
+        }
+
+        rv = LossyDctDecoderCsc_construct (
+            &decoder,
+            &(me->_channelData[rChan]._dctData),
+            &(me->_channelData[gChan]._dctData),
+            &(me->_channelData[bChan]._dctData),
+            packedAcBufferEnd,
+            packedAcBufferEnd + totalAcUncompressedCount * sizeof (uint16_t),
+            packedDcBufferEnd,
+            totalDcUncompressedCount,
+            dwaCompressorToLinear,
+            me->_channelData[rChan].chan->width,
+            me->_channelData[rChan].chan->height);
+
+        if (rv == EXR_ERR_SUCCESS)
+            rv = LossyDctDecoder_execute (me->alloc_fn, me->free_fn, &decoder);
+
+        packedAcBufferEnd += decoder._packedAcCount * sizeof (uint16_t);
+
+        packedDcBufferEnd += decoder._packedDcCount * sizeof (uint16_t);
+        totalDcUncompressedCount -= decoder._packedDcCount;
+
+        me->_channelData[rChan].processed = 1;
+        me->_channelData[gChan].processed = 1;
+        me->_channelData[bChan].processed = 1;
+
+        if (rv != EXR_ERR_SUCCESS) { return rv; }
+    }
+
+    //
+    // Setup to handle the remaining channels by themselves
     //
 
-    if (unknownCompressedSize > 0)
+    for (int c = 0; c < me->_numChannels; ++c)
+    {
+        ChannelData*               cd      = &(me->_channelData[c]);
+        exr_coding_channel_info_t* chan    = cd->chan;
+        DctCoderChannelData*       dcddata = &(cd->_dctData);
+
+        if (cd->processed) continue;
+
+        switch (cd->compression)
+        {
+            case LOSSY_DCT:
+
+                //
+                // Setup a single-channel lossy DCT decoder pointing
+                // at the output buffer
+                //
+
+                {
+                    const uint16_t* linearLut = NULL;
+                    LossyDctDecoder decoder;
+
+                    if (!chan->p_linear) linearLut = dwaCompressorToLinear;
+
+                    rv = LossyDctDecoder_construct (
+                        &decoder,
+                        dcddata,
+                        packedAcBufferEnd,
+                        packedAcBufferEnd +
+                            totalAcUncompressedCount * sizeof (uint16_t),
+                        packedDcBufferEnd,
+                        totalDcUncompressedCount,
+                        linearLut,
+                        chan->width,
+                        chan->height);
+
+                    if (rv == EXR_ERR_SUCCESS)
+                        rv = LossyDctDecoder_execute (
+                            me->alloc_fn, me->free_fn, &decoder);
+
+                    packedAcBufferEnd +=
+                        (size_t) decoder._packedAcCount * sizeof (uint16_t);
+
+                    packedDcBufferEnd +=
+                        (size_t) decoder._packedDcCount * sizeof (uint16_t);
+
+                    totalDcUncompressedCount -= decoder._packedDcCount;
+                    if (rv != EXR_ERR_SUCCESS) { return rv; }
+                }
+
+                break;
+
+            case RLE:
+                rv = DwaCompressor_unpackRleChannel (me, cd);
+                if (rv != EXR_ERR_SUCCESS) { return rv; }
+                break;
+
+            case UNKNOWN:
+                rv = DwaCompressor_copyUnknownChannel (me, cd);
+                if (rv != EXR_ERR_SUCCESS) { return rv; }
+                break;
+
+            case NUM_COMPRESSOR_SCHEMES:
+            default: return EXR_ERR_CORRUPT_CHUNK; break;
+        }
+
+        cd->processed = 1;
+    }
+
+    return rv;
+}
+
+/**************************************/
+
+//
+// Uncompress the UNKNOWN data into _planarUncBuffer[UNKNOWN]
+//
+
+static exr_result_t
+DwaStreams_uncompressUnknown (DwaStreams* s)
+{
+    DwaCompressor* me = s->me;
+
+    if (s->unknownCompressedSize > 0)
     {
-        if (unknownUncompressedSize > me->_planarUncBufferSize[UNKNOWN])
+        if (s->unknownUncompressedSize > me->_planarUncBufferSize[UNKNOWN])
         {
             return EXR_ERR_CORRUPT_CHUNK;
         }
 
         if (EXR_ERR_SUCCESS != exr_uncompress_buffer (
                                    me->_decode->context,
-                                   compressedUnknownBuf,
-                                   unknownCompressedSize,
+                                   s->unknownBuf,
+                                   s->unknownCompressedSize,
                                    me->_planarUncBuffer[UNKNOWN],
-                                   unknownUncompressedSize,
+                                   s->unknownUncompressedSize,
                                    NULL))
         {
             return EXR_ERR_CORRUPT_CHUNK;
         }
     }
 
-    //
-    // Uncompress the AC data into _packedAcBuffer
-    //
+    return EXR_ERR_SUCCESS;
+}
 
-    if (acCompressedSize > 0)
+//
+// Uncompress the AC data into _packedAcBuffer
+//
+
+static exr_result_t
+DwaStreams_uncompressAc (DwaStreams* s)
+{
+    DwaCompressor* me = s->me;
+    exr_result_t   rv = EXR_ERR_SUCCESS;
+
+    if (s->acCompressedSize > 0)
     {
         if (!me->_packedAcBuffer ||
-            totalAcUncompressedCount * sizeof (uint16_t) >
+            s->acUncompressedCount * sizeof (uint16_t) >
                 me->_packedAcBufferSize)
         {
             return EXR_ERR_CORRUPT_CHUNK;
@@ -908,18 +1237,17 @@ DwaCompressor_uncompress (
         // Don't trust the user to get it right, look in the file.
         //
 
-        switch (acCompression)
+        switch (s->acCompression)
         {
             case STATIC_HUFFMAN:
                 rv = internal_huf_decompress (
                     me->_decode,
-                    compressedAcBuf,
-                    acCompressedSize,
+                    s->acBuf,
+                    s->acCompressedSize,
                     (uint16_t*) me->_packedAcBuffer,
-                    totalAcUncompressedCount,
+                    s->acUncompressedCount,
                     me->_decode->scratch_buffer_1,
                     me->_decode->scratch_alloc_size_1);
-                if (rv != EXR_ERR_SUCCESS) { return rv; }
                 break;
 
             case DEFLATE: {
@@ -927,14 +1255,14 @@ DwaCompressor_uncompress (
 
                 rv = exr_uncompress_buffer (
                     me->_decode->context,
-                    compressedAcBuf,
-                    acCompressedSize,
+                    s->acBuf,
+                    s->acCompressedSize,
                     me->_packedAcBuffer,
-                    totalAcUncompressedCount * sizeof (uint16_t),
+                    s->acUncompressedCount * sizeof (uint16_t),
                     &destLen);
                 if (rv != EXR_ERR_SUCCESS) return rv;
 
-                if (totalAcUncompressedCount * sizeof (uint16_t) != destLen)
+                if (s->acUncompressedCount * sizeof (uint16_t) != destLen)
                 {
                     return EXR_ERR_CORRUPT_CHUNK;
                 }
@@ -945,14 +1273,25 @@ DwaCompressor_uncompress (
         }
     }
 
-    //
-    // Uncompress the DC data into _packedDcBuffer
-    //
+    return rv;
+}
 
-    if (dcCompressedSize > 0)
+//
+// Uncompress the DC data into _packedDcBuffer. This goes through
+// the second scratch buffer, as the first holds the tables for
+// decoding the AC data, which may be going on at the same time.
+//
+
+static exr_result_t
+DwaStreams_uncompressDc (DwaStreams* s)
+{
+    DwaCompressor* me = s->me;
+    exr_result_t   rv;
+
+    if (s->dcCompressedSize > 0)
     {
         size_t destLen;
-        size_t uncompBytes = totalDcUncompressedCount * sizeof (uint16_t);
+        size_t uncompBytes = s->dcUncompressedCount * sizeof (uint16_t);
         if (uncompBytes > me->_packedDcBufferSize)
         {
             return EXR_ERR_CORRUPT_CHUNK;
@@ -960,18 +1299,18 @@ DwaCompressor_uncompress (
 
         rv = internal_decode_alloc_buffer (
             me->_decode,
-            EXR_TRANSCODE_BUFFER_SCRATCH1,
-            &(me->_decode->scratch_buffer_1),
-            &(me->_decode->scratch_alloc_size_1),
+            EXR_TRANSCODE_BUFFER_SCRATCH2,
+            &(me->_decode->scratch_buffer_2),
+            &(me->_decode->scratch_alloc_size_2),
             uncompBytes);
 
         if (rv != EXR_ERR_SUCCESS) return rv;
 
         rv = exr_uncompress_buffer (
             me->_decode->context,
-            compressedDcBuf,
-            dcCompressedSize,
-            me->_decode->scratch_buffer_1,
+            s->dcBuf,
+            s->dcCompressedSize,
+            me->_decode->scratch_buffer_2,
             uncompBytes,
             &destLen);
         if (rv != EXR_ERR_SUCCESS || (uncompBytes != destLen))
@@ -980,276 +1319,345 @@ DwaCompressor_uncompress (
         }
 
         internal_zip_reconstruct_bytes (
-            me->_packedDcBuffer, me->_decode->scratch_buffer_1, uncompBytes);
+            me->_packedDcBuffer, me->_decode->scratch_buffer_2, uncompBytes);
     }
     else
     {
         // if the compressed size is 0, then the uncompressed size must also be zero
-        if (totalDcUncompressedCount != 0) { return EXR_ERR_CORRUPT_CHUNK; }
+        if (s->dcUncompressedCount != 0) { return EXR_ERR_CORRUPT_CHUNK; }
     }
 
-    //
-    // Uncompress the RLE data into _rleBuffer, then unRLE the results
-    // into _planarUncBuffer[RLE]
-    //
+    return EXR_ERR_SUCCESS;
+}
+
+//
+// Uncompress the RLE data into _rleBuffer, then unRLE the results
+// into _planarUncBuffer[RLE]
+//
 
-    if (rleRawSize > 0)
+static exr_result_t
+DwaStreams_uncompressRle (DwaStreams* s)
+{
+    DwaCompressor* me = s->me;
+
+    if (s->rleRawSize > 0)
     {
         size_t dstLen;
 
-        if (rleUncompressedSize > me->_rleBufferSize ||
-            rleRawSize > me->_planarUncBufferSize[RLE])
+        if (s->rleUncompressedSize > me->_rleBufferSize ||
+            s->rleRawSize > me->_planarUncBufferSize[RLE])
         {
             return EXR_ERR_CORRUPT_CHUNK;
         }
 
         if (EXR_ERR_SUCCESS != exr_uncompress_buffer (
                                    me->_decode->context,
-                                   compressedRleBuf,
-                                   rleCompressedSize,
+                                   s->rleBuf,
+                                   s->rleCompressedSize,
                                    me->_rleBuffer,
-                                   rleUncompressedSize,
+                                   s->rleUncompressedSize,
                                    &dstLen))
         {
             return EXR_ERR_CORRUPT_CHUNK;
         }
 
-        if (dstLen != rleUncompressedSize) { return EXR_ERR_CORRUPT_CHUNK; }
+        if (dstLen != s->rleUncompressedSize) { return EXR_ERR_CORRUPT_CHUNK; }
 
         if (internal_rle_decompress (
                 me->_planarUncBuffer[RLE],
-                rleRawSize,
+                s->rleRawSize,
                 (const uint8_t*) me->_rleBuffer,
-                rleUncompressedSize) != rleRawSize)
+                s->rleUncompressedSize) != s->rleRawSize)
         {
             return EXR_ERR_CORRUPT_CHUNK;
         }
     }
 
-    //
-    // Determine the start of each row in the output buffer
-    //
-    for (int c = 0; c < me->_numChannels; ++c)
-    {
-        me->_channelData[c].processed = 0;
-    }
+    return EXR_ERR_SUCCESS;
+}
 
-    for (int y = me->_min[1]; y <= me->_max[1]; ++y)
-    {
-        for (int c = 0; c < me->_numChannels; ++c)
-        {
-            ChannelData*               cd   = &(me->_channelData[c]);
-            exr_coding_channel_info_t* chan = cd->chan;
+void
+DwaStreams_uncompress (void* streams, int idx)
+{
+    DwaStreams* s = (DwaStreams*) streams;
 
-            if ((y % chan->y_samples) != 0) continue;
+    switch (idx)
+    {
+        case 0: s->rv[idx] = DwaStreams_uncompressAc (s); break;
+        case 1: s->rv[idx] = DwaStreams_uncompressDc (s); break;
+        case 2: s->rv[idx] = DwaStreams_uncompressRle (s); break;
+        default: s->rv[idx] = DwaStreams_uncompressUnknown (s); break;
+    }
+}
 
-            rv = DctCoderChannelData_push_row (
-                me->alloc_fn, me->free_fn, &(cd->_dctData), outBufferEnd);
-            if (rv != EXR_ERR_SUCCESS) return rv;
+/**************************************/
 
-            outBufferEnd += chan->width * chan->bytes_per_element;
-        }
-    }
+exr_result_t
+DwaCompressor_buildDecodeTasks (
+    DwaCompressor* me,
+    DwaDecodeTask* tasks,
+    int*           taskCount,
+    uint8_t*       packedAcBuffer,
+    uint8_t*       packedAcBufferEnd,
+    uint8_t*       packedDcBuffer,
+    uint64_t       totalDcUncompressedCount)
+{
+    exr_result_t    rv;
+    int             count      = 0;
+    uint16_t*       currAcComp = (uint16_t*) packedAcBuffer;
+    uint16_t*       acCompEnd  = (uint16_t*) packedAcBufferEnd;
+    LossyDctDecoder decoder;
 
     //
-    // Setup to decode each block of 3 channels that need to
-    // be handled together
+    // Walks the channels in the same order as the AC and DC data were
+    // written, so each decoder can be pointed at its own part of them
+    // up front. When tasks is NULL, this only counts them.
     //
 
-    for (int csc = 0; csc < me->_numCscChannelSets; ++csc)
+    for (int c = 0; c < me->_numChannels; ++c)
     {
-        LossyDctDecoder decoder;
-        CscChannelSet*  cset = &(me->_cscChannelSets[csc]);
+        me->_channelData[c].processed = 0;
+    }
 
-        int rChan = cset->idx[0];
-        int gChan = cset->idx[1];
-        int bChan = cset->idx[2];
+    for (int csc = 0, c = 0; c < me->_numChannels;)
+    {
+        ChannelData* cd = NULL;
+        uint64_t     numBlocks;
+        int          numBlocksX, numBlocksY;
 
-        if (me->_channelData[rChan].compression != LOSSY_DCT ||
-            me->_channelData[gChan].compression != LOSSY_DCT ||
-            me->_channelData[bChan].compression != LOSSY_DCT)
+        if (csc < me->_numCscChannelSets)
         {
-            return EXR_ERR_CORRUPT_CHUNK;
-        }
-
-        rv = LossyDctDecoderCsc_construct (
-            &decoder,
-            &(me->_channelData[rChan]._dctData),
-            &(me->_channelData[gChan]._dctData),
-            &(me->_channelData[bChan]._dctData),
-            packedAcBufferEnd,
-            packedAcBufferEnd + totalAcUncompressedCount * sizeof (uint16_t),
-            packedDcBufferEnd,
-            totalDcUncompressedCount,
-            dwaCompressorToLinear,
-            me->_channelData[rChan].chan->width,
-            me->_channelData[rChan].chan->height);
+            CscChannelSet* cset = &(me->_cscChannelSets[csc++]);
 
-        if (rv == EXR_ERR_SUCCESS)
-            rv = LossyDctDecoder_execute (me->alloc_fn, me->free_fn, &decoder);
+            int rChan = cset->idx[0];
+            int gChan = cset->idx[1];
+            int bChan = cset->idx[2];
 
-        packedAcBufferEnd += decoder._packedAcCount * sizeof (uint16_t);
-
-        packedDcBufferEnd += decoder._packedDcCount * sizeof (uint16_t);
-        totalDcUncompressedCount -= decoder._packedDcCount;
-
-        me->_channelData[rChan].processed = 1;
-        me->_channelData[gChan].processed = 1;
-        me->_channelData[bChan].processed = 1;
-
-        if (rv != EXR_ERR_SUCCESS) { return rv; }
-    }
-
-    //
-    // Setup to handle the remaining channels by themselves
-    //
-
-    for (int c = 0; c < me->_numChannels; ++c)
-    {
-        ChannelData*               cd        = &(me->_channelData[c]);
-        exr_coding_channel_info_t* chan      = cd->chan;
-        DctCoderChannelData*       dcddata   = &(cd->_dctData);
-        int                        pixelSize = chan->bytes_per_element;
+            if (me->_channelData[rChan].compression != LOSSY_DCT ||
+                me->_channelData[gChan].compression != LOSSY_DCT ||
+                me->_channelData[bChan].compression != LOSSY_DCT)
+            {
+                return EXR_ERR_CORRUPT_CHUNK;
+            }
 
-        if (cd->processed) continue;
+            rv = LossyDctDecoderCsc_construct (
+                &decoder,
+                &(me->_channelData[rChan]._dctData),
+                &(me->_channelData[gChan]._dctData),
+                &(me->_channelData[bChan]._dctData),
+                (uint8_t*) currAcComp,
+                packedAcBufferEnd,
+                packedDcBuffer,
+                totalDcUncompressedCount,
+                dwaCompressorToLinear,
+                me->_channelData[rChan].chan->width,
+                me->_channelData[rChan].chan->height);
+            if (rv != EXR_ERR_SUCCESS) return rv;
 
-        switch (cd->compression)
+            me->_channelData[rChan].processed = 1;
+            me->_channelData[gChan].processed = 1;
+            me->_channelData[bChan].processed = 1;
+        }
+        else
         {
-            case LOSSY_DCT:
+            exr_coding_channel_info_t* chan;
 
-                //
-                // Setup a single-channel lossy DCT decoder pointing
-                // at the output buffer
-                //
+            cd = &(me->_channelData[c++]);
+            if (cd->processed) continue;
 
-                {
-                    const uint16_t* linearLut = NULL;
-                    LossyDctDecoder decoder;
-
-                    if (!chan->p_linear) linearLut = dwaCompressorToLinear;
+            chan          = cd->chan;
+            cd->processed = 1;
 
+            switch (cd->compression)
+            {
+                case LOSSY_DCT:
                     rv = LossyDctDecoder_construct (
                         &decoder,
-                        dcddata,
+                        &(cd->_dctData),
+                        (uint8_t*) currAcComp,
                         packedAcBufferEnd,
-                        packedAcBufferEnd +
-                            totalAcUncompressedCount * sizeof (uint16_t),
-                        packedDcBufferEnd,
+                        packedDcBuffer,
                         totalDcUncompressedCount,
-                        linearLut,
+                        chan->p_linear ? NULL : dwaCompressorToLinear,
                         chan->width,
                         chan->height);
+                    if (rv != EXR_ERR_SUCCESS) return rv;
+                    cd = NULL;
+                    break;
 
-                    if (rv == EXR_ERR_SUCCESS)
-                        rv = LossyDctDecoder_execute (
-                            me->alloc_fn, me->free_fn, &decoder);
+                case RLE:
+                case UNKNOWN:
+                    if (tasks)
+                    {
+                        tasks[count].me = me;
+                        tasks[count].cd = cd;
+                    }
+                    ++count;
+                    continue;
 
-                    packedAcBufferEnd +=
-                        (size_t) decoder._packedAcCount * sizeof (uint16_t);
+                case NUM_COMPRESSOR_SCHEMES:
+                default: return EXR_ERR_CORRUPT_CHUNK;
+            }
+        }
 
-                    packedDcBufferEnd +=
-                        (size_t) decoder._packedDcCount * sizeof (uint16_t);
+        //
+        // Split the LOSSY_DCT channel(s) into bands of rows of blocks,
+        // finding where the AC data for each starts
+        //
 
-                    totalDcUncompressedCount -= decoder._packedDcCount;
-                    if (rv != EXR_ERR_SUCCESS) { return rv; }
-                }
+        numBlocksX = (decoder._width + 7) / 8;
+        numBlocksY = (decoder._height + 7) / 8;
+        numBlocks  = (uint64_t) decoder._channel_decode_data_count *
+                    (uint64_t) numBlocksX * (uint64_t) numBlocksY;
 
-                break;
+        if (totalDcUncompressedCount < numBlocks)
+        {
+            return EXR_ERR_CORRUPT_CHUNK;
+        }
 
-            case RLE:
+        for (int by = 0; by < numBlocksY; by += DWA_DECODE_BAND_BLOCKS)
+        {
+            int byEnd = by + DWA_DECODE_BAND_BLOCKS;
+            if (byEnd > numBlocksY) byEnd = numBlocksY;
 
-                //
-                // For the RLE case, the data has been un-RLE'd into
-                // planarUncRleEnd[], but is still split out by bytes.
-                // We need to rearrange the bytes back into the correct
-                // order in the output buffer;
-                //
+            if (tasks)
+            {
+                DwaDecodeTask* t = tasks + count;
+
+                t->me                = me;
+                t->cd                = NULL;
+                t->decoder           = decoder;
+                t->decoder._packedAc = (uint8_t*) currAcComp;
+                t->blockyBegin       = by;
+                t->blockyEnd         = byEnd;
+
+                rv = LossyDctDecoder_skipAc (
+                    &currAcComp,
+                    acCompEnd,
+                    (uint64_t) decoder._channel_decode_data_count *
+                        (uint64_t) numBlocksX * (uint64_t) (byEnd - by));
+                if (rv != EXR_ERR_SUCCESS) return rv;
+            }
+            ++count;
+        }
 
-                {
-                    int row = 0;
+        packedDcBuffer += numBlocks * sizeof (uint16_t);
+        totalDcUncompressedCount -= numBlocks;
+    }
 
-                    for (int y = me->_min[1]; y <= me->_max[1]; ++y)
-                    {
-                        uint8_t* dst;
-                        if ((y % chan->y_samples) != 0) continue;
+    *taskCount = count;
+    return EXR_ERR_SUCCESS;
+}
 
-                        dst = dcddata->_rows[row];
+/**************************************/
 
-                        if (pixelSize == 2)
-                        {
-                            interleaveByte2 (
-                                dst,
-                                cd->planarUncRleEnd[0],
-                                cd->planarUncRleEnd[1],
-                                chan->width);
-
-                            cd->planarUncRleEnd[0] += chan->width;
-                            cd->planarUncRleEnd[1] += chan->width;
-                        }
-                        else
-                        {
-                            for (int x = 0; x < chan->width; ++x)
-                            {
-                                for (int byte = 0; byte < pixelSize; ++byte)
-                                {
-                                    *dst++ = *cd->planarUncRleEnd[byte]++;
-                                }
-                            }
-                        }
+void
+DwaDecodeTask_run (void* tasks, int idx)
+{
+    DwaDecodeTask* t  = ((DwaDecodeTask*) tasks) + idx;
+    DwaCompressor* me = t->me;
 
-                        row++;
-                    }
-                }
+    if (!t->cd)
+    {
+        t->rv = LossyDctDecoder_executeRows (
+            me->alloc_fn,
+            me->free_fn,
+            &(t->decoder),
+            t->blockyBegin,
+            t->blockyEnd);
+    }
+    else if (t->cd->compression == RLE)
+    {
+        t->rv = DwaCompressor_unpackRleChannel (me, t->cd);
+    }
+    else { t->rv = DwaCompressor_copyUnknownChannel (me, t->cd); }
+}
 
-                break;
+/**************************************/
 
-            case UNKNOWN:
+//
+// For the RLE case, the data has been un-RLE'd into
+// planarUncRleEnd[], but is still split out by bytes.
+// We need to rearrange the bytes back into the correct
+// order in the output buffer;
+//
 
-                //
-                // In the UNKNOWN case, data is already in planarUncBufferEnd
-                // and just needs to copied over to the output buffer
-                //
+exr_result_t
+DwaCompressor_unpackRleChannel (DwaCompressor* me, ChannelData* cd)
+{
+    exr_coding_channel_info_t* chan      = cd->chan;
+    DctCoderChannelData*       dcddata   = &(cd->_dctData);
+    int                        pixelSize = chan->bytes_per_element;
+    int                        row       = 0;
 
-                {
-                    int    row = 0;
-                    size_t dstScanlineSize =
-                        (size_t) chan->width * (size_t) pixelSize;
+    for (int y = me->_min[1]; y <= me->_max[1]; ++y)
+    {
+        uint8_t* dst;
+        if ((y % chan->y_samples) != 0) continue;
 
-                    for (int y = me->_min[1]; y <= me->_max[1]; ++y)
-                    {
-                        if ((y % chan->y_samples) != 0) continue;
-
-                        //
-                        // sanity check for buffer data lying within range
-                        //
-                        if ((cd->planarUncBufferEnd +
-                             (size_t) (dstScanlineSize)) >
-                            (me->_planarUncBuffer[UNKNOWN] +
-                             me->_planarUncBufferSize[UNKNOWN]))
-                        {
-                            return EXR_ERR_CORRUPT_CHUNK;
-                        }
+        dst = dcddata->_rows[row];
 
-                        memcpy (
-                            dcddata->_rows[row],
-                            cd->planarUncBufferEnd,
-                            dstScanlineSize);
+        if (pixelSize == 2)
+        {
+            interleaveByte2 (
+                dst, cd->planarUncRleEnd[0], cd->planarUncRleEnd[1], chan->width);
 
-                        cd->planarUncBufferEnd += dstScanlineSize;
-                        row++;
-                    }
+            cd->planarUncRleEnd[0] += chan->width;
+            cd->planarUncRleEnd[1] += chan->width;
+        }
+        else
+        {
+            for (int x = 0; x < chan->width; ++x)
+            {
+                for (int byte = 0; byte < pixelSize; ++byte)
+                {
+                    *dst++ = *cd->planarUncRleEnd[byte]++;
                 }
+            }
+        }
 
-                break;
+        row++;
+    }
 
-            case NUM_COMPRESSOR_SCHEMES:
-            default: return EXR_ERR_CORRUPT_CHUNK; break;
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+//
+// In the UNKNOWN case, data is already in planarUncBufferEnd
+// and just needs to copied over to the output buffer
+//
+
+exr_result_t
+DwaCompressor_copyUnknownChannel (DwaCompressor* me, ChannelData* cd)
+{
+    exr_coding_channel_info_t* chan      = cd->chan;
+    DctCoderChannelData*       dcddata   = &(cd->_dctData);
+    int                        pixelSize = chan->bytes_per_element;
+    int                        row       = 0;
+    size_t dstScanlineSize = (size_t) chan->width * (size_t) pixelSize;
+
+    for (int y = me->_min[1]; y <= me->_max[1]; ++y)
+    {
+        if ((y % chan->y_samples) != 0) continue;
+
+        //
+        // sanity check for buffer data lying within range
+        //
+        if ((cd->planarUncBufferEnd + (size_t) (dstScanlineSize)) >
+            (me->_planarUncBuffer[UNKNOWN] + me->_planarUncBufferSize[UNKNOWN]))
+        {
+            return EXR_ERR_CORRUPT_CHUNK;
         }
 
-        cd->processed = 1;
+        memcpy (dcddata->_rows[row], cd->planarUncBufferEnd, dstScanlineSize);
+
+        cd->planarUncBufferEnd += dstScanlineSize;
+        row++;
     }
 
-    return rv;
+    return EXR_ERR_SUCCESS;
 }
 
 /**************************************/
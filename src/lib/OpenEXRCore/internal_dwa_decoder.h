@@ -91,6 +91,26 @@ static exr_result_t LossyDctDecoderCsc_construct (
 static exr_result_t LossyDctDecoder_execute (
     void* (*alloc_fn) (size_t), void (*free_fn) (void*), LossyDctDecoder* d);
 
+//
+// Decode only the rows of blocks [blockyBegin, blockyEnd), with
+// _packedAc pointing at the AC components of the first of them.
+// Different rows of blocks of the same channels can be decoded
+// at the same time, by different decoders.
+//
+static exr_result_t LossyDctDecoder_executeRows (
+    void* (*alloc_fn) (size_t),
+    void (*free_fn) (void*),
+    LossyDctDecoder* d,
+    int              blockyBegin,
+    int              blockyEnd);
+
+//
+// Advance currAcComp past the packed AC components of blockCount
+// blocks, without decoding them.
+//
+static exr_result_t LossyDctDecoder_skipAc (
+    uint16_t** currAcComp, uint16_t* packedAcEnd, uint64_t blockCount);
+
 //
 // Un-RLE the packed AC components into
 // a half buffer. The half block should
@@ -218,6 +238,28 @@ LossyDctDecoder_base_construct (
 exr_result_t
 LossyDctDecoder_execute (
     void* (*alloc_fn) (size_t), void (*free_fn) (void*), LossyDctDecoder* d)
+{
+    int numComp    = d->_channel_decode_data_count;
+    int numBlocksX = (d->_width + 7) / 8;
+    int numBlocksY = (d->_height + 7) / 8;
+
+    if (d->_remDcCount < ((uint64_t)numComp * (uint64_t)numBlocksX * (uint64_t)numBlocksY))
+    {
+        return EXR_ERR_CORRUPT_CHUNK;
+    }
+
+    return LossyDctDecoder_executeRows (alloc_fn, free_fn, d, 0, numBlocksY);
+}
+
+/**************************************/
+
+exr_result_t
+LossyDctDecoder_executeRows (
+    void* (*alloc_fn) (size_t),
+    void (*free_fn) (void*),
+    LossyDctDecoder* d,
+    int              blockyBegin,
+    int              blockyEnd)
 {
     exr_result_t         rv;
     int                  numComp = d->_channel_decode_data_count;
@@ -227,6 +269,7 @@ LossyDctDecoder_execute (
     int                  numBlocksY = (d->_height + 7) / 8;
     int                  leftoverX  = d->_width - (numBlocksX - 1) * 8;
     int                  leftoverY  = d->_height - (numBlocksY - 1) * 8;
+    int                  endY;
 
     int numFullBlocksX = d->_width / 8;
 
@@ -236,10 +279,14 @@ LossyDctDecoder_execute (
     uint8_t*  rowBlockHandle;
     uint16_t* rowBlock[3];
 
-    if (d->_remDcCount < ((uint64_t)numComp * (uint64_t)numBlocksX * (uint64_t)numBlocksY))
-    {
-        return EXR_ERR_CORRUPT_CHUNK;
-    }
+    //
+    // Per block scratch, kept here rather than in the channel data
+    // so that decoders working on other rows of the same channels
+    // do not get in the way.
+    //
+
+    EXR_DCT_ALIGN float    dctBlock[3][64];
+    EXR_DCT_ALIGN uint16_t halfZigBlock[3][64];
 
     for (int chan = 0; chan < numComp; ++chan)
     {
@@ -273,11 +320,11 @@ LossyDctDecoder_execute (
     // one component per block, so we can computed offsets.
     //
 
-    currDcComp[0] = (uint16_t*) d->_packedDc;
+    currDcComp[0] = (uint16_t*) d->_packedDc + blockyBegin * numBlocksX;
     for (int comp = 1; comp < numComp; ++comp)
         currDcComp[comp] = currDcComp[comp - 1] + numBlocksX * numBlocksY;
 
-    for (int blocky = 0; blocky < numBlocksY; ++blocky)
+    for (int blocky = blockyBegin; blocky < blockyEnd; ++blocky)
     {
         int maxY = 8, maxX = 8;
         if (blocky == numBlocksY - 1) maxY = leftoverY;
@@ -299,8 +346,8 @@ LossyDctDecoder_execute (
             //
             for (int comp = 0; comp < numComp; ++comp)
             {
-                uint16_t* halfZigData = chanData[comp]->_halfZigData;
-                float*    dctData     = chanData[comp]->_dctData;
+                uint16_t* halfZigData = halfZigBlock[comp];
+                float*    dctData     = dctBlock[comp];
                 //
                 // DC component is stored separately
                 //
@@ -425,18 +472,9 @@ LossyDctDecoder_execute (
             {
                 if (!blockIsConstant)
                 {
-                    csc709Inverse64 (
-                        chanData[0]->_dctData,
-                        chanData[1]->_dctData,
-                        chanData[2]->_dctData);
-                }
-                else
-                {
-                    csc709Inverse (
-                        chanData[0]->_dctData,
-                        chanData[1]->_dctData,
-                        chanData[2]->_dctData);
+                    csc709Inverse64 (dctBlock[0], dctBlock[1], dctBlock[2]);
                 }
+                else { csc709Inverse (dctBlock[0], dctBlock[1], dctBlock[2]); }
             }
 
             //
@@ -450,7 +488,7 @@ LossyDctDecoder_execute (
                 if (!blockIsConstant)
                 {
                     (*convertFloatToHalf64) (
-                        &rowBlock[comp][blockx * 64], chanData[comp]->_dctData);
+                        &rowBlock[comp][blockx * 64], dctBlock[comp]);
                 }
                 else
                 {
@@ -459,7 +497,7 @@ LossyDctDecoder_execute (
                     __m128i* dst = (__m128i*) &rowBlock[comp][blockx * 64];
 
                     dst[0] = _mm_set1_epi16 (
-                        (short) float_to_half (chanData[comp]->_dctData[0]));
+                        (short) float_to_half (dctBlock[comp][0]));
 
                     dst[1] = dst[0];
                     dst[2] = dst[0];
@@ -473,7 +511,7 @@ LossyDctDecoder_execute (
 
                     uint16_t* dst = &rowBlock[comp][blockx * 64];
 
-                    dst[0] = float_to_half (chanData[comp]->_dctData[0]);
+                    dst[0] = float_to_half (dctBlock[comp][0]);
 
                     for (int i = 1; i < 64; ++i)
                     {
@@ -644,12 +682,15 @@ LossyDctDecoder_execute (
     // Convert from HALF XDR back to FLOAT XDR.
     //
 
+    endY = 8 * blockyEnd;
+    if (endY > d->_height) endY = d->_height;
+
     for (int chan = 0; chan < numComp; ++chan)
     {
         if (chanData[chan]->_type != EXR_PIXEL_FLOAT) continue;
 
         /* process in place in reverse to avoid temporary buffer */
-        for (int y = 0; y < d->_height; ++y)
+        for (int y = 8 * blockyBegin; y < endY; ++y)
         {
             float*    floatXdrPtr = (float*) chanData[chan]->_rows[y];
             uint16_t* halfXdr     = (uint16_t*) floatXdrPtr;
@@ -752,3 +793,42 @@ LossyDctDecoder_unRleAc (
     *currAcComp  = acComp;
     return EXR_ERR_SUCCESS;
 }
+
+/**************************************/
+
+exr_result_t
+LossyDctDecoder_skipAc (
+    uint16_t** currAcComp, uint16_t* packedAcEnd, uint64_t blockCount)
+{
+    uint16_t* acComp = *currAcComp;
+
+    //
+    // Same walk as LossyDctDecoder_unRleAc, only counting
+    //
+
+    for (uint64_t b = 0; b < blockCount; ++b)
+    {
+        int dctComp = 1;
+
+        while (dctComp < 64)
+        {
+            uint16_t val;
+            int      step;
+
+            if (acComp >= packedAcEnd) { return EXR_ERR_CORRUPT_CHUNK; }
+            val = *acComp++;
+
+            //
+            // Written to compile without branches, as which of these
+            // comes next is hard to predict
+            //
+
+            step = ((val >> 8) == 0xff) ? (val & 0xff) : 1;
+            step = (val == 0xff00) ? 64 : step;
+            dctComp += step;
+        }
+    }
+
+    *currAcComp = acComp;
+    return EXR_ERR_SUCCESS;
+}
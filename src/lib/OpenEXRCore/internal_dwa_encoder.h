@@ -218,82 +218,6 @@ LossyDctEncoderCsc_construct (
 
 /**************************************/
 
-//
-// Reorder from zig-zag order to normal ordering
-//
-static void
-toZigZag (uint16_t* dst, uint16_t* src)
-{
-    static const int remap[] = {
-        0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
-        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
-        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
-        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
-
-    for (int i = 0; i < 64; ++i)
-        dst[i] = src[remap[i]];
-}
-
-//
-// Precomputing the bit count runs faster than using
-// the builtin instruction, at least in one case..
-//
-// Precomputing 8-bits is no slower than 16-bits,
-// and saves a fair bit of overhead..
-//
-static inline int
-countSetBits (uint16_t src)
-{
-    static const uint16_t numBitsSet[256] = {
-        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4,
-        2, 3, 3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 1, 2, 2, 3, 2, 3, 3, 4,
-        2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
-        4, 5, 5, 6, 5, 6, 6, 7, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5,
-        3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
-        4, 5, 5, 6, 5, 6, 6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
-
-    return numBitsSet[src & 0xff] + numBitsSet[src >> 8];
-}
-
-//
-// Take a DCT coefficient, as well as an acceptable error. Search
-// nearby values within the error tolerance, that have fewer
-// bits set.
-//
-// The list of candidates has been pre-computed and sorted
-// in order of increasing numbers of bits set. This way, we
-// can stop searching as soon as we find a candidate that
-// is within the error tolerance.
-//
-static inline uint16_t
-quantize (float dctval, float errorTolerance)
-{
-    uint16_t tmp;
-    // pre-quantize float -> half and back
-    uint16_t src      = float_to_half (dctval);
-    float    srcFloat = half_to_float (src);
-
-    int             numSetBits = countSetBits (src);
-    const uint16_t* closest    = closestData + closestDataOffset[src];
-
-    for (int targetNumSetBits = numSetBits - 1; targetNumSetBits >= 0;
-         --targetNumSetBits)
-    {
-        tmp = *closest;
-
-        if (fabsf (half_to_float (tmp) - srcFloat) < errorTolerance) return tmp;
-
-        closest++;
-    }
-
-    return src;
-}
-
 /**************************************/
 
 //
@@ -314,7 +238,7 @@ LossyDctEncoder_execute (
     int numBlocksY = (int) (ceilf ((float) e->_height / 8.0f));
 
     uint16_t halfZigCoef[64];
-    uint16_t halfCoef[64];
+    uint16_t halfBlock[64];
 
     uint16_t* currAcComp            = (uint16_t*) e->_packedAc;
     int       tmpHalfBufferElements = 0;
@@ -358,19 +282,7 @@ LossyDctEncoder_execute (
         {
             const float* srcXdr = (const float*) chanData[chan]->_rows[y];
 
-            for (int x = 0; x < e->_width; ++x)
-            {
-                //
-                // Clamp to half ranges, instead of just casting. This
-                // avoids introducing Infs which end up getting zeroed later
-                //
-                float src = one_to_native_float (srcXdr[x]);
-                if (src > 65504.f)
-                    src = 65504.f;
-                else if (src < -65504.f)
-                    src = -65504.f;
-                tmpHalfBufferPtr[x] = one_from_native16 (float_to_half (src));
-            }
+            convertFloatToHalfRow (tmpHalfBufferPtr, srcXdr, e->_width);
 
             chanData[chan]->_rows[y] = (uint8_t*) tmpHalfBufferPtr;
             tmpHalfBufferPtr += e->_width;
@@ -394,6 +306,8 @@ LossyDctEncoder_execute (
         {
             uint16_t     h;
             const float* quantTable;
+            int          inside = 8 * blockx + 8 <= e->_width &&
+                         8 * blocky + 8 <= e->_height;
 
             for (int chan = 0; chan < numComp; ++chan)
             {
@@ -410,7 +324,25 @@ LossyDctEncoder_execute (
                 // we'll need to explicitly do it.
                 //
 
-                for (int y = 0; y < 8; ++y)
+                for (int y = 0; y < 8 && inside; ++y)
+                {
+                    const uint16_t* row =
+                        (const uint16_t*) chanData[chan]->_rows[8 * blocky + y];
+
+                    row += 8 * blockx;
+
+                    for (int x = 0; x < 8; ++x)
+                    {
+                        h = row[x];
+
+                        if (e->_toNonlinear) { h = e->_toNonlinear[h]; }
+                        else { h = one_to_native16 (h); }
+
+                        halfBlock[y * 8 + x] = h;
+                    } // x
+                }     // y
+
+                for (int y = 0; y < 8 && !inside; ++y)
                 {
                     for (int x = 0; x < 8; ++x)
                     {
@@ -432,10 +364,12 @@ LossyDctEncoder_execute (
                         if (e->_toNonlinear) { h = e->_toNonlinear[h]; }
                         else { h = one_to_native16 (h); }
 
-                        chanData[chan]->_dctData[y * 8 + x] = half_to_float (h);
+                        halfBlock[y * 8 + x] = h;
                     } // x
                 }     // y
-            }         // chan
+
+                convertHalfToFloat64 (chanData[chan]->_dctData, halfBlock);
+            } // chan
 
             //
             // Color space conversion
@@ -461,13 +395,8 @@ LossyDctEncoder_execute (
                 // Quantize to half, and zigzag
                 //
 
-                for (int i = 0; i < 64; ++i)
-                {
-                    halfCoef[i] =
-                        quantize (chanData[chan]->_dctData[i], quantTable[i]);
-                }
-
-                toZigZag (halfZigCoef, halfCoef);
+                quantizeZigZag64 (
+                    halfZigCoef, chanData[chan]->_dctData, quantTable);
 
                 //
                 // Convert from NATIVE back to XDR, before we write out
@@ -43,6 +43,29 @@
 #    endif /* __LP64__ */
 #endif     /* OPENEXR_IMF_HAVE_GCC_INLINE_ASM_AVX */
 
+//
+// The AVX2 and AVX-512 versions are compiled with target attributes,
+// so the rest of the library keeps building for the x86_64 baseline,
+// and picked in initializeFuncs() from the cpuid bits.
+//
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    if defined(__GNUC__) || defined(__clang__)
+#        define IMF_HAVE_X86_DISPATCH 1
+#        define IMF_TARGET_F16C __attribute__ ((target ("avx,f16c")))
+#        define IMF_TARGET_AVX2 __attribute__ ((target ("avx2,f16c")))
+#        define IMF_TARGET_AVX512                                              \
+            __attribute__ ((target ("avx512f,avx512bw,avx2,f16c")))
+#        include <immintrin.h>
+#    elif defined(_MSC_VER)
+#        define IMF_HAVE_X86_DISPATCH 1
+#        define IMF_TARGET_F16C
+#        define IMF_TARGET_AVX2
+#        define IMF_TARGET_AVX512
+#        include <immintrin.h>
+#    endif
+#endif
+
 #define _SSE_ALIGNMENT 32
 #define _SSE_ALIGNMENT_MASK 0x0F
 #define _AVX_ALIGNMENT_MASK 0x1F
@@ -90,8 +113,8 @@ csc709Inverse (float* comp0, float* comp1, float* comp2)
 // No scaling or offsets, just the matrix
 //
 
-static inline void
-csc709Inverse64 (float* comp0, float* comp1, float* comp2)
+static void
+csc709Inverse64_scalar (float* comp0, float* comp1, float* comp2)
 {
     for (int i = 0; i < 64; ++i)
         csc709Inverse (comp0 + i, comp1 + i, comp2 + i);
@@ -103,8 +126,8 @@ csc709Inverse64 (float* comp0, float* comp1, float* comp2)
 // SSE2 color space conversion
 //
 
-static inline void
-csc709Inverse64 (float* comp0, float* comp1, float* comp2)
+static void
+csc709Inverse64_sse2 (float* comp0, float* comp1, float* comp2)
 {
     __m128 c0 = {1.5747f, 1.5747f, 1.5747f, 1.5747f};
     __m128 c1 = {1.8556f, 1.8556f, 1.8556f, 1.8556f};
@@ -154,6 +177,39 @@ csc709Inverse64 (float* comp0, float* comp1, float* comp2)
 
 #endif /* IMF_HAVE_SSE2 */
 
+#ifdef IMF_HAVE_X86_DISPATCH
+
+//
+// AVX2 color space conversion, the same operations as the SSE2
+// version, 8 values at a time
+//
+
+IMF_TARGET_AVX2 static void
+csc709Inverse64_avx2 (float* comp0, float* comp1, float* comp2)
+{
+    const __m256 c0 = _mm256_set1_ps (1.5747f);
+    const __m256 c1 = _mm256_set1_ps (1.8556f);
+    const __m256 c2 = _mm256_set1_ps (-0.1873f);
+    const __m256 c3 = _mm256_set1_ps (-0.4682f);
+
+    for (int i = 0; i < 64; i += 8)
+    {
+        __m256 y  = _mm256_loadu_ps (comp0 + i);
+        __m256 cb = _mm256_loadu_ps (comp1 + i);
+        __m256 cr = _mm256_loadu_ps (comp2 + i);
+
+        _mm256_storeu_ps (comp0 + i, _mm256_add_ps (y, _mm256_mul_ps (cr, c0)));
+        _mm256_storeu_ps (
+            comp1 + i,
+            _mm256_add_ps (
+                _mm256_add_ps (_mm256_mul_ps (cb, c2), y),
+                _mm256_mul_ps (cr, c3)));
+        _mm256_storeu_ps (comp2 + i, _mm256_add_ps (_mm256_mul_ps (c1, cb), y));
+    }
+}
+
+#endif /* IMF_HAVE_X86_DISPATCH */
+
 //
 // Color space conversion, Forward 709 CSC, R'G'B' -> Y'CbCr
 //
@@ -161,8 +217,8 @@ csc709Inverse64 (float* comp0, float* comp1, float* comp2)
 // primary chromaticies, with no scaling or offsets.
 //
 
-static inline void
-csc709Forward64 (float* comp0, float* comp1, float* comp2)
+static void
+csc709Forward64_scalar (float* comp0, float* comp1, float* comp2)
 {
     float src[3];
 
@@ -178,6 +234,51 @@ csc709Forward64 (float* comp0, float* comp1, float* comp2)
     }
 }
 
+#ifdef IMF_HAVE_X86_DISPATCH
+
+//
+// AVX2 version, evaluated in the same order as the scalar one
+// so the results match to the bit
+//
+
+IMF_TARGET_AVX2 static void
+csc709Forward64_avx2 (float* comp0, float* comp1, float* comp2)
+{
+    const __m256 y0  = _mm256_set1_ps (0.2126f);
+    const __m256 y1  = _mm256_set1_ps (0.7152f);
+    const __m256 y2  = _mm256_set1_ps (0.0722f);
+    const __m256 cb0 = _mm256_set1_ps (-0.1146f);
+    const __m256 cb1 = _mm256_set1_ps (0.3854f);
+    const __m256 cr1 = _mm256_set1_ps (0.4542f);
+    const __m256 cr2 = _mm256_set1_ps (0.0458f);
+    const __m256 hlf = _mm256_set1_ps (0.5000f);
+
+    for (int i = 0; i < 64; i += 8)
+    {
+        __m256 r = _mm256_loadu_ps (comp0 + i);
+        __m256 g = _mm256_loadu_ps (comp1 + i);
+        __m256 b = _mm256_loadu_ps (comp2 + i);
+
+        _mm256_storeu_ps (
+            comp0 + i,
+            _mm256_add_ps (
+                _mm256_add_ps (_mm256_mul_ps (y0, r), _mm256_mul_ps (y1, g)),
+                _mm256_mul_ps (y2, b)));
+        _mm256_storeu_ps (
+            comp1 + i,
+            _mm256_add_ps (
+                _mm256_sub_ps (_mm256_mul_ps (cb0, r), _mm256_mul_ps (cb1, g)),
+                _mm256_mul_ps (hlf, b)));
+        _mm256_storeu_ps (
+            comp2 + i,
+            _mm256_sub_ps (
+                _mm256_sub_ps (_mm256_mul_ps (hlf, r), _mm256_mul_ps (cr1, g)),
+                _mm256_mul_ps (cr2, b)));
+    }
+}
+
+#endif /* IMF_HAVE_X86_DISPATCH */
+
 //
 // Byte interleaving of 2 byte arrays:
 //    src0 = AAAA
@@ -1883,7 +1984,7 @@ dctInverse8x8_avx_7 (float* data)
 //
 
 static void
-dctForward8x8 (float* data)
+dctForward8x8_scalar (float* data)
 {
     float A0, A1, A2, A3, A4, A5, A6, A7;
     float K0, K1, rot_x, rot_y;
@@ -2065,7 +2166,7 @@ dctForward8x8 (float* data)
 //
 
 static void
-dctForward8x8 (float* data)
+dctForward8x8_sse2 (float* data)
 {
     __m128* srcVec = (__m128*) data;
     __m128  a0Vec, a1Vec, a2Vec, a3Vec, a4Vec, a5Vec, a6Vec, a7Vec;
@@ -2266,6 +2367,456 @@ dctForward8x8 (float* data)
 
 #endif /* IMF_HAVE_SSE2 */
 
+#ifdef IMF_HAVE_X86_DISPATCH
+
+//
+// AVX2 implementation
+//
+// The SSE2 version on all 8 columns at once: a column pass,
+// an 8x8 transpose, and again. The arithmetic is the same, so
+// the coefficients match the SSE2 ones exactly.
+//
+
+IMF_TARGET_AVX2 static inline void
+dctForward8x8_avx2_transpose (__m256* row)
+{
+    __m256 t0, t1, t2, t3, t4, t5, t6, t7;
+    __m256 u0, u1, u2, u3, u4, u5, u6, u7;
+
+    t0 = _mm256_unpacklo_ps (row[0], row[1]);
+    t1 = _mm256_unpackhi_ps (row[0], row[1]);
+    t2 = _mm256_unpacklo_ps (row[2], row[3]);
+    t3 = _mm256_unpackhi_ps (row[2], row[3]);
+    t4 = _mm256_unpacklo_ps (row[4], row[5]);
+    t5 = _mm256_unpackhi_ps (row[4], row[5]);
+    t6 = _mm256_unpacklo_ps (row[6], row[7]);
+    t7 = _mm256_unpackhi_ps (row[6], row[7]);
+
+    u0 = _mm256_shuffle_ps (t0, t2, 0x44);
+    u1 = _mm256_shuffle_ps (t0, t2, 0xEE);
+    u2 = _mm256_shuffle_ps (t1, t3, 0x44);
+    u3 = _mm256_shuffle_ps (t1, t3, 0xEE);
+    u4 = _mm256_shuffle_ps (t4, t6, 0x44);
+    u5 = _mm256_shuffle_ps (t4, t6, 0xEE);
+    u6 = _mm256_shuffle_ps (t5, t7, 0x44);
+    u7 = _mm256_shuffle_ps (t5, t7, 0xEE);
+
+    row[0] = _mm256_permute2f128_ps (u0, u4, 0x20);
+    row[1] = _mm256_permute2f128_ps (u1, u5, 0x20);
+    row[2] = _mm256_permute2f128_ps (u2, u6, 0x20);
+    row[3] = _mm256_permute2f128_ps (u3, u7, 0x20);
+    row[4] = _mm256_permute2f128_ps (u0, u4, 0x31);
+    row[5] = _mm256_permute2f128_ps (u1, u5, 0x31);
+    row[6] = _mm256_permute2f128_ps (u2, u6, 0x31);
+    row[7] = _mm256_permute2f128_ps (u3, u7, 0x31);
+}
+
+IMF_TARGET_AVX2 static void
+dctForward8x8_avx2 (float* data)
+{
+    const __m256 c4Vec    = _mm256_set1_ps (.70710678f);
+    const __m256 c4NegVec = _mm256_set1_ps (-.70710678f);
+    const __m256 c1Half   = _mm256_set1_ps (.490392640f);
+    const __m256 c2Half   = _mm256_set1_ps (.461939770f);
+    const __m256 c3Half   = _mm256_set1_ps (.415734810f);
+    const __m256 c5Half   = _mm256_set1_ps (.277785120f);
+    const __m256 c6Half   = _mm256_set1_ps (.191341720f);
+    const __m256 c7Half   = _mm256_set1_ps (.097545161f);
+    const __m256 halfVec  = _mm256_set1_ps (.5f);
+
+    __m256 row[8];
+    __m256 a0, a1, a2, a3, a4, a5, a6, a7;
+    __m256 k0, k1, rotX, rotY;
+
+    for (int i = 0; i < 8; ++i)
+        row[i] = _mm256_loadu_ps (data + 8 * i);
+
+    for (int iter = 0; iter < 2; ++iter)
+    {
+        a0 = _mm256_add_ps (row[0], row[7]);
+        a1 = _mm256_add_ps (row[1], row[2]);
+        a3 = _mm256_add_ps (row[3], row[4]);
+        a5 = _mm256_add_ps (row[5], row[6]);
+
+        a7 = _mm256_sub_ps (row[0], row[7]);
+        a2 = _mm256_sub_ps (row[1], row[2]);
+        a4 = _mm256_sub_ps (row[3], row[4]);
+        a6 = _mm256_sub_ps (row[5], row[6]);
+
+        k0 = _mm256_mul_ps (c4Vec, _mm256_add_ps (a0, a3));
+        k1 = _mm256_mul_ps (c4Vec, _mm256_add_ps (a1, a5));
+
+        row[0] = _mm256_mul_ps (_mm256_add_ps (k0, k1), halfVec);
+        row[4] = _mm256_mul_ps (_mm256_sub_ps (k0, k1), halfVec);
+
+        k0 = _mm256_sub_ps (a2, a6);
+        k1 = _mm256_sub_ps (a0, a3);
+
+        row[2] = _mm256_add_ps (
+            _mm256_mul_ps (c6Half, k0), _mm256_mul_ps (c2Half, k1));
+        row[6] = _mm256_sub_ps (
+            _mm256_mul_ps (c6Half, k1), _mm256_mul_ps (c2Half, k0));
+
+        k0 = _mm256_mul_ps (_mm256_sub_ps (a1, a5), c4Vec);
+        k1 = _mm256_mul_ps (_mm256_add_ps (a2, a6), c4NegVec);
+
+        rotX = _mm256_sub_ps (a7, k0);
+        rotY = _mm256_add_ps (a4, k1);
+
+        row[3] = _mm256_sub_ps (
+            _mm256_mul_ps (c3Half, rotX), _mm256_mul_ps (c5Half, rotY));
+        row[5] = _mm256_add_ps (
+            _mm256_mul_ps (c5Half, rotX), _mm256_mul_ps (c3Half, rotY));
+
+        rotX = _mm256_add_ps (a7, k0);
+        rotY = _mm256_sub_ps (k1, a4);
+
+        row[1] = _mm256_sub_ps (
+            _mm256_mul_ps (c1Half, rotX), _mm256_mul_ps (c7Half, rotY));
+        row[7] = _mm256_add_ps (
+            _mm256_mul_ps (c7Half, rotX), _mm256_mul_ps (c1Half, rotY));
+
+        dctForward8x8_avx2_transpose (row);
+    }
+
+    for (int i = 0; i < 8; ++i)
+        _mm256_storeu_ps (data + 8 * i, row[i]);
+}
+
+#endif /* IMF_HAVE_X86_DISPATCH */
+
+/**************************************/
+
+//
+// Quantization of the forward DCT coefficients to half, and the
+// reorder into zig-zag order, for the encoder
+//
+
+//
+// Reorder from zig-zag order to normal ordering
+//
+static const int zigZagRemap[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6,  7,  14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+static void
+toZigZag (uint16_t* dst, uint16_t* src)
+{
+    for (int i = 0; i < 64; ++i)
+        dst[i] = src[zigZagRemap[i]];
+}
+
+//
+// Precomputing the bit count runs faster than using
+// the builtin instruction, at least in one case..
+//
+// Precomputing 8-bits is no slower than 16-bits,
+// and saves a fair bit of overhead..
+//
+static inline int
+countSetBits (uint16_t src)
+{
+    static const uint16_t numBitsSet[256] = {
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4,
+        2, 3, 3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 1, 2, 2, 3, 2, 3, 3, 4,
+        2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
+        4, 5, 5, 6, 5, 6, 6, 7, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5,
+        3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6,
+        4, 5, 5, 6, 5, 6, 6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+        4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
+
+    return numBitsSet[src & 0xff] + numBitsSet[src >> 8];
+}
+
+//
+// Take a DCT coefficient, as well as an acceptable error. Search
+// nearby values within the error tolerance, that have fewer
+// bits set.
+//
+// The list of candidates has been pre-computed and sorted
+// in order of increasing numbers of bits set. This way, we
+// can stop searching as soon as we find a candidate that
+// is within the error tolerance.
+//
+static inline uint16_t
+quantize (float dctval, float errorTolerance)
+{
+    uint16_t tmp;
+    // pre-quantize float -> half and back
+    uint16_t src      = float_to_half (dctval);
+    float    srcFloat = half_to_float (src);
+
+    int             numSetBits = countSetBits (src);
+    const uint16_t* closest    = closestData + closestDataOffset[src];
+
+    for (int targetNumSetBits = numSetBits - 1; targetNumSetBits >= 0;
+         --targetNumSetBits)
+    {
+        tmp = *closest;
+
+        if (fabsf (half_to_float (tmp) - srcFloat) < errorTolerance) return tmp;
+
+        closest++;
+    }
+
+    return src;
+}
+
+static void
+quantizeZigZag64_scalar (
+    uint16_t* dst, const float* src, const float* quantTable)
+{
+    uint16_t halfCoef[64];
+
+    for (int i = 0; i < 64; ++i)
+        halfCoef[i] = quantize (src[i], quantTable[i]);
+
+    toZigZag (dst, halfCoef);
+}
+
+#ifdef IMF_HAVE_X86_DISPATCH
+
+//
+// The vector versions quantize 8 (AVX2) or 16 (AVX-512) coefficients
+// at a time, fetched straight in zig-zag order. Each lane walks its
+// list of candidates like the scalar loop, until every lane found
+// one within its error tolerance or ran out of candidates, so the
+// results are the same.
+//
+// The candidates are 16 bits, gathered as 32-bit words and masked.
+// The last entry of closestData is broadcast instead, so the gather
+// never reads past the end of the table.
+//
+
+#define QUANTIZE_LAST_CANDIDATE                                                \
+    ((int) (sizeof (closestData) / sizeof (closestData[0])) - 1)
+
+IMF_TARGET_AVX2 static void
+quantizeZigZag64_avx2 (uint16_t* dst, const float* src, const float* quantTable)
+{
+    const __m256i nibbleBits = _mm256_setr_epi8 (
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8 (0x0f);
+    const __m256i lastIdx   = _mm256_set1_epi32 (QUANTIZE_LAST_CANDIDATE);
+    const __m256i lastCand =
+        _mm256_set1_epi32 (closestData[QUANTIZE_LAST_CANDIDATE]);
+    const __m256i low16   = _mm256_set1_epi32 (0xffff);
+    const __m256i one     = _mm256_set1_epi32 (1);
+    const __m256  absMask =
+        _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff));
+
+    for (int i = 0; i < 64; i += 8)
+    {
+        __m256i zig = _mm256_loadu_si256 ((const __m256i*) (zigZagRemap + i));
+        __m256  tol = _mm256_i32gather_ps (quantTable, zig, 4);
+        __m128i h   = _mm256_cvtps_ph (
+            _mm256_i32gather_ps (src, zig, 4), _MM_FROUND_TO_NEAREST_INT);
+        __m256  hFloat = _mm256_cvtph_ps (h);
+        __m256i h32    = _mm256_cvtepu16_epi32 (h);
+        __m256i offset =
+            _mm256_i32gather_epi32 ((const int*) closestDataOffset, h32, 4);
+        __m256i result = h32;
+        __m256i k      = _mm256_setzero_si256 ();
+        __m256i numBits, pending;
+
+        numBits = _mm256_add_epi8 (
+            _mm256_shuffle_epi8 (nibbleBits, _mm256_and_si256 (h32, lowNibble)),
+            _mm256_shuffle_epi8 (
+                nibbleBits,
+                _mm256_and_si256 (_mm256_srli_epi16 (h32, 4), lowNibble)));
+        numBits = _mm256_madd_epi16 (
+            _mm256_maddubs_epi16 (numBits, _mm256_set1_epi8 (1)),
+            _mm256_set1_epi16 (1));
+
+        pending = _mm256_cmpgt_epi32 (numBits, k);
+
+        while (!_mm256_testz_si256 (pending, pending))
+        {
+            __m256i idx  = _mm256_add_epi32 (offset, k);
+            __m256i mask = _mm256_andnot_si256 (
+                _mm256_cmpeq_epi32 (idx, lastIdx), pending);
+            __m256i cand = _mm256_and_si256 (
+                _mm256_mask_i32gather_epi32 (
+                    lastCand, (const int*) closestData, idx, mask, 2),
+                low16);
+            __m256 diff = _mm256_and_ps (
+                _mm256_sub_ps (
+                    _mm256_cvtph_ps (_mm_packus_epi32 (
+                        _mm256_castsi256_si128 (cand),
+                        _mm256_extracti128_si256 (cand, 1))),
+                    hFloat),
+                absMask);
+            __m256i found = _mm256_and_si256 (
+                _mm256_castps_si256 (_mm256_cmp_ps (diff, tol, _CMP_LT_OQ)),
+                pending);
+
+            result  = _mm256_blendv_epi8 (result, cand, found);
+            k       = _mm256_add_epi32 (k, one);
+            pending = _mm256_and_si256 (
+                _mm256_andnot_si256 (found, pending),
+                _mm256_cmpgt_epi32 (numBits, k));
+        }
+
+        _mm_storeu_si128 (
+            (__m128i*) (dst + i),
+            _mm_packus_epi32 (
+                _mm256_castsi256_si128 (result),
+                _mm256_extracti128_si256 (result, 1)));
+    }
+}
+
+IMF_TARGET_AVX512 static void
+quantizeZigZag64_avx512 (
+    uint16_t* dst, const float* src, const float* quantTable)
+{
+    const __m512i nibbleBits = _mm512_broadcast_i32x4 (_mm_setr_epi8 (
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+    const __m512i lowNibble = _mm512_set1_epi8 (0x0f);
+    const __m512i lastIdx   = _mm512_set1_epi32 (QUANTIZE_LAST_CANDIDATE);
+    const __m512i lastCand =
+        _mm512_set1_epi32 (closestData[QUANTIZE_LAST_CANDIDATE]);
+    const __m512i low16 = _mm512_set1_epi32 (0xffff);
+    const __m512i one   = _mm512_set1_epi32 (1);
+
+    for (int i = 0; i < 64; i += 16)
+    {
+        __m512i zig = _mm512_loadu_si512 ((const void*) (zigZagRemap + i));
+        __m512  tol = _mm512_i32gather_ps (zig, quantTable, 4);
+        __m256i h   = _mm512_cvtps_ph (
+            _mm512_i32gather_ps (zig, src, 4), _MM_FROUND_TO_NEAREST_INT);
+        __m512  hFloat = _mm512_cvtph_ps (h);
+        __m512i h32    = _mm512_cvtepu16_epi32 (h);
+        __m512i offset =
+            _mm512_i32gather_epi32 (h32, (const void*) closestDataOffset, 4);
+        __m512i   result = h32;
+        __m512i   k      = _mm512_setzero_si512 ();
+        __m512i   numBits;
+        __mmask16 pending;
+
+        numBits = _mm512_add_epi8 (
+            _mm512_shuffle_epi8 (nibbleBits, _mm512_and_si512 (h32, lowNibble)),
+            _mm512_shuffle_epi8 (
+                nibbleBits,
+                _mm512_and_si512 (_mm512_srli_epi16 (h32, 4), lowNibble)));
+        numBits = _mm512_madd_epi16 (
+            _mm512_maddubs_epi16 (numBits, _mm512_set1_epi8 (1)),
+            _mm512_set1_epi16 (1));
+
+        pending = _mm512_cmpgt_epi32_mask (numBits, k);
+
+        while (pending)
+        {
+            __m512i   idx  = _mm512_add_epi32 (offset, k);
+            __mmask16 mask = pending & ~_mm512_cmpeq_epi32_mask (idx, lastIdx);
+            __m512i   cand = _mm512_and_si512 (
+                _mm512_mask_i32gather_epi32 (
+                    lastCand, mask, idx, (const void*) closestData, 2),
+                low16);
+            __mmask16 found = _mm512_mask_cmp_ps_mask (
+                pending,
+                _mm512_abs_ps (_mm512_sub_ps (
+                    _mm512_cvtph_ps (_mm512_cvtepi32_epi16 (cand)), hFloat)),
+                tol,
+                _CMP_LT_OQ);
+
+            result  = _mm512_mask_mov_epi32 (result, found, cand);
+            k       = _mm512_add_epi32 (k, one);
+            pending = (__mmask16) (pending & ~found) &
+                      _mm512_cmpgt_epi32_mask (numBits, k);
+        }
+
+        _mm256_storeu_si256 (
+            (__m256i*) (dst + i), _mm512_cvtepi32_epi16 (result));
+    }
+}
+
+#undef QUANTIZE_LAST_CANDIDATE
+
+#endif /* IMF_HAVE_X86_DISPATCH */
+
+//
+// Half -> float conversion of an 8x8 block of source pixels,
+// and the clamped float -> half conversion of FLOAT source
+// scan lines (XDR in and out), for the encoder
+//
+
+static void
+convertHalfToFloat64_scalar (float* dst, const uint16_t* src)
+{
+    for (int i = 0; i < 64; ++i)
+        dst[i] = half_to_float (src[i]);
+}
+
+static void
+convertFloatToHalfRow_scalar (uint16_t* dst, const float* src, int n)
+{
+    for (int x = 0; x < n; ++x)
+    {
+        //
+        // Clamp to half ranges, instead of just casting. This
+        // avoids introducing Infs which end up getting zeroed later
+        //
+        float v = one_to_native_float (src[x]);
+        if (v > 65504.f)
+            v = 65504.f;
+        else if (v < -65504.f)
+            v = -65504.f;
+        dst[x] = one_from_native16 (float_to_half (v));
+    }
+}
+
+#ifdef IMF_HAVE_X86_DISPATCH
+
+IMF_TARGET_F16C static void
+convertHalfToFloat64_f16c (float* dst, const uint16_t* src)
+{
+    for (int i = 0; i < 64; i += 8)
+    {
+        __m128i h = _mm_loadu_si128 ((const __m128i*) (src + i));
+        _mm256_storeu_ps (dst + i, _mm256_cvtph_ps (h));
+    }
+}
+
+//
+// x86 is little endian, so XDR is native here. Groups holding a NaN
+// go through the scalar code, which keeps signaling NaNs as they are.
+//
+
+IMF_TARGET_F16C static void
+convertFloatToHalfRow_f16c (uint16_t* dst, const float* src, int n)
+{
+    const __m256 halfMax = _mm256_set1_ps (65504.f);
+    const __m256 halfMin = _mm256_set1_ps (-65504.f);
+    int          x       = 0;
+
+    for (; x + 8 <= n; x += 8)
+    {
+        __m256 v = _mm256_loadu_ps (src + x);
+
+        if (_mm256_movemask_ps (_mm256_cmp_ps (v, v, _CMP_UNORD_Q)))
+        {
+            convertFloatToHalfRow_scalar (dst + x, src + x, 8);
+            continue;
+        }
+
+        v = _mm256_min_ps (_mm256_max_ps (v, halfMin), halfMax);
+        _mm_storeu_si128 (
+            (__m128i*) (dst + x),
+            _mm256_cvtps_ph (v, _MM_FROUND_TO_NEAREST_INT));
+    }
+
+    convertFloatToHalfRow_scalar (dst + x, src + x, n - x);
+}
+
+#endif /* IMF_HAVE_X86_DISPATCH */
+
 /**************************************/
 
 //
@@ -2296,6 +2847,27 @@ static void (*dctInverse8x8_5) (float*) = dctInverse8x8_scalar_5;
 static void (*dctInverse8x8_6) (float*) = dctInverse8x8_scalar_6;
 static void (*dctInverse8x8_7) (float*) = dctInverse8x8_scalar_7;
 
+//
+// Dispatch the color space conversions and the encoder kernels
+//
+
+#ifdef IMF_HAVE_SSE2
+static void (*csc709Inverse64) (float*, float*, float*) = csc709Inverse64_sse2;
+static void (*dctForward8x8) (float*)                   = dctForward8x8_sse2;
+#else
+static void (*csc709Inverse64) (float*, float*, float*) =
+    csc709Inverse64_scalar;
+static void (*dctForward8x8) (float*) = dctForward8x8_scalar;
+#endif
+static void (*csc709Forward64) (float*, float*, float*) =
+    csc709Forward64_scalar;
+static void (*quantizeZigZag64) (uint16_t*, const float*, const float*) =
+    quantizeZigZag64_scalar;
+static void (*convertHalfToFloat64) (float*, const uint16_t*) =
+    convertHalfToFloat64_scalar;
+static void (*convertFloatToHalfRow) (uint16_t*, const float*, int) =
+    convertFloatToHalfRow_scalar;
+
 static void
 initializeFuncs (void)
 {
@@ -2355,5 +2927,26 @@ initializeFuncs (void)
         dctInverse8x8_6 = dctInverse8x8_sse2_6;
         dctInverse8x8_7 = dctInverse8x8_sse2_7;
     }
+
+#    ifdef IMF_HAVE_X86_DISPATCH
+    int simd = internal_exr_x86_byte_simd ();
+
+    if (avx && f16c)
+    {
+        convertHalfToFloat64  = convertHalfToFloat64_f16c;
+        convertFloatToHalfRow = convertFloatToHalfRow_f16c;
+    }
+
+    if ((simd & EXR_X86_SIMD_AVX2) && f16c)
+    {
+        csc709Inverse64  = csc709Inverse64_avx2;
+        csc709Forward64  = csc709Forward64_avx2;
+        dctForward8x8    = dctForward8x8_avx2;
+        quantizeZigZag64 = quantizeZigZag64_avx2;
+    }
+
+    if ((simd & EXR_X86_SIMD_AVX512) && f16c)
+        quantizeZigZag64 = quantizeZigZag64_avx512;
+#    endif /* IMF_HAVE_X86_DISPATCH */
 #endif
 }
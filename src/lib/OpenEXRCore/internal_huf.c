@@ -1016,10 +1016,10 @@ readUInt (const uint8_t* b)
 #    define READ64(c) _byteswap_uint64 (*(const uint64_t*) (c))
 #else
 #    define READ64(c)                                                          \
-        ((uint64_t) (c)[0] << 56) | ((uint64_t) (c)[1] << 48) |                \
-            ((uint64_t) (c)[2] << 40) | ((uint64_t) (c)[3] << 32) |            \
-            ((uint64_t) (c)[4] << 24) | ((uint64_t) (c)[5] << 16) |            \
-            ((uint64_t) (c)[6] << 8) | ((uint64_t) (c)[7])
+        (((uint64_t) (c)[0] << 56) | ((uint64_t) (c)[1] << 48) |               \
+         ((uint64_t) (c)[2] << 40) | ((uint64_t) (c)[3] << 32) |               \
+         ((uint64_t) (c)[4] << 24) | ((uint64_t) (c)[5] << 16) |               \
+         ((uint64_t) (c)[6] << 8) | ((uint64_t) (c)[7]))
 #endif
 
 typedef struct FastHufDecoder
@@ -1735,6 +1735,324 @@ fasthuf_decode (
     return EXR_ERR_SUCCESS;
 }
 
+//
+// Decoder for the multi stream layout. Rather than the refill buffers
+// above, each stream reloads 64 bits from wherever it is in its data
+// for every code, so the state of a stream is just a byte pointer and
+// a bit offset, and the work for the different streams is independent
+// enough for the cpu to overlap.  The end of each stream is copied to
+// a zero padded buffer, so the loads never read past the data.
+//
+
+#define HUF_STREAM_TAIL 24
+
+//
+// The multi stream layout cuts nRaw symbols in runs of the same
+// length, with the last one shorter (or empty)
+//
+
+static inline uint64_t
+hufStreamSymbols (uint64_t nRaw, uint32_t nStreams, uint32_t s, uint64_t* first)
+{
+    uint64_t perStream = (nRaw + nStreams - 1) / nStreams;
+
+    *first = perStream * s;
+    if (*first >= nRaw)
+    {
+        *first = nRaw;
+        return 0;
+    }
+    return (nRaw - *first < perStream) ? nRaw - *first : perStream;
+}
+
+static inline uint64_t
+fasthuf_load64 (const uint8_t* p)
+{
+    uint64_t v;
+    memcpy (&v, p, sizeof (uint64_t));
+    return READ64 ((const uint8_t*) &v);
+}
+
+typedef struct FastHufStream
+{
+    const uint8_t* p;      // byte holding the next bit of the stream
+    const uint8_t* end;    // end of the data (or of the copied tail)
+    uint32_t       bitpos; // bits of *p already consumed
+    uint16_t*      dst;
+    uint16_t*      dstStart;
+    uint16_t*      dstEnd;
+} FastHufStream;
+
+//
+// Decode one symbol (or run of symbols), given buffer, the bits loaded
+// from the current position of the stream
+//
+
+static inline exr_result_t
+fasthuf_stream_symbol (
+    const struct _internal_exr_context* pctxt,
+    const FastHufDecoder*               fhd,
+    FastHufStream*                      s,
+    uint64_t                            buffer)
+{
+    const uint8_t* p      = s->p;
+    uint32_t       bitpos = s->bitpos;
+    int            codeLen;
+    int            symbol;
+
+    if (fhd->_tableMin <= buffer)
+    {
+        int tableIdx = fhd->_lookupSymbol[buffer >> (64 - TABLE_LOOKUP_BITS)];
+
+        codeLen = tableIdx >> 24;
+        symbol  = tableIdx & 0xffffff;
+    }
+    else
+    {
+        uint64_t id;
+
+        // long codes may need all 64 bits
+        if (bitpos > 0) buffer |= ((uint64_t) p[8]) >> (8 - bitpos);
+
+        codeLen = TABLE_LOOKUP_BITS + 1;
+        while (fhd->_ljBase[codeLen] > buffer)
+            codeLen++;
+
+        if (codeLen > fhd->_maxCodeLength)
+        {
+            if (pctxt)
+                pctxt->print_error (
+                    pctxt,
+                    EXR_ERR_CORRUPT_CHUNK,
+                    "Huffman decode error (Decoded an invalid symbol)");
+            return EXR_ERR_CORRUPT_CHUNK;
+        }
+
+        id = fhd->_ljOffset[codeLen] + (buffer >> (64 - codeLen));
+        if (id >= (uint64_t) fhd->_numSymbols)
+        {
+            if (pctxt)
+                pctxt->print_error (
+                    pctxt,
+                    EXR_ERR_CORRUPT_CHUNK,
+                    "Huffman decode error (Decoded an invalid symbol)");
+            return EXR_ERR_CORRUPT_CHUNK;
+        }
+        symbol = fhd->_idToSymbol[id];
+    }
+
+    bitpos += (uint32_t) codeLen;
+    p += bitpos >> 3;
+    bitpos &= 7;
+
+    if (symbol == fhd->_rleSymbol)
+    {
+        uint16_t* dst      = s->dst;
+        int       rleCount = (int) ((fasthuf_load64 (p) << bitpos) >> 56);
+
+        if (dst == s->dstStart || rleCount <= 0 ||
+            rleCount > s->dstEnd - dst)
+        {
+            if (pctxt)
+                pctxt->print_error (
+                    pctxt,
+                    EXR_ERR_CORRUPT_CHUNK,
+                    "Huffman decode error (Invalid RLE code)");
+            return EXR_ERR_CORRUPT_CHUNK;
+        }
+
+        for (int i = 0; i < rleCount; ++i)
+            dst[i] = dst[-1];
+        s->dst = dst + rleCount;
+        ++p;
+    }
+    else { *(s->dst)++ = (uint16_t) symbol; }
+
+    s->p      = p;
+    s->bitpos = bitpos;
+    return EXR_ERR_SUCCESS;
+}
+
+//
+// At least 56 bits are valid after a load, enough for three codes from
+// the lookup table, which is what most codes are. Anything else goes
+// through the general path.
+//
+
+static inline exr_result_t
+fasthuf_stream_symbols (
+    const struct _internal_exr_context* pctxt,
+    const FastHufDecoder*               fhd,
+    FastHufStream*                      s)
+{
+    uint64_t buffer = fasthuf_load64 (s->p) << s->bitpos;
+    uint64_t bits;
+    uint32_t used;
+    int      first, second, third;
+
+    if (fhd->_tableMin > buffer || s->dstEnd - s->dst < 2)
+        return fasthuf_stream_symbol (pctxt, fhd, s, buffer);
+
+    first = fhd->_lookupSymbol[buffer >> (64 - TABLE_LOOKUP_BITS)];
+    bits  = buffer << (first >> 24);
+    if ((first & 0xffffff) == fhd->_rleSymbol || fhd->_tableMin > bits)
+        return fasthuf_stream_symbol (pctxt, fhd, s, buffer);
+
+    second = fhd->_lookupSymbol[bits >> (64 - TABLE_LOOKUP_BITS)];
+    if ((second & 0xffffff) == fhd->_rleSymbol)
+        return fasthuf_stream_symbol (pctxt, fhd, s, buffer);
+
+    s->dst[0] = (uint16_t) first;
+    s->dst[1] = (uint16_t) second;
+    s->dst += 2;
+    used = s->bitpos + (uint32_t) (first >> 24) + (uint32_t) (second >> 24);
+
+    bits <<= second >> 24;
+    if (fhd->_tableMin <= bits && s->dst < s->dstEnd)
+    {
+        third = fhd->_lookupSymbol[bits >> (64 - TABLE_LOOKUP_BITS)];
+        if ((third & 0xffffff) != fhd->_rleSymbol)
+        {
+            *(s->dst)++ = (uint16_t) third;
+            used += (uint32_t) (third >> 24);
+        }
+    }
+
+    s->p += used >> 3;
+    s->bitpos = used & 7;
+    return EXR_ERR_SUCCESS;
+}
+
+//
+// Finish a stream of nBits bits starting at src: decode from the data
+// itself while there is enough of it left to load from, then from a
+// padded copy of the rest, and check it ends exactly where it should.
+//
+
+static exr_result_t
+fasthuf_stream_finish (
+    const struct _internal_exr_context* pctxt,
+    const FastHufDecoder*               fhd,
+    FastHufStream*                      s,
+    const uint8_t*                      src,
+    uint64_t                            nBits)
+{
+    uint8_t      tail[3 * HUF_STREAM_TAIL];
+    uint64_t     used, left;
+    exr_result_t rv;
+
+    while (s->dst < s->dstEnd && s->p + HUF_STREAM_TAIL <= s->end)
+    {
+        rv = fasthuf_stream_symbols (pctxt, fhd, s);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+    }
+
+    if (s->dst < s->dstEnd)
+    {
+        used = (uint64_t) (s->p - src);
+        left = (uint64_t) (s->end - s->p);
+        memset (tail, 0, sizeof (tail));
+        memcpy (tail, s->p, left);
+        s->p   = tail;
+        s->end = tail + left;
+
+        while (s->dst < s->dstEnd && s->p <= s->end)
+        {
+            rv = fasthuf_stream_symbols (pctxt, fhd, s);
+            if (rv != EXR_ERR_SUCCESS) return rv;
+        }
+        used += (uint64_t) (s->p - tail);
+    }
+    else
+        used = (uint64_t) (s->p - src);
+
+    used = 8 * used + s->bitpos;
+    if (used != nBits || s->dst != s->dstEnd)
+    {
+        if (pctxt)
+            pctxt->print_error (
+                pctxt,
+                EXR_ERR_CORRUPT_CHUNK,
+                "Huffman decode error (%" PRIu64
+                " bits used of a stream of %" PRIu64 " bits)",
+                used,
+                nBits);
+        return EXR_ERR_CORRUPT_CHUNK;
+    }
+    return EXR_ERR_SUCCESS;
+}
+
+static exr_result_t
+fasthuf_decode_streams (
+    const struct _internal_exr_context* pctxt,
+    const FastHufDecoder*               fhd,
+    const uint8_t*                      src,
+    const uint32_t*                     nBits,
+    int                                 nStreams,
+    uint16_t*                           dst,
+    uint64_t                            nDst)
+{
+    FastHufStream  st[HUF_STREAMS];
+    const uint8_t* starts[HUF_STREAMS];
+    exr_result_t   rv;
+
+    for (int i = 0; i < nStreams; ++i)
+    {
+        uint64_t first, count;
+
+        count = hufStreamSymbols (nDst, (uint32_t) nStreams, (uint32_t) i, &first);
+
+        starts[i]    = src;
+        st[i].p      = src;
+        st[i].bitpos = 0;
+        src += ((uint64_t) nBits[i] + 7) / 8;
+        st[i].end      = src;
+        st[i].dstStart = dst + first;
+        st[i].dst      = st[i].dstStart;
+        st[i].dstEnd   = st[i].dstStart + count;
+    }
+
+    //
+    // The four streams in lock step for as long as they all have
+    // data and symbols left
+    //
+
+    if (nStreams == 4)
+    {
+        // work on copies, so the compiler can keep them in registers
+        FastHufStream s0 = st[0], s1 = st[1], s2 = st[2], s3 = st[3];
+
+        while (s0.dst < s0.dstEnd && s1.dst < s1.dstEnd &&
+               s2.dst < s2.dstEnd && s3.dst < s3.dstEnd &&
+               s0.p + HUF_STREAM_TAIL <= s0.end &&
+               s1.p + HUF_STREAM_TAIL <= s1.end &&
+               s2.p + HUF_STREAM_TAIL <= s2.end &&
+               s3.p + HUF_STREAM_TAIL <= s3.end)
+        {
+            rv = fasthuf_stream_symbols (pctxt, fhd, &s0);
+            if (rv != EXR_ERR_SUCCESS) return rv;
+            rv = fasthuf_stream_symbols (pctxt, fhd, &s1);
+            if (rv != EXR_ERR_SUCCESS) return rv;
+            rv = fasthuf_stream_symbols (pctxt, fhd, &s2);
+            if (rv != EXR_ERR_SUCCESS) return rv;
+            rv = fasthuf_stream_symbols (pctxt, fhd, &s3);
+            if (rv != EXR_ERR_SUCCESS) return rv;
+        }
+
+        st[0] = s0;
+        st[1] = s1;
+        st[2] = s2;
+        st[3] = s3;
+    }
+
+    for (int i = 0; i < nStreams; ++i)
+    {
+        rv = fasthuf_stream_finish (pctxt, fhd, st + i, starts[i], nBits[i]);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+    }
+    return EXR_ERR_SUCCESS;
+}
+
 /**************************************/
 
 uint64_t
@@ -1909,3 +2227,207 @@ internal_huf_decompress (
     }
     return rv;
 }
+
+/**************************************/
+
+//
+// Multi stream layout: the same header and code table as above, but
+// the header's extension field holds the number of streams, followed
+// by the length in bits of each stream, then the table.  The data is
+// cut in as many runs of equal length (the last one shorter), each
+// encoded on its own into a byte aligned stream, one after the other,
+// so a decoder can work on all of them at once.
+//
+
+exr_result_t
+internal_huf_compress_streams (
+    uint64_t*       encbytes,
+    void*           out,
+    uint64_t        outsz,
+    const uint16_t* raw,
+    uint64_t        nRaw,
+    void*           spare,
+    uint64_t        sparebytes)
+{
+    exr_result_t rv;
+    uint64_t*    freq;
+    uint32_t*    hlink;
+    uint64_t**   fHeap;
+    uint64_t*    scode;
+    uint32_t     im = 0;
+    uint32_t     iM = 0;
+    uint32_t     tableLength, nBits, totalBits = 0;
+    uint8_t*     dataStart;
+    uint8_t*     compressed = (uint8_t*) out;
+    uint8_t*     tableStart = compressed + 20 + 4 * HUF_STREAMS;
+    uint8_t*     tableEnd   = tableStart;
+    uint8_t*     maxcompout = compressed + outsz;
+
+    if (nRaw == 0)
+    {
+        *encbytes = 0;
+        return EXR_ERR_SUCCESS;
+    }
+
+    if (outsz < 20 + 4 * HUF_STREAMS) return EXR_ERR_INVALID_ARGUMENT;
+    if (sparebytes != internal_exr_huf_compress_spare_bytes ())
+        return EXR_ERR_INVALID_ARGUMENT;
+
+    freq  = (uint64_t*) spare;
+    scode = freq + HUF_ENCSIZE;
+    fHeap = (uint64_t**) (scode + HUF_ENCSIZE);
+    hlink = (uint32_t*) (fHeap + HUF_ENCSIZE);
+
+    countFrequencies (freq, raw, nRaw);
+
+    hufBuildEncTable (freq, &im, &iM, hlink, fHeap, scode);
+
+    rv = hufPackEncTable (freq, im, iM, &tableEnd, maxcompout);
+
+    if (rv != EXR_ERR_SUCCESS) return rv;
+    tableLength =
+        (uint32_t) (((uintptr_t) tableEnd) - ((uintptr_t) tableStart));
+    dataStart = tableEnd;
+
+    for (uint32_t s = 0; s < HUF_STREAMS; ++s)
+    {
+        uint64_t first, count;
+
+        count = hufStreamSymbols (nRaw, HUF_STREAMS, s, &first);
+
+        nBits = 0;
+        if (count > 0)
+        {
+            rv = hufEncode (
+                freq, raw + first, count, iM, dataStart, maxcompout, &nBits);
+            if (rv != EXR_ERR_SUCCESS) return rv;
+        }
+
+        if ((uint64_t) totalBits + nBits > (uint64_t) UINT32_MAX)
+            return EXR_ERR_ARGUMENT_OUT_OF_RANGE;
+
+        writeUInt (compressed + 20 + 4 * s, nBits);
+        totalBits += nBits;
+        dataStart += (nBits + 7) / 8;
+    }
+
+    writeUInt (compressed, im);
+    writeUInt (compressed + 4, iM);
+    writeUInt (compressed + 8, tableLength);
+    writeUInt (compressed + 12, totalBits);
+    writeUInt (compressed + 16, HUF_STREAMS);
+
+    *encbytes = (((uintptr_t) dataStart) - ((uintptr_t) compressed));
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+internal_huf_decompress_streams (
+    exr_decode_pipeline_t* decode,
+    const uint8_t*         compressed,
+    uint64_t               nCompressed,
+    uint16_t*              raw,
+    uint64_t               nRaw,
+    void*                  spare,
+    uint64_t               sparebytes)
+{
+    uint32_t                            im, iM, totalBits, nStreams;
+    uint32_t                            nBits[HUF_STREAMS];
+    uint64_t                            nBytes, sumBits;
+    uint64_t                            hufInfoBlockSize;
+    const uint8_t*                      ptr;
+    const uint8_t*                      streams;
+    exr_result_t                        rv;
+    const struct _internal_exr_context* pctxt = NULL;
+
+    if (decode) pctxt = EXR_CCTXT (decode->context);
+
+    if (nCompressed < 20)
+    {
+        if (nRaw != 0) return EXR_ERR_INVALID_ARGUMENT;
+        return EXR_ERR_SUCCESS;
+    }
+
+    if (sparebytes != internal_exr_huf_decompress_spare_bytes ())
+        return EXR_ERR_INVALID_ARGUMENT;
+
+    im = readUInt (compressed);
+    iM = readUInt (compressed + 4);
+    // uint32_t tableLength = readUInt (compressed + 8);
+    totalBits = readUInt (compressed + 12);
+    nStreams  = readUInt (compressed + 16);
+
+    if (im >= HUF_ENCSIZE || iM >= HUF_ENCSIZE) return EXR_ERR_CORRUPT_CHUNK;
+    if (nStreams < 1 || nStreams > HUF_STREAMS) return EXR_ERR_CORRUPT_CHUNK;
+
+    hufInfoBlockSize = 20 + 4 * (uint64_t) nStreams;
+    if (hufInfoBlockSize > nCompressed) return EXR_ERR_CORRUPT_CHUNK;
+
+    nBytes  = 0;
+    sumBits = 0;
+    for (uint32_t s = 0; s < nStreams; ++s)
+    {
+        nBits[s] = readUInt (compressed + 20 + 4 * s);
+        sumBits += nBits[s];
+        nBytes += ((uint64_t) (nBits[s]) + 7) / 8;
+    }
+    if (sumBits != totalBits) return EXR_ERR_CORRUPT_CHUNK;
+
+    // must be nBytes remaining in buffer
+    if (hufInfoBlockSize + nBytes > nCompressed) return EXR_ERR_OUT_OF_MEMORY;
+
+    ptr = compressed + hufInfoBlockSize;
+
+    if (fasthuf_decode_enabled ())
+    {
+        FastHufDecoder* fhd = (FastHufDecoder*) spare;
+
+        rv = fasthuf_initialize (
+            pctxt,
+            fhd,
+            &ptr,
+            nCompressed - hufInfoBlockSize,
+            im,
+            iM,
+            (int) iM);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+
+        if ((uint64_t) (ptr - compressed) + nBytes > nCompressed)
+            return EXR_ERR_OUT_OF_MEMORY;
+
+        rv = fasthuf_decode_streams (
+            pctxt, fhd, ptr, nBits, (int) nStreams, raw, nRaw);
+    }
+    else
+    {
+        uint64_t* freq  = (uint64_t*) spare;
+        HufDec*   hdec  = (HufDec*) (freq + HUF_ENCSIZE);
+        uint64_t  nLeft = nCompressed - hufInfoBlockSize;
+
+        hufClearDecTable (hdec);
+        rv = hufUnpackEncTable (&ptr, &nLeft, im, iM, freq);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+
+        if (nBytes > nLeft) return EXR_ERR_CORRUPT_CHUNK;
+
+        rv = hufBuildDecTable (pctxt, freq, im, iM, hdec);
+
+        streams = ptr;
+        for (uint32_t s = 0; s < nStreams && rv == EXR_ERR_SUCCESS; ++s)
+        {
+            uint64_t first, count;
+
+            count = hufStreamSymbols (nRaw, nStreams, s, &first);
+
+            if (count > 0)
+                rv = hufDecode (
+                    freq, hdec, streams, nBits[s], iM, count, raw + first);
+            else if (nBits[s] != 0)
+                rv = EXR_ERR_CORRUPT_CHUNK;
+            streams += ((uint64_t) (nBits[s]) + 7) / 8;
+        }
+
+        hufFreeDecTable (pctxt, hdec);
+    }
+    return rv;
+}
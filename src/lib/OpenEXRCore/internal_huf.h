@@ -9,6 +9,9 @@
 #include "openexr_errors.h"
 #include "openexr_decode.h"
 
+/* number of streams written by internal_huf_compress_streams */
+#define HUF_STREAMS 4
+
 uint64_t internal_exr_huf_compress_spare_bytes (void);
 uint64_t internal_exr_huf_decompress_spare_bytes (void);
 
@@ -30,4 +33,22 @@ exr_result_t internal_huf_decompress (
     void*                  spare,
     uint64_t               sparebytes);
 
+exr_result_t internal_huf_compress_streams (
+    uint64_t*       encbytes,
+    void*           out,
+    uint64_t        outsz,
+    const uint16_t* raw,
+    uint64_t        nRaw,
+    void*           spare,
+    uint64_t        sparebytes);
+
+exr_result_t internal_huf_decompress_streams (
+    exr_decode_pipeline_t* decode,
+    const uint8_t*         compressed,
+    uint64_t               nCompressed,
+    uint16_t*              raw,
+    uint64_t               nRaw,
+    void*                  spare,
+    uint64_t               sparebytes);
+
 #endif /* OPENEXR_CORE_HUF_CODING_H */
@@ -0,0 +1,576 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_compress.h"
+#include "internal_decompress.h"
+
+#include "internal_byte_simd.h"
+#include "internal_coding.h"
+#include "internal_lz4.h"
+#include "internal_xdr.h"
+
+#include <string.h>
+
+/*
+ * LZ4 compression shuffles the bytes of each channel's scanline into
+ * planes, byte k of every value going to plane k, so the slowly
+ * changing high bytes of neighboring pixels line up, then compresses
+ * the chunk as one LZ4 block.  There is no entropy coding stage, so
+ * the files are larger than ZIP, but decoding is mostly copies.
+ */
+
+#define LZ4_MIN_MATCH 4
+/* the last 5 bytes are always literals */
+#define LZ4_LAST_LITERALS 5
+/* and the last match starts 12 bytes before the end */
+#define LZ4_MF_LIMIT 12
+#define LZ4_MAX_DISTANCE 65535
+#define LZ4_HASH_LOG 12
+/* widen the search step after 2^6 failed attempts */
+#define LZ4_SKIP_TRIGGER 6
+
+/**************************************/
+
+static inline uint32_t
+lz4_read32 (const uint8_t* p)
+{
+    uint32_t v;
+    memcpy (&v, p, sizeof (v));
+    return v;
+}
+
+static inline uint32_t
+lz4_hash (uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+/* number of equal bytes at p and m, stopping at limit */
+static inline uint64_t
+lz4_count (const uint8_t* p, const uint8_t* m, const uint8_t* limit)
+{
+    const uint8_t* start = p;
+
+#if !EXR_HOST_IS_NOT_LITTLE_ENDIAN
+    while (p + 8 <= limit)
+    {
+        uint64_t a, b, diff;
+
+        memcpy (&a, p, sizeof (a));
+        memcpy (&b, m, sizeof (b));
+        diff = a ^ b;
+        if (diff)
+        {
+            uint32_t lo = (uint32_t) diff;
+            return (uint64_t) (p - start) +
+                   (lo ? exr_byte_simd_ctz (lo)
+                       : 32 + exr_byte_simd_ctz ((uint32_t) (diff >> 32))) /
+                       8;
+        }
+        p += 8;
+        m += 8;
+    }
+#endif
+    while (p < limit && *p == *m)
+    {
+        ++p;
+        ++m;
+    }
+    return (uint64_t) (p - start);
+}
+
+static inline uint8_t*
+lz4_write_length (uint8_t* op, uint64_t len)
+{
+    while (len >= 255)
+    {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t) len;
+    return op;
+}
+
+/**************************************/
+
+uint64_t
+internal_lz4_compress_bound (uint64_t n)
+{
+    return n + n / 255 + 16;
+}
+
+/*
+ * Greedy single probe hash search, the "fast" mode of the reference
+ * encoder, which is what the decode speed is tuned for.
+ */
+
+uint64_t
+internal_lz4_compress (
+    uint8_t* out, uint64_t outsz, const uint8_t* in, uint64_t n)
+{
+    uint32_t       table[1 << LZ4_HASH_LOG];
+    const uint8_t* ip     = in;
+    const uint8_t* anchor = in;
+    const uint8_t* iend   = in + n;
+    uint8_t*       op     = out;
+    uint8_t*       oend   = out + outsz;
+    uint64_t       litlen;
+
+    /* positions are kept in 32 bits */
+    if (n > (uint64_t) UINT32_MAX) return 0;
+
+    if (n > LZ4_MF_LIMIT)
+    {
+        const uint8_t* mflimit = iend - LZ4_MF_LIMIT;
+        const uint8_t* mlimit  = iend - LZ4_LAST_LITERALS;
+
+        memset (table, 0, sizeof (table));
+        ++ip;
+
+        for (;;)
+        {
+            const uint8_t* match;
+            uint32_t       attempts = 1u << LZ4_SKIP_TRIGGER;
+            uint64_t       mlen;
+            uint8_t*       token;
+
+            for (;;)
+            {
+                uint32_t       h    = lz4_hash (lz4_read32 (ip));
+                const uint8_t* next = ip + (attempts++ >> LZ4_SKIP_TRIGGER);
+
+                match    = in + table[h];
+                table[h] = (uint32_t) (ip - in);
+                if (ip - match <= LZ4_MAX_DISTANCE &&
+                    lz4_read32 (match) == lz4_read32 (ip))
+                    break;
+
+                ip = next;
+                if (ip > mflimit) goto last_literals;
+            }
+
+            while (ip > anchor && match > in && ip[-1] == match[-1])
+            {
+                --ip;
+                --match;
+            }
+
+            litlen = (uint64_t) (ip - anchor);
+            mlen   = lz4_count (
+                ip + LZ4_MIN_MATCH, match + LZ4_MIN_MATCH, mlimit);
+
+            /* token, lengths, literals and offset */
+            if ((uint64_t) (oend - op) <
+                litlen + litlen / 255 + mlen / 255 + 5)
+                return 0;
+
+            token = op++;
+            if (litlen >= 15)
+            {
+                *token = 15 << 4;
+                op     = lz4_write_length (op, litlen - 15);
+            }
+            else
+                *token = (uint8_t) (litlen << 4);
+
+            memcpy (op, anchor, litlen);
+            op += litlen;
+
+            *op++ = (uint8_t) (ip - match);
+            *op++ = (uint8_t) ((ip - match) >> 8);
+
+            if (mlen >= 15)
+            {
+                *token |= 15;
+                op = lz4_write_length (op, mlen - 15);
+            }
+            else
+                *token |= (uint8_t) mlen;
+
+            ip += mlen + LZ4_MIN_MATCH;
+            anchor = ip;
+
+            if (ip > mflimit) break;
+
+            table[lz4_hash (lz4_read32 (ip - 2))] = (uint32_t) (ip - 2 - in);
+        }
+    }
+
+last_literals:
+    litlen = (uint64_t) (iend - anchor);
+    if ((uint64_t) (oend - op) < litlen + litlen / 255 + 2) return 0;
+
+    if (litlen >= 15)
+    {
+        *op++ = 15 << 4;
+        op    = lz4_write_length (op, litlen - 15);
+    }
+    else
+        *op++ = (uint8_t) (litlen << 4);
+
+    memcpy (op, anchor, litlen);
+    op += litlen;
+
+    return (uint64_t) (op - out);
+}
+
+/**************************************/
+
+/*
+ * Copies run 16 (or 8) bytes at a time and may write up to 15 bytes
+ * past their end, which the next sequence overwrites, so they are
+ * only used when there is that much room left in the output.
+ */
+
+exr_result_t
+internal_lz4_decompress (
+    uint8_t*       out,
+    uint64_t       outsz,
+    const uint8_t* in,
+    uint64_t       n,
+    uint64_t*      nout)
+{
+    const uint8_t* ip   = in;
+    const uint8_t* iend = in + n;
+    uint8_t*       op   = out;
+    uint8_t*       oend = out + outsz;
+
+    *nout = 0;
+    for (;;)
+    {
+        uint64_t       len, off;
+        uint32_t       token;
+        const uint8_t* match;
+        uint8_t*       cpyend;
+
+        if (ip >= iend) return EXR_ERR_CORRUPT_CHUNK;
+        token = *ip++;
+
+        len = token >> 4;
+        if (len != 15 && iend - ip >= 18 && oend - op >= 32)
+        {
+            /*
+             * a short literal run, which leaves the offset and at
+             * least 2 more bytes in the input
+             */
+            memcpy (op, ip, 16);
+            op += len;
+            ip += len;
+        }
+        else
+        {
+            if (len == 15)
+            {
+                uint32_t s;
+                do
+                {
+                    if (ip >= iend) return EXR_ERR_CORRUPT_CHUNK;
+                    s = *ip++;
+                    len += s;
+                } while (s == 255);
+            }
+
+            if (len > (uint64_t) (iend - ip) || len > (uint64_t) (oend - op))
+                return EXR_ERR_CORRUPT_CHUNK;
+
+            if ((uint64_t) (iend - ip) >= len + 16 &&
+                (uint64_t) (oend - op) >= len + 16)
+            {
+                cpyend = op + len;
+                do
+                {
+                    memcpy (op, ip, 16);
+                    op += 16;
+                    ip += 16;
+                } while (op < cpyend);
+                ip -= op - cpyend;
+                op = cpyend;
+            }
+            else
+            {
+                memcpy (op, ip, len);
+                op += len;
+                ip += len;
+            }
+
+            /* the last sequence has no match */
+            if (ip == iend) break;
+        }
+
+        if (iend - ip < 2) return EXR_ERR_CORRUPT_CHUNK;
+        off = (uint64_t) ip[0] | ((uint64_t) ip[1] << 8);
+        ip += 2;
+        if (off == 0 || off > (uint64_t) (op - out))
+            return EXR_ERR_CORRUPT_CHUNK;
+
+        len = token & 15;
+        if (len == 15)
+        {
+            uint32_t s;
+            do
+            {
+                if (ip >= iend) return EXR_ERR_CORRUPT_CHUNK;
+                s = *ip++;
+                len += s;
+            } while (s == 255);
+        }
+        len += LZ4_MIN_MATCH;
+
+        if (len > (uint64_t) (oend - op)) return EXR_ERR_CORRUPT_CHUNK;
+
+        match = op - off;
+        if (len <= 18 && off >= 8 && oend - op >= 18)
+        {
+            memcpy (op, match, 8);
+            memcpy (op + 8, match + 8, 8);
+            memcpy (op + 16, match + 16, 2);
+            op += len;
+            continue;
+        }
+
+        cpyend = op + len;
+        if ((uint64_t) (oend - op) >= len + 16)
+        {
+            if (off >= 16)
+            {
+                do
+                {
+                    memcpy (op, match, 16);
+                    op += 16;
+                    match += 16;
+                } while (op < cpyend);
+            }
+            else
+            {
+                if (off < 8)
+                {
+                    /*
+                     * the first 8 bytes one at a time, then continue
+                     * from the earliest repeat of the pattern at least
+                     * 8 bytes back
+                     */
+                    for (int i = 0; i < 8; ++i)
+                        op[i] = match[i];
+                    op += 8;
+                    match = op - off * ((8 + off - 1) / off);
+                }
+                while (op < cpyend)
+                {
+                    memcpy (op, match, 8);
+                    op += 8;
+                    match += 8;
+                }
+            }
+            op = cpyend;
+        }
+        else
+        {
+            while (op < cpyend)
+                *op++ = *match++;
+        }
+    }
+
+    *nout = (uint64_t) (op - out);
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+static void
+shuffle_values (uint8_t* out, const uint8_t* in, uint64_t count, int bpe)
+{
+    if (bpe == 2)
+    {
+#if defined(EXR_BYTE_SIMD_X86_DISPATCH)
+        if (internal_exr_x86_byte_simd () & EXR_X86_SIMD_AVX2)
+            exr_deinterleave_avx2 (out, in, 2 * count);
+        else
+            exr_deinterleave_sse2 (out, in, 2 * count);
+#elif defined(EXR_BYTE_SIMD_NEON)
+        exr_deinterleave_neon (out, in, 2 * count);
+#elif defined(EXR_BYTE_SIMD_SSE2)
+        exr_deinterleave_sse2 (out, in, 2 * count);
+#else
+        exr_deinterleave_scalar (out, in, 2 * count);
+#endif
+    }
+    else
+    {
+#if defined(EXR_BYTE_SIMD_SSE2)
+        exr_shuffle4_sse2 (out, in, count);
+#elif defined(EXR_BYTE_SIMD_NEON)
+        exr_shuffle4_neon (out, in, count);
+#else
+        exr_shuffle4_scalar (out, in, count);
+#endif
+    }
+}
+
+static void
+unshuffle_values (uint8_t* out, const uint8_t* in, uint64_t count, int bpe)
+{
+    if (bpe == 2)
+    {
+#if defined(EXR_BYTE_SIMD_X86_DISPATCH)
+        if (internal_exr_x86_byte_simd () & EXR_X86_SIMD_AVX2)
+            exr_interleave_avx2 (out, in, 2 * count);
+        else
+            exr_interleave_sse2 (out, in, 2 * count);
+#elif defined(EXR_BYTE_SIMD_NEON)
+        exr_interleave_neon (out, in, 2 * count);
+#elif defined(EXR_BYTE_SIMD_SSE2)
+        exr_interleave_sse2 (out, in, 2 * count);
+#else
+        exr_interleave_scalar (out, in, 2 * count);
+#endif
+    }
+    else
+    {
+#if defined(EXR_BYTE_SIMD_SSE2)
+        exr_unshuffle4_sse2 (out, in, count);
+#elif defined(EXR_BYTE_SIMD_NEON)
+        exr_unshuffle4_neon (out, in, count);
+#else
+        exr_unshuffle4_scalar (out, in, count);
+#endif
+    }
+}
+
+/**************************************/
+
+exr_result_t
+internal_exr_apply_lz4 (exr_encode_pipeline_t* encode)
+{
+    const uint8_t* in   = encode->packed_buffer;
+    uint8_t*       out;
+    uint64_t       nOut = 0;
+    uint64_t       compbufsz;
+    exr_result_t   rv;
+
+    rv = internal_encode_alloc_buffer (
+        encode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(encode->scratch_buffer_1),
+        &(encode->scratch_alloc_size_1),
+        encode->packed_bytes);
+    if (rv == EXR_ERR_SUCCESS)
+        rv = internal_encode_alloc_buffer (
+            encode,
+            EXR_TRANSCODE_BUFFER_COMPRESSED,
+            &(encode->compressed_buffer),
+            &(encode->compressed_alloc_size),
+            internal_lz4_compress_bound (encode->packed_bytes));
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    out = encode->scratch_buffer_1;
+    for (int y = 0; y < encode->chunk.height; ++y)
+    {
+        int cury = y + encode->chunk.start_y;
+
+        for (int c = 0; c < encode->channel_count; ++c)
+        {
+            const exr_coding_channel_info_t* curc = encode->channels + c;
+            uint64_t nBytes = (uint64_t) (curc->width) *
+                              (uint64_t) (curc->bytes_per_element);
+
+            if (curc->height == 0 ||
+                (curc->y_samples > 1 && (cury % curc->y_samples) != 0))
+                continue;
+
+            if (nOut + nBytes > encode->packed_bytes)
+                return EXR_ERR_OUT_OF_MEMORY;
+
+            shuffle_values (
+                out + nOut,
+                in + nOut,
+                (uint64_t) curc->width,
+                curc->bytes_per_element);
+            nOut += nBytes;
+        }
+    }
+    if (nOut != encode->packed_bytes) return EXR_ERR_INVALID_ARGUMENT;
+
+    compbufsz = internal_lz4_compress (
+        encode->compressed_buffer,
+        encode->compressed_alloc_size,
+        encode->scratch_buffer_1,
+        nOut);
+
+    /* a chunk the same size as the raw data is read back as raw */
+    if (compbufsz == 0 || compbufsz >= encode->packed_bytes)
+    {
+        memcpy (
+            encode->compressed_buffer,
+            encode->packed_buffer,
+            encode->packed_bytes);
+        compbufsz = encode->packed_bytes;
+    }
+    encode->compressed_bytes = compbufsz;
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+exr_result_t
+internal_exr_undo_lz4 (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size)
+{
+    uint8_t*       out = uncompressed_data;
+    const uint8_t* in;
+    uint64_t       nOut = 0;
+    uint64_t       actual_out_bytes;
+    exr_result_t   rv;
+
+    rv = internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(decode->scratch_buffer_1),
+        &(decode->scratch_alloc_size_1),
+        uncompressed_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rv = internal_lz4_decompress (
+        decode->scratch_buffer_1,
+        uncompressed_size,
+        compressed_data,
+        comp_buf_size,
+        &actual_out_bytes);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+    if (actual_out_bytes != uncompressed_size) return EXR_ERR_CORRUPT_CHUNK;
+
+    in = decode->scratch_buffer_1;
+    for (int y = 0; y < decode->chunk.height; ++y)
+    {
+        int cury = y + decode->chunk.start_y;
+
+        for (int c = 0; c < decode->channel_count; ++c)
+        {
+            const exr_coding_channel_info_t* curc = decode->channels + c;
+            uint64_t nBytes = (uint64_t) (curc->width) *
+                              (uint64_t) (curc->bytes_per_element);
+
+            if (curc->height == 0 ||
+                (curc->y_samples > 1 && (cury % curc->y_samples) != 0))
+                continue;
+
+            if (nOut + nBytes > uncompressed_size)
+                return EXR_ERR_CORRUPT_CHUNK;
+
+            unshuffle_values (
+                out + nOut,
+                in + nOut,
+                (uint64_t) curc->width,
+                curc->bytes_per_element);
+            nOut += nBytes;
+        }
+    }
+    if (nOut != uncompressed_size) return EXR_ERR_CORRUPT_CHUNK;
+
+    return EXR_ERR_SUCCESS;
+}
@@ -0,0 +1,33 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_CORE_LZ4_CODING_H
+#define OPENEXR_CORE_LZ4_CODING_H
+
+#include "openexr_errors.h"
+
+#include <stdint.h>
+
+/*
+ * Encoder and decoder for the LZ4 block format: a sequence of
+ * literal runs and matches of at least 4 bytes within the previous
+ * 64k, with no frame header or checksum.
+ */
+
+/* largest block internal_lz4_compress can produce for n bytes */
+uint64_t internal_lz4_compress_bound (uint64_t n);
+
+/* returns the number of bytes written, 0 if they do not fit in outsz */
+uint64_t internal_lz4_compress (
+    uint8_t* out, uint64_t outsz, const uint8_t* in, uint64_t n);
+
+exr_result_t internal_lz4_decompress (
+    uint8_t*       out,
+    uint64_t       outsz,
+    const uint8_t* in,
+    uint64_t       n,
+    uint64_t*      nout);
+
+#endif /* OPENEXR_CORE_LZ4_CODING_H */
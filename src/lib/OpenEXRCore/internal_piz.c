@@ -399,8 +399,8 @@ wav_2D_decode (
     }
 }
 
-exr_result_t
-internal_exr_apply_piz (exr_encode_pipeline_t* encode)
+static exr_result_t
+compress_piz_impl (exr_encode_pipeline_t* encode, int hufstreams)
 {
     uint8_t*       out  = encode->compressed_buffer;
     uint64_t       nOut = 0;
@@ -479,6 +479,18 @@ internal_exr_apply_piz (exr_encode_pipeline_t* encode)
 
     applyLut (lut, encode->scratch_buffer_1, ndata);
 
+    /* for small chunks, the bitmap alone may not fit in the output,
+     * in which case the data is stored as is */
+    if (minNonZero <= maxNonZero &&
+        2 * sizeof (uint16_t) + (uint64_t) (maxNonZero - minNonZero + 1) +
+                sizeof (uint32_t) >=
+            packedbytes)
+    {
+        memcpy (encode->compressed_buffer, encode->packed_buffer, packedbytes);
+        encode->compressed_bytes = packedbytes;
+        return EXR_ERR_SUCCESS;
+    }
+
     nOut = 0;
     unaligned_store16 (out, minNonZero);
     out += 2;
@@ -513,14 +525,24 @@ internal_exr_apply_piz (exr_encode_pipeline_t* encode)
     lengthptr = (uint32_t*) out;
     out += sizeof (uint32_t);
     nOut += sizeof (uint32_t);
-    rv = internal_huf_compress (
-        &nBytes,
-        out,
-        encode->compressed_alloc_size - nOut,
-        encode->scratch_buffer_1,
-        ndata,
-        hufspare,
-        hufSpareBytes);
+    if (hufstreams)
+        rv = internal_huf_compress_streams (
+            &nBytes,
+            out,
+            encode->compressed_alloc_size - nOut,
+            encode->scratch_buffer_1,
+            ndata,
+            hufspare,
+            hufSpareBytes);
+    else
+        rv = internal_huf_compress (
+            &nBytes,
+            out,
+            encode->compressed_alloc_size - nOut,
+            encode->scratch_buffer_1,
+            ndata,
+            hufspare,
+            hufSpareBytes);
     if (rv != EXR_ERR_SUCCESS)
     {
         if (rv == EXR_ERR_ARGUMENT_OUT_OF_RANGE)
@@ -548,15 +570,32 @@ internal_exr_apply_piz (exr_encode_pipeline_t* encode)
     return EXR_ERR_SUCCESS;
 }
 
-/**************************************/
+exr_result_t
+internal_exr_apply_piz (exr_encode_pipeline_t* encode)
+{
+    return compress_piz_impl (encode, 0);
+}
 
+/*
+ * PIZ4 is PIZ with the Huffman coded data cut in HUF_STREAMS streams,
+ * which the decoder works through in parallel
+ */
 exr_result_t
-internal_exr_undo_piz (
+internal_exr_apply_piz4 (exr_encode_pipeline_t* encode)
+{
+    return compress_piz_impl (encode, 1);
+}
+
+/**************************************/
+
+static exr_result_t
+uncompress_piz_impl (
     exr_decode_pipeline_t* decode,
     const void*            src,
     uint64_t               packsz,
     void*                  outptr,
-    uint64_t               outsz)
+    uint64_t               outsz,
+    int                    hufstreams)
 {
     uint8_t*       out  = outptr;
     uint64_t       nOut = 0;
@@ -633,14 +672,24 @@ internal_exr_undo_piz (
     if (nBytes + hufbytes > packsz) return EXR_ERR_CORRUPT_CHUNK;
 
     wavbuf = decode->scratch_buffer_1;
-    rv     = internal_huf_decompress (
-        decode,
-        packed + nBytes,
-        hufbytes,
-        wavbuf,
-        outsz / 2,
-        hufspare,
-        hufSpareBytes);
+    if (hufstreams)
+        rv = internal_huf_decompress_streams (
+            decode,
+            packed + nBytes,
+            hufbytes,
+            wavbuf,
+            outsz / 2,
+            hufspare,
+            hufSpareBytes);
+    else
+        rv = internal_huf_decompress (
+            decode,
+            packed + nBytes,
+            hufbytes,
+            wavbuf,
+            outsz / 2,
+            hufspare,
+            hufSpareBytes);
     if (rv != EXR_ERR_SUCCESS) return rv;
 
     //
@@ -710,3 +759,25 @@ internal_exr_undo_piz (
     if (nOut != outsz) return EXR_ERR_CORRUPT_CHUNK;
     return EXR_ERR_SUCCESS;
 }
+
+exr_result_t
+internal_exr_undo_piz (
+    exr_decode_pipeline_t* decode,
+    const void*            src,
+    uint64_t               packsz,
+    void*                  outptr,
+    uint64_t               outsz)
+{
+    return uncompress_piz_impl (decode, src, packsz, outptr, outsz, 0);
+}
+
+exr_result_t
+internal_exr_undo_piz4 (
+    exr_decode_pipeline_t* decode,
+    const void*            src,
+    uint64_t               packsz,
+    void*                  outptr,
+    uint64_t               outsz)
+{
+    return uncompress_piz_impl (decode, src, packsz, outptr, outsz, 1);
+}
@@ -9,13 +9,16 @@
 #include <errno.h>
 
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #ifdef ILMTHREAD_THREADING_ENABLED
 #    include <pthread.h>
 #endif
+#include <limits.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -28,15 +31,27 @@
 #    define CAN_USE_PREAD 0
 #endif
 
+/* preadv2 and RWF_NOWAIT are only declared for _GNU_SOURCE (which
+ * context.c defines), and come together in the C library headers */
+#if defined(__linux__) && defined(_GNU_SOURCE) && defined(RWF_NOWAIT)
+#    define CAN_USE_PREADV2 1
+#else
+#    define CAN_USE_PREADV2 0
+#endif
+
 #if CAN_USE_PREAD
 struct _internal_exr_filehandle
 {
-    int fd;
+    int      fd;
+    void*    map;
+    uint64_t map_size;
 };
 #else
 struct _internal_exr_filehandle
 {
     int             fd;
+    void*           map;
+    uint64_t        map_size;
 #    ifdef ILMTHREAD_THREADING_ENABLED
     pthread_mutex_t mutex;
 #    endif
@@ -52,6 +67,7 @@ default_shutdown (exr_const_context_t c, void* userdata, int failed)
     struct _internal_exr_filehandle* fh = userdata;
     if (fh)
     {
+        if (fh->map) munmap (fh->map, (size_t) fh->map_size);
         if (fh->fd >= 0) close (fh->fd);
 #if !CAN_USE_PREAD
 #    ifdef ILMTHREAD_THREADING_ENABLED
@@ -131,6 +147,14 @@ default_read_func (
         return retsz;
     }
 
+    if (fh->map)
+    {
+        if (offset >= fh->map_size) return 0;
+        if (readsz > fh->map_size - offset) readsz = fh->map_size - offset;
+        memcpy (curbuf, ((const uint8_t*) fh->map) + offset, (size_t) readsz);
+        return (int64_t) readsz;
+    }
+
     fd = fh->fd;
     if (fd < 0)
     {
@@ -324,13 +348,88 @@ default_write_func (
 
 /**************************************/
 
+static exr_result_t
+default_read_async_func (
+    exr_const_context_t          ctxt,
+    void*                        userdata,
+    void*                        buffer,
+    uint64_t                     sz,
+    uint64_t                     offset,
+    exr_read_complete_func_ptr_t complete_fn,
+    void*                        request,
+    exr_stream_error_func_ptr_t  error_cb)
+{
+    struct _internal_exr_filehandle* fh = userdata;
+
+    /* reads that cannot block are just done right away, everything
+     * else is handed to the context's reader thread */
+    if (fh && fh->map)
+    {
+        complete_fn (
+            ctxt,
+            request,
+            default_read_func (ctxt, userdata, buffer, sz, offset, error_cb));
+        return EXR_ERR_SUCCESS;
+    }
+
+#if CAN_USE_PREADV2
+    if (fh && fh->fd >= 0 && sz > 0 && sz <= (uint64_t) SSIZE_MAX &&
+        (uint64_t) (off_t) offset == offset)
+    {
+        struct iovec iov;
+        ssize_t      nread;
+
+        iov.iov_base = buffer;
+        iov.iov_len  = (size_t) sz;
+
+        /* succeeds only if the data is already in the page cache */
+        nread = preadv2 (fh->fd, &iov, 1, (off_t) offset, RWF_NOWAIT);
+        if (nread == (ssize_t) sz)
+        {
+            complete_fn (ctxt, request, (int64_t) nread);
+            return EXR_ERR_SUCCESS;
+        }
+    }
+#endif
+
+    return internal_exr_queue_read (
+        ctxt, userdata, buffer, sz, offset, complete_fn, request, error_cb);
+}
+
+/**************************************/
+
+static void
+default_map_file (
+    struct _internal_exr_context* file, struct _internal_exr_filehandle* fh)
+{
+    /* mapping is only an optimization, so on any failure we quietly
+     * keep using regular reads */
+    struct stat sbuf;
+    void*       map;
+
+    if (fstat (fh->fd, &sbuf) != 0 || sbuf.st_size <= 0) return;
+    if ((uint64_t) sbuf.st_size > (uint64_t) SIZE_MAX) return;
+
+    map = mmap (NULL, (size_t) sbuf.st_size, PROT_READ, MAP_PRIVATE, fh->fd, 0);
+    if (map == MAP_FAILED) return;
+
+    fh->map           = map;
+    fh->map_size      = (uint64_t) sbuf.st_size;
+    file->mapped_data = (const uint8_t*) map;
+    file->mapped_size = fh->map_size;
+}
+
+/**************************************/
+
 static exr_result_t
 default_init_read_file (struct _internal_exr_context* file)
 {
     int                              fd;
     struct _internal_exr_filehandle* fh = file->user_data;
 
-    fh->fd = -1;
+    fh->fd       = -1;
+    fh->map      = NULL;
+    fh->map_size = 0;
 #if !CAN_USE_PREAD
 #    ifdef ILMTHREAD_THREADING_ENABLED
     fd = pthread_mutex_init (&(fh->mutex), NULL);
@@ -343,8 +442,9 @@ default_init_read_file (struct _internal_exr_context* file)
 #    endif
 #endif
 
-    file->destroy_fn = &default_shutdown;
-    file->read_fn    = &default_read_func;
+    file->destroy_fn    = &default_shutdown;
+    file->read_fn       = &default_read_func;
+    file->read_async_fn = &default_read_async_func;
 
     fd = open (file->filename.str, O_RDONLY | O_CLOEXEC);
     if (fd < 0)
@@ -355,6 +455,9 @@ default_init_read_file (struct _internal_exr_context* file)
             strerror (errno));
 
     fh->fd = fd;
+
+    if (file->memory_map) default_map_file (file, fh);
+
     return EXR_ERR_SUCCESS;
 }
 
@@ -381,6 +484,8 @@ default_init_write_file (struct _internal_exr_context* file)
 #endif
 
     fh->fd           = -1;
+    fh->map          = NULL;
+    fh->map_size     = 0;
     file->destroy_fn = &default_shutdown;
     file->write_fn   = &default_write_func;
 
@@ -0,0 +1,733 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#ifndef OPENEXR_CORE_PXR24_SIMD_H
+#define OPENEXR_CORE_PXR24_SIMD_H
+
+/*
+ * Scan line loops of the PXR24 codec, scalar and SIMD.  This is a
+ * header so the tests can check that the versions produce the same
+ * bytes without going through the library.
+ */
+
+#include "internal_byte_simd.h"
+#include "internal_xdr.h"
+
+#include <stdint.h>
+
+/**************************************/
+
+static inline uint32_t
+float_to_float24 (float f)
+{
+    union
+    {
+        float    f;
+        uint32_t i;
+    } u;
+    uint32_t s, e, m, i;
+
+    u.f = f;
+
+    //
+    // Disassemble the 32-bit floating point number, f,
+    // into sign, s, exponent, e, and significand, m.
+    //
+
+    s = u.i & 0x80000000;
+    e = u.i & 0x7f800000;
+    m = u.i & 0x007fffff;
+
+    if (e == 0x7f800000)
+    {
+        if (m)
+        {
+            //
+            // F is a NAN; we preserve the sign bit and
+            // the 15 leftmost bits of the significand,
+            // with one exception: If the 15 leftmost
+            // bits are all zero, the NAN would turn
+            // into an infinity, so we have to set at
+            // least one bit in the significand.
+            //
+
+            m >>= 8;
+            i = (e >> 8) | m | (m == 0);
+        }
+        else
+        {
+            //
+            // F is an infinity.
+            //
+
+            i = e >> 8;
+        }
+    }
+    else
+    {
+        //
+        // F is finite, round the significand to 15 bits.
+        //
+
+        i = ((e | m) + (m & 0x00000080)) >> 8;
+
+        if (i >= 0x7f8000)
+        {
+            //
+            // F was close to FLT_MAX, and the significand was
+            // rounded up, resulting in an exponent overflow.
+            // Avoid the overflow by truncating the significand
+            // instead of rounding it.
+            //
+
+            i = (e | m) >> 8;
+        }
+    }
+
+    return (s >> 8) | i;
+}
+
+/**************************************/
+
+/*
+ * Per scan line kernels.  A line of w values is split into byte
+ * planes of w bytes each, most significant byte first, after taking
+ * the difference to the previous value (UINT, HALF) or to the previous
+ * 24-bit float (FLOAT).  Decoding adds the differences back up.
+ *
+ * The SIMD versions handle 16 values at a time and return how many
+ * they did, along with the last value, and the scalar loops finish
+ * the line.  The data is little endian, so they are only used on
+ * little endian hosts.
+ */
+
+#if !EXR_HOST_IS_NOT_LITTLE_ENDIAN
+#    if defined(EXR_BYTE_SIMD_X86_DISPATCH)
+#        define PXR24_SSE4_1 1
+#    elif defined(EXR_BYTE_SIMD_NEON)
+#        define PXR24_NEON 1
+#    endif
+#endif
+
+/*
+ * The line routines at the end take the check_for_x86_byte_simd bits
+ * in simd.  NEON is part of the aarch64 baseline, so there any non
+ * zero value uses it.  0 runs only the scalar loops, which is what the
+ * tests compare the SIMD versions against.
+ */
+static inline int
+pxr24_line_simd (int x86_simd)
+{
+#if defined(PXR24_NEON)
+    (void) x86_simd;
+    return 1;
+#else
+    return x86_simd;
+#endif
+}
+
+#ifdef PXR24_SSE4_1
+
+EXR_TARGET_SSE4_1 static inline __m128i
+float_to_float24_sse4_1 (__m128i f)
+{
+    const __m128i one = _mm_set1_epi32 (1);
+    const __m128i zero = _mm_setzero_si128 ();
+    __m128i       a, m, rnd, trn, fin, spec, nan;
+
+    a   = _mm_and_si128 (f, _mm_set1_epi32 (0x7fffffff));
+    m   = _mm_and_si128 (f, _mm_set1_epi32 (0x007fffff));
+    rnd = _mm_srli_epi32 (
+        _mm_add_epi32 (a, _mm_and_si128 (a, _mm_set1_epi32 (0x80))), 8);
+    trn = _mm_srli_epi32 (a, 8);
+
+    /* finite, truncate instead of rounding into the exponent */
+    fin = _mm_blendv_epi8 (
+        rnd, trn, _mm_cmpgt_epi32 (rnd, _mm_set1_epi32 (0x7f7fff)));
+
+    /* infinity or NAN, keep a NAN from turning into an infinity */
+    nan = _mm_andnot_si128 (
+        _mm_cmpeq_epi32 (m, zero),
+        _mm_cmpeq_epi32 (
+            _mm_and_si128 (trn, _mm_set1_epi32 (0x7fff)), zero));
+    spec = _mm_or_si128 (trn, _mm_and_si128 (nan, one));
+
+    fin = _mm_blendv_epi8 (
+        fin, spec, _mm_cmpgt_epi32 (a, _mm_set1_epi32 (0x7f7fffff)));
+
+    return _mm_or_si128 (
+        fin,
+        _mm_and_si128 (_mm_srli_epi32 (f, 8), _mm_set1_epi32 (0x800000)));
+}
+
+/*
+ * 4x4 transpose of 32-bit lanes, after which plane k holds byte k of
+ * the gather mask order for 16 values
+ */
+#    define PXR24_SSE_TRANSPOSE(t0, t1, t2, t3, p0, p1, p2, p3)                \
+        do                                                                     \
+        {                                                                      \
+            __m128i a_ = _mm_unpacklo_epi32 (t0, t1);                          \
+            __m128i b_ = _mm_unpacklo_epi32 (t2, t3);                          \
+            __m128i c_ = _mm_unpackhi_epi32 (t0, t1);                          \
+            __m128i d_ = _mm_unpackhi_epi32 (t2, t3);                          \
+            p0         = _mm_unpacklo_epi64 (a_, b_);                          \
+            p1         = _mm_unpackhi_epi64 (a_, b_);                          \
+            p2         = _mm_unpacklo_epi64 (c_, d_);                          \
+            p3         = _mm_unpackhi_epi64 (c_, d_);                          \
+        } while (0)
+
+EXR_TARGET_SSE4_1 static inline int
+encode_uint_sse4_1 (uint8_t* out, const uint8_t* in, int w, uint32_t* prev)
+{
+    const __m128i gather =
+        _mm_setr_epi8 (3, 7, 11, 15, 2, 6, 10, 14, 1, 5, 9, 13, 0, 4, 8, 12);
+    __m128i last = _mm_set_epi32 ((int) *prev, 0, 0, 0);
+    int     x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i t[4], p0, p1, p2, p3;
+
+        for (int k = 0; k < 4; ++k)
+        {
+            __m128i cur =
+                _mm_loadu_si128 ((const __m128i*) (in + 4 * (x + 4 * k)));
+            __m128i d = _mm_sub_epi32 (cur, _mm_alignr_epi8 (cur, last, 12));
+            last      = cur;
+            t[k]      = _mm_shuffle_epi8 (d, gather);
+        }
+        PXR24_SSE_TRANSPOSE (t[0], t[1], t[2], t[3], p0, p1, p2, p3);
+
+        _mm_storeu_si128 ((__m128i*) (out + x), p0);
+        _mm_storeu_si128 ((__m128i*) (out + w + x), p1);
+        _mm_storeu_si128 ((__m128i*) (out + 2 * w + x), p2);
+        _mm_storeu_si128 ((__m128i*) (out + 3 * w + x), p3);
+    }
+    *prev = (uint32_t) _mm_extract_epi32 (last, 3);
+    return x;
+}
+
+EXR_TARGET_SSE4_1 static inline int
+encode_half_sse4_1 (uint8_t* out, const uint8_t* in, int w, uint32_t* prev)
+{
+    const __m128i lowByte = _mm_set1_epi16 (0x00ff);
+    __m128i       last    = _mm_insert_epi16 (_mm_setzero_si128 (), *prev, 7);
+    int           x       = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i c0 = _mm_loadu_si128 ((const __m128i*) (in + 2 * x));
+        __m128i c1 = _mm_loadu_si128 ((const __m128i*) (in + 2 * x + 16));
+        __m128i d0 = _mm_sub_epi16 (c0, _mm_alignr_epi8 (c0, last, 14));
+        __m128i d1 = _mm_sub_epi16 (c1, _mm_alignr_epi8 (c1, c0, 14));
+
+        last = c1;
+        _mm_storeu_si128 (
+            (__m128i*) (out + x),
+            _mm_packus_epi16 (_mm_srli_epi16 (d0, 8), _mm_srli_epi16 (d1, 8)));
+        _mm_storeu_si128 (
+            (__m128i*) (out + w + x),
+            _mm_packus_epi16 (
+                _mm_and_si128 (d0, lowByte), _mm_and_si128 (d1, lowByte)));
+    }
+    *prev = (uint32_t) _mm_extract_epi16 (last, 7);
+    return x;
+}
+
+EXR_TARGET_SSE4_1 static inline int
+encode_float_sse4_1 (uint8_t* out, const uint8_t* in, int w, uint32_t* prev)
+{
+    const __m128i gather =
+        _mm_setr_epi8 (2, 6, 10, 14, 1, 5, 9, 13, 0, 4, 8, 12, 3, 7, 11, 15);
+    __m128i last = _mm_set_epi32 ((int) *prev, 0, 0, 0);
+    int     x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i t[4], p0, p1, p2, p3;
+
+        for (int k = 0; k < 4; ++k)
+        {
+            __m128i cur = float_to_float24_sse4_1 (
+                _mm_loadu_si128 ((const __m128i*) (in + 4 * (x + 4 * k))));
+            __m128i d = _mm_sub_epi32 (cur, _mm_alignr_epi8 (cur, last, 12));
+            last      = cur;
+            t[k]      = _mm_shuffle_epi8 (d, gather);
+        }
+        PXR24_SSE_TRANSPOSE (t[0], t[1], t[2], t[3], p0, p1, p2, p3);
+        (void) p3;
+
+        _mm_storeu_si128 ((__m128i*) (out + x), p0);
+        _mm_storeu_si128 ((__m128i*) (out + w + x), p1);
+        _mm_storeu_si128 ((__m128i*) (out + 2 * w + x), p2);
+    }
+    *prev = (uint32_t) _mm_extract_epi32 (last, 3);
+    return x;
+}
+
+/* prefix sum of 4 32-bit lanes, plus the running total in last */
+EXR_TARGET_SSE4_1 static inline __m128i
+prefix_sum32_sse4_1 (__m128i v, __m128i* last)
+{
+    v     = _mm_add_epi32 (v, _mm_slli_si128 (v, 4));
+    v     = _mm_add_epi32 (v, _mm_slli_si128 (v, 8));
+    v     = _mm_add_epi32 (v, *last);
+    *last = _mm_shuffle_epi32 (v, 0xff);
+    return v;
+}
+
+/* p0 is the most significant byte plane, p3 the least */
+EXR_TARGET_SSE4_1 static inline int
+decode_32_sse4_1 (
+    uint8_t*       out,
+    const uint8_t* p0,
+    const uint8_t* p1,
+    const uint8_t* p2,
+    const uint8_t* p3,
+    int            w,
+    uint32_t*      prev)
+{
+    __m128i last = _mm_set1_epi32 ((int) *prev);
+    int     x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i b0 = _mm_loadu_si128 ((const __m128i*) (p0 + x));
+        __m128i b1 = _mm_loadu_si128 ((const __m128i*) (p1 + x));
+        __m128i b2 = _mm_loadu_si128 ((const __m128i*) (p2 + x));
+        __m128i b3 = p3 ? _mm_loadu_si128 ((const __m128i*) (p3 + x))
+                        : _mm_setzero_si128 ();
+        __m128i lo, hi;
+
+        lo = _mm_unpacklo_epi8 (b3, b2);
+        hi = _mm_unpacklo_epi8 (b1, b0);
+        _mm_storeu_si128 (
+            (__m128i*) (out + 4 * x),
+            prefix_sum32_sse4_1 (_mm_unpacklo_epi16 (lo, hi), &last));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 4 * x + 16),
+            prefix_sum32_sse4_1 (_mm_unpackhi_epi16 (lo, hi), &last));
+
+        lo = _mm_unpackhi_epi8 (b3, b2);
+        hi = _mm_unpackhi_epi8 (b1, b0);
+        _mm_storeu_si128 (
+            (__m128i*) (out + 4 * x + 32),
+            prefix_sum32_sse4_1 (_mm_unpacklo_epi16 (lo, hi), &last));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 4 * x + 48),
+            prefix_sum32_sse4_1 (_mm_unpackhi_epi16 (lo, hi), &last));
+    }
+    *prev = (uint32_t) _mm_cvtsi128_si32 (last);
+    return x;
+}
+
+EXR_TARGET_SSE4_1 static inline __m128i
+prefix_sum16_sse4_1 (__m128i v, __m128i* last)
+{
+    v     = _mm_add_epi16 (v, _mm_slli_si128 (v, 2));
+    v     = _mm_add_epi16 (v, _mm_slli_si128 (v, 4));
+    v     = _mm_add_epi16 (v, _mm_slli_si128 (v, 8));
+    v     = _mm_add_epi16 (v, *last);
+    *last = _mm_shuffle_epi8 (v, _mm_set1_epi16 (0x0f0e));
+    return v;
+}
+
+EXR_TARGET_SSE4_1 static inline int
+decode_half_sse4_1 (uint8_t* out, const uint8_t* in, int w, uint32_t* prev)
+{
+    __m128i last = _mm_set1_epi16 ((short) *prev);
+    int     x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i hi = _mm_loadu_si128 ((const __m128i*) (in + x));
+        __m128i lo = _mm_loadu_si128 ((const __m128i*) (in + w + x));
+
+        _mm_storeu_si128 (
+            (__m128i*) (out + 2 * x),
+            prefix_sum16_sse4_1 (_mm_unpacklo_epi8 (lo, hi), &last));
+        _mm_storeu_si128 (
+            (__m128i*) (out + 2 * x + 16),
+            prefix_sum16_sse4_1 (_mm_unpackhi_epi8 (lo, hi), &last));
+    }
+    *prev = (uint32_t) (uint16_t) _mm_extract_epi16 (last, 0);
+    return x;
+}
+
+#endif /* PXR24_SSE4_1 */
+
+#ifdef PXR24_NEON
+
+static inline uint32x4_t
+float_to_float24_neon (uint32x4_t f)
+{
+    uint32x4_t a, m, rnd, trn, fin, spec, nan;
+
+    a   = vandq_u32 (f, vdupq_n_u32 (0x7fffffff));
+    m   = vandq_u32 (f, vdupq_n_u32 (0x007fffff));
+    rnd = vshrq_n_u32 (vaddq_u32 (a, vandq_u32 (a, vdupq_n_u32 (0x80))), 8);
+    trn = vshrq_n_u32 (a, 8);
+
+    fin = vbslq_u32 (vcgeq_u32 (rnd, vdupq_n_u32 (0x7f8000)), trn, rnd);
+
+    nan = vbicq_u32 (
+        vceqq_u32 (vandq_u32 (trn, vdupq_n_u32 (0x7fff)), vdupq_n_u32 (0)),
+        vceqq_u32 (m, vdupq_n_u32 (0)));
+    spec = vorrq_u32 (trn, vandq_u32 (nan, vdupq_n_u32 (1)));
+
+    fin = vbslq_u32 (vcgeq_u32 (a, vdupq_n_u32 (0x7f800000)), spec, fin);
+
+    return vorrq_u32 (
+        fin, vandq_u32 (vshrq_n_u32 (f, 8), vdupq_n_u32 (0x800000)));
+}
+
+/*
+ * Differences of 16 32-bit values, split into byte planes b[0]
+ * (least significant) to b[3]
+ */
+static inline void
+delta_planes_neon (
+    uint32x4_t v[4], uint32x4_t* last, uint8x16_t b[4])
+{
+    uint8x16_t   d[4];
+    uint8x16x2_t e01, e23, b02, b13;
+
+    for (int k = 0; k < 4; ++k)
+    {
+        d[k] = vreinterpretq_u8_u32 (
+            vsubq_u32 (v[k], vextq_u32 (*last, v[k], 3)));
+        *last = v[k];
+    }
+
+    e01 = vuzpq_u8 (d[0], d[1]);
+    e23 = vuzpq_u8 (d[2], d[3]);
+    b02 = vuzpq_u8 (e01.val[0], e23.val[0]);
+    b13 = vuzpq_u8 (e01.val[1], e23.val[1]);
+
+    b[0] = b02.val[0];
+    b[1] = b13.val[0];
+    b[2] = b02.val[1];
+    b[3] = b13.val[1];
+}
+
+static inline int
+encode_uint_neon (uint8_t* out, const uint8_t* in, int w, uint32_t* prev)
+{
+    uint32x4_t last = vdupq_n_u32 (*prev);
+    int        x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint32x4_t v[4];
+        uint8x16_t b[4];
+
+        for (int k = 0; k < 4; ++k)
+            v[k] = vreinterpretq_u32_u8 (vld1q_u8 (in + 4 * (x + 4 * k)));
+        delta_planes_neon (v, &last, b);
+
+        vst1q_u8 (out + x, b[3]);
+        vst1q_u8 (out + w + x, b[2]);
+        vst1q_u8 (out + 2 * w + x, b[1]);
+        vst1q_u8 (out + 3 * w + x, b[0]);
+    }
+    *prev = vgetq_lane_u32 (last, 3);
+    return x;
+}
+
+static inline int
+encode_half_neon (uint8_t* out, const uint8_t* in, int w, uint32_t* prev)
+{
+    uint16x8_t last = vdupq_n_u16 ((uint16_t) *prev);
+    int        x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint16x8_t   c0 = vreinterpretq_u16_u8 (vld1q_u8 (in + 2 * x));
+        uint16x8_t   c1 = vreinterpretq_u16_u8 (vld1q_u8 (in + 2 * x + 16));
+        uint16x8_t   d0 = vsubq_u16 (c0, vextq_u16 (last, c0, 7));
+        uint16x8_t   d1 = vsubq_u16 (c1, vextq_u16 (c0, c1, 7));
+        uint8x16x2_t b =
+            vuzpq_u8 (vreinterpretq_u8_u16 (d0), vreinterpretq_u8_u16 (d1));
+
+        last = c1;
+        vst1q_u8 (out + x, b.val[1]);
+        vst1q_u8 (out + w + x, b.val[0]);
+    }
+    *prev = vgetq_lane_u16 (last, 7);
+    return x;
+}
+
+static inline int
+encode_float_neon (uint8_t* out, const uint8_t* in, int w, uint32_t* prev)
+{
+    uint32x4_t last = vdupq_n_u32 (*prev);
+    int        x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint32x4_t v[4];
+        uint8x16_t b[4];
+
+        for (int k = 0; k < 4; ++k)
+            v[k] = float_to_float24_neon (
+                vreinterpretq_u32_u8 (vld1q_u8 (in + 4 * (x + 4 * k))));
+        delta_planes_neon (v, &last, b);
+
+        vst1q_u8 (out + x, b[2]);
+        vst1q_u8 (out + w + x, b[1]);
+        vst1q_u8 (out + 2 * w + x, b[0]);
+    }
+    *prev = vgetq_lane_u32 (last, 3);
+    return x;
+}
+
+static inline uint32x4_t
+prefix_sum32_neon (uint32x4_t v, uint32x4_t* last)
+{
+    const uint32x4_t zero = vdupq_n_u32 (0);
+
+    v     = vaddq_u32 (v, vextq_u32 (zero, v, 3));
+    v     = vaddq_u32 (v, vextq_u32 (zero, v, 2));
+    v     = vaddq_u32 (v, *last);
+    *last = vdupq_n_u32 (vgetq_lane_u32 (v, 3));
+    return v;
+}
+
+static inline int
+decode_32_neon (
+    uint8_t*       out,
+    const uint8_t* p0,
+    const uint8_t* p1,
+    const uint8_t* p2,
+    const uint8_t* p3,
+    int            w,
+    uint32_t*      prev)
+{
+    uint32x4_t last = vdupq_n_u32 (*prev);
+    int        x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint8x16_t   b0 = vld1q_u8 (p0 + x);
+        uint8x16_t   b1 = vld1q_u8 (p1 + x);
+        uint8x16_t   b2 = vld1q_u8 (p2 + x);
+        uint8x16_t   b3 = p3 ? vld1q_u8 (p3 + x) : vdupq_n_u8 (0);
+        uint8x16x2_t lo = vzipq_u8 (b3, b2);
+        uint8x16x2_t hi = vzipq_u8 (b1, b0);
+
+        for (int h = 0; h < 2; ++h)
+        {
+            uint16x8x2_t v = vzipq_u16 (
+                vreinterpretq_u16_u8 (lo.val[h]),
+                vreinterpretq_u16_u8 (hi.val[h]));
+
+            for (int k = 0; k < 2; ++k)
+            {
+                vst1q_u8 (
+                    out + 4 * x + 32 * h + 16 * k,
+                    vreinterpretq_u8_u32 (prefix_sum32_neon (
+                        vreinterpretq_u32_u16 (v.val[k]), &last)));
+            }
+        }
+    }
+    *prev = vgetq_lane_u32 (last, 0);
+    return x;
+}
+
+static inline int
+decode_half_neon (uint8_t* out, const uint8_t* in, int w, uint32_t* prev)
+{
+    const uint16x8_t zero = vdupq_n_u16 (0);
+    uint16x8_t       last = vdupq_n_u16 ((uint16_t) *prev);
+    int              x    = 0;
+
+    for (; x + 16 <= w; x += 16)
+    {
+        uint8x16x2_t z = vzipq_u8 (vld1q_u8 (in + w + x), vld1q_u8 (in + x));
+
+        for (int h = 0; h < 2; ++h)
+        {
+            uint16x8_t v = vreinterpretq_u16_u8 (z.val[h]);
+
+            v    = vaddq_u16 (v, vextq_u16 (zero, v, 7));
+            v    = vaddq_u16 (v, vextq_u16 (zero, v, 6));
+            v    = vaddq_u16 (v, vextq_u16 (zero, v, 4));
+            v    = vaddq_u16 (v, last);
+            last = vdupq_n_u16 (vgetq_lane_u16 (v, 7));
+            vst1q_u8 (out + 2 * x + 16 * h, vreinterpretq_u8_u16 (v));
+        }
+    }
+    *prev = vgetq_lane_u16 (last, 0);
+    return x;
+}
+
+#endif /* PXR24_NEON */
+
+/**************************************/
+
+static inline void
+encode_uint_line (uint8_t* out, const uint8_t* in, int w, int simd)
+{
+    uint32_t prev = 0;
+    int      x    = 0;
+
+#if defined(PXR24_SSE4_1)
+    if (simd & EXR_X86_SIMD_SSE4_1) x = encode_uint_sse4_1 (out, in, w, &prev);
+#elif defined(PXR24_NEON)
+    if (simd) x = encode_uint_neon (out, in, w, &prev);
+#endif
+    (void) simd;
+
+    for (; x < w; ++x)
+    {
+        uint32_t pixel = unaligned_load32 (in + 4 * x);
+        uint32_t diff  = pixel - prev;
+        prev           = pixel;
+
+        out[x]         = (uint8_t) (diff >> 24);
+        out[w + x]     = (uint8_t) (diff >> 16);
+        out[2 * w + x] = (uint8_t) (diff >> 8);
+        out[3 * w + x] = (uint8_t) (diff);
+    }
+}
+
+static inline void
+encode_half_line (uint8_t* out, const uint8_t* in, int w, int simd)
+{
+    uint32_t prev = 0;
+    int      x    = 0;
+
+#if defined(PXR24_SSE4_1)
+    if (simd & EXR_X86_SIMD_SSE4_1) x = encode_half_sse4_1 (out, in, w, &prev);
+#elif defined(PXR24_NEON)
+    if (simd) x = encode_half_neon (out, in, w, &prev);
+#endif
+    (void) simd;
+
+    for (; x < w; ++x)
+    {
+        uint32_t pixel = (uint32_t) unaligned_load16 (in + 2 * x);
+        uint32_t diff  = pixel - prev;
+        prev           = pixel;
+
+        out[x]     = (uint8_t) (diff >> 8);
+        out[w + x] = (uint8_t) (diff);
+    }
+}
+
+static inline void
+encode_float_line (uint8_t* out, const uint8_t* in, int w, int simd)
+{
+    uint32_t prev = 0;
+    int      x    = 0;
+
+#if defined(PXR24_SSE4_1)
+    if (simd & EXR_X86_SIMD_SSE4_1)
+        x = encode_float_sse4_1 (out, in, w, &prev);
+#elif defined(PXR24_NEON)
+    if (simd) x = encode_float_neon (out, in, w, &prev);
+#endif
+    (void) simd;
+
+    for (; x < w; ++x)
+    {
+        union
+        {
+            uint32_t i;
+            float    f;
+        } v;
+        uint32_t pixel24, diff;
+
+        v.i     = unaligned_load32 (in + 4 * x);
+        pixel24 = float_to_float24 (v.f);
+        diff    = pixel24 - prev;
+        prev    = pixel24;
+
+        out[x]         = (uint8_t) (diff >> 16);
+        out[w + x]     = (uint8_t) (diff >> 8);
+        out[2 * w + x] = (uint8_t) (diff);
+    }
+}
+
+static inline void
+decode_uint_line (uint8_t* out, const uint8_t* in, int w, int simd)
+{
+    const uint8_t* p0    = in;
+    const uint8_t* p1    = p0 + w;
+    const uint8_t* p2    = p1 + w;
+    const uint8_t* p3    = p2 + w;
+    uint32_t       pixel = 0;
+    int            x     = 0;
+
+#if defined(PXR24_SSE4_1)
+    if (simd & EXR_X86_SIMD_SSE4_1)
+        x = decode_32_sse4_1 (out, p0, p1, p2, p3, w, &pixel);
+#elif defined(PXR24_NEON)
+    if (simd) x = decode_32_neon (out, p0, p1, p2, p3, w, &pixel);
+#endif
+    (void) simd;
+
+    for (; x < w; ++x)
+    {
+        uint32_t diff =
+            (((uint32_t) (p0[x]) << 24) | ((uint32_t) (p1[x]) << 16) |
+             ((uint32_t) (p2[x]) << 8) | ((uint32_t) (p3[x])));
+        pixel += diff;
+        unaligned_store32 (out + 4 * x, pixel);
+    }
+}
+
+static inline void
+decode_half_line (uint8_t* out, const uint8_t* in, int w, int simd)
+{
+    const uint8_t* p0    = in;
+    const uint8_t* p1    = p0 + w;
+    uint32_t       pixel = 0;
+    int            x     = 0;
+
+#if defined(PXR24_SSE4_1)
+    if (simd & EXR_X86_SIMD_SSE4_1) x = decode_half_sse4_1 (out, in, w, &pixel);
+#elif defined(PXR24_NEON)
+    if (simd) x = decode_half_neon (out, in, w, &pixel);
+#endif
+    (void) simd;
+
+    for (; x < w; ++x)
+    {
+        uint32_t diff = (((uint32_t) (p0[x]) << 8) | ((uint32_t) (p1[x])));
+        pixel += diff;
+        unaligned_store16 (out + 2 * x, (uint16_t) pixel);
+    }
+}
+
+static inline void
+decode_float_line (uint8_t* out, const uint8_t* in, int w, int simd)
+{
+    const uint8_t* p0    = in;
+    const uint8_t* p1    = p0 + w;
+    const uint8_t* p2    = p1 + w;
+    uint32_t       pixel = 0;
+    int            x     = 0;
+
+#if defined(PXR24_SSE4_1)
+    if (simd & EXR_X86_SIMD_SSE4_1)
+        x = decode_32_sse4_1 (out, p0, p1, p2, NULL, w, &pixel);
+#elif defined(PXR24_NEON)
+    if (simd) x = decode_32_neon (out, p0, p1, p2, NULL, w, &pixel);
+#endif
+    (void) simd;
+
+    for (; x < w; ++x)
+    {
+        uint32_t diff =
+            (((uint32_t) (p0[x]) << 24) | ((uint32_t) (p1[x]) << 16) |
+             ((uint32_t) (p2[x]) << 8));
+        pixel += diff;
+        unaligned_store32 (out + 4 * x, pixel);
+    }
+}
+
+#endif /* OPENEXR_CORE_PXR24_SIMD_H */
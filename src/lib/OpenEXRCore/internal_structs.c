@@ -5,6 +5,7 @@
 
 #include "openexr_config.h"
 #include "internal_structs.h"
+#include "internal_async.h"
 #include "internal_attr.h"
 #include "internal_constants.h"
 #include "internal_memory.h"
@@ -160,6 +161,7 @@ internal_exr_destroy_part (
 {
     exr_memory_free_func_t dofree = ctxt->free_fn;
     uint64_t*              ctable;
+    void*                  itable;
 
     exr_attr_list_destroy ((exr_context_t) ctxt, &(cur->attributes));
 
@@ -170,11 +172,17 @@ internal_exr_destroy_part (
     ctable = (uint64_t*) InterlockedOr64 (
         (int64_t volatile*) &(cur->chunk_table), 0);
     cur->chunk_table = 0;
+    itable =
+        (void*) InterlockedOr64 ((int64_t volatile*) &(cur->chunk_info_table), 0);
+    cur->chunk_info_table = 0;
 #else
     ctable = (uint64_t*) atomic_load (&(cur->chunk_table));
     atomic_store (&(cur->chunk_table), (uintptr_t) (0));
+    itable = (void*) atomic_load (&(cur->chunk_info_table));
+    atomic_store (&(cur->chunk_info_table), (uintptr_t) (0));
 #endif
     if (ctable) dofree (ctable);
+    if (itable) dofree (itable);
 }
 
 /**************************************/
@@ -247,6 +255,7 @@ internal_exr_add_part (
 
     part->zip_compression_level = f->default_zip_level;
     part->dwa_compression_level = f->default_dwa_quality;
+    exr_get_default_zstd_compression_level (&(part->zstd_compression_level));
 
     /* put it into the part table */
     if (ncount > 1)
@@ -313,9 +322,10 @@ exr_result_t
 internal_exr_context_restore_handlers (
     struct _internal_exr_context* ctxt, exr_result_t rv)
 {
-    ctxt->standard_error = &dispatch_standard_error;
-    ctxt->report_error   = &dispatch_error;
-    ctxt->print_error    = &dispatch_print_error;
+    ctxt->standard_error      = &dispatch_standard_error;
+    ctxt->report_error        = &dispatch_error;
+    ctxt->print_error         = &dispatch_print_error;
+    ctxt->header_arena_active = 0;
     return rv;
 }
 
@@ -414,12 +424,30 @@ internal_exr_alloc_context (
              EXR_CONTEXT_FLAG_DISABLE_CHUNK_RECONSTRUCTION);
         ret->legacy_header =
             (initializers->flags & EXR_CONTEXT_FLAG_WRITE_LEGACY_HEADER);
+        ret->memory_map =
+            (initializers->flags & EXR_CONTEXT_FLAG_MEMORY_MAP) ? 1 : 0;
+        if (mode == EXR_CONTEXT_READ &&
+            (initializers->flags & EXR_CONTEXT_FLAG_HEADER_ONLY))
+        {
+            ret->header_only = 1;
+            ret->memory_map  = 0;
+        }
+        if (mode == EXR_CONTEXT_READ &&
+            (initializers->flags & EXR_CONTEXT_FLAG_HEADER_ARENA))
+            ret->use_header_arena = 1;
+        if (mode == EXR_CONTEXT_READ && initializers->chunk_read_ahead > 0)
+            ret->chunk_read_ahead = (uint64_t) initializers->chunk_read_ahead;
+        if (initializers->header_prefetch > 0)
+            ret->header_prefetch = (uint64_t) initializers->header_prefetch;
 
         ret->file_size       = -1;
         ret->max_name_length = EXR_SHORTNAME_MAXLEN;
 
         ret->destroy_fn = initializers->destroy_fn;
         ret->read_fn    = initializers->read_fn;
+        ret->read_async_fn =
+            initializers->read_async_fn ? initializers->read_async_fn
+                                        : &internal_exr_queue_read;
         ret->write_fn   = initializers->write_fn;
 
 #ifdef ILMTHREAD_THREADING_ENABLED
@@ -470,6 +498,76 @@ internal_exr_alloc_context (
 
 /**************************************/
 
+/* the first block of a header arena, each further one is twice the
+ * size of the previous one up to the max, allocations bigger than a
+ * quarter of the first block (previews, big opaque attributes, ...)
+ * do not go in the arena */
+#define EXR_HEADER_ARENA_BLOCK_SIZE 16384
+#define EXR_HEADER_ARENA_BLOCK_MAX (256 * 1024)
+#define EXR_HEADER_ARENA_ALIGN 16
+#define EXR_HEADER_ARENA_ROUND(x)                                              \
+    (((x) + (EXR_HEADER_ARENA_ALIGN - 1)) &                                    \
+     ~((size_t) (EXR_HEADER_ARENA_ALIGN - 1)))
+#define EXR_HEADER_ARENA_BLOCK_HEADER                                          \
+    EXR_HEADER_ARENA_ROUND (sizeof (struct _internal_exr_arena_block))
+#define EXR_HEADER_ARENA_BLOCK_DATA(b)                                         \
+    (((uint8_t*) (b)) + EXR_HEADER_ARENA_BLOCK_HEADER)
+
+void*
+internal_exr_header_alloc (struct _internal_exr_context* ctxt, size_t bytes)
+{
+    struct _internal_exr_arena_block* blk = ctxt->header_arena;
+    void*                             ret;
+
+    if (!ctxt->header_arena_active || bytes > EXR_HEADER_ARENA_BLOCK_SIZE / 4)
+        return ctxt->alloc_fn (bytes);
+
+    bytes = EXR_HEADER_ARENA_ROUND (bytes);
+    if (!blk || blk->size - blk->used < bytes)
+    {
+        size_t                            bsz = EXR_HEADER_ARENA_BLOCK_SIZE;
+        struct _internal_exr_arena_block* nblk;
+
+        if (blk) bsz = blk->size * 2;
+        if (bsz > EXR_HEADER_ARENA_BLOCK_MAX) bsz = EXR_HEADER_ARENA_BLOCK_MAX;
+
+        nblk = ctxt->alloc_fn (EXR_HEADER_ARENA_BLOCK_HEADER + bsz);
+        if (!nblk) return NULL;
+
+        nblk->next         = blk;
+        nblk->size         = bsz;
+        nblk->used         = 0;
+        ctxt->header_arena = nblk;
+        blk                = nblk;
+    }
+
+    ret = EXR_HEADER_ARENA_BLOCK_DATA (blk) + blk->used;
+    blk->used += bytes;
+    return ret;
+}
+
+/**************************************/
+
+void
+internal_exr_header_free (const struct _internal_exr_context* ctxt, void* ptr)
+{
+    const struct _internal_exr_arena_block* blk = ctxt->header_arena;
+    const uint8_t*                          p   = (const uint8_t*) ptr;
+
+    if (!ptr) return;
+
+    /* anything in the arena goes with the arena */
+    while (blk)
+    {
+        const uint8_t* data = EXR_HEADER_ARENA_BLOCK_DATA (blk);
+        if (p >= data && p < data + blk->size) return;
+        blk = blk->next;
+    }
+    ctxt->free_fn (ptr);
+}
+
+/**************************************/
+
 void
 internal_exr_destroy_context (struct _internal_exr_context* ctxt)
 {
@@ -479,6 +577,17 @@ internal_exr_destroy_context (struct _internal_exr_context* ctxt)
     exr_attr_string_destroy ((exr_context_t) ctxt, &(ctxt->tmp_filename));
     exr_attr_list_destroy ((exr_context_t) ctxt, &(ctxt->custom_handlers));
     internal_exr_destroy_parts (ctxt);
+    for (int s = 0; s < EXR_CHUNK_CACHE_SLOTS; ++s)
+    {
+        if (ctxt->chunk_cache[s].data) dofree (ctxt->chunk_cache[s].data);
+    }
+    if (ctxt->chunk_table_prefix) dofree (ctxt->chunk_table_prefix);
+    while (ctxt->header_arena)
+    {
+        struct _internal_exr_arena_block* next = ctxt->header_arena->next;
+        dofree (ctxt->header_arena);
+        ctxt->header_arena = next;
+    }
 #ifdef ILMTHREAD_THREADING_ENABLED
 #    ifdef _WIN32
     DeleteCriticalSection (&(ctxt->mutex));
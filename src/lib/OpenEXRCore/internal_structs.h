@@ -62,6 +62,11 @@ typedef uint64_t atomic_uintptr_t;
 #    endif
 #endif
 
+/* number of chunks measured and candidate levels when auto-tuning
+ * the zip compression level */
+#define EXR_ZIP_TUNING_SAMPLE_CHUNKS 4
+#define EXR_ZIP_TUNING_LEVEL_COUNT 5
+
 struct _internal_exr_part
 {
     int part_index;
@@ -99,6 +104,20 @@ struct _internal_exr_part
 
     int32_t zip_compression_level;
     float   dwa_compression_level;
+    int32_t zstd_compression_level;
+
+    /* zip level auto-tuning, see internal_zip.c */
+    int32_t          zip_tuning_mode;
+    float            zip_tuning_target;
+    atomic_uintptr_t zip_tuning_claimed;
+    atomic_uintptr_t zip_tuning_measured;
+    atomic_uintptr_t zip_tuning_level; /**< tuned level + 1, 0 until known */
+    struct
+    {
+        uint64_t in_bytes;
+        uint64_t out_bytes[EXR_ZIP_TUNING_LEVEL_COUNT];
+        uint64_t nanos[EXR_ZIP_TUNING_LEVEL_COUNT];
+    } zip_tuning_samples[EXR_ZIP_TUNING_SAMPLE_CHUNKS];
 
     int32_t  num_tile_levels_x;
     int32_t  num_tile_levels_y;
@@ -114,6 +133,8 @@ struct _internal_exr_part
     int32_t          chunk_count;
     uint64_t         chunk_table_offset;
     atomic_uintptr_t chunk_table;
+    /* resolved exr_chunk_info_t per chunk, see chunk.c */
+    atomic_uintptr_t chunk_info_table;
 };
 
 enum _INTERNAL_EXR_READ_MODE
@@ -131,6 +152,31 @@ enum _INTERNAL_EXR_CONTEXT_MODE
     EXR_CONTEXT_WRITE_FINISHED
 };
 
+/* chunk data read along with the chunk leaders, see chunk.c */
+#define EXR_CHUNK_CACHE_SLOTS 8
+
+struct _internal_exr_chunk_cache_slot
+{
+    uint64_t offset;
+    uint64_t size;
+    uint64_t stamp;
+    uint8_t* data;
+    uint64_t alloc_size;
+    /* readers copying out, or the filling thread */
+    int32_t users;
+    /* read to the end once, so the first to be replaced */
+    int32_t spent;
+};
+
+/* blocks the header attributes are carved from when the context has
+ * a header arena, see internal_exr_header_alloc */
+struct _internal_exr_arena_block
+{
+    struct _internal_exr_arena_block* next;
+    size_t                            size;
+    size_t                            used;
+};
+
 struct _internal_exr_context
 {
     uint8_t mode;
@@ -186,8 +232,31 @@ struct _internal_exr_context
     void*                         user_data;
     exr_destroy_stream_func_ptr_t destroy_fn;
 
-    int64_t             file_size;
-    exr_read_func_ptr_t read_fn;
+    int64_t                   file_size;
+    exr_read_func_ptr_t       read_fn;
+    exr_read_async_func_ptr_t read_async_fn;
+    /* worker thread serving read_async_fn on top of a blocking
+     * read_fn, started on first use */
+    struct _internal_exr_async_reader* async_reader;
+
+    /* set by the default file routines when the file is memory mapped */
+    const uint8_t* mapped_data;
+    uint64_t       mapped_size;
+
+    /* bytes past each chunk leader to read ahead, 0 when disabled,
+     * slots are claimed and released under the mutex */
+    uint64_t                              chunk_read_ahead;
+    uint64_t                              chunk_cache_clock;
+    struct _internal_exr_chunk_cache_slot chunk_cache[EXR_CHUNK_CACHE_SLOTS];
+
+    /* size of the first header read, 0 for the default */
+    uint64_t header_prefetch;
+    /* start of the chunk offset tables, read along with the header */
+    uint8_t* chunk_table_prefix;
+    uint64_t chunk_table_prefix_size;
+
+    /* most recent block first, only added to while a header is parsed */
+    struct _internal_exr_arena_block* header_arena;
 
     exr_write_func_ptr_t write_fn;
     /* used when writing under a mutex, is there a better way? */
@@ -217,7 +286,11 @@ struct _internal_exr_context
 #endif
     uint8_t disable_chunk_reconstruct;
     uint8_t legacy_header;
-    uint8_t _pad[6];
+    uint8_t memory_map;
+    uint8_t header_only;
+    uint8_t use_header_arena;
+    uint8_t header_arena_active;
+    uint8_t _pad[2];
 };
 
 #define EXR_CTXT(c) ((struct _internal_exr_context*) (c))
@@ -384,4 +457,13 @@ exr_result_t internal_exr_alloc_context (
     size_t                           extra_data);
 void internal_exr_destroy_context (struct _internal_exr_context* ctxt);
 
+/* Allocation routines for attribute data: while a header is parsed
+ * into a context with a header arena, these carve the memory out of
+ * the arena blocks, which are only released with the context, and
+ * otherwise use alloc_fn / free_fn. */
+void* internal_exr_header_alloc (
+    struct _internal_exr_context* ctxt, size_t bytes);
+void internal_exr_header_free (
+    const struct _internal_exr_context* ctxt, void* ptr);
+
 #endif /* OPENEXR_PRIVATE_STRUCTS_H */
@@ -110,7 +110,10 @@ widen_filename (struct _internal_exr_context* file, const char* fn)
 
 struct _internal_exr_filehandle
 {
-    HANDLE fd;
+    HANDLE         fd;
+    HANDLE         mapping;
+    const uint8_t* view;
+    uint64_t       view_size;
 };
 
 /**************************************/
@@ -122,6 +125,10 @@ default_shutdown (exr_const_context_t c, void* userdata, int failed)
     struct _internal_exr_filehandle* fh = userdata;
     if (fh)
     {
+        if (fh->view) UnmapViewOfFile (fh->view);
+        if (fh->mapping) CloseHandle (fh->mapping);
+        fh->view    = NULL;
+        fh->mapping = NULL;
         if (fh->fd != INVALID_HANDLE_VALUE) CloseHandle (fh->fd);
         fh->fd = INVALID_HANDLE_VALUE;
     }
@@ -193,6 +200,14 @@ default_read_func (
         return retsz;
     }
 
+    if (fh->view)
+    {
+        if (offset >= fh->view_size) return 0;
+        if (sz > fh->view_size - offset) sz = fh->view_size - offset;
+        memcpy (buffer, fh->view + offset, (size_t) sz);
+        return (int64_t) sz;
+    }
+
     fd = fh->fd;
     if (fd == INVALID_HANDLE_VALUE)
     {
@@ -302,6 +317,68 @@ default_write_func (
 
 /**************************************/
 
+static exr_result_t
+default_read_async_func (
+    exr_const_context_t          ctxt,
+    void*                        userdata,
+    void*                        buffer,
+    uint64_t                     sz,
+    uint64_t                     offset,
+    exr_read_complete_func_ptr_t complete_fn,
+    void*                        request,
+    exr_stream_error_func_ptr_t  error_cb)
+{
+    struct _internal_exr_filehandle* fh = userdata;
+
+    /* reads from the mapping cannot block, so are just done right
+     * away, everything else is handed to the context's reader thread */
+    if (fh && fh->view)
+    {
+        complete_fn (
+            ctxt,
+            request,
+            default_read_func (ctxt, userdata, buffer, sz, offset, error_cb));
+        return EXR_ERR_SUCCESS;
+    }
+
+    return internal_exr_queue_read (
+        ctxt, userdata, buffer, sz, offset, complete_fn, request, error_cb);
+}
+
+/**************************************/
+
+static void
+default_map_file (
+    struct _internal_exr_context* file, struct _internal_exr_filehandle* fh)
+{
+    /* mapping is only an optimization, so on any failure we quietly
+     * keep using regular reads */
+    LARGE_INTEGER lint;
+    HANDLE        mapping;
+    LPVOID        view;
+
+    if (!GetFileSizeEx (fh->fd, &lint) || lint.QuadPart <= 0) return;
+    if ((uint64_t) lint.QuadPart > (uint64_t) SIZE_MAX) return;
+
+    mapping = CreateFileMappingW (fh->fd, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) return;
+
+    view = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle (mapping);
+        return;
+    }
+
+    fh->mapping       = mapping;
+    fh->view          = (const uint8_t*) view;
+    fh->view_size     = (uint64_t) lint.QuadPart;
+    file->mapped_data = fh->view;
+    file->mapped_size = fh->view_size;
+}
+
+/**************************************/
+
 static exr_result_t
 default_init_read_file (struct _internal_exr_context* file)
 {
@@ -309,9 +386,13 @@ default_init_read_file (struct _internal_exr_context* file)
     HANDLE                           fd;
     struct _internal_exr_filehandle* fh = file->user_data;
 
-    fh->fd           = INVALID_HANDLE_VALUE;
-    file->destroy_fn = &default_shutdown;
-    file->read_fn    = &default_read_func;
+    fh->fd              = INVALID_HANDLE_VALUE;
+    fh->mapping         = NULL;
+    fh->view            = NULL;
+    fh->view_size       = 0;
+    file->destroy_fn    = &default_shutdown;
+    file->read_fn       = &default_read_func;
+    file->read_async_fn = &default_read_async_func;
 
     wcFn = widen_filename (file, file->filename.str);
     if (wcFn)
@@ -341,6 +422,8 @@ default_init_read_file (struct _internal_exr_context* file)
 
     fh->fd = fd;
 
+    if (file->memory_map) default_map_file (file, fh);
+
     return EXR_ERR_SUCCESS;
 }
 
@@ -357,6 +440,9 @@ default_init_write_file (struct _internal_exr_context* file)
     if (outfn == NULL) outfn = file->filename.str;
 
     fh->fd           = INVALID_HANDLE_VALUE;
+    fh->mapping      = NULL;
+    fh->view         = NULL;
+    fh->view_size    = 0;
     file->destroy_fn = &default_shutdown;
     file->write_fn   = &default_write_func;
 
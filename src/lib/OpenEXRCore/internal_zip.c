@@ -3,9 +3,15 @@
 ** Copyright Contributors to the OpenEXR Project.
 */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// for clock_gettime
+#    define _GNU_SOURCE
+#endif
+
 #include "internal_compress.h"
 #include "internal_decompress.h"
 
+#include "internal_byte_simd.h"
 #include "internal_coding.h"
 #include "internal_structs.h"
 
@@ -13,228 +19,54 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "openexr_compression.h"
-
-#if defined __SSE2__ || (_MSC_VER >= 1300 && (_M_IX86 || _M_X64))
-#    define IMF_HAVE_SSE2 1
-#    include <emmintrin.h>
-#    include <mmintrin.h>
-#endif
-#if defined __SSE4_1__
-#    define IMF_HAVE_SSE4_1 1
-#    include <smmintrin.h>
-#endif
-#if defined(__aarch64__)
-#    define IMF_HAVE_NEON_AARCH64 1
-#    include <arm_neon.h>
+#ifdef _WIN32
+#    include <windows.h>
+#else
+#    include <time.h>
 #endif
 
-/**************************************/
-
-#ifdef IMF_HAVE_SSE4_1
-static void
-reconstruct (uint8_t* buf, uint64_t outSize)
-{
-    static const uint64_t bytesPerChunk = sizeof (__m128i);
-    const uint64_t        vOutSize      = outSize / bytesPerChunk;
-    const __m128i         c             = _mm_set1_epi8 (-128);
-    const __m128i         shuffleMask   = _mm_set1_epi8 (15);
-    __m128i *             vBuf, vPrev;
-    uint8_t               prev;
-
-    /*
-     * The first element doesn't have its high bit flipped during compression,
-     * so it must not be flipped here.  To make the SIMD loop nice and
-     * uniform, we pre-flip the bit so that the loop will unflip it again.
-     */
-    buf[0] += -128;
-    vBuf  = (__m128i*) buf;
-    vPrev = _mm_setzero_si128 ();
-
-    for (uint64_t i = 0; i < vOutSize; ++i)
-    {
-        __m128i d = _mm_add_epi8 (_mm_loadu_si128 (vBuf), c);
-
-        /* Compute the prefix sum of elements. */
-        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 1));
-        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 2));
-        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 4));
-        d = _mm_add_epi8 (d, _mm_slli_si128 (d, 8));
-        d = _mm_add_epi8 (d, vPrev);
-
-        _mm_storeu_si128 (vBuf++, d);
-
-        // Broadcast the high byte in our result to all lanes of the prev
-        // value for the next iteration.
-        vPrev = _mm_shuffle_epi8 (d, shuffleMask);
-    }
-
-    prev = _mm_extract_epi8 (vPrev, 15);
-    for (uint64_t i = vOutSize * bytesPerChunk; i < outSize; ++i)
-    {
-        uint8_t d = prev + buf[i] - 128;
-        buf[i]    = d;
-        prev      = d;
-    }
-}
-#elif defined(IMF_HAVE_NEON_AARCH64)
-static void
-reconstruct (uint8_t* buf, uint64_t outSize)
-{
-    static const uint64_t bytesPerChunk = sizeof (uint8x16_t);
-    const uint64_t        vOutSize      = outSize / bytesPerChunk;
-    const uint8x16_t      c             = vdupq_n_u8 (-128);
-    const uint8x16_t      shuffleMask   = vdupq_n_u8 (15);
-    const uint8x16_t      zero          = vdupq_n_u8 (0);
-    uint8_t*              vBuf;
-    uint8x16_t            vPrev;
-    uint8_t               prev;
-
-    /*
-     * The first element doesn't have its high bit flipped during compression,
-     * so it must not be flipped here.  To make the SIMD loop nice and
-     * uniform, we pre-flip the bit so that the loop will unflip it again.
-     */
-    buf[0] += -128;
-    vBuf  = buf;
-    vPrev = vdupq_n_u8 (0);
-
-    for (uint64_t i = 0; i < vOutSize; ++i)
-    {
-        uint8x16_t d = vaddq_u8 (vld1q_u8 (vBuf), c);
-
-        /* Compute the prefix sum of elements. */
-        d = vaddq_u8 (d, vextq_u8 (zero, d, 16 - 1));
-        d = vaddq_u8 (d, vextq_u8 (zero, d, 16 - 2));
-        d = vaddq_u8 (d, vextq_u8 (zero, d, 16 - 4));
-        d = vaddq_u8 (d, vextq_u8 (zero, d, 16 - 8));
-        d = vaddq_u8 (d, vPrev);
-
-        vst1q_u8 (vBuf, d);
-        vBuf += sizeof (uint8x16_t);
-
-        // Broadcast the high byte in our result to all lanes of the prev
-        // value for the next iteration.
-        vPrev = vqtbl1q_u8 (d, shuffleMask);
-    }
-
-    prev = vgetq_lane_u8 (vPrev, 15);
-    for (uint64_t i = vOutSize * bytesPerChunk; i < outSize; ++i)
-    {
-        uint8_t d = prev + buf[i] - 128;
-        buf[i]    = d;
-        prev      = d;
-    }
-}
+#include "openexr_compression.h"
+#include "openexr_part.h"
+
+#ifdef EXR_HAS_STD_ATOMICS
+#    include <stdatomic.h>
+#elif defined(_MSC_VER)
+#    define atomic_load(object) InterlockedOr64 ((int64_t volatile*) object, 0)
+#    define atomic_store(object, desired)                                     \
+        InterlockedExchange64 ((int64_t volatile*) object, (int64_t) desired)
+#    define atomic_fetch_add(object, operand)                                 \
+        InterlockedExchangeAdd64 ((int64_t volatile*) object, (int64_t) operand)
 #else
-static void
-reconstruct (uint8_t* buf, uint64_t sz)
-{
-    uint8_t* t    = buf + 1;
-    uint8_t* stop = buf + sz;
-    while (t < stop)
-    {
-        int d = (int) (t[-1]) + (int) (t[0]) - 128;
-        t[0]  = (uint8_t) d;
-        ++t;
-    }
-}
+#    error OS unimplemented support for atomics
 #endif
 
 /**************************************/
 
-#ifdef IMF_HAVE_SSE2
-static void
-interleave (uint8_t* out, const uint8_t* source, uint64_t outSize)
-{
-    static const uint64_t bytesPerChunk = 2 * sizeof (__m128i);
-    const uint64_t        vOutSize      = outSize / bytesPerChunk;
-    const __m128i*        v1            = (const __m128i*) source;
-    const __m128i*        v2   = (const __m128i*) (source + (outSize + 1) / 2);
-    __m128i*              vOut = (__m128i*) out;
-    const uint8_t *       t1, *t2;
-    uint8_t*              sOut;
-
-    for (uint64_t i = 0; i < vOutSize; ++i)
-    {
-        __m128i a  = _mm_loadu_si128 (v1++);
-        __m128i b  = _mm_loadu_si128 (v2++);
-        __m128i lo = _mm_unpacklo_epi8 (a, b);
-        __m128i hi = _mm_unpackhi_epi8 (a, b);
-
-        _mm_storeu_si128 (vOut++, lo);
-        _mm_storeu_si128 (vOut++, hi);
-    }
-
-    t1   = (const uint8_t*) v1;
-    t2   = (const uint8_t*) v2;
-    sOut = (uint8_t*) vOut;
-
-    for (uint64_t i = vOutSize * bytesPerChunk; i < outSize; ++i)
-        *(sOut++) = (i % 2 == 0) ? *(t1++) : *(t2++);
-}
-
-#elif defined(IMF_HAVE_NEON_AARCH64)
-static void
-interleave (uint8_t* out, const uint8_t* source, uint64_t outSize)
+void
+internal_zip_reconstruct_bytes (uint8_t* out, uint8_t* source, uint64_t count)
 {
-    static const uint64_t bytesPerChunk = 2 * sizeof (uint8x16_t);
-    const uint64_t        vOutSize      = outSize / bytesPerChunk;
-    const uint8_t*        v1            = source;
-    const uint8_t*        v2            = source + (outSize + 1) / 2;
-
-    for (uint64_t i = 0; i < vOutSize; ++i)
-    {
-        uint8x16_t a = vld1q_u8 (v1);
-        v1 += sizeof (uint8x16_t);
-        uint8x16_t b = vld1q_u8 (v2);
-        v2 += sizeof (uint8x16_t);
-        uint8x16_t lo = vzip1q_u8 (a, b);
-        uint8x16_t hi = vzip2q_u8 (a, b);
-
-        vst1q_u8 (out, lo);
-        out += sizeof (uint8x16_t);
-        vst1q_u8 (out, hi);
-        out += sizeof (uint8x16_t);
-    }
+#if defined(EXR_BYTE_SIMD_X86_DISPATCH)
+    int simd = internal_exr_x86_byte_simd ();
 
-    for (uint64_t i = vOutSize * bytesPerChunk; i < outSize; ++i)
-        *(out++) = (i % 2 == 0) ? *(v1++) : *(v2++);
-}
+    if (simd & EXR_X86_SIMD_SSE4_1)
+        exr_reconstruct_sse4_1 (source, count);
+    else
+        exr_reconstruct_scalar (source, count);
 
+    if (simd & EXR_X86_SIMD_AVX2)
+        exr_interleave_avx2 (out, source, count);
+    else
+        exr_interleave_sse2 (out, source, count);
+#elif defined(EXR_BYTE_SIMD_NEON)
+    exr_reconstruct_neon (source, count);
+    exr_interleave_neon (out, source, count);
+#elif defined(EXR_BYTE_SIMD_SSE2)
+    exr_reconstruct_scalar (source, count);
+    exr_interleave_sse2 (out, source, count);
 #else
-
-static void
-interleave (uint8_t* out, const uint8_t* source, uint64_t outSize)
-{
-    const uint8_t* t1   = source;
-    const uint8_t* t2   = source + (outSize + 1) / 2;
-    uint8_t*       s    = out;
-    uint8_t* const stop = s + outSize;
-
-    while (1)
-    {
-        if (s < stop)
-            *(s++) = *(t1++);
-        else
-            break;
-
-        if (s < stop)
-            *(s++) = *(t2++);
-        else
-            break;
-    }
-}
-
+    exr_reconstruct_scalar (source, count);
+    exr_interleave_scalar (out, source, count);
 #endif
-
-/**************************************/
-
-void
-internal_zip_reconstruct_bytes (uint8_t* out, uint8_t* source, uint64_t count)
-{
-    reconstruct (source, count);
-    interleave (out, source, count);
 }
 
 /**************************************/
@@ -243,31 +75,27 @@ void
 internal_zip_deconstruct_bytes (
     uint8_t* scratch, const uint8_t* source, uint64_t count)
 {
-    int            p;
-    uint8_t*       t1   = scratch;
-    uint8_t*       t2   = t1 + (count + 1) / 2;
-    const uint8_t* raw  = source;
-    const uint8_t* stop = raw + count;
-
-    /* reorder */
-    while (raw < stop)
+#if defined(EXR_BYTE_SIMD_X86_DISPATCH)
+    if (internal_exr_x86_byte_simd () & EXR_X86_SIMD_AVX2)
     {
-        *(t1++) = *(raw++);
-        if (raw < stop) *(t2++) = *(raw++);
+        exr_deinterleave_avx2 (scratch, source, count);
+        exr_predict_avx2 (scratch, count);
     }
-
-    /* reorder */
-    t1 = scratch;
-    t2 = t1 + count;
-    t1++;
-    p = (int) t1[-1];
-    while (t1 < t2)
+    else
     {
-        int d = (int) (t1[0]) - p + (128 + 256);
-        p     = (int) t1[0];
-        t1[0] = (uint8_t) d;
-        ++t1;
+        exr_deinterleave_sse2 (scratch, source, count);
+        exr_predict_sse2 (scratch, count);
     }
+#elif defined(EXR_BYTE_SIMD_NEON)
+    exr_deinterleave_neon (scratch, source, count);
+    exr_predict_neon (scratch, count);
+#elif defined(EXR_BYTE_SIMD_SSE2)
+    exr_deinterleave_sse2 (scratch, source, count);
+    exr_predict_sse2 (scratch, count);
+#else
+    exr_deinterleave_scalar (scratch, source, count);
+    exr_predict_scalar (scratch, count);
+#endif
 }
 
 /**************************************/
@@ -342,28 +170,162 @@ internal_exr_undo_zip (
 
 /**************************************/
 
+/* candidate levels measured when auto-tuning, in increasing order */
+static const int zip_tuning_levels[EXR_ZIP_TUNING_LEVEL_COUNT] = {
+    1, 2, 4, 6, 9};
+
+static uint64_t
+zip_tuning_clock (void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency (&freq);
+    QueryPerformanceCounter (&now);
+    return (uint64_t) ((double) now.QuadPart * 1e9 / (double) freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * (uint64_t) 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+int
+internal_exr_zip_tuned_level (const struct _internal_exr_part* part)
+{
+    uintptr_t tl;
+
+    if (part->zip_tuning_mode == EXR_ZIP_TUNING_NONE)
+        return part->zip_compression_level;
+
+    tl = (uintptr_t) atomic_load (
+        EXR_CONST_CAST (atomic_uintptr_t*, &(part->zip_tuning_level)));
+    return (tl > 0) ? (int) (tl - 1) : part->zip_compression_level;
+}
+
+/* all sample chunks are measured, pick the level matching the target */
+static int
+zip_tuning_pick (const struct _internal_exr_part* part)
+{
+    uint64_t inb = 0;
+    uint64_t outb[EXR_ZIP_TUNING_LEVEL_COUNT] = {0};
+    uint64_t nanos[EXR_ZIP_TUNING_LEVEL_COUNT] = {0};
+    double   target = (double) part->zip_tuning_target;
+    int      best;
+
+    for (int s = 0; s < EXR_ZIP_TUNING_SAMPLE_CHUNKS; ++s)
+    {
+        inb += part->zip_tuning_samples[s].in_bytes;
+        for (int l = 0; l < EXR_ZIP_TUNING_LEVEL_COUNT; ++l)
+        {
+            outb[l] += part->zip_tuning_samples[s].out_bytes[l];
+            nanos[l] += part->zip_tuning_samples[s].nanos[l];
+        }
+    }
+
+    if (part->zip_tuning_mode == EXR_ZIP_TUNING_THROUGHPUT)
+    {
+        /* highest level still fast enough, or the fastest one */
+        best = 0;
+        for (int l = 0; l < EXR_ZIP_TUNING_LEVEL_COUNT; ++l)
+        {
+            /* bytes per ns * 1000 -> MB/s */
+            if (nanos[l] == 0 ||
+                (double) inb * 1000.0 / (double) nanos[l] >= target)
+                best = l;
+        }
+    }
+    else
+    {
+        /* lowest level compressing enough, or the smallest output */
+        best = EXR_ZIP_TUNING_LEVEL_COUNT - 1;
+        for (int l = EXR_ZIP_TUNING_LEVEL_COUNT - 1; l >= 0; --l)
+        {
+            if (outb[l] > 0 && (double) inb / (double) outb[l] >= target)
+                best = l;
+        }
+    }
+    return zip_tuning_levels[best];
+}
+
+/* compress a sample chunk at each candidate level, leaving the
+ * highest level result in the output buffer */
 static exr_result_t
-apply_zip_impl (exr_encode_pipeline_t* encode)
+zip_tuning_measure (
+    exr_encode_pipeline_t*     encode,
+    struct _internal_exr_part* part,
+    int                        sample,
+    int*                       level,
+    size_t*                    compbufsz)
 {
-    int          level;
-    size_t       compbufsz;
-    exr_result_t rv;
+    exr_result_t rv = EXR_ERR_SUCCESS;
 
-    rv = exr_get_zip_compression_level (
-        encode->context, encode->part_index, &level);
-    if (rv != EXR_ERR_SUCCESS) return rv;
+    part->zip_tuning_samples[sample].in_bytes = encode->packed_bytes;
+    for (int l = 0; l < EXR_ZIP_TUNING_LEVEL_COUNT; ++l)
+    {
+        uint64_t start = zip_tuning_clock ();
+
+        *level = zip_tuning_levels[l];
+        rv     = exr_compress_buffer (
+            encode->context,
+            *level,
+            encode->scratch_buffer_1,
+            encode->packed_bytes,
+            encode->compressed_buffer,
+            encode->compressed_alloc_size,
+            compbufsz);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+
+        part->zip_tuning_samples[sample].nanos[l] =
+            zip_tuning_clock () - start;
+        part->zip_tuning_samples[sample].out_bytes[l] = *compbufsz;
+    }
+
+    /* the last sample in decides for the rest of the chunks */
+    if ((uintptr_t) atomic_fetch_add (&(part->zip_tuning_measured), 1) ==
+        EXR_ZIP_TUNING_SAMPLE_CHUNKS - 1)
+    {
+        atomic_store (
+            &(part->zip_tuning_level),
+            (uintptr_t) (zip_tuning_pick (part) + 1));
+    }
+    return rv;
+}
+
+static exr_result_t
+apply_zip_impl (exr_encode_pipeline_t* encode)
+{
+    int                                 level;
+    size_t                              compbufsz;
+    exr_result_t                        rv;
+    const struct _internal_exr_context* pctxt = EXR_CCTXT (encode->context);
+    struct _internal_exr_part*          part;
+    uintptr_t                           sample = EXR_ZIP_TUNING_SAMPLE_CHUNKS;
+
+    if (!pctxt) return EXR_ERR_MISSING_CONTEXT_ARG;
+    if (encode->part_index < 0 || encode->part_index >= pctxt->num_parts)
+        return pctxt->standard_error (pctxt, EXR_ERR_ARGUMENT_OUT_OF_RANGE);
+    part  = pctxt->parts[encode->part_index];
+    level = internal_exr_zip_tuned_level (part);
 
     internal_zip_deconstruct_bytes (
         encode->scratch_buffer_1, encode->packed_buffer, encode->packed_bytes);
 
-    rv = exr_compress_buffer (
-        encode->context,
-        level,
-        encode->scratch_buffer_1,
-        encode->packed_bytes,
-        encode->compressed_buffer,
-        encode->compressed_alloc_size,
-        &compbufsz);
+    /* while tuning, the first chunks in are measured */
+    if (part->zip_tuning_mode != EXR_ZIP_TUNING_NONE &&
+        atomic_load (&(part->zip_tuning_level)) == 0)
+        sample = (uintptr_t) atomic_fetch_add (&(part->zip_tuning_claimed), 1);
+
+    if (sample < EXR_ZIP_TUNING_SAMPLE_CHUNKS)
+        rv = zip_tuning_measure (encode, part, (int) sample, &level, &compbufsz);
+    else
+        rv = exr_compress_buffer (
+            encode->context,
+            level,
+            encode->scratch_buffer_1,
+            encode->packed_bytes,
+            encode->compressed_buffer,
+            encode->compressed_alloc_size,
+            &compbufsz);
 
     if (rv == EXR_ERR_SUCCESS)
     {
@@ -379,16 +341,13 @@ apply_zip_impl (exr_encode_pipeline_t* encode)
     }
     else
     {
-        const struct _internal_exr_context* pctxt = EXR_CCTXT (encode->context);
-        if (pctxt)
-            pctxt->print_error (
-                pctxt,
-                rv,
-                "Unable to compress buffer %" PRIu64 " -> %" PRIu64
-                " @ level %d",
-                encode->packed_bytes,
-                (uint64_t) encode->compressed_alloc_size,
-                level);
+        pctxt->print_error (
+            pctxt,
+            rv,
+            "Unable to compress buffer %" PRIu64 " -> %" PRIu64 " @ level %d",
+            encode->packed_bytes,
+            (uint64_t) encode->compressed_alloc_size,
+            level);
     }
 
     return rv;
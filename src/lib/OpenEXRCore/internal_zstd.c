@@ -0,0 +1,141 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_compress.h"
+#include "internal_decompress.h"
+
+#include "internal_coding.h"
+#include "internal_structs.h"
+
+#include <string.h>
+
+#include "openexr_compression.h"
+
+/*
+ * ZSTD compression uses the same byte split and delta predictor as
+ * ZIP, only the entropy coder differs, and works on the same 32
+ * scanline chunks as PIZ. Each pipeline keeps its zstd context from
+ * chunk to chunk, rather than setting one up for every chunk.
+ */
+
+/**************************************/
+
+exr_result_t
+internal_exr_undo_zstd (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size)
+{
+    size_t       actual_out_bytes;
+    exr_result_t rv;
+
+    rv = internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(decode->scratch_buffer_1),
+        &(decode->scratch_alloc_size_1),
+        uncompressed_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rv = internal_exr_zstd_uncompress (
+        EXR_CCTXT (decode->context),
+        &(decode->_zstd_dctx),
+        compressed_data,
+        comp_buf_size,
+        decode->scratch_buffer_1,
+        uncompressed_size,
+        &actual_out_bytes);
+    if (rv == EXR_ERR_SUCCESS)
+    {
+        if (actual_out_bytes == uncompressed_size)
+            internal_zip_reconstruct_bytes (
+                uncompressed_data, decode->scratch_buffer_1, actual_out_bytes);
+        else
+            rv = EXR_ERR_CORRUPT_CHUNK;
+    }
+    return rv;
+}
+
+/**************************************/
+
+exr_result_t
+internal_exr_apply_zstd (exr_encode_pipeline_t* encode)
+{
+    size_t                              compbufsz;
+    exr_result_t                        rv;
+    const struct _internal_exr_context* pctxt = EXR_CCTXT (encode->context);
+    const struct _internal_exr_part*    part;
+
+    if (!pctxt) return EXR_ERR_MISSING_CONTEXT_ARG;
+    if (encode->part_index < 0 || encode->part_index >= pctxt->num_parts)
+        return pctxt->standard_error (pctxt, EXR_ERR_ARGUMENT_OUT_OF_RANGE);
+    part = pctxt->parts[encode->part_index];
+
+    rv = internal_encode_alloc_buffer (
+        encode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(encode->scratch_buffer_1),
+        &(encode->scratch_alloc_size_1),
+        encode->packed_bytes);
+    if (rv == EXR_ERR_SUCCESS)
+        rv = internal_encode_alloc_buffer (
+            encode,
+            EXR_TRANSCODE_BUFFER_COMPRESSED,
+            &(encode->compressed_buffer),
+            &(encode->compressed_alloc_size),
+            exr_zstd_compress_max_buffer_size (encode->packed_bytes));
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        pctxt->print_error (
+            pctxt,
+            rv,
+            "Unable to allocate buffers for zstd compression of %" PRIu64
+            " bytes",
+            encode->packed_bytes);
+        return rv;
+    }
+
+    internal_zip_deconstruct_bytes (
+        encode->scratch_buffer_1, encode->packed_buffer, encode->packed_bytes);
+
+    rv = internal_exr_zstd_compress (
+        pctxt,
+        &(encode->_zstd_cctx),
+        part->zstd_compression_level,
+        encode->scratch_buffer_1,
+        encode->packed_bytes,
+        encode->compressed_buffer,
+        encode->compressed_alloc_size,
+        &compbufsz);
+
+    if (rv == EXR_ERR_SUCCESS)
+    {
+        /* a chunk the same size as the raw data is read back as raw */
+        if (compbufsz >= encode->packed_bytes)
+        {
+            memcpy (
+                encode->compressed_buffer,
+                encode->packed_buffer,
+                encode->packed_bytes);
+            compbufsz = encode->packed_bytes;
+        }
+        encode->compressed_bytes = compbufsz;
+    }
+    else
+    {
+        pctxt->print_error (
+            pctxt,
+            rv,
+            "Unable to zstd compress buffer %" PRIu64 " -> %" PRIu64
+            " @ level %d",
+            encode->packed_bytes,
+            (uint64_t) encode->compressed_alloc_size,
+            (int) part->zstd_compression_level);
+    }
+
+    return rv;
+}
@@ -38,7 +38,7 @@ exr_attr_opaquedata_init (
     if (b > 0)
     {
 
-        u->packed_data = pctxt->alloc_fn (b);
+        u->packed_data = internal_exr_header_alloc (pctxt, b);
         if (!u->packed_data)
             return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
     }
@@ -73,7 +73,7 @@ exr_attr_opaquedata_destroy (exr_context_t ctxt, exr_attr_opaquedata_t* ud)
     {
         exr_attr_opaquedata_t nil = {0};
         if (ud->packed_data && ud->packed_alloc_size > 0)
-            pctxt->free_fn (ud->packed_data);
+            internal_exr_header_free (pctxt, ud->packed_data);
 
         if (ud->unpacked_data && ud->destroy_unpacked_func_ptr)
             ud->destroy_unpacked_func_ptr (
@@ -194,7 +194,7 @@ exr_attr_opaquedata_pack (
 
     if (nsize > 0)
     {
-        tmpptr = pctxt->alloc_fn ((size_t) nsize);
+        tmpptr = internal_exr_header_alloc (pctxt, (size_t) nsize);
         if (tmpptr == NULL)
             return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
 
@@ -204,7 +204,7 @@ exr_attr_opaquedata_pack (
             ctxt, u->unpacked_data, u->unpacked_size, &nsize, tmpptr);
         if (rv != EXR_ERR_SUCCESS)
         {
-            pctxt->free_fn (tmpptr);
+            internal_exr_header_free (pctxt, tmpptr);
             nsize                = u->packed_alloc_size;
             u->packed_alloc_size = 0;
             return pctxt->print_error (
@@ -257,7 +257,8 @@ exr_attr_opaquedata_set_unpacked (
 
     if (u->packed_data)
     {
-        if (u->packed_alloc_size > 0) pctxt->free_fn (u->packed_data);
+        if (u->packed_alloc_size > 0)
+            internal_exr_header_free (pctxt, u->packed_data);
         u->packed_data       = NULL;
         u->size              = 0;
         u->packed_alloc_size = 0;
@@ -287,7 +288,7 @@ exr_attr_opaquedata_set_packed (
             "Opaque data given invalid negative size (%d)",
             sz);
 
-    nmem = pctxt->alloc_fn ((size_t) sz);
+    nmem = internal_exr_header_alloc (pctxt, (size_t) sz);
     if (!nmem) return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
 
     if (u->unpacked_data)
@@ -301,7 +302,8 @@ exr_attr_opaquedata_set_packed (
 
     if (u->packed_data)
     {
-        if (u->packed_alloc_size > 0) pctxt->free_fn (u->packed_data);
+        if (u->packed_alloc_size > 0)
+            internal_exr_header_free (pctxt, u->packed_data);
         u->packed_data       = NULL;
         u->size              = 0;
         u->packed_alloc_size = 0;
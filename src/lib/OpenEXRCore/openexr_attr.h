@@ -45,6 +45,9 @@ typedef enum
     EXR_COMPRESSION_B44A  = 7,
     EXR_COMPRESSION_DWAA  = 8,
     EXR_COMPRESSION_DWAB  = 9,
+    EXR_COMPRESSION_PIZ4  = 10, /**< PIZ, Huffman data in 4 streams. */
+    EXR_COMPRESSION_ZSTD  = 11, /**< Zip predictor, then zstd. */
+    EXR_COMPRESSION_LZ4   = 12, /**< Byte planes per value, then LZ4. */
     EXR_COMPRESSION_LAST_TYPE /**< Invalid value, provided for range checking. */
 } exr_compression_t;
 
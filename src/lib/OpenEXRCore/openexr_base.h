@@ -136,6 +136,19 @@ EXR_EXPORT void exr_set_default_dwa_compression_quality (float q);
  */
 EXR_EXPORT void exr_get_default_dwa_compression_quality (float* q);
 
+/** @brief Assigns a default zstd compression level.
+ *
+ * 0 leaves the choice to zstd, otherwise levels 1 to 22 trade speed
+ * for size and negative levels are faster still. This may be
+ * controlled separately on each part, but this global control
+ * determines the initial value.
+ */
+EXR_EXPORT void exr_set_default_zstd_compression_level (int l);
+
+/** @brief Retrieve the global default zstd compression level
+ */
+EXR_EXPORT void exr_get_default_zstd_compression_level (int* l);
+
 /** @} */
 
 /**
@@ -62,6 +62,21 @@ exr_result_t exr_read_tile_chunk_info (
     int                 levely,
     exr_chunk_info_t*   cinfo);
 
+/** Reads and checks the leaders of all the chunks of a part up front.
+ *
+ * Once a chunk has been looked up, its info is kept with the part, so
+ * exr_read_scanline_chunk_info() and exr_read_tile_chunk_info() only
+ * read the file the first time for each chunk. This looks up every
+ * chunk not yet seen in file order, with each read picking up the
+ * leaders of many chunks, so that later lookups in any order, such as
+ * for texture lookups or scrubbing, do not read any leaders.
+ *
+ * All chunks are tried, the first error encountered is returned.
+ */
+EXR_EXPORT
+exr_result_t exr_build_chunk_info_table (
+    exr_const_context_t ctxt, int part_index);
+
 /** Read the packed data block for a chunk.
  *
  * This assumes that the buffer pointed to by @p packed_data is
@@ -74,6 +89,24 @@ exr_result_t exr_read_chunk (
     const exr_chunk_info_t* cinfo,
     void*                   packed_data);
 
+/** Read the packed data blocks for several chunks of a part.
+ *
+ * Fills @p packed_data[i] with the packed data of @p cinfos[i], each
+ * buffer being large enough to hold that chunk's packed_size bytes.
+ * The requests are sorted into file order and chunks lying close to
+ * each other are fetched with a single read, so this issues far
+ * fewer reads than calling \c exr_read_chunk for each chunk, which
+ * matters most where the latency of each read dominates. For deep
+ * data, only the packed data is read, as with \c exr_read_chunk.
+ */
+EXR_EXPORT
+exr_result_t exr_read_chunks (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    int                     count,
+    const exr_chunk_info_t* cinfos,
+    void* const*            packed_data);
+
 /**
  * Read chunk for deep data.
  *
@@ -6,6 +6,8 @@
 #ifndef OPENEXR_CORE_CODING_H
 #define OPENEXR_CORE_CODING_H
 
+#include "openexr_errors.h"
+
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -134,6 +136,52 @@ typedef struct
     };
 } exr_coding_channel_info_t;
 
+/** Layout of one channel of a rectangle of pixels for
+ * exr_decode_region() and exr_encode_region().
+ */
+typedef struct _exr_region_channel
+{
+    /** Name of the channel in the part. */
+    const char* channel_name;
+
+    /** Address of the channel's value for the pixel at the top left
+     * corner of the region, i.e. (region.min.x, region.min.y). When
+     * decoding, if this is `NULL`, the channel is skipped. As for
+     * exr_coding_channel_info_t, the pointer is only read from when
+     * encoding.
+     */
+    union
+    {
+        uint8_t*       decode_to_base;
+        const uint8_t* encode_from_base;
+    };
+
+    /** Increment in bytes from one pixel to the next. */
+    int32_t pixel_stride;
+
+    /** Increment in bytes from one line of the region to the next. */
+    int32_t line_stride;
+
+    /** Small form of exr_pixel_type_t enum (EXR_PIXEL_UINT/HALF/FLOAT)
+     * to convert the channel from / to.
+     */
+    uint16_t data_type;
+} exr_region_channel_t;
+
+/** Function used by exr_decode_region() and exr_encode_region() to
+ * run @p task_fn (@p task_data) on another thread, such as one from
+ * the application's thread pool.
+ *
+ * Return EXR_ERR_SUCCESS if @p task_fn will be called, or has already
+ * been called; anything else and the work is done by the other
+ * workers instead. The calling thread does not wait for tasks which
+ * have not started, so they may be queued behind it. A task which
+ * only starts once the work is all done returns right away, but it
+ * must still be called, as it releases its share of the state.
+ */
+typedef exr_result_t (*exr_spawn_task_func_ptr_t) (
+    void* spawn_userdata, void (*task_fn) (void*), void* task_data);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -45,6 +45,66 @@ exr_result_t exr_uncompress_buffer (
     size_t              out_bytes_avail,
     size_t*             actual_out);
 
+/** Computes a buffer size large enough to hold the zstd compressed
+ * form of in_bytes of data. */
+EXR_EXPORT
+size_t exr_zstd_compress_max_buffer_size (size_t in_bytes);
+
+/** Compresses a buffer into a single zstd frame.
+ *
+ * If the level is 0, will use the default compression set to the library
+ * \ref exr_set_default_zstd_compression_level
+ *
+ * Returns \ref EXR_ERR_FEATURE_NOT_IMPLEMENTED if the library was built
+ * without zstd support, \ref EXR_ERR_OUT_OF_MEMORY if the output does
+ * not fit in out_bytes_avail. */
+EXR_EXPORT
+exr_result_t exr_zstd_compress_buffer (
+    exr_const_context_t ctxt,
+    int                 level,
+    const void*         in,
+    size_t              in_bytes,
+    void*               out,
+    size_t              out_bytes_avail,
+    size_t*             actual_out);
+
+EXR_EXPORT
+exr_result_t exr_zstd_uncompress_buffer (
+    exr_const_context_t ctxt,
+    const void*         in,
+    size_t              in_bytes,
+    void*               out,
+    size_t              out_bytes_avail,
+    size_t*             actual_out);
+
+/** Computes a buffer size large enough to hold the LZ4 compressed
+ * form of in_bytes of data. */
+EXR_EXPORT
+size_t exr_lz4_compress_max_buffer_size (size_t in_bytes);
+
+/** Compresses a buffer into a single LZ4 block, without a frame
+ * header.
+ *
+ * Returns \ref EXR_ERR_OUT_OF_MEMORY if the output does not fit in
+ * out_bytes_avail. */
+EXR_EXPORT
+exr_result_t exr_lz4_compress_buffer (
+    exr_const_context_t ctxt,
+    const void*         in,
+    size_t              in_bytes,
+    void*               out,
+    size_t              out_bytes_avail,
+    size_t*             actual_out);
+
+EXR_EXPORT
+exr_result_t exr_lz4_uncompress_buffer (
+    exr_const_context_t ctxt,
+    const void*         in,
+    size_t              in_bytes,
+    void*               out,
+    size_t              out_bytes_avail,
+    size_t*             actual_out);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
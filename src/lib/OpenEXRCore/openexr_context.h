@@ -134,6 +134,41 @@ typedef int64_t (*exr_read_func_ptr_t) (
     uint64_t                    offset,
     exr_stream_error_func_ptr_t error_cb);
 
+/** @brief Asynchronous read completion function pointer
+ *
+ * Passed to an \ref exr_read_async_func_ptr_t, which must call it
+ * exactly once when the read finishes, with the number of bytes read
+ * (or -1 on error) and the request pointer it was handed. It may be
+ * called from any thread, including the submitting thread before the
+ * submit function returns.
+ */
+typedef void (*exr_read_complete_func_ptr_t) (
+    exr_const_context_t ctxt, void* request, int64_t nread);
+
+/** @brief Asynchronous read custom function pointer
+ *
+ * Starts a read with the same semantics as \ref exr_read_func_ptr_t
+ * but does not wait for it to finish, reporting the result through
+ * @p complete_fn instead. This is used to read chunks ahead while
+ * others are being decoded (see exr_decoding_prefetch()).
+ *
+ * Return `EXR_ERR_SUCCESS` if the read was started, in which case
+ * @p complete_fn will be called, or an error code if it could not
+ * be, in which case it must not be.
+ *
+ * As with the synchronous read, this must be safe to call from
+ * multiple threads at once.
+ */
+typedef exr_result_t (*exr_read_async_func_ptr_t) (
+    exr_const_context_t          ctxt,
+    void*                        userdata,
+    void*                        buffer,
+    uint64_t                     sz,
+    uint64_t                     offset,
+    exr_read_complete_func_ptr_t complete_fn,
+    void*                        request,
+    exr_stream_error_func_ptr_t  error_cb);
+
 /** Write custom function pointer
  *
  *  Used to write data to a custom output. Expects similar semantics to
@@ -187,7 +222,7 @@ typedef int64_t (*exr_write_func_ptr_t) (
  * \endcode
  *
  */
-typedef struct _exr_context_initializer_v3
+typedef struct _exr_context_initializer_v5
 {
     /** @brief Size member to tag initializer for version stability.
      *
@@ -321,6 +356,43 @@ typedef struct _exr_context_initializer_v3
     int flags;
 
     uint8_t pad[4];
+
+    /** @brief Custom asynchronous read routine.
+     *
+     * Optional, only used during read contexts to read chunks
+     * ahead. If this is `NULL`, reads through a custom \c read_fn
+     * are started on a worker thread owned by the context, and the
+     * internal file implementation uses its own routine.
+     *
+     * @sa exr_read_async_func_ptr_t
+     */
+    exr_read_async_func_ptr_t read_async_fn;
+
+    /** Initialize the number of bytes of chunk data to read along
+     * with each chunk leader.
+     *
+     * When positive, exr_read_scanline_chunk_info() and
+     * exr_read_tile_chunk_info() read up to this many bytes past the
+     * leader, stopping at the next chunk in the offset table, and
+     * keep them in a small cache in the context. A following
+     * exr_read_chunk() of that chunk is then served from the cache,
+     * so a chunk that fits takes one read instead of two, which
+     * matters when each read is a round trip to a network file
+     * system. This is ignored for deep data and memory mapped
+     * files. The default of 0 disables it.
+     */
+    int chunk_read_ahead;
+
+    /** Initialize the size of the first read of the file header.
+     *
+     * Headers that fit take one read, which also picks up the chunk
+     * offset tables that follow when they fit in the same read, so
+     * they are not read again later. Larger headers (big previews,
+     * many channels, ...) are read in further reads, each twice the
+     * size of the previous one. The default of 0 uses 64k, reading
+     * no more than the file size when it is known.
+     */
+    int header_prefetch;
 } exr_context_initializer_t;
 
 /** @brief context flag which will enforce strict header validation
@@ -347,10 +419,45 @@ typedef struct _exr_context_initializer_v3
 /** @brief Writes an old-style, sorted header with minimal information */
 #define EXR_CONTEXT_FLAG_WRITE_LEGACY_HEADER (1 << 3)
 
+/** @brief Memory maps the file when reading with the default file routines
+ *
+ * Reads are then served from the mapping, and the default decode
+ * pipeline references chunk data for uncompressed, RLE and ZIP parts
+ * in place instead of copying it into a packed buffer, so the packed
+ * buffer (and the unpacked buffer of chunks stored raw) must then be
+ * treated as read only. If the file cannot be mapped, regular reads
+ * are used. This has no effect when custom read routines are
+ * provided. The file must not be truncated while it is mapped. This
+ * is only valid for reading contexts
+ */
+#define EXR_CONTEXT_FLAG_MEMORY_MAP (1 << 4)
+
+/** @brief Opens the file for its headers only
+ *
+ * The headers are parsed and can be queried as usual, but nothing
+ * past them is read: the chunk offset tables are neither loaded nor
+ * checked, the file is not memory mapped, and any request for chunk
+ * information or chunk data fails with \ref EXR_ERR_NOT_OPEN_READ.
+ * Meant for tools that only look at the metadata of many files. This
+ * is only valid for reading contexts
+ */
+#define EXR_CONTEXT_FLAG_HEADER_ONLY (1 << 5)
+
+/** @brief Allocates the parsed header attributes from a few blocks
+ *
+ * The attributes, strings, channel lists and other data making up the
+ * headers are carved out of a few large blocks owned by the context
+ * instead of being allocated one by one, and the blocks are released
+ * together by \ref exr_finish. Attributes changed or added once the
+ * file is open are allocated as usual. This is only valid for reading
+ * contexts
+ */
+#define EXR_CONTEXT_FLAG_HEADER_ARENA (1 << 6)
+
 /* clang-format off */
 /** @brief Simple macro to initialize the context initializer with default values. */
 #define EXR_DEFAULT_CONTEXT_INITIALIZER                                        \
-    { sizeof (exr_context_initializer_t), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -2, -1.f, 0, { 0, 0, 0, 0 } }
+    { sizeof (exr_context_initializer_t), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -2, -1.f, 0, { 0, 0, 0, 0 }, 0, 0, 0 }
 /* clang-format on */
 
 /** @} */ /* context function pointer declarations */
@@ -244,6 +244,40 @@ typedef struct _exr_decode_pipeline
      * this being used.
      */
     exr_coding_channel_info_t _quick_chan_store[5];
+
+    /** State of a read started by exr_decoding_prefetch(), if any.
+     *
+     * This is managed internally, and released by
+     * exr_decoding_destroy().
+     */
+    void* _prefetch;
+
+    /** Function which can be provided to let the decompression of a
+     * single chunk be split over several threads, such as ones from
+     * the application's thread pool.
+     *
+     * Only decompressors with large chunks make use of this
+     * (currently DWAA and DWAB), to cut the time to decode one chunk
+     * when there are more threads than chunks to go around, such as
+     * when opening a single image. The calling thread always takes
+     * part, and returns once all the work is done. Tasks which have
+     * not started by then are not waited for: when they do run, they
+     * return right away.
+     *
+     * If left `NULL`, all of the work is done by the calling thread.
+     */
+    exr_spawn_task_func_ptr_t spawn_fn;
+
+    /** Passed to spawn_fn. */
+    void* spawn_userdata;
+
+    /** The zstd decompression context, created for the first zstd
+     * chunk and kept for the ones after it.
+     *
+     * This is managed internally, and released by
+     * exr_decoding_destroy().
+     */
+    void* _zstd_dctx;
 } exr_decode_pipeline_t;
 
 /** @brief Simple macro to initialize an empty decode pipeline. */
@@ -297,6 +331,26 @@ EXR_EXPORT
 exr_result_t exr_decoding_run (
     exr_const_context_t ctxt, int part_index, exr_decode_pipeline_t* decode);
 
+/** Start reading the packed data of a chunk of the same part ahead of
+ * decoding it.
+ *
+ * The read goes through the context's asynchronous read routine, so
+ * it overlaps with whatever the caller does next, typically running
+ * the pipeline on the current chunk. When the pipeline is later
+ * updated to @p cinfo and run, the default read routine uses the
+ * prefetched data instead of reading the chunk again. A previous
+ * prefetch which was never used is waited for and dropped.
+ *
+ * This does nothing for deep data, or when the chunk data is read
+ * straight from a memory mapped file.
+ */
+EXR_EXPORT
+exr_result_t exr_decoding_prefetch (
+    exr_const_context_t     ctxt,
+    int                     part_index,
+    const exr_chunk_info_t* cinfo,
+    exr_decode_pipeline_t*  decode);
+
 /** Free any intermediate memory in the decoding pipeline.
  *
  * This does *not* free any pointers referred to in the channel info
@@ -307,6 +361,45 @@ EXR_EXPORT
 exr_result_t
 exr_decoding_destroy (exr_const_context_t ctxt, exr_decode_pipeline_t* decode);
 
+/** Decode a rectangle of pixels of a (non-deep) part, spread over
+ * several threads.
+ *
+ * The chunks overlapping @p region are shared out among
+ * @p num_threads workers, the calling thread being one of them,
+ * each of which reuses a single decode pipeline for all of its
+ * chunks. Pixels of those chunks outside the region are not written.
+ * Passing 0 for @p num_threads uses one worker per processor.
+ *
+ * The other workers are started through @p spawn_fn if given,
+ * otherwise on threads created for the call. Either way, this returns
+ * once all of the chunks are decoded, without waiting for workers
+ * which have not started by then: those may still be called later,
+ * and return right away. So @p spawn_fn may queue them behind the
+ * calling thread, such as in a busy thread pool. Without threading
+ * support in the library, all of the work is done by the calling
+ * thread.
+ *
+ * @p level_x and @p level_y select the mip / rip level for tiled parts,
+ * and must be 0 for scanline parts. The region is in the coordinates
+ * of the data window (of the level), which it must lie within.
+ * Channels must not be subsampled.
+ *
+ * Returns the first error encountered, in which case some of the
+ * pixels may have been written.
+ */
+EXR_EXPORT
+exr_result_t exr_decode_region (
+    exr_const_context_t         ctxt,
+    int                         part_index,
+    int                         level_x,
+    int                         level_y,
+    const exr_attr_box2i_t*     region,
+    int                         channel_count,
+    const exr_region_channel_t* channels,
+    int                         num_threads,
+    exr_spawn_task_func_ptr_t   spawn_fn,
+    void*                       spawn_userdata);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
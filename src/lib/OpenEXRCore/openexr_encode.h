@@ -271,6 +271,14 @@ typedef struct _exr_encode_pipeline
      * this being used.
      */
     exr_coding_channel_info_t _quick_chan_store[5];
+
+    /** The zstd compression context, created for the first zstd
+     * chunk and kept for the ones after it.
+     *
+     * This is managed internally, and released by
+     * exr_encoding_destroy().
+     */
+    void* _zstd_cctx;
 } exr_encode_pipeline_t;
 
 /** @brief Simple macro to initialize an empty decode pipeline. */
@@ -337,6 +345,50 @@ EXR_EXPORT
 exr_result_t exr_encoding_destroy (
     exr_const_context_t ctxt, exr_encode_pipeline_t* encode_pipe);
 
+/** Encode and write the chunks making up a rectangle of pixels of a
+ * (non-deep) part, spread over several threads.
+ *
+ * The chunks are shared out among @p num_threads workers, the
+ * calling thread being one of them, each of which reuses a single
+ * encode pipeline for all of its chunks. Unless the part has a line
+ * order of EXR_LINEORDER_RANDOM_Y, the chunks are compressed out of
+ * order but held back as needed to be written in file order. With
+ * random line order, they are written as soon as they are ready.
+ * Passing 0 for @p num_threads uses one worker per processor.
+ *
+ * The other workers are started through @p spawn_fn if given,
+ * otherwise on threads created for the call. Either way, this returns
+ * once all of the chunks are written, without waiting for workers
+ * which have not started by then, as with exr_decode_region().
+ * Without threading support in the library, all of the work is done
+ * by the calling thread.
+ *
+ * @p level_x and @p level_y select the mip / rip level for tiled parts,
+ * and must be 0 for scanline parts. The region is in the coordinates
+ * of the data window (of the level), and must be made of whole
+ * chunks: for a scanline part, that is full width lines starting at
+ * a chunk boundary. Every channel of the part must be given, and
+ * must not be subsampled. As when writing chunks one at a time, the
+ * chunks of the part must be written in order, so a part with
+ * ordered lines may need several calls, one per row of chunks (or
+ * per level), in the order they are stored.
+ *
+ * Returns the first error encountered, in which case some of the
+ * chunks may have been written.
+ */
+EXR_EXPORT
+exr_result_t exr_encode_region (
+    exr_context_t               ctxt,
+    int                         part_index,
+    int                         level_x,
+    int                         level_y,
+    const exr_attr_box2i_t*     region,
+    int                         channel_count,
+    const exr_region_channel_t* channels,
+    int                         num_threads,
+    exr_spawn_task_func_ptr_t   spawn_fn,
+    void*                       spawn_userdata);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -175,6 +175,68 @@ EXR_EXPORT exr_result_t exr_get_zip_compression_level (
 EXR_EXPORT exr_result_t
 exr_set_zip_compression_level (exr_context_t ctxt, int part_index, int level);
 
+/** @brief Retrieve the zstd compression level used for the specified part.
+ *
+ * This only applies to \ref EXR_COMPRESSION_ZSTD. Like the zip level,
+ * this value is NOT persisted in the file.
+ */
+EXR_EXPORT exr_result_t exr_get_zstd_compression_level (
+    exr_const_context_t ctxt, int part_index, int* level);
+
+/** @brief Set the zstd compression level used for the specified part.
+ *
+ * 0 uses the global default (see \ref
+ * exr_set_default_zstd_compression_level), otherwise the level is
+ * passed to zstd, from -22 (fastest) to 22 (smallest). Like the zip
+ * level, this value is NOT persisted in the file.
+ */
+EXR_EXPORT exr_result_t
+exr_set_zstd_compression_level (exr_context_t ctxt, int part_index, int level);
+
+/** @brief Enum describing how the zip compression level is chosen
+ * when writing a part.
+ */
+typedef enum exr_zip_tuning
+{
+    EXR_ZIP_TUNING_NONE = 0, /**< Use the zip compression level as set. */
+    EXR_ZIP_TUNING_THROUGHPUT, /**< Highest level compressing at least target MB/s. */
+    EXR_ZIP_TUNING_RATIO, /**< Lowest level reaching a compression ratio of at least target. */
+    EXR_ZIP_TUNING_LAST_TYPE /**< Invalid value, provided for range checking. */
+} exr_zip_tuning_t;
+
+/** @brief Set how the zip compression level is picked for the
+ * specified part when writing ZIP or ZIPS compressed chunks.
+ *
+ * When tuning is enabled, the first few chunks encoded for the part
+ * are compressed at a range of levels and timed. Once enough chunks
+ * have been measured, the remaining chunks use the level which best
+ * matches the target: for \ref EXR_ZIP_TUNING_THROUGHPUT, the highest
+ * level which still compresses at least target megabytes (of
+ * uncompressed data) per second on a single thread, for \ref
+ * EXR_ZIP_TUNING_RATIO, the lowest level which reaches an
+ * uncompressed / compressed ratio of target. Chunks encoded while the
+ * measurement is still in progress on other threads use the level set
+ * via \ref exr_set_zip_compression_level.
+ *
+ * Like the zip level, this is NOT persisted in the file.
+ */
+EXR_EXPORT exr_result_t exr_set_zip_compression_tuning (
+    exr_context_t ctxt, int part_index, exr_zip_tuning_t mode, float target);
+
+/** @brief Retrieve the zip tuning mode and target for the specified
+ * part, along with the zip level currently used to compress chunks.
+ *
+ * The level is the tuned level once the measurement has completed,
+ * the level set via \ref exr_set_zip_compression_level otherwise. Any
+ * of the output arguments may be NULL.
+ */
+EXR_EXPORT exr_result_t exr_get_zip_compression_tuning (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    exr_zip_tuning_t*   mode,
+    float*              target,
+    int*                level);
+
 /** @brief Retrieve the dwa compression level used for the specified part.
  *
  * This only applies when the compression method is DWAA/DWAB.
@@ -58,6 +58,8 @@ struct _internal_exr_seq_scratch
     uint64_t curpos;
     int64_t  navail;
     uint64_t fileoff;
+    uint64_t allocsz;
+    uint64_t readsz;
 
     exr_result_t (*sequential_read) (
         struct _internal_exr_seq_scratch*, void*, uint64_t);
@@ -81,7 +83,61 @@ scratch_attr_too_big (
     return 0;
 }
 
-#define SCRATCH_BUFFER_SIZE 4096
+/* most headers fit in the first read, along with the chunk offset
+ * tables following them */
+#define EXR_HEADER_PREFETCH_DEFAULT 65536
+/* headers that do not fit are read in reads twice as big as the
+ * previous one, up to this */
+#define EXR_HEADER_PREFETCH_MAX (4 * 1024 * 1024)
+
+static exr_result_t
+scratch_refill (struct _internal_exr_seq_scratch* scr)
+{
+    struct _internal_exr_context* ctxt   = scr->ctxt;
+    uint64_t                      toread = scr->readsz;
+    int64_t                       nread  = 0;
+    exr_result_t                  rv;
+
+    if (ctxt->file_size > 0 && (uint64_t) ctxt->file_size > scr->fileoff &&
+        (uint64_t) ctxt->file_size - scr->fileoff < toread)
+        toread = (uint64_t) ctxt->file_size - scr->fileoff;
+
+    /* the buffer is empty, so can be replaced by a bigger one */
+    if (toread > scr->allocsz)
+    {
+        uint8_t* nbuf = ctxt->alloc_fn ((size_t) toread);
+        if (nbuf)
+        {
+            ctxt->free_fn (scr->scratch);
+            scr->scratch = nbuf;
+            scr->allocsz = toread;
+        }
+        else
+            toread = scr->allocsz;
+    }
+
+    rv = ctxt->do_read (
+        ctxt,
+        scr->scratch,
+        toread,
+        &(scr->fileoff),
+        &nread,
+        EXR_ALLOW_SHORT_READ);
+    if (nread > 0)
+    {
+        scr->navail = nread;
+        scr->curpos = 0;
+        if (scr->readsz < EXR_HEADER_PREFETCH_MAX) scr->readsz *= 2;
+        return EXR_ERR_SUCCESS;
+    }
+
+    if (nread == 0)
+        rv = ctxt->report_error (
+            ctxt, EXR_ERR_READ_IO, "End of file attempting to read header");
+    else if (rv == EXR_ERR_SUCCESS)
+        rv = EXR_ERR_READ_IO;
+    return rv;
+}
 
 static exr_result_t
 scratch_seq_read (struct _internal_exr_seq_scratch* scr, void* buf, uint64_t sz)
@@ -105,15 +161,14 @@ scratch_seq_read (struct _internal_exr_seq_scratch* scr, void* buf, uint64_t sz)
             outbuf += nCopy;
             nCopied += nCopy;
         }
-        else if (notdone > SCRATCH_BUFFER_SIZE)
+        else if (notdone > scr->readsz)
         {
-            uint64_t nPages  = notdone / SCRATCH_BUFFER_SIZE;
-            int64_t  nread   = 0;
-            uint64_t nToRead = nPages * SCRATCH_BUFFER_SIZE;
-            rv               = scr->ctxt->do_read (
+            /* bigger than the next read would be, read it in place */
+            int64_t nread = 0;
+            rv            = scr->ctxt->do_read (
                 scr->ctxt,
                 outbuf,
-                nToRead,
+                notdone,
                 &(scr->fileoff),
                 &nread,
                 EXR_MUST_READ_ALL);
@@ -127,28 +182,9 @@ scratch_seq_read (struct _internal_exr_seq_scratch* scr, void* buf, uint64_t sz)
         }
         else
         {
-            int64_t nread = 0;
-            rv            = scr->ctxt->do_read (
-                scr->ctxt,
-                scr->scratch,
-                SCRATCH_BUFFER_SIZE,
-                &(scr->fileoff),
-                &nread,
-                EXR_ALLOW_SHORT_READ);
-            if (nread > 0)
-            {
-                scr->navail = nread;
-                scr->curpos = 0;
-            }
-            else
-            {
-                if (nread == 0)
-                    rv = scr->ctxt->report_error (
-                        scr->ctxt,
-                        EXR_ERR_READ_IO,
-                        "End of file attempting to read header");
-                break;
-            }
+            rv = scratch_refill (scr);
+            if (rv != EXR_ERR_SUCCESS) break;
+            rv = -1;
         }
     }
     if (rv == -1)
@@ -182,28 +218,9 @@ scratch_seq_skip (struct _internal_exr_seq_scratch* scr, int32_t sz)
         }
         else
         {
-            int64_t nread = 0;
-            rv            = scr->ctxt->do_read (
-                scr->ctxt,
-                scr->scratch,
-                SCRATCH_BUFFER_SIZE,
-                &(scr->fileoff),
-                &nread,
-                EXR_ALLOW_SHORT_READ);
-            if (nread > 0)
-            {
-                scr->navail = nread;
-                scr->curpos = 0;
-            }
-            else
-            {
-                if (nread == 0)
-                    rv = scr->ctxt->report_error (
-                        scr->ctxt,
-                        EXR_ERR_READ_IO,
-                        "End of file attempting to read header");
-                break;
-            }
+            rv = scratch_refill (scr);
+            if (rv != EXR_ERR_SUCCESS) break;
+            rv = -1;
         }
     }
     if (rv == -1)
@@ -224,13 +241,21 @@ priv_init_scratch (
     struct _internal_exr_seq_scratch* scr,
     uint64_t                          offset)
 {
+    uint64_t readsz = ctxt->header_prefetch;
+
+    if (readsz == 0) readsz = EXR_HEADER_PREFETCH_DEFAULT;
+    if (ctxt->file_size > 0 && (uint64_t) ctxt->file_size < readsz)
+        readsz = (uint64_t) ctxt->file_size;
+
     scr->curpos          = 0;
     scr->navail          = 0;
     scr->fileoff         = offset;
+    scr->allocsz         = readsz;
+    scr->readsz          = readsz;
     scr->sequential_read = &scratch_seq_read;
     scr->sequential_skip = &scratch_seq_skip;
     scr->ctxt            = ctxt;
-    scr->scratch         = ctxt->alloc_fn (SCRATCH_BUFFER_SIZE);
+    scr->scratch         = ctxt->alloc_fn ((size_t) readsz);
     if (scr->scratch == NULL)
         return ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
     return EXR_ERR_SUCCESS;
@@ -621,7 +646,8 @@ extract_attr_string_vector (
 
         if (nalloced == 0)
         {
-            clist = ctxt->alloc_fn (4 * sizeof (exr_attr_string_t));
+            clist = internal_exr_header_alloc (
+                ctxt, 4 * sizeof (exr_attr_string_t));
             if (clist == NULL)
             {
                 rv = ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
@@ -632,8 +658,8 @@ extract_attr_string_vector (
         if ((nstr + 1) >= nalloced)
         {
             nalloced *= 2;
-            nlist = ctxt->alloc_fn (
-                (size_t) (nalloced) * sizeof (exr_attr_string_t));
+            nlist = internal_exr_header_alloc (
+                ctxt, (size_t) (nalloced) * sizeof (exr_attr_string_t));
             if (nlist == NULL)
             {
                 rv = ctxt->standard_error (ctxt, EXR_ERR_OUT_OF_MEMORY);
@@ -641,7 +667,7 @@ extract_attr_string_vector (
             }
             for (int32_t i = 0; i < nstr; ++i)
                 *(nlist + i) = clist[i];
-            ctxt->free_fn (clist);
+            internal_exr_header_free (ctxt, clist);
             clist = nlist;
         }
         nlist  = clist + nstr;
@@ -675,7 +701,7 @@ extract_attr_string_vector (
 extract_string_vector_fail:
     for (int32_t i = 0; i < nstr; ++i)
         exr_attr_string_destroy ((exr_context_t) ctxt, clist + i);
-    if (clist) ctxt->free_fn (clist);
+    if (clist) internal_exr_header_free (ctxt, clist);
 
     return rv;
 }
@@ -2358,8 +2384,11 @@ internal_exr_compute_chunk_offset_size (struct _internal_exr_part* curpart)
             case EXR_COMPRESSION_RLE:
             case EXR_COMPRESSION_ZIPS: linePerChunk = 1; break;
             case EXR_COMPRESSION_ZIP:
+            case EXR_COMPRESSION_LZ4:
             case EXR_COMPRESSION_PXR24: linePerChunk = 16; break;
             case EXR_COMPRESSION_PIZ:
+            case EXR_COMPRESSION_PIZ4:
+            case EXR_COMPRESSION_ZSTD:
             case EXR_COMPRESSION_B44:
             case EXR_COMPRESSION_B44A:
             case EXR_COMPRESSION_DWAA: linePerChunk = 32; break;
@@ -2464,30 +2493,13 @@ update_chunk_offsets (
 /**************************************/
 
 static exr_result_t
-read_magic_and_flags (
-    struct _internal_exr_context* ctxt, uint32_t* outflags, uint64_t* initpos)
+check_magic_and_flags (
+    struct _internal_exr_context* ctxt,
+    uint32_t*                     magic_and_version,
+    uint32_t*                     outflags)
 {
-    uint32_t     magic_and_version[2];
     uint32_t     flags;
-    exr_result_t rv      = EXR_ERR_UNKNOWN;
-    uint64_t     fileoff = 0;
-    int64_t      nread   = 0;
-
-    rv = ctxt->do_read (
-        ctxt,
-        magic_and_version,
-        sizeof (uint32_t) * 2,
-        &fileoff,
-        &nread,
-        EXR_MUST_READ_ALL);
-    if (rv != EXR_ERR_SUCCESS)
-    {
-        ctxt->report_error (
-            ctxt, EXR_ERR_READ_IO, "Unable to read magic and version flags");
-        return rv;
-    }
-
-    *initpos = sizeof (uint32_t) * 2;
+    exr_result_t rv = EXR_ERR_UNKNOWN;
 
     priv_to_native32 (magic_and_version, 2);
     if (magic_and_version[0] != 20000630)
@@ -2537,12 +2549,55 @@ read_magic_and_flags (
 exr_result_t
 internal_exr_check_magic (struct _internal_exr_context* ctxt)
 {
+    uint32_t     magic_and_version[2];
     uint32_t     flags;
-    uint64_t     initpos;
-    exr_result_t rv = EXR_ERR_UNKNOWN;
+    exr_result_t rv      = EXR_ERR_UNKNOWN;
+    uint64_t     fileoff = 0;
+    int64_t      nread   = 0;
 
-    rv = read_magic_and_flags (ctxt, &flags, &initpos);
-    return rv;
+    rv = ctxt->do_read (
+        ctxt,
+        magic_and_version,
+        sizeof (uint32_t) * 2,
+        &fileoff,
+        &nread,
+        EXR_MUST_READ_ALL);
+    if (rv != EXR_ERR_SUCCESS)
+    {
+        ctxt->report_error (
+            ctxt, EXR_ERR_READ_IO, "Unable to read magic and version flags");
+        return rv;
+    }
+
+    return check_magic_and_flags (ctxt, magic_and_version, &flags);
+}
+
+/**************************************/
+
+/* The header reads usually run on into the chunk offset tables that
+ * follow the header, keep what they got of those so they do not need
+ * to be read again. */
+static void
+keep_chunk_table_prefix (
+    struct _internal_exr_context*           ctxt,
+    const struct _internal_exr_seq_scratch* scratch)
+{
+    uint64_t tablebytes = 0, keep;
+
+    for (int p = 0; p < ctxt->num_parts; ++p)
+        tablebytes +=
+            sizeof (uint64_t) * (uint64_t) ctxt->parts[p]->chunk_count;
+
+    keep = (uint64_t) scratch->navail;
+    if (keep > tablebytes) keep = tablebytes;
+    if (keep == 0) return;
+
+    ctxt->chunk_table_prefix = ctxt->alloc_fn ((size_t) keep);
+    if (!ctxt->chunk_table_prefix) return;
+
+    memcpy (
+        ctxt->chunk_table_prefix, scratch->scratch + scratch->curpos, keep);
+    ctxt->chunk_table_prefix_size = keep;
 }
 
 /**************************************/
@@ -2552,8 +2607,8 @@ internal_exr_parse_header (struct _internal_exr_context* ctxt)
 {
     struct _internal_exr_seq_scratch scratch;
     struct _internal_exr_part*       curpart;
+    uint32_t                         magic_and_version[2];
     uint32_t                         flags;
-    uint64_t                         initpos;
     uint8_t                          next_byte;
     exr_result_t                     rv = EXR_ERR_UNKNOWN;
 
@@ -2563,11 +2618,24 @@ internal_exr_parse_header (struct _internal_exr_context* ctxt)
         ctxt->report_error   = &silent_error;
         ctxt->print_error    = &silent_print_error;
     }
-    rv = read_magic_and_flags (ctxt, &flags, &initpos);
+    /* cleared again with the handlers when done */
+    ctxt->header_arena_active = ctxt->use_header_arena;
+
+    /* the magic comes in with the first header read */
+    rv = priv_init_scratch (ctxt, &scratch, 0);
     if (rv != EXR_ERR_SUCCESS)
+    {
+        priv_destroy_scratch (&scratch);
         return internal_exr_context_restore_handlers (ctxt, rv);
+    }
 
-    rv = priv_init_scratch (ctxt, &scratch, initpos);
+    rv = scratch.sequential_read (
+        &scratch, magic_and_version, sizeof (uint32_t) * 2);
+    if (rv != EXR_ERR_SUCCESS)
+        rv = ctxt->report_error (
+            ctxt, EXR_ERR_READ_IO, "Unable to read magic and version flags");
+    else
+        rv = check_magic_and_flags (ctxt, magic_and_version, &flags);
     if (rv != EXR_ERR_SUCCESS)
     {
         priv_destroy_scratch (&scratch);
@@ -2676,6 +2744,8 @@ internal_exr_parse_header (struct _internal_exr_context* ctxt)
     } while (1);
 
     if (rv == EXR_ERR_SUCCESS) { rv = update_chunk_offsets (ctxt, &scratch); }
+    if (rv == EXR_ERR_SUCCESS && !ctxt->header_only)
+        keep_chunk_table_prefix (ctxt, &scratch);
 
     priv_destroy_scratch (&scratch);
     return internal_exr_context_restore_handlers (ctxt, rv);
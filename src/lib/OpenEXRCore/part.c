@@ -6,6 +6,7 @@
 #include "openexr_part.h"
 
 #include "internal_attr.h"
+#include "internal_compress.h"
 #include "internal_constants.h"
 #include "internal_structs.h"
 
@@ -438,6 +439,96 @@ exr_set_zip_compression_level (exr_context_t ctxt, int part_index, int level)
 
 /**************************************/
 
+exr_result_t
+exr_get_zstd_compression_level (
+    exr_const_context_t ctxt, int part_index, int* level)
+{
+    int l;
+    EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+    l = part->zstd_compression_level;
+    EXR_UNLOCK_WRITE (pctxt);
+
+    if (!level) return pctxt->standard_error (pctxt, EXR_ERR_INVALID_ARGUMENT);
+    *level = l;
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+exr_result_t
+exr_set_zstd_compression_level (exr_context_t ctxt, int part_index, int level)
+{
+    EXR_PROMOTE_LOCKED_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (pctxt->mode != EXR_CONTEXT_WRITE)
+        return EXR_UNLOCK_AND_RETURN_PCTXT (
+            pctxt->standard_error (pctxt, EXR_ERR_NOT_OPEN_WRITE));
+
+    if (level < -22 || level > 22)
+        return EXR_UNLOCK_AND_RETURN_PCTXT (pctxt->report_error (
+            pctxt, EXR_ERR_INVALID_ARGUMENT, "Invalid zstd level specified"));
+
+    part->zstd_compression_level = level;
+    return EXR_UNLOCK_AND_RETURN_PCTXT (EXR_ERR_SUCCESS);
+}
+
+/**************************************/
+
+exr_result_t
+exr_set_zip_compression_tuning (
+    exr_context_t ctxt, int part_index, exr_zip_tuning_t mode, float target)
+{
+    EXR_PROMOTE_LOCKED_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+
+    if (pctxt->mode != EXR_CONTEXT_WRITE)
+        return EXR_UNLOCK_AND_RETURN_PCTXT (
+            pctxt->standard_error (pctxt, EXR_ERR_NOT_OPEN_WRITE));
+
+    if ((int) mode < (int) EXR_ZIP_TUNING_NONE ||
+        (int) mode >= (int) EXR_ZIP_TUNING_LAST_TYPE)
+        return EXR_UNLOCK_AND_RETURN_PCTXT (pctxt->report_error (
+            pctxt, EXR_ERR_INVALID_ARGUMENT, "Invalid zip tuning mode"));
+
+    if (mode != EXR_ZIP_TUNING_NONE && !(target > 0.f))
+        return EXR_UNLOCK_AND_RETURN_PCTXT (pctxt->print_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid zip tuning target %g, must be positive",
+            (double) target));
+
+    part->zip_tuning_mode   = (int32_t) mode;
+    part->zip_tuning_target = target;
+
+    return EXR_UNLOCK_AND_RETURN_PCTXT (EXR_ERR_SUCCESS);
+}
+
+/**************************************/
+
+exr_result_t
+exr_get_zip_compression_tuning (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    exr_zip_tuning_t*   mode,
+    float*              target,
+    int*                level)
+{
+    exr_zip_tuning_t m;
+    float            t;
+    int              l;
+    EXR_PROMOTE_CONST_CONTEXT_AND_PART_OR_ERROR (ctxt, part_index);
+    m = (exr_zip_tuning_t) part->zip_tuning_mode;
+    t = part->zip_tuning_target;
+    l = internal_exr_zip_tuned_level (part);
+    EXR_UNLOCK_WRITE (pctxt);
+
+    if (mode) *mode = m;
+    if (target) *target = t;
+    if (level) *level = l;
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
 exr_result_t
 exr_get_dwa_compression_level (
     exr_const_context_t ctxt, int part_index, float* level)
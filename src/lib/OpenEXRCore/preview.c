@@ -39,7 +39,7 @@ exr_attr_preview_init (
     *p = nil;
     if (bytes > 0)
     {
-        p->rgba = (uint8_t*) pctxt->alloc_fn (bytes);
+        p->rgba = (uint8_t*) internal_exr_header_alloc (pctxt, bytes);
         if (p->rgba == NULL)
             return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
         p->alloc_size = bytes;
@@ -80,7 +80,8 @@ exr_attr_preview_destroy (exr_context_t ctxt, exr_attr_preview_t* p)
     {
         exr_attr_preview_t nil = {0};
         if (p->rgba && p->alloc_size > 0)
-            pctxt->free_fn (EXR_CONST_CAST (uint8_t*, p->rgba));
+            internal_exr_header_free (
+                pctxt, EXR_CONST_CAST (uint8_t*, p->rgba));
         *p = nil;
     }
     return EXR_ERR_SUCCESS;
@@ -32,7 +32,7 @@ exr_attr_string_init (exr_context_t ctxt, exr_attr_string_t* s, int32_t len)
             "Invalid reference to string object to initialize");
 
     *s     = nil;
-    s->str = (char*) pctxt->alloc_fn ((size_t) (len + 1));
+    s->str = (char*) internal_exr_header_alloc (pctxt, (size_t) (len + 1));
     if (s->str == NULL)
         return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
     s->length     = len;
@@ -250,7 +250,7 @@ exr_attr_string_destroy (exr_context_t ctxt, exr_attr_string_t* s)
     {
         exr_attr_string_t nil = {0};
         if (s->str && s->alloc_size > 0)
-            pctxt->free_fn ((char*) (uintptr_t) s->str);
+            internal_exr_header_free (pctxt, (char*) (uintptr_t) s->str);
         *s = nil;
     }
     return EXR_ERR_SUCCESS;
@@ -42,7 +42,8 @@ exr_attr_string_vector_init (
     *sv = nil;
     if (bytes > 0)
     {
-        sv->strings = (exr_attr_string_t*) pctxt->alloc_fn (bytes);
+        sv->strings =
+            (exr_attr_string_t*) internal_exr_header_alloc (pctxt, bytes);
         if (sv->strings == NULL)
             return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
         sv->n_strings  = nent;
@@ -71,7 +72,7 @@ exr_attr_string_vector_destroy (
                 EXR_CONST_CAST (exr_attr_string_t*, sv->strings);
             for (int32_t i = 0; i < sv->n_strings; ++i)
                 exr_attr_string_destroy (ctxt, strs + i);
-            if (strs) pctxt->free_fn (strs);
+            if (strs) internal_exr_header_free (pctxt, strs);
         }
         *sv = nil;
     }
@@ -208,7 +209,7 @@ exr_attr_string_vector_add_entry_with_length (
 
         if (nent > allsz) allsz = nent + 1;
         bytes = ((size_t) allsz) * sizeof (exr_attr_string_t);
-        nlist = (exr_attr_string_t*) pctxt->alloc_fn (bytes);
+        nlist = (exr_attr_string_t*) internal_exr_header_alloc (pctxt, bytes);
         if (nlist == NULL)
             return pctxt->standard_error (pctxt, EXR_ERR_OUT_OF_MEMORY);
 
@@ -216,7 +217,8 @@ exr_attr_string_vector_add_entry_with_length (
             *(nlist + i) = sv->strings[i];
 
         if (sv->alloc_size > 0)
-            pctxt->free_fn (EXR_CONST_CAST (void*, sv->strings));
+            internal_exr_header_free (
+                pctxt, EXR_CONST_CAST (void*, sv->strings));
         sv->strings    = nlist;
         sv->alloc_size = allsz;
     }
@@ -636,10 +636,10 @@ unpack_half_to_float_4chan_interleave (exr_decode_pipeline_t* decode)
         srcbuffer += w * 8; // 4 * sizeof(uint16_t), avoid type conversion
         for (int x = 0; x < w; ++x)
         {
-            out[0] = half_to_float (one_to_native16 (in3[x]));
-            out[1] = half_to_float (one_to_native16 (in2[x]));
-            out[2] = half_to_float (one_to_native16 (in1[x]));
-            out[3] = half_to_float (one_to_native16 (in0[x]));
+            out[0] = half_to_float (one_to_native16 (in0[x]));
+            out[1] = half_to_float (one_to_native16 (in1[x]));
+            out[2] = half_to_float (one_to_native16 (in2[x]));
+            out[3] = half_to_float (one_to_native16 (in3[x]));
             out += 4;
         }
         out0 += linc0;
@@ -677,10 +677,10 @@ unpack_half_to_float_4chan_interleave_rev (exr_decode_pipeline_t* decode)
         srcbuffer += w * 8; // 4 * sizeof(uint16_t), avoid type conversion
         for (int x = 0; x < w; ++x)
         {
-            out[0] = half_to_float (one_to_native16 (in0[x]));
-            out[1] = half_to_float (one_to_native16 (in1[x]));
-            out[2] = half_to_float (one_to_native16 (in2[x]));
-            out[3] = half_to_float (one_to_native16 (in3[x]));
+            out[0] = half_to_float (one_to_native16 (in3[x]));
+            out[1] = half_to_float (one_to_native16 (in2[x]));
+            out[2] = half_to_float (one_to_native16 (in1[x]));
+            out[3] = half_to_float (one_to_native16 (in0[x]));
             out += 4;
         }
         out0 += linc0;
@@ -128,6 +128,8 @@ internal_exr_free (void* p)
 #    include "../../lib/OpenEXRCore/internal_huf.h"
 #endif
 
+#include "../../lib/OpenEXRCore/internal_pxr24_simd.h"
+
 using namespace IMATH_NAMESPACE;
 namespace IMF = OPENEXR_IMF_NAMESPACE;
 using namespace IMF;
@@ -1419,9 +1421,12 @@ doWriteRead (
         case EXR_COMPRESSION_RLE:
         case EXR_COMPRESSION_ZIP:
         case EXR_COMPRESSION_ZIPS:
+        case EXR_COMPRESSION_ZSTD:
+        case EXR_COMPRESSION_LZ4:
             restore.compareExact (p, "orig", "C loaded C");
             break;
         case EXR_COMPRESSION_PIZ:
+        case EXR_COMPRESSION_PIZ4:
         case EXR_COMPRESSION_PXR24:
         case EXR_COMPRESSION_B44:
         case EXR_COMPRESSION_B44A:
@@ -1617,6 +1622,53 @@ testHUF (const std::string& tempdir)
     {
         EXRCORE_TEST (decode.h[i] == p.h[i]);
     }
+
+    // the PIZ4 streams have to match between the two libraries too,
+    // and decode in both
+    for (int pattern = 0; pattern < 3; ++pattern)
+    {
+        if (pattern == 0)
+            p.fillZero ();
+        else if (pattern == 1)
+            p.fillPattern1 ();
+        else
+            p.fillRandom ();
+
+        EXRCORE_TEST_RVAL (internal_huf_compress_streams (
+            &ebytes,
+            encoded.data (),
+            encoded.size (),
+            p.h.data (),
+            IMG_WIDTH,
+            hspare.data (),
+            esize));
+        cppebytes = hufCompressStreams (
+            p.h.data (), IMG_WIDTH, (char*) (&cppencoded[0]));
+        EXRCORE_TEST (ebytes == cppebytes);
+        EXRCORE_TEST (memcmp (encoded.data (), cppencoded.data (), ebytes) == 0);
+
+        decode.fillDead ();
+        EXRCORE_TEST_RVAL (internal_huf_decompress_streams (
+            NULL,
+            encoded.data (),
+            ebytes,
+            decode.h.data (),
+            IMG_WIDTH,
+            hspare.data (),
+            dsize));
+        for (size_t i = 0; i < IMG_WIDTH; ++i)
+        {
+            EXRCORE_TEST (decode.h[i] == p.h[i]);
+        }
+
+        decode.fillDead ();
+        hufUncompressStreams (
+            (const char*) encoded.data (), ebytes, decode.h.data (), IMG_WIDTH);
+        for (size_t i = 0; i < IMG_WIDTH; ++i)
+        {
+            EXRCORE_TEST (decode.h[i] == p.h[i]);
+        }
+    }
 }
 
 ////////////////////////////////////////
@@ -1645,16 +1697,193 @@ testZIPSCompression (const std::string& tempdir)
     testComp (tempdir, EXR_COMPRESSION_ZIPS);
 }
 
+////////////////////////////////////////
+
+// Transcode buffers with a guard area behind them, big enough to hold
+// a whole PIZ bitmap, so that writing past the end is caught rather
+// than trashing the heap.
+static const size_t GUARD_BYTES = 8192 + 64;
+static bool         guardOverwritten;
+
+static void*
+guardedAlloc (exr_transcoding_pipeline_buffer_id_t, size_t sz)
+{
+    uint8_t* p = (uint8_t*) malloc (sizeof (size_t) + sz + GUARD_BYTES);
+    if (!p) return NULL;
+    memcpy (p, &sz, sizeof (size_t));
+    memset (p + sizeof (size_t) + sz, 0xa5, GUARD_BYTES);
+    return p + sizeof (size_t);
+}
+
+static void
+guardedFree (exr_transcoding_pipeline_buffer_id_t, void* ptr)
+{
+    uint8_t* p = (uint8_t*) ptr - sizeof (size_t);
+    size_t   sz;
+
+    memcpy (&sz, p, sizeof (size_t));
+    for (size_t i = 0; i < GUARD_BYTES; ++i)
+        if (p[sizeof (size_t) + sz + i] != 0xa5) guardOverwritten = true;
+    free (p);
+}
+
+// A chunk of a few pixels spread far apart in value has a bitmap
+// bigger than the chunk itself, and bigger than the compressed buffer
+// sized from it. Such chunks must be stored as they are.
+static void
+testPIZSmallChunk (const std::string& tempdir, exr_compression_t comp)
+{
+    std::string filename = tempdir + "piz_small_chunk.exr";
+    const uint16_t values[4] = {0x0001, 0x7bff, 0x3c00, 0x0001};
+
+    exr_context_t             f;
+    int                       partidx;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_chunk_info_t          cinfo;
+    exr_encode_pipeline_t     encoder;
+
+    EXRCORE_TEST_RVAL (exr_start_write (
+        &f, filename.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (f, "scan", EXR_STORAGE_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (
+        exr_initialize_required_attr_simple (f, partidx, 4, 1, comp));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "Y", EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LOGARITHMIC, 1, 1));
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+
+    EXRCORE_TEST_RVAL (exr_write_scanline_chunk_info (f, partidx, 0, &cinfo));
+    EXRCORE_TEST_RVAL (exr_encoding_initialize (f, partidx, &cinfo, &encoder));
+    encoder.channels[0].encode_from_ptr   = (const uint8_t*) values;
+    encoder.channels[0].user_pixel_stride = 2;
+    encoder.channels[0].user_line_stride  = 8;
+    encoder.alloc_fn                      = &guardedAlloc;
+    encoder.free_fn                       = &guardedFree;
+    guardOverwritten                      = false;
+    EXRCORE_TEST_RVAL (
+        exr_encoding_choose_default_routines (f, partidx, &encoder));
+    EXRCORE_TEST_RVAL (exr_encoding_run (f, partidx, &encoder));
+    EXRCORE_TEST_RVAL (exr_encoding_destroy (f, &encoder));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    EXRCORE_TEST (!guardOverwritten);
+
+    Array2D<half> pix (1, 4);
+    FrameBuffer   fb;
+    fb.insert ("Y", Slice (IMF::HALF, (char*) &pix[0][0], 2, 8));
+
+    InputFile in (filename.c_str ());
+    in.setFrameBuffer (fb);
+    in.readPixels (0, 0);
+    for (int x = 0; x < 4; ++x)
+        EXRCORE_TEST (pix[0][x].bits () == values[x]);
+
+    remove (filename.c_str ());
+}
+
 void
 testPIZCompression (const std::string& tempdir)
 {
     testComp (tempdir, EXR_COMPRESSION_PIZ);
+    testPIZSmallChunk (tempdir, EXR_COMPRESSION_PIZ);
+}
+
+void
+testPIZ4Compression (const std::string& tempdir)
+{
+    testComp (tempdir, EXR_COMPRESSION_PIZ4);
+    testPIZSmallChunk (tempdir, EXR_COMPRESSION_PIZ4);
+}
+
+// The SIMD line routines of PXR24 must produce the same bytes as the
+// scalar loops, including for the float values float_to_float24 treats
+// specially and for the tail of lines that are not a multiple of 16.
+static void
+testPXR24Lines ()
+{
+    static const int widths[] = {1, 3, 15, 16, 17, 31, 32, 33, 100, 257};
+    static const uint32_t specials[] = {
+        0x7f800000, 0xff800000, // +/- inf
+        0x7fc00000, 0xffc00000, // quiet nans
+        0x7f800001, 0xff8000ff, // nans which would round to inf
+        0x7fbfff80, 0x7f80a500, // nans keeping some significand bits
+        0x7f7fffff, 0xff7fffff, // +/- FLT_MAX, rounding overflows
+        0x7f7fff80, 0x7f7fff7f, // just at / below the rounding overflow
+        0x00000001, 0x807fffff, // denormals
+        0x00000000, 0x80000000, // +/- 0
+        0x3f800080, 0x3f800180, // round to even
+        0xffffffff, 0x0000ffff};
+    const int nspecial = sizeof (specials) / sizeof (specials[0]);
+
+    int simd = pxr24_line_simd (check_for_x86_byte_simd ());
+    if (simd == 0)
+    {
+        std::cout << "  no SIMD PXR24 line routines to compare" << std::endl;
+        return;
+    }
+
+    Rand32 rand (42);
+    for (int w: widths)
+    {
+        std::vector<uint8_t> in (4 * w), ref (4 * w), out (4 * w);
+
+        for (int pass = 0; pass < 4; ++pass)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                uint32_t v = rand.nexti ();
+                // every other pass is mostly special values, in runs
+                // so the differences between neighbours stay small
+                if ((pass & 1) && (v & 3) != 0)
+                    v = specials[(x / 2 + pass) % nspecial];
+                unaligned_store32 (&in[4 * x], v);
+            }
+
+            std::fill (ref.begin (), ref.end (), 0xcd);
+            std::fill (out.begin (), out.end (), 0xcd);
+            encode_uint_line (ref.data (), in.data (), w, 0);
+            encode_uint_line (out.data (), in.data (), w, simd);
+            EXRCORE_TEST (ref == out);
+
+            std::fill (ref.begin (), ref.end (), 0xcd);
+            std::fill (out.begin (), out.end (), 0xcd);
+            encode_half_line (ref.data (), in.data (), w, 0);
+            encode_half_line (out.data (), in.data (), w, simd);
+            EXRCORE_TEST (ref == out);
+
+            std::fill (ref.begin (), ref.end (), 0xcd);
+            std::fill (out.begin (), out.end (), 0xcd);
+            encode_float_line (ref.data (), in.data (), w, 0);
+            encode_float_line (out.data (), in.data (), w, simd);
+            EXRCORE_TEST (ref == out);
+
+            // the decoders are fed the random bytes as they are, the
+            // plane differences wrap around just like any others
+            std::fill (ref.begin (), ref.end (), 0xcd);
+            std::fill (out.begin (), out.end (), 0xcd);
+            decode_uint_line (ref.data (), in.data (), w, 0);
+            decode_uint_line (out.data (), in.data (), w, simd);
+            EXRCORE_TEST (ref == out);
+
+            std::fill (ref.begin (), ref.end (), 0xcd);
+            std::fill (out.begin (), out.end (), 0xcd);
+            decode_half_line (ref.data (), in.data (), w, 0);
+            decode_half_line (out.data (), in.data (), w, simd);
+            EXRCORE_TEST (ref == out);
+
+            std::fill (ref.begin (), ref.end (), 0xcd);
+            std::fill (out.begin (), out.end (), 0xcd);
+            decode_float_line (ref.data (), in.data (), w, 0);
+            decode_float_line (out.data (), in.data (), w, simd);
+            EXRCORE_TEST (ref == out);
+        }
+    }
 }
 
 void
 testPXR24Compression (const std::string& tempdir)
 {
     testComp (tempdir, EXR_COMPRESSION_PXR24);
+    testPXR24Lines ();
 }
 
 void
@@ -1681,6 +1910,48 @@ testDWABCompression (const std::string& tempdir)
     testComp (tempdir, EXR_COMPRESSION_DWAB);
 }
 
+void
+testZSTDCompression (const std::string& tempdir)
+{
+    uint8_t src[16] = {0}, dst[64];
+    if (exr_zstd_compress_buffer (
+            NULL, 0, src, sizeof (src), dst, sizeof (dst), NULL) ==
+        EXR_ERR_FEATURE_NOT_IMPLEMENTED)
+    {
+        std::cout << "  zstd support not built in, skipping" << std::endl;
+        return;
+    }
+    testComp (tempdir, EXR_COMPRESSION_ZSTD);
+}
+
+void
+testLZ4Compression (const std::string& tempdir)
+{
+    std::vector<uint8_t> src (4096), comp, dst (4096);
+    size_t               csz, dsz;
+
+    for (size_t i = 0; i < src.size (); ++i)
+        src[i] = (uint8_t) ((i % 7) * (i / 512));
+    comp.resize (exr_lz4_compress_max_buffer_size (src.size ()));
+    EXRCORE_TEST_RVAL (exr_lz4_compress_buffer (
+        NULL, src.data (), src.size (), comp.data (), comp.size (), &csz));
+    EXRCORE_TEST (csz < src.size ());
+    EXRCORE_TEST_RVAL (exr_lz4_uncompress_buffer (
+        NULL, comp.data (), csz, dst.data (), dst.size (), &dsz));
+    EXRCORE_TEST (dsz == src.size () && dst == src);
+    // a truncated block or too small an output is an error, not a crash
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_CORRUPT_CHUNK,
+        exr_lz4_uncompress_buffer (
+            NULL, comp.data (), csz - 1, dst.data (), dst.size (), &dsz));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_CORRUPT_CHUNK,
+        exr_lz4_uncompress_buffer (
+            NULL, comp.data (), csz, dst.data (), dst.size () - 1, &dsz));
+
+    testComp (tempdir, EXR_COMPRESSION_LZ4);
+}
+
 void
 testDeepNoCompression (const std::string& tempdir)
 {}
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright Contributors to the OpenEXR Project.
+
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Imath/half.h>
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfMultiPartInputFile.h>
+#include <ImfOutputFile.h>
+
+#include <openexr.h>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+
+//
+// Measures how many files per second a metadata crawler gets through
+// when it only wants the headers, opening each file with the full
+// C++ and Core opens and with their header-only modes.  Without any
+// files named, a scan line image with many channels and a line per
+// chunk is written, so the offset table is about as big as the
+// header.
+//
+
+static void
+writeImage (const std::string& fn, int channels, int width, int height)
+{
+    Header hdr (width, height);
+    hdr.compression () = ZIPS_COMPRESSION;
+    for (int c = 0; c < channels; ++c)
+        hdr.channels ().insert (
+            "layer" + std::to_string (c / 4) + "." + "RGBA"[c % 4],
+            Channel (HALF));
+
+    std::vector<half> pixels (size_t (width) * height, half (0.5f));
+
+    FrameBuffer fb;
+    for (ChannelList::ConstIterator i = hdr.channels ().begin ();
+         i != hdr.channels ().end ();
+         ++i)
+    {
+        fb.insert (
+            i.name (),
+            Slice (
+                HALF,
+                reinterpret_cast<char*> (pixels.data ()),
+                sizeof (half),
+                sizeof (half) * width));
+    }
+
+    OutputFile out (fn.c_str (), hdr);
+    out.setFrameBuffer (fb);
+    out.writePixels (height);
+}
+
+static void
+quietError (exr_const_context_t, exr_result_t, const char*)
+{}
+
+static void
+openCore (const std::string& fn, int flags)
+{
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_context_t             f;
+
+    cinit.error_handler_fn = &quietError;
+    cinit.flags            = flags;
+    if (exr_start_read (&f, fn.c_str (), &cinit) != EXR_ERR_SUCCESS)
+        throw std::runtime_error ("unable to open " + fn);
+
+    int parts = 0;
+    exr_get_count (f, &parts);
+    exr_finish (&f);
+}
+
+static void
+timeOpen (
+    const char*                                     name,
+    const std::vector<std::string>&                 files,
+    int                                             iters,
+    const std::function<void (const std::string&)>& open)
+{
+    auto start = std::chrono::steady_clock::now ();
+    for (int i = 0; i < iters; ++i)
+        for (const std::string& fn: files)
+            open (fn);
+    auto end = std::chrono::steady_clock::now ();
+
+    double secs = std::chrono::duration<double> (end - start).count ();
+    std::cout << " " << std::setw (36) << std::left << name << std::fixed
+              << std::setprecision (0)
+              << double (iters) * double (files.size ()) / secs << std::endl;
+}
+
+static int
+usageAndExit (const char* argv0, int ec)
+{
+    std::cerr << "Usage: " << argv0
+              << " [--iters <n>] [--channels <n>] [--height <n>] [file ...]"
+              << std::endl;
+    return ec;
+}
+
+int
+main (int argc, char* argv[])
+{
+    std::string              generated = "header_perf.exr";
+    int                      iters     = 2000;
+    int                      channels  = 64;
+    int                      height    = 4096;
+    std::vector<std::string> files;
+
+    for (int a = 1; a < argc; ++a)
+    {
+        if (!strcmp (argv[a], "-h") || !strcmp (argv[a], "--help") ||
+            !strcmp (argv[a], "-?"))
+        {
+            return usageAndExit (argv[0], 0);
+        }
+        else if (a + 1 < argc && !strcmp (argv[a], "--iters"))
+            iters = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--channels"))
+            channels = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--height"))
+            height = atoi (argv[++a]);
+        else if (argv[a][0] == '-')
+            return usageAndExit (argv[0], 1);
+        else
+            files.push_back (argv[a]);
+    }
+
+    if (iters <= 0 || channels <= 0 || height <= 0)
+        return usageAndExit (argv[0], 1);
+
+    bool generate = files.empty ();
+
+    try
+    {
+        if (generate)
+        {
+            writeImage (generated, channels, 16, height);
+            files.push_back (generated);
+            std::cout << "16x" << height << " half image, " << channels
+                      << " channels, ZIPS, ";
+        }
+        else
+            std::cout << files.size () << " files, ";
+        std::cout << iters << " iterations\n\n"
+                  << std::setw (37) << std::left << " Open" << "files/s"
+                  << std::endl;
+
+        timeOpen (
+            "MultiPartInputFile",
+            files,
+            iters,
+            [] (const std::string& fn) {
+                MultiPartInputFile in (fn.c_str ());
+            });
+        timeOpen (
+            "MultiPartInputFile (HEADER_ONLY)",
+            files,
+            iters,
+            [] (const std::string& fn) {
+                MultiPartInputFile in (
+                    fn.c_str (), MultiPartInputFile::HEADER_ONLY);
+            });
+        timeOpen (
+            "exr_start_read", files, iters, [] (const std::string& fn) {
+                openCore (fn, 0);
+            });
+        timeOpen (
+            "exr_start_read (HEADER_ONLY)",
+            files,
+            iters,
+            [] (const std::string& fn) {
+                openCore (fn, EXR_CONTEXT_FLAG_HEADER_ONLY);
+            });
+        timeOpen (
+            "exr_start_read (HEADER_ONLY, ARENA)",
+            files,
+            iters,
+            [] (const std::string& fn) {
+                openCore (
+                    fn,
+                    EXR_CONTEXT_FLAG_HEADER_ONLY |
+                        EXR_CONTEXT_FLAG_HEADER_ARENA);
+            });
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what () << std::endl;
+        if (generate) remove (generated.c_str ());
+        return 1;
+    }
+
+    if (generate) remove (generated.c_str ());
+    return 0;
+}
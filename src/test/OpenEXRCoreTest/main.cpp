@@ -176,6 +176,16 @@ main (int argc, char* argv[])
     TEST (testReadMultiPart, "core_read");
     TEST (testReadDeep, "core_read");
     TEST (testReadUnpack, "core_read");
+    TEST (testReadMemoryMapped, "core_read");
+    TEST (testReadChunks, "core_read");
+    TEST (testReadChunkReadAhead, "core_read");
+    TEST (testReadChunkInfoTable, "core_read");
+    TEST (testReadHeaderPrefetch, "core_read");
+    TEST (testReadHeaderOnly, "core_read");
+    TEST (testReadHeaderArena, "core_read");
+    TEST (testReadPrefetch, "core_read");
+    TEST (testReadRegion, "core_read");
+    TEST (testReadDWATasks, "core_read");
 
     TEST (testWriteBadArgs, "core_write");
     TEST (testWriteBadFiles, "core_write");
@@ -189,6 +199,8 @@ main (int argc, char* argv[])
     TEST (testWriteScans, "core_write");
     TEST (testWriteTiles, "core_write");
     TEST (testWriteMultiPart, "core_write");
+    TEST (testWriteRegion, "core_write");
+    TEST (testWriteZipTuning, "core_write");
     TEST (testWriteDeep, "core_write");
 
     TEST (testHUF, "core_compression");
@@ -197,11 +209,14 @@ main (int argc, char* argv[])
     TEST (testZIPCompression, "core_compression");
     TEST (testZIPSCompression, "core_compression");
     TEST (testPIZCompression, "core_compression");
+    TEST (testPIZ4Compression, "core_compression");
     TEST (testPXR24Compression, "core_compression");
     TEST (testB44Compression, "core_compression");
     TEST (testB44ACompression, "core_compression");
     TEST (testDWAACompression, "core_compression");
     TEST (testDWABCompression, "core_compression");
+    TEST (testZSTDCompression, "core_compression");
+    TEST (testLZ4Compression, "core_compression");
 
     TEST (testDeepNoCompression, "core_compression");
     TEST (testDeepZIPCompression, "core_compression");
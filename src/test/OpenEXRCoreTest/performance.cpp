@@ -81,6 +81,66 @@ private:
 //#define THREADS 0
 #define THREADS 16
 
+static bool s_useRegion = false;
+
+class SpawnedTask : public Task
+{
+public:
+    SpawnedTask (void (*fn) (void*), void* data)
+        : Task (nullptr), _fn (fn), _data (data)
+    {}
+    void execute () override { _fn (_data); }
+
+private:
+    void (*_fn) (void*);
+    void* _data;
+};
+
+static exr_result_t
+spawn_global_task (void*, void (*task_fn) (void*), void* task_data)
+{
+    ThreadPool::addGlobalTask (new SpawnedTask (task_fn, task_data));
+    return EXR_ERR_SUCCESS;
+}
+
+static void
+read_region (exr_context_t f, const exr_attr_box2i_t& dw, uint8_t* imgptr)
+{
+    const exr_attr_chlist_t* chlist;
+    if (EXR_ERR_SUCCESS != exr_get_channels (f, 0, &chlist))
+        throw std::logic_error ("Unable to query channels from part");
+
+    int32_t bytesperpixel = 0;
+    for (int c = 0; c < chlist->num_channels; ++c)
+        bytesperpixel += (chlist->entries[c].pixel_type == EXR_PIXEL_HALF) ? 2
+                                                                           : 4;
+
+    std::vector<exr_region_channel_t> chans (chlist->num_channels);
+    int32_t                           w = dw.max.x - dw.min.x + 1;
+    for (int c = 0; c < chlist->num_channels; ++c)
+    {
+        chans[c].channel_name   = chlist->entries[c].name.str;
+        chans[c].decode_to_base = imgptr;
+        chans[c].pixel_stride   = bytesperpixel;
+        chans[c].line_stride    = w * bytesperpixel;
+        chans[c].data_type      = (uint16_t) chlist->entries[c].pixel_type;
+        imgptr += (chlist->entries[c].pixel_type == EXR_PIXEL_HALF) ? 2 : 4;
+    }
+
+    if (EXR_ERR_SUCCESS != exr_decode_region (
+                               f,
+                               0,
+                               0,
+                               0,
+                               &dw,
+                               chlist->num_channels,
+                               chans.data (),
+                               THREADS > 0 ? THREADS : 1,
+                               THREADS > 0 ? &spawn_global_task : nullptr,
+                               nullptr))
+        throw std::runtime_error ("unable to decode region");
+}
+
 static uint64_t
 read_pixels_raw (exr_context_t f)
 {
@@ -131,6 +191,12 @@ read_pixels_raw (exr_context_t f)
         rawBuf.resize (size_t (ccount) * sizePerChunk);
         uint8_t* imgptr = rawBuf.data ();
 
+        if (s_useRegion)
+        {
+            read_region (f, dw, imgptr);
+            return uint64_t (dw.max.y - dw.min.y + 1) * uint64_t (w);
+        }
+
 #if THREADS > 0
         TaskGroup   taskgroup;
         ThreadPool& tp = ThreadPool::globalThreadPool ();
@@ -395,7 +461,9 @@ readImf (
 static int
 usageAndExit (const char* argv0, int ec)
 {
-    std::cerr << "Usage: " << argv0 << "[--imf|--core] <file1> [<file2>...]"
+    std::cerr << "Usage: " << argv0
+              << "[--imf|--core] [--region] <file1> [<file2>...]\n"
+                 "  --region  decode through exr_decode_region"
               << std::endl;
     return ec;
 }
@@ -432,6 +500,8 @@ main (int argc, char* argv[])
                 return usageAndExit (argv[0], 1);
             }
         }
+        else if (!strcmp (argv[a], "--region"))
+            s_useRegion = true;
         else
             files.push_back (argv[a]);
     }
@@ -12,9 +12,13 @@
 #include <math.h>
 #include <string.h>
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
 
 static void
 err_cb (exr_const_context_t f, int code, const char* msg)
@@ -589,3 +593,998 @@ testReadUnpack (const std::string& tempdir)
 
     exr_finish (&f);
 }
+
+static void
+readAllChunks (
+    const std::string& fn, int flags, std::vector<std::vector<uint8_t>>& out)
+{
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+    cinit.flags                     = flags;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+    exr_attr_box2i_t dw;
+    int32_t          lpc;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+    for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+    {
+        exr_chunk_info_t cinfo;
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+        if (y == dw.min.y)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_decoding_initialize (f, 0, &cinfo, &decoder));
+        }
+        else
+        {
+            EXRCORE_TEST_RVAL (exr_decoding_update (f, 0, &cinfo, &decoder));
+        }
+
+        for (int c = 0; c < decoder.channel_count; ++c)
+            decoder.channels[c].decode_to_ptr = NULL;
+
+        EXRCORE_TEST_RVAL (
+            exr_decoding_choose_default_routines (f, 0, &decoder));
+        EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+
+        /* chunk data is referenced in the mapping, not copied */
+        if (flags & EXR_CONTEXT_FLAG_MEMORY_MAP)
+        {
+            EXRCORE_TEST (decoder.packed_alloc_size == 0);
+        }
+
+        const uint8_t* data = (const uint8_t*) decoder.unpacked_buffer;
+        out.emplace_back (data, data + cinfo.unpacked_size);
+    }
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+
+    exr_finish (&f);
+}
+
+void
+testReadMemoryMapped (const std::string& tempdir)
+{
+    static const char* files[] = {
+        "comp_none.exr", "comp_rle.exr", "comp_zips.exr", "comp_zip.exr"};
+
+    for (const char* file: files)
+    {
+        std::string fn = ILM_IMF_TEST_IMAGEDIR;
+        fn += file;
+
+        std::vector<std::vector<uint8_t>> plain, mapped;
+        readAllChunks (fn, 0, plain);
+        readAllChunks (fn, EXR_CONTEXT_FLAG_MEMORY_MAP, mapped);
+
+        EXRCORE_TEST (!plain.empty ());
+        EXRCORE_TEST (plain == mapped);
+    }
+}
+
+struct CountingStream
+{
+    std::vector<uint8_t> data;
+    int                  reads;
+};
+
+static int64_t
+counting_read (
+    exr_const_context_t         f,
+    void*                       userdata,
+    void*                       buffer,
+    uint64_t                    sz,
+    uint64_t                    offset,
+    exr_stream_error_func_ptr_t errcb)
+{
+    CountingStream* s = static_cast<CountingStream*> (userdata);
+
+    ++s->reads;
+    if (offset >= s->data.size ()) return 0;
+    if (sz > s->data.size () - offset) sz = s->data.size () - offset;
+    memcpy (buffer, s->data.data () + offset, sz);
+    return static_cast<int64_t> (sz);
+}
+
+static int64_t
+counting_size (exr_const_context_t f, void* userdata)
+{
+    return static_cast<int64_t> (
+        static_cast<CountingStream*> (userdata)->data.size ());
+}
+
+static void
+loadStream (const char* file, CountingStream& stream)
+{
+    std::string fn = ILM_IMF_TEST_IMAGEDIR;
+    fn += file;
+
+    FILE* fp = fopen (fn.c_str (), "rb");
+    EXRCORE_TEST (fp != NULL);
+    uint8_t buf[4096];
+    size_t  n;
+    while ((n = fread (buf, 1, sizeof (buf), fp)) > 0)
+        stream.data.insert (stream.data.end (), buf, buf + n);
+    fclose (fp);
+}
+
+void
+testReadChunks (const std::string& tempdir)
+{
+    exr_context_t             f;
+    std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    CountingStream            stream;
+
+    fn += "comp_zips.exr";
+    loadStream ("comp_zips.exr", stream);
+    stream.reads = 0;
+
+    cinit.error_handler_fn = &err_cb;
+    cinit.user_data        = &stream;
+    cinit.read_fn          = &counting_read;
+    cinit.size_fn          = &counting_size;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+    exr_attr_box2i_t dw;
+    int32_t          lpc;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    std::vector<exr_chunk_info_t>     cinfos;
+    std::vector<std::vector<uint8_t>> single, batch;
+    std::vector<void*>                ptrs;
+
+    for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+    {
+        exr_chunk_info_t cinfo;
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+        cinfos.push_back (cinfo);
+    }
+    EXRCORE_TEST (cinfos.size () > 1);
+
+    /* request them out of order, the batch should sort them */
+    std::reverse (cinfos.begin (), cinfos.end ());
+
+    for (const exr_chunk_info_t& cinfo: cinfos)
+    {
+        single.emplace_back (cinfo.packed_size);
+        EXRCORE_TEST_RVAL (
+            exr_read_chunk (f, 0, &cinfo, single.back ().data ()));
+        batch.emplace_back (cinfo.packed_size);
+        ptrs.push_back (batch.back ().data ());
+    }
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT, exr_read_chunks (f, 0, -1, NULL, NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_read_chunks (f, 0, (int) cinfos.size (), cinfos.data (), NULL));
+    EXRCORE_TEST_RVAL (exr_read_chunks (f, 0, 0, NULL, NULL));
+
+    stream.reads = 0;
+    EXRCORE_TEST_RVAL (exr_read_chunks (
+        f, 0, (int) cinfos.size (), cinfos.data (), ptrs.data ()));
+    /* the whole (small) image is contiguous, so one read does it */
+    EXRCORE_TEST (stream.reads == 1);
+    EXRCORE_TEST (single == batch);
+
+    exr_finish (&f);
+}
+
+static void
+readChunksCounted (
+    CountingStream&                    stream,
+    int                                readahead,
+    std::vector<std::vector<uint8_t>>& out)
+{
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+
+    cinit.error_handler_fn = &err_cb;
+    cinit.user_data        = &stream;
+    cinit.read_fn          = &counting_read;
+    cinit.size_fn          = &counting_size;
+    cinit.chunk_read_ahead = readahead;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, "readahead.exr", &cinit));
+
+    exr_attr_box2i_t dw;
+    int32_t          lpc;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    stream.reads = 0;
+    for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+    {
+        exr_chunk_info_t cinfo;
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+        out.emplace_back (cinfo.packed_size);
+        EXRCORE_TEST_RVAL (exr_read_chunk (f, 0, &cinfo, out.back ().data ()));
+    }
+
+    /* the info is kept, but the data is long since dropped from the
+     * read ahead and read again */
+    exr_chunk_info_t     cinfo;
+    std::vector<uint8_t> again;
+    EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, dw.min.y, &cinfo));
+    again.resize (cinfo.packed_size);
+    EXRCORE_TEST_RVAL (exr_read_chunk (f, 0, &cinfo, again.data ()));
+    EXRCORE_TEST (again == out.front ());
+
+    exr_finish (&f);
+}
+
+void
+testReadChunkReadAhead (const std::string& tempdir)
+{
+    CountingStream stream;
+
+    loadStream ("comp_zips.exr", stream);
+
+    std::vector<std::vector<uint8_t>> plain, fused, partial;
+    int                               nchunks;
+
+    readChunksCounted (stream, 0, plain);
+    nchunks = (int) plain.size ();
+    EXRCORE_TEST (nchunks > 1);
+    /* the offset table came in with the header, so a leader read and
+     * a data read per chunk, and the data of the first one again */
+    EXRCORE_TEST (stream.reads == 2 * nchunks + 1);
+
+    /* each chunk fits in the read ahead, so the leader read brings
+     * in all of it */
+    readChunksCounted (stream, 1024 * 1024, fused);
+    EXRCORE_TEST (stream.reads == nchunks + 1);
+    EXRCORE_TEST (plain == fused);
+
+    /* only the start of each chunk, the rest is read after it */
+    readChunksCounted (stream, 4, partial);
+    EXRCORE_TEST (stream.reads == 2 * nchunks + 1);
+    EXRCORE_TEST (plain == partial);
+}
+
+static void
+lookupAllChunks (exr_context_t f, std::vector<exr_chunk_info_t>& out)
+{
+    exr_storage_t storage;
+    EXRCORE_TEST_RVAL (exr_get_storage (f, 0, &storage));
+
+    if (storage == EXR_STORAGE_SCANLINE)
+    {
+        exr_attr_box2i_t dw;
+        int32_t          lpc;
+        EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+        EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+        /* bottom up, so nothing is in file order */
+        for (int y = dw.max.y; y >= dw.min.y; --y)
+        {
+            if ((y - dw.min.y) % lpc != 0) continue;
+            exr_chunk_info_t cinfo;
+            EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+            out.push_back (cinfo);
+        }
+        return;
+    }
+
+    int32_t levelsx, levelsy;
+    EXRCORE_TEST_RVAL (exr_get_tile_levels (f, 0, &levelsx, &levelsy));
+    for (int l = levelsx - 1; l >= 0; --l)
+    {
+        int32_t levelw, levelh, tilew, tileh;
+        EXRCORE_TEST_RVAL (exr_get_level_sizes (f, 0, l, l, &levelw, &levelh));
+        EXRCORE_TEST_RVAL (exr_get_tile_sizes (f, 0, l, l, &tilew, &tileh));
+        for (int ty = (levelh + tileh - 1) / tileh - 1; ty >= 0; --ty)
+        {
+            for (int tx = (levelw + tilew - 1) / tilew - 1; tx >= 0; --tx)
+            {
+                exr_chunk_info_t cinfo;
+                EXRCORE_TEST_RVAL (
+                    exr_read_tile_chunk_info (f, 0, tx, ty, l, l, &cinfo));
+                out.push_back (cinfo);
+            }
+        }
+    }
+}
+
+void
+testReadChunkInfoTable (const std::string& tempdir)
+{
+    static const char* files[] = {"comp_zips.exr", "v1.7.test.tiled.exr"};
+
+    for (const char* file: files)
+    {
+        CountingStream            stream;
+        exr_context_t             f;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+
+        loadStream (file, stream);
+        cinit.error_handler_fn = &err_cb;
+        cinit.user_data        = &stream;
+        cinit.read_fn          = &counting_read;
+        cinit.size_fn          = &counting_size;
+
+        std::vector<exr_chunk_info_t> plain, again, built;
+
+        /* the first lookup of each chunk reads its leader, the
+         * next one does not */
+        EXRCORE_TEST_RVAL (exr_start_read (&f, file, &cinit));
+        stream.reads = 0;
+        lookupAllChunks (f, plain);
+        EXRCORE_TEST (stream.reads == (int) plain.size ());
+        stream.reads = 0;
+        lookupAllChunks (f, again);
+        EXRCORE_TEST (stream.reads == 0);
+        exr_finish (&f);
+
+        /* a read per megabyte of chunks at most, after which lookups
+         * in any order do not read */
+        EXRCORE_TEST_RVAL (exr_start_read (&f, file, &cinit));
+        stream.reads = 0;
+        EXRCORE_TEST_RVAL (exr_build_chunk_info_table (f, 0));
+        int nbuild = stream.reads;
+        EXRCORE_TEST (nbuild <= 1 + (int) (stream.data.size () >> 20));
+        EXRCORE_TEST_RVAL (exr_build_chunk_info_table (f, 0));
+        EXRCORE_TEST (stream.reads == nbuild);
+        lookupAllChunks (f, built);
+        EXRCORE_TEST (stream.reads == nbuild);
+        exr_finish (&f);
+
+        EXRCORE_TEST (plain.size () > 1);
+        EXRCORE_TEST (again.size () == plain.size ());
+        EXRCORE_TEST (built.size () == plain.size ());
+        for (size_t c = 0; c < plain.size (); ++c)
+        {
+            EXRCORE_TEST (
+                memcmp (&plain[c], &again[c], sizeof (exr_chunk_info_t)) == 0);
+            EXRCORE_TEST (
+                memcmp (&plain[c], &built[c], sizeof (exr_chunk_info_t)) == 0);
+        }
+    }
+}
+
+void
+testReadHeaderPrefetch (const std::string& tempdir)
+{
+    static const char* files[] = {"comp_zips.exr", "v1.7.test.tiled.exr"};
+
+    for (const char* file: files)
+    {
+        CountingStream            stream;
+        exr_context_t             f;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+
+        loadStream (file, stream);
+        cinit.error_handler_fn = &err_cb;
+        cinit.user_data        = &stream;
+        cinit.read_fn          = &counting_read;
+        cinit.size_fn          = &counting_size;
+
+        std::vector<exr_chunk_info_t> plain, small;
+        int                           nattrs, smallattrs;
+
+        /* the magic, the header and the offset table in one read */
+        stream.reads = 0;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, file, &cinit));
+        EXRCORE_TEST (stream.reads == 1);
+        EXRCORE_TEST_RVAL (exr_get_attribute_count (f, 0, &nattrs));
+        lookupAllChunks (f, plain);
+        EXRCORE_TEST (stream.reads == 1 + (int) plain.size ());
+        exr_finish (&f);
+
+        /* tiny reads to start with still get the same header, the
+         * offset table is read on its own if need be */
+        cinit.header_prefetch = 16;
+        stream.reads          = 0;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, file, &cinit));
+        EXRCORE_TEST (stream.reads > 1);
+        EXRCORE_TEST_RVAL (exr_get_attribute_count (f, 0, &smallattrs));
+        EXRCORE_TEST (smallattrs == nattrs);
+        lookupAllChunks (f, small);
+        exr_finish (&f);
+
+        EXRCORE_TEST (small.size () == plain.size ());
+        for (size_t c = 0; c < plain.size (); ++c)
+            EXRCORE_TEST (
+                memcmp (&plain[c], &small[c], sizeof (exr_chunk_info_t)) == 0);
+    }
+}
+
+void
+testReadHeaderOnly (const std::string& tempdir)
+{
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_context_initializer_t minit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    CountingStream            stream;
+    exr_attr_box2i_t          dw;
+    exr_chunk_info_t          cinfo;
+    int32_t                   nattrs;
+
+    loadStream ("comp_zips.exr", stream);
+    cinit.error_handler_fn = &err_cb;
+    cinit.user_data        = &stream;
+    cinit.read_fn          = &counting_read;
+    cinit.size_fn          = &counting_size;
+    cinit.flags            = EXR_CONTEXT_FLAG_HEADER_ONLY;
+
+    /* the header is all there is, nothing past it is read */
+    stream.reads = 0;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, "comp_zips.exr", &cinit));
+    EXRCORE_TEST (stream.reads == 1);
+    EXRCORE_TEST_RVAL (exr_get_attribute_count (f, 0, &nattrs));
+    EXRCORE_TEST (nattrs > 0);
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NOT_OPEN_READ,
+        exr_read_scanline_chunk_info (f, 0, dw.min.y, &cinfo));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NOT_OPEN_READ, exr_build_chunk_info_table (f, 0));
+    EXRCORE_TEST (stream.reads == 1);
+    exr_finish (&f);
+
+    /* and the file is not mapped */
+    std::string fn = ILM_IMF_TEST_IMAGEDIR;
+    fn += "v1.7.test.tiled.exr";
+    minit.error_handler_fn = &err_cb;
+    minit.flags = EXR_CONTEXT_FLAG_HEADER_ONLY | EXR_CONTEXT_FLAG_MEMORY_MAP;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &minit));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NOT_OPEN_READ,
+        exr_read_tile_chunk_info (f, 0, 0, 0, 0, 0, &cinfo));
+    exr_finish (&f);
+}
+
+static int s_counted_allocs = 0;
+static int s_counted_live   = 0;
+
+static void*
+counted_malloc (size_t bytes)
+{
+    ++s_counted_allocs;
+    ++s_counted_live;
+    return malloc (bytes);
+}
+
+static void
+counted_free (void* p)
+{
+    if (!p) return;
+    --s_counted_live;
+    free (p);
+}
+
+static int
+openCountingAllocs (const char* file, int flags, exr_context_t* f)
+{
+    std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+
+    fn += file;
+    cinit.error_handler_fn = &err_cb;
+    cinit.alloc_fn         = &counted_malloc;
+    cinit.free_fn          = &counted_free;
+    cinit.flags            = flags;
+
+    s_counted_allocs = 0;
+    EXRCORE_TEST_RVAL (exr_start_read (f, fn.c_str (), &cinit));
+    return s_counted_allocs;
+}
+
+void
+testReadHeaderArena (const std::string& tempdir)
+{
+    static const char* files[] = {
+        "comp_zips.exr", "v1.7.test.1.exr", "v1.7.test.tiled.exr"};
+
+    for (const char* file: files)
+    {
+        exr_context_t plain, arena;
+        int           nplain, narena, nparts;
+
+        nplain = openCountingAllocs (file, 0, &plain);
+        narena =
+            openCountingAllocs (file, EXR_CONTEXT_FLAG_HEADER_ARENA, &arena);
+        EXRCORE_TEST (narena < nplain);
+
+        /* the same header either way */
+        EXRCORE_TEST_RVAL (exr_get_count (arena, &nparts));
+        for (int p = 0; p < nparts; ++p)
+        {
+            int32_t na, nb;
+            EXRCORE_TEST_RVAL (exr_get_attribute_count (plain, p, &na));
+            EXRCORE_TEST_RVAL (exr_get_attribute_count (arena, p, &nb));
+            EXRCORE_TEST (na == nb);
+            for (int32_t i = 0; i < na; ++i)
+            {
+                const exr_attribute_t *a, *b;
+                EXRCORE_TEST_RVAL (exr_get_attribute_by_index (
+                    plain, p, EXR_ATTR_LIST_FILE_ORDER, i, &a));
+                EXRCORE_TEST_RVAL (exr_get_attribute_by_index (
+                    arena, p, EXR_ATTR_LIST_FILE_ORDER, i, &b));
+                EXRCORE_TEST (!strcmp (a->name, b->name));
+                EXRCORE_TEST (a->type == b->type);
+                if (a->type == EXR_ATTR_STRING)
+                    EXRCORE_TEST (!strcmp (a->string->str, b->string->str));
+                if (a->type == EXR_ATTR_CHLIST)
+                {
+                    EXRCORE_TEST (
+                        a->chlist->num_channels == b->chlist->num_channels);
+                    for (int c = 0; c < a->chlist->num_channels; ++c)
+                        EXRCORE_TEST (!strcmp (
+                            a->chlist->entries[c].name.str,
+                            b->chlist->entries[c].name.str));
+                }
+            }
+        }
+
+        /* and everything goes with the context */
+        exr_finish (&plain);
+        exr_finish (&arena);
+        EXRCORE_TEST (s_counted_live == 0);
+    }
+}
+
+static int s_async_reads = 0;
+
+static exr_result_t
+counting_read_async (
+    exr_const_context_t          f,
+    void*                        userdata,
+    void*                        buffer,
+    uint64_t                     sz,
+    uint64_t                     offset,
+    exr_read_complete_func_ptr_t complete_fn,
+    void*                        request,
+    exr_stream_error_func_ptr_t  errcb)
+{
+    ++s_async_reads;
+    complete_fn (
+        f, request, counting_read (f, userdata, buffer, sz, offset, errcb));
+    return EXR_ERR_SUCCESS;
+}
+
+static void
+readAllChunksPrefetched (
+    exr_context_t f, std::vector<std::vector<uint8_t>>& out)
+{
+    exr_attr_box2i_t dw;
+    int32_t          lpc;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+    exr_chunk_info_t      cinfo, next;
+    EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, dw.min.y, &cinfo));
+    EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+    EXRCORE_TEST_RVAL (exr_decoding_choose_default_routines (f, 0, &decoder));
+
+    for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+    {
+        if (y != dw.min.y)
+        {
+            EXRCORE_TEST_RVAL (exr_decoding_update (f, 0, &cinfo, &decoder));
+        }
+
+        /* read the next chunk while this one is decoded */
+        if (y + lpc <= dw.max.y)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_read_scanline_chunk_info (f, 0, y + lpc, &next));
+            EXRCORE_TEST_RVAL (exr_decoding_prefetch (f, 0, &next, &decoder));
+        }
+
+        EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+
+        const uint8_t* data = (const uint8_t*) decoder.unpacked_buffer;
+        out.emplace_back (data, data + cinfo.unpacked_size);
+        cinfo = next;
+    }
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+}
+
+void
+testReadPrefetch (const std::string& tempdir)
+{
+    exr_context_t             f;
+    std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    CountingStream            stream;
+
+    fn += "comp_zips.exr";
+
+    std::vector<std::vector<uint8_t>> expected, prefetched;
+    readAllChunks (fn, 0, expected);
+    EXRCORE_TEST (expected.size () > 1);
+
+    /* default file routines */
+    cinit.error_handler_fn = &err_cb;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    readAllChunksPrefetched (f, prefetched);
+    EXRCORE_TEST (prefetched == expected);
+    exr_finish (&f);
+
+    loadStream ("comp_zips.exr", stream);
+
+    /* custom blocking read, served by the context's reader thread */
+    cinit.user_data = &stream;
+    cinit.read_fn   = &counting_read;
+    cinit.size_fn   = &counting_size;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    prefetched.clear ();
+    readAllChunksPrefetched (f, prefetched);
+    EXRCORE_TEST (prefetched == expected);
+    exr_finish (&f);
+
+    /* custom asynchronous read */
+    cinit.read_async_fn = &counting_read_async;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    prefetched.clear ();
+    s_async_reads = 0;
+    stream.reads  = 0;
+    readAllChunksPrefetched (f, prefetched);
+    EXRCORE_TEST (prefetched == expected);
+    /* every chunk but the first came from a prefetch */
+    EXRCORE_TEST (s_async_reads == (int) expected.size () - 1);
+    EXRCORE_TEST (stream.reads > s_async_reads);
+    exr_finish (&f);
+}
+
+/* decodes level 0 of part 0 chunk by chunk, one float plane per channel */
+static void
+decodeReference (
+    exr_context_t                    f,
+    std::vector<std::string>&        names,
+    std::vector<std::vector<float>>& planes,
+    exr_spawn_task_func_ptr_t        spawn_fn = NULL)
+{
+    exr_attr_box2i_t         dw;
+    exr_storage_t            storage;
+    const exr_attr_chlist_t* chlist;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_storage (f, 0, &storage));
+    EXRCORE_TEST_RVAL (exr_get_channels (f, 0, &chlist));
+
+    int64_t w = (int64_t) dw.max.x - (int64_t) dw.min.x + 1;
+    int64_t h = (int64_t) dw.max.y - (int64_t) dw.min.y + 1;
+
+    names.clear ();
+    planes.clear ();
+    for (int c = 0; c < chlist->num_channels; ++c)
+    {
+        names.push_back (chlist->entries[c].name.str);
+        planes.emplace_back ((size_t) (w * h), 0.f);
+    }
+
+    /* each chunk, with the position of its first pixel */
+    std::vector<exr_chunk_info_t> chunks;
+    std::vector<int32_t>          xs, ys;
+    if (storage == EXR_STORAGE_TILED)
+    {
+        int32_t tw, th, lw, lh;
+        EXRCORE_TEST_RVAL (exr_get_tile_sizes (f, 0, 0, 0, &tw, &th));
+        EXRCORE_TEST_RVAL (exr_get_level_sizes (f, 0, 0, 0, &lw, &lh));
+        int32_t tx = (lw + tw - 1) / tw;
+        int32_t ty = (lh + th - 1) / th;
+        for (int y = 0; y < ty; ++y)
+        {
+            for (int x = 0; x < tx; ++x)
+            {
+                exr_chunk_info_t cinfo;
+                EXRCORE_TEST_RVAL (
+                    exr_read_tile_chunk_info (f, 0, x, y, 0, 0, &cinfo));
+                chunks.push_back (cinfo);
+                xs.push_back (dw.min.x + x * tw);
+                ys.push_back (dw.min.y + y * th);
+            }
+        }
+    }
+    else
+    {
+        int32_t lpc;
+        EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+        for (int y = dw.min.y; y <= dw.max.y; y += lpc)
+        {
+            exr_chunk_info_t cinfo;
+            EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+            chunks.push_back (cinfo);
+            xs.push_back (cinfo.start_x);
+            ys.push_back (cinfo.start_y);
+        }
+    }
+
+    exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
+    for (size_t i = 0; i < chunks.size (); ++i)
+    {
+        const exr_chunk_info_t& cinfo = chunks[i];
+        int32_t                 x0    = xs[i];
+        int32_t                 y0    = ys[i];
+
+        if (i == 0)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_decoding_initialize (f, 0, &cinfo, &decoder));
+            decoder.spawn_fn = spawn_fn;
+        }
+        else
+        {
+            EXRCORE_TEST_RVAL (exr_decoding_update (f, 0, &cinfo, &decoder));
+        }
+
+        for (int c = 0; c < decoder.channel_count; ++c)
+        {
+            exr_coding_channel_info_t& chan = decoder.channels[c];
+            chan.decode_to_ptr              = (uint8_t*) (planes[c].data () +
+                                             (y0 - dw.min.y) * w +
+                                             (x0 - dw.min.x));
+            chan.user_data_type             = EXR_PIXEL_FLOAT;
+            chan.user_bytes_per_element     = 4;
+            chan.user_pixel_stride          = 4;
+            chan.user_line_stride           = (int32_t) (w * 4);
+        }
+
+        EXRCORE_TEST_RVAL (
+            exr_decoding_choose_default_routines (f, 0, &decoder));
+        EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+    }
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+}
+
+static int s_spawned = 0;
+
+static exr_result_t
+inline_spawn (void* userdata, void (*task_fn) (void*), void* task_data)
+{
+    /* run the task right away, as a pool with no free threads might */
+    ++s_spawned;
+    task_fn (task_data);
+    return EXR_ERR_SUCCESS;
+}
+
+static exr_result_t
+failing_spawn (void* userdata, void (*task_fn) (void*), void* task_data)
+{
+    return EXR_ERR_OUT_OF_MEMORY;
+}
+
+static std::vector<std::pair<void (*) (void*), void*>> s_deferred;
+
+static exr_result_t
+deferred_spawn (void* userdata, void (*task_fn) (void*), void* task_data)
+{
+    /* queue the task behind the caller, as a saturated or nested
+     * pool would, to be run once the call has returned */
+    s_deferred.emplace_back (task_fn, task_data);
+    return EXR_ERR_SUCCESS;
+}
+
+static void
+runDeferred ()
+{
+    for (auto& t: s_deferred)
+        t.first (t.second);
+    s_deferred.clear ();
+}
+
+static void
+checkRegion (
+    exr_context_t                          f,
+    const exr_attr_box2i_t&                region,
+    const std::vector<std::string>&        names,
+    const std::vector<std::vector<float>>& planes,
+    int                                    nthreads,
+    exr_spawn_task_func_ptr_t              spawn_fn)
+{
+    exr_attr_box2i_t dw;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+
+    int64_t w  = (int64_t) dw.max.x - (int64_t) dw.min.x + 1;
+    int64_t rw = (int64_t) region.max.x - (int64_t) region.min.x + 1;
+    int64_t rh = (int64_t) region.max.y - (int64_t) region.min.y + 1;
+    size_t  nc = names.size ();
+
+    /* all channels interleaved, to exercise the strides */
+    std::vector<float>                out ((size_t) (rw * rh) * nc, -1.f);
+    std::vector<exr_region_channel_t> chans (nc);
+    for (size_t c = 0; c < nc; ++c)
+    {
+        chans[c].channel_name   = names[c].c_str ();
+        chans[c].decode_to_base = (uint8_t*) (out.data () + c);
+        chans[c].pixel_stride   = (int32_t) (nc * sizeof (float));
+        chans[c].line_stride    = (int32_t) (rw * nc * sizeof (float));
+        chans[c].data_type      = EXR_PIXEL_FLOAT;
+    }
+
+    EXRCORE_TEST_RVAL (exr_decode_region (
+        f,
+        0,
+        0,
+        0,
+        &region,
+        (int) nc,
+        chans.data (),
+        nthreads,
+        spawn_fn,
+        NULL));
+
+    for (int64_t y = 0; y < rh; ++y)
+    {
+        for (int64_t x = 0; x < rw; ++x)
+        {
+            for (size_t c = 0; c < nc; ++c)
+            {
+                float a = out[(size_t) ((y * rw + x) * (int64_t) nc) + c];
+                float b = planes[c][(size_t) ((region.min.y - dw.min.y + y) *
+                                                  w +
+                                              (region.min.x - dw.min.x + x))];
+                EXRCORE_TEST (memcmp (&a, &b, sizeof (float)) == 0);
+            }
+        }
+    }
+}
+
+void
+testReadRegion (const std::string& tempdir)
+{
+    static const char* files[] = {
+        "comp_none.exr",
+        "comp_zips.exr",
+        "comp_zip.exr",
+        "comp_piz.exr",
+        "comp_dwaa_v2.exr",
+        "v1.7.test.tiled.exr"};
+
+    for (const char* file: files)
+    {
+        exr_context_t             f;
+        std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+
+        fn += file;
+        cinit.error_handler_fn = &err_cb;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+        std::vector<std::string>        names;
+        std::vector<std::vector<float>> planes;
+        decodeReference (f, names, planes);
+
+        exr_attr_box2i_t dw;
+        EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+
+        /* whole data window, on internal threads */
+        checkRegion (f, dw, names, planes, 4, NULL);
+        checkRegion (f, dw, names, planes, 1, NULL);
+
+        /* a region cutting through chunks */
+        exr_attr_box2i_t sub = dw;
+        sub.min.x += (dw.max.x - dw.min.x) / 5;
+        sub.min.y += (dw.max.y - dw.min.y) / 7 + 1;
+        sub.max.x -= (dw.max.x - dw.min.x) / 3;
+        sub.max.y -= (dw.max.y - dw.min.y) / 4;
+        checkRegion (f, sub, names, planes, 0, NULL);
+
+        s_spawned = 0;
+        checkRegion (f, sub, names, planes, 3, &inline_spawn);
+        EXRCORE_TEST (s_spawned == 2);
+
+        /* the calling thread does all the work */
+        checkRegion (f, sub, names, planes, 3, &failing_spawn);
+
+        /* the tasks only run after the call, and then do nothing */
+        checkRegion (f, sub, names, planes, 3, &deferred_spawn);
+        EXRCORE_TEST (s_deferred.size () == 2);
+        runDeferred ();
+
+        /* a single pixel */
+        sub.max = sub.min;
+        checkRegion (f, sub, names, planes, 2, NULL);
+
+        exr_finish (&f);
+    }
+
+    /* bad arguments */
+    exr_context_t             f;
+    std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    fn += "comp_zip.exr";
+    cinit.error_handler_fn = &err_cb;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+    exr_attr_box2i_t dw;
+    EXRCORE_TEST_RVAL (exr_get_data_window (f, 0, &dw));
+
+    float                pixel;
+    exr_region_channel_t chan;
+    chan.channel_name   = "nosuchchannel";
+    chan.decode_to_base = (uint8_t*) &pixel;
+    chan.pixel_stride   = 4;
+    chan.line_stride    = 4;
+    chan.data_type      = EXR_PIXEL_FLOAT;
+
+    exr_attr_box2i_t one = {dw.min, dw.min};
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_decode_region (f, 0, 0, 0, &one, 1, &chan, 1, NULL, NULL));
+
+    chan.channel_name = NULL;
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_decode_region (f, 0, 0, 0, &one, 1, &chan, 1, NULL, NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_decode_region (f, 0, 0, 0, NULL, 0, NULL, 1, NULL, NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+        exr_decode_region (f, 0, 1, 0, &one, 0, NULL, 1, NULL, NULL));
+
+    exr_attr_box2i_t outside = dw;
+    outside.max.y += 1;
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+        exr_decode_region (f, 0, 0, 0, &outside, 0, NULL, 1, NULL, NULL));
+
+    exr_finish (&f);
+}
+
+static bool
+samePlanes (
+    const std::vector<std::vector<float>>& a,
+    const std::vector<std::vector<float>>& b)
+{
+    if (a.size () != b.size ()) return false;
+    for (size_t c = 0; c < a.size (); ++c)
+    {
+        if (a[c].size () != b[c].size () ||
+            memcmp (a[c].data (), b[c].data (), a[c].size () * sizeof (float)))
+            return false;
+    }
+    return true;
+}
+
+void
+testReadDWATasks (const std::string& tempdir)
+{
+    static const char* files[] = {
+        "comp_dwaa_v1.exr",
+        "comp_dwaa_v2.exr",
+        "comp_dwab_v1.exr",
+        "comp_dwab_v2.exr"};
+
+    /* the chunks are only split with more than one processor */
+    bool split = std::thread::hardware_concurrency () > 1;
+
+    for (const char* file: files)
+    {
+        exr_context_t             f;
+        std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+
+        fn += file;
+        cinit.error_handler_fn = &err_cb;
+        EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+
+        std::vector<std::string>        names;
+        std::vector<std::vector<float>> serial, planes;
+        decodeReference (f, names, serial);
+
+        s_spawned = 0;
+        decodeReference (f, names, planes, &inline_spawn);
+        EXRCORE_TEST (samePlanes (planes, serial));
+        EXRCORE_TEST (!split || s_spawned > 0);
+
+        decodeReference (f, names, planes, &failing_spawn);
+        EXRCORE_TEST (samePlanes (planes, serial));
+
+        /* the tasks only run after the decode, and then do nothing */
+        decodeReference (f, names, planes, &deferred_spawn);
+        EXRCORE_TEST (samePlanes (planes, serial));
+        EXRCORE_TEST (!split || !s_deferred.empty ());
+        runDeferred ();
+
+        exr_finish (&f);
+    }
+}
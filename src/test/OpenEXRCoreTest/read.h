@@ -21,5 +21,15 @@ void testReadTiles (const std::string& tempdir);
 void testReadMultiPart (const std::string& tempdir);
 
 void testReadUnpack (const std::string& tempdir);
+void testReadMemoryMapped (const std::string& tempdir);
+void testReadChunks (const std::string& tempdir);
+void testReadChunkReadAhead (const std::string& tempdir);
+void testReadChunkInfoTable (const std::string& tempdir);
+void testReadHeaderPrefetch (const std::string& tempdir);
+void testReadHeaderOnly (const std::string& tempdir);
+void testReadHeaderArena (const std::string& tempdir);
+void testReadPrefetch (const std::string& tempdir);
+void testReadRegion (const std::string& tempdir);
+void testReadDWATasks (const std::string& tempdir);
 
 #endif // OPENEXR_CORE_TEST_READ_H
@@ -0,0 +1,309 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright Contributors to the OpenEXR Project.
+
+#include <iomanip>
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../../lib/OpenEXRCore/internal_byte_simd.h"
+
+//
+// Times the byte loops of the RLE codec (and the predictor and
+// interleave it shares with ZIP and DWA), scalar against the SIMD
+// versions this cpu can run, on chunk sized buffers of different
+// kinds of data.  Every version must produce the same bytes as the
+// scalar one.
+//
+
+typedef void (*PredictFn) (uint8_t*, const uint8_t*, uint64_t);
+typedef void (*ReconstructFn) (uint8_t*, uint8_t*, uint64_t);
+typedef uint64_t (*CompressFn) (void*, uint64_t, const void*, uint64_t);
+
+struct Kernels
+{
+    const char*   name;
+    PredictFn     predict;
+    ReconstructFn reconstruct;
+    CompressFn    compress;
+};
+
+static void
+predictScalar (uint8_t* scratch, const uint8_t* src, uint64_t n)
+{
+    exr_deinterleave_scalar (scratch, src, n);
+    exr_predict_scalar (scratch, n);
+}
+
+static void
+reconstructScalar (uint8_t* out, uint8_t* src, uint64_t n)
+{
+    exr_reconstruct_scalar (src, n);
+    exr_interleave_scalar (out, src, n);
+}
+
+#ifdef EXR_BYTE_SIMD_SSE2
+static void
+predictSse2 (uint8_t* scratch, const uint8_t* src, uint64_t n)
+{
+    exr_deinterleave_sse2 (scratch, src, n);
+    exr_predict_sse2 (scratch, n);
+}
+
+static void
+reconstructSse2 (uint8_t* out, uint8_t* src, uint64_t n)
+{
+    exr_reconstruct_scalar (src, n);
+    exr_interleave_sse2 (out, src, n);
+}
+#endif
+
+#ifdef EXR_BYTE_SIMD_X86_DISPATCH
+static void
+reconstructSse41 (uint8_t* out, uint8_t* src, uint64_t n)
+{
+    exr_reconstruct_sse4_1 (src, n);
+    exr_interleave_sse2 (out, src, n);
+}
+
+static void
+predictAvx2 (uint8_t* scratch, const uint8_t* src, uint64_t n)
+{
+    exr_deinterleave_avx2 (scratch, src, n);
+    exr_predict_avx2 (scratch, n);
+}
+
+static void
+reconstructAvx2 (uint8_t* out, uint8_t* src, uint64_t n)
+{
+    exr_reconstruct_sse4_1 (src, n);
+    exr_interleave_avx2 (out, src, n);
+}
+#endif
+
+#ifdef EXR_BYTE_SIMD_NEON
+static void
+predictNeon (uint8_t* scratch, const uint8_t* src, uint64_t n)
+{
+    exr_deinterleave_neon (scratch, src, n);
+    exr_predict_neon (scratch, n);
+}
+
+static void
+reconstructNeon (uint8_t* out, uint8_t* src, uint64_t n)
+{
+    exr_reconstruct_neon (src, n);
+    exr_interleave_neon (out, src, n);
+}
+#endif
+
+static std::vector<Kernels>
+availableKernels ()
+{
+    std::vector<Kernels> ret;
+
+    ret.push_back (
+        {"scalar", predictScalar, reconstructScalar, exr_rle_compress_scalar});
+#ifdef EXR_BYTE_SIMD_SSE2
+    ret.push_back (
+        {"sse2", predictSse2, reconstructSse2, exr_rle_compress_sse2});
+#endif
+#ifdef EXR_BYTE_SIMD_X86_DISPATCH
+    int simd = check_for_x86_byte_simd ();
+    if (simd & EXR_X86_SIMD_SSE4_1)
+        ret.push_back (
+            {"sse4.1", predictSse2, reconstructSse41, exr_rle_compress_sse2});
+    if (simd & EXR_X86_SIMD_AVX2)
+        ret.push_back (
+            {"avx2", predictAvx2, reconstructAvx2, exr_rle_compress_avx2});
+#endif
+#ifdef EXR_BYTE_SIMD_NEON
+    ret.push_back (
+        {"neon", predictNeon, reconstructNeon, exr_rle_compress_neon});
+#endif
+    return ret;
+}
+
+//
+// Half pixels, little endian, the way the codecs see a chunk
+//
+
+static void
+makeData (const std::string& kind, std::vector<uint8_t>& buf, int width)
+{
+    size_t   pixels = buf.size () / 2;
+    uint32_t seed   = 1;
+
+    auto rnd = [&seed] () {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+
+    for (size_t i = 0; i < pixels; ++i)
+    {
+        size_t   x = i % width, y = i / width;
+        uint16_t h;
+
+        if (kind == "noise")
+            h = uint16_t (rnd ());
+        else if (kind == "matte")
+        {
+            // mostly 0 or 1, with a soft edge along a diagonal
+            int d = int (x) - int (y) * 2;
+            if (d < -2)
+                h = 0x3c00;
+            else if (d > 2)
+                h = 0;
+            else
+                h = uint16_t (0x3800 + (rnd () & 0x3ff));
+        }
+        else
+        {
+            // object ids: a few values in large blocks
+            h = uint16_t (((x / 37) * 7 + (y / 23) * 13) % 5 + 0x4000);
+        }
+
+        buf[2 * i]     = uint8_t (h & 0xff);
+        buf[2 * i + 1] = uint8_t (h >> 8);
+    }
+}
+
+static double
+nsPerByte (
+    std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point end,
+    size_t                                bytes,
+    int                                   iters)
+{
+    return std::chrono::duration<double, std::nano> (end - start).count () /
+           (double (bytes) * iters);
+}
+
+static bool
+timeData (const std::string& kind, int width, int lines, int iters)
+{
+    std::vector<uint8_t> src (size_t (width) * lines * 2);
+    makeData (kind, src, width);
+
+    size_t               n = src.size ();
+    std::vector<uint8_t> scratch (n), packed (n * 2), out (n);
+    std::vector<uint8_t> refScratch (n), refPacked (n * 2);
+    uint64_t             refBytes = 0;
+    bool                 ok       = true;
+
+    for (const Kernels& k: availableKernels ())
+    {
+        auto t0 = std::chrono::steady_clock::now ();
+        for (int i = 0; i < iters; ++i)
+            k.predict (scratch.data (), src.data (), n);
+        auto t1 = std::chrono::steady_clock::now ();
+
+        uint64_t bytes = 0;
+        for (int i = 0; i < iters; ++i)
+            bytes = k.compress (
+                packed.data (), packed.size (), scratch.data (), n);
+        auto t2 = std::chrono::steady_clock::now ();
+
+        std::chrono::steady_clock::duration rtime {};
+        for (int i = 0; i < iters; ++i)
+        {
+            std::vector<uint8_t> tmp (scratch);
+            auto                 r0 = std::chrono::steady_clock::now ();
+            k.reconstruct (out.data (), tmp.data (), n);
+            rtime += std::chrono::steady_clock::now () - r0;
+        }
+
+        if (refBytes == 0)
+        {
+            refScratch = scratch;
+            refPacked  = packed;
+            refBytes   = bytes;
+        }
+        else if (
+            scratch != refScratch || bytes != refBytes ||
+            memcmp (packed.data (), refPacked.data (), bytes) != 0)
+        {
+            std::cerr << "ERROR: " << k.name << " differs from scalar on "
+                      << kind << std::endl;
+            ok = false;
+        }
+        if (out != src)
+        {
+            std::cerr << "ERROR: " << k.name << " does not round trip "
+                      << kind << std::endl;
+            ok = false;
+        }
+
+        std::cout << " " << std::setw (8) << std::left << kind << std::setw (9)
+                  << k.name << std::setw (12) << std::fixed
+                  << std::setprecision (3) << nsPerByte (t0, t1, n, iters)
+                  << std::setw (12) << nsPerByte (t1, t2, n, iters)
+                  << std::setw (12)
+                  << std::chrono::duration<double, std::nano> (rtime).count () /
+                         (double (n) * iters)
+                  << std::setprecision (1)
+                  << 100.0 * double (bytes) / double (n) << "%" << std::endl;
+    }
+    return ok;
+}
+
+static int
+usageAndExit (const char* argv0, int ec)
+{
+    std::cerr << "Usage: " << argv0
+              << " [--width <n>] [--lines <n>] [--iters <n>]"
+                 " [--data noise|matte|id ...]"
+              << std::endl;
+    return ec;
+}
+
+int
+main (int argc, char* argv[])
+{
+    int                      width = 1920;
+    int                      lines = 32;
+    int                      iters = 200;
+    std::vector<std::string> kinds;
+
+    for (int a = 1; a < argc; ++a)
+    {
+        if (!strcmp (argv[a], "-h") || !strcmp (argv[a], "--help") ||
+            !strcmp (argv[a], "-?"))
+        {
+            return usageAndExit (argv[0], 0);
+        }
+        else if (a + 1 < argc && !strcmp (argv[a], "--width"))
+            width = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--lines"))
+            lines = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--iters"))
+            iters = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--data"))
+            kinds.push_back (argv[++a]);
+        else
+            return usageAndExit (argv[0], 1);
+    }
+
+    if (kinds.empty ()) kinds = {"noise", "matte", "id"};
+
+    if (width <= 0 || lines <= 0 || iters <= 0)
+        return usageAndExit (argv[0], 1);
+
+    std::cout << width << "x" << lines << " half chunk, " << iters
+              << " iterations\n\n"
+              << std::setw (9) << std::left << " Data" << std::setw (9)
+              << "Kernels" << std::setw (12) << "predict" << std::setw (12)
+              << "rle" << std::setw (12) << "reconst" << "Size"
+              << "\n (ns per byte)" << std::endl;
+
+    bool ok = true;
+    for (const std::string& k: kinds)
+        ok = timeData (k, width, lines, iters) && ok;
+
+    return ok ? 0 : 1;
+}
@@ -10,11 +10,14 @@
 #include <float.h>
 #include <limits.h>
 #include <math.h>
+#include <stddef.h>
 #include <string.h>
 
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <utility>
+#include <vector>
 
 static void
 err_cb (exr_const_context_t f, exr_result_t code, const char* msg)
@@ -1369,3 +1372,379 @@ testWriteMultiPart (const std::string& tempdir)
     EXRCORE_TEST_RVAL (exr_finish (&outf));
     remove (outfn.c_str ());
 }
+
+struct RegionPixel
+{
+    uint16_t a;
+    uint16_t pad;
+    float    b;
+    uint32_t c;
+};
+
+static int s_region_spawned = 0;
+
+static exr_result_t
+inline_region_spawn (void* userdata, void (*task_fn) (void*), void* task_data)
+{
+    ++s_region_spawned;
+    task_fn (task_data);
+    return EXR_ERR_SUCCESS;
+}
+
+static std::vector<std::pair<void (*) (void*), void*>> s_region_deferred;
+
+static exr_result_t
+deferred_region_spawn (
+    void* userdata, void (*task_fn) (void*), void* task_data)
+{
+    /* as a saturated pool would, only run the task once the call has
+     * returned */
+    s_region_deferred.emplace_back (task_fn, task_data);
+    return EXR_ERR_SUCCESS;
+}
+
+static void
+fillRegionChannels (
+    std::vector<exr_region_channel_t>& chans,
+    RegionPixel*                       base,
+    int32_t                            width,
+    bool                               decode)
+{
+    static const char* names[] = {"A", "B", "C"};
+    static const exr_pixel_type_t types[] = {
+        EXR_PIXEL_HALF, EXR_PIXEL_FLOAT, EXR_PIXEL_UINT};
+    size_t offsets[] = {
+        offsetof (RegionPixel, a),
+        offsetof (RegionPixel, b),
+        offsetof (RegionPixel, c)};
+
+    chans.resize (3);
+    for (int c = 0; c < 3; ++c)
+    {
+        uint8_t* p            = ((uint8_t*) base) + offsets[c];
+        chans[c].channel_name = names[c];
+        if (decode)
+            chans[c].decode_to_base = p;
+        else
+            chans[c].encode_from_base = p;
+        chans[c].pixel_stride = (int32_t) sizeof (RegionPixel);
+        chans[c].line_stride  = (int32_t) sizeof (RegionPixel) * width;
+        chans[c].data_type    = (uint16_t) types[c];
+    }
+}
+
+static const exr_attr_box2i_t s_region_dw = {{-3, 5}, {153, 87}};
+
+/* fills a source image of the size of s_region_dw, smooth enough to
+ * compress well if asked to */
+static void
+fillRegionSource (std::vector<RegionPixel>& src, bool compressible)
+{
+    int32_t w = s_region_dw.max.x - s_region_dw.min.x + 1;
+    int32_t h = s_region_dw.max.y - s_region_dw.min.y + 1;
+
+    src.resize ((size_t) w * (size_t) h);
+    for (int32_t y = 0; y < h; ++y)
+    {
+        for (int32_t x = 0; x < w; ++x)
+        {
+            RegionPixel& p = src[(size_t) y * (size_t) w + (size_t) x];
+            p.a            = (uint16_t) ((x * 7 + y * 13) % 0x7bff);
+            p.pad          = 0;
+            if (compressible)
+            {
+                p.b = (float) (x - y) * 0.25f;
+                p.c = (uint32_t) (x / 4 + y * 3);
+            }
+            else
+            {
+                p.b = (float) (x - y) * 0.25f + (float) (x * y);
+                p.c = (uint32_t) (x * 977 + y * 31337);
+            }
+        }
+    }
+}
+
+/* starts writing fn with a single part covering s_region_dw, with
+ * the channels of RegionPixel */
+static void
+startRegionFile (
+    exr_context_t*     f,
+    const std::string& fn,
+    const char*        partname,
+    exr_storage_t      storage,
+    exr_compression_t  comp,
+    exr_lineorder_t    lo)
+{
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_attr_v2f_t            swc   = {0.f, 0.f};
+    int                       partidx;
+
+    cinit.error_handler_fn = &err_cb;
+
+    EXRCORE_TEST_RVAL (
+        exr_start_write (f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (exr_add_part (*f, partname, storage, &partidx));
+    EXRCORE_TEST (partidx == 0);
+    EXRCORE_TEST_RVAL (exr_initialize_required_attr (
+        *f, 0, &s_region_dw, &s_region_dw, 1.f, &swc, 1.f, lo, comp));
+    if (storage == EXR_STORAGE_TILED)
+    {
+        EXRCORE_TEST_RVAL (exr_set_tile_descriptor (
+            *f, 0, 32, 16, EXR_TILE_ONE_LEVEL, EXR_TILE_ROUND_DOWN));
+    }
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        *f, 0, "A", EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LOGARITHMIC, 1, 1));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        *f, 0, "B", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        *f, 0, "C", EXR_PIXEL_UINT, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+}
+
+/* reads fn back, checks it matches src, and removes it */
+static void
+checkRegionFile (
+    const std::string& fn, const std::vector<RegionPixel>& src, int nthreads)
+{
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    int32_t                   w = s_region_dw.max.x - s_region_dw.min.x + 1;
+
+    cinit.error_handler_fn = &err_cb;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    std::vector<RegionPixel> dst (src.size ());
+    memset (dst.data (), 0, dst.size () * sizeof (RegionPixel));
+
+    std::vector<exr_region_channel_t> chans;
+    fillRegionChannels (chans, dst.data (), w, true);
+    EXRCORE_TEST_RVAL (exr_decode_region (
+        f, 0, 0, 0, &s_region_dw, 3, chans.data (), nthreads, NULL, NULL));
+    EXRCORE_TEST (
+        memcmp (dst.data (), src.data (), dst.size () * sizeof (RegionPixel)) ==
+        0);
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    remove (fn.c_str ());
+}
+
+static void
+doWriteRegion (
+    const std::string&        tempdir,
+    exr_storage_t             storage,
+    exr_compression_t         comp,
+    exr_lineorder_t           lo,
+    int                       nthreads,
+    exr_spawn_task_func_ptr_t spawn_fn)
+{
+    exr_context_t            f;
+    std::string              fn = tempdir + "testregion.exr";
+    exr_attr_box2i_t         dw = s_region_dw;
+    int32_t                  w  = dw.max.x - dw.min.x + 1;
+    std::vector<RegionPixel> src;
+
+    fillRegionSource (src, false);
+    startRegionFile (&f, fn, "region", storage, comp, lo);
+
+    std::vector<exr_region_channel_t> chans;
+    fillRegionChannels (chans, src.data (), w, false);
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_HEADER_NOT_WRITTEN,
+        exr_encode_region (
+            f, 0, 0, 0, &dw, 3, chans.data (), nthreads, spawn_fn, NULL));
+
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+
+    /* only whole chunks, and all channels */
+    exr_attr_box2i_t bad = dw;
+    bad.min.x += 1;
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_encode_region (
+            f, 0, 0, 0, &bad, 3, chans.data (), nthreads, spawn_fn, NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_encode_region (
+            f, 0, 0, 0, &dw, 2, chans.data (), nthreads, spawn_fn, NULL));
+
+    /* write the top band of chunks, then the rest */
+    int32_t lpc = 16;
+    if (storage == EXR_STORAGE_SCANLINE)
+        EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &lpc));
+
+    exr_attr_box2i_t top = dw;
+    exr_attr_box2i_t rest = dw;
+    top.max.y             = dw.min.y + 2 * lpc - 1;
+    rest.min.y            = top.max.y + 1;
+
+    if (lo != EXR_LINEORDER_RANDOM_Y)
+    {
+        EXRCORE_TEST_RVAL_FAIL (
+            EXR_ERR_INCORRECT_CHUNK,
+            exr_encode_region (
+                f,
+                0,
+                0,
+                0,
+                &rest,
+                3,
+                chans.data (),
+                nthreads,
+                spawn_fn,
+                NULL));
+    }
+    EXRCORE_TEST_RVAL (exr_encode_region (
+        f, 0, 0, 0, &top, 3, chans.data (), nthreads, spawn_fn, NULL));
+
+    /* the channels point at the top left of the region */
+    fillRegionChannels (
+        chans, src.data () + (size_t) (rest.min.y - dw.min.y) * w, w, false);
+    EXRCORE_TEST_RVAL (exr_encode_region (
+        f, 0, 0, 0, &rest, 3, chans.data (), nthreads, spawn_fn, NULL));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+
+    checkRegionFile (fn, src, 4);
+}
+
+void
+testWriteRegion (const std::string& tempdir)
+{
+    doWriteRegion (
+        tempdir,
+        EXR_STORAGE_SCANLINE,
+        EXR_COMPRESSION_ZIP,
+        EXR_LINEORDER_INCREASING_Y,
+        4,
+        NULL);
+    doWriteRegion (
+        tempdir,
+        EXR_STORAGE_SCANLINE,
+        EXR_COMPRESSION_RLE,
+        EXR_LINEORDER_DECREASING_Y,
+        0,
+        NULL);
+    doWriteRegion (
+        tempdir,
+        EXR_STORAGE_SCANLINE,
+        EXR_COMPRESSION_NONE,
+        EXR_LINEORDER_RANDOM_Y,
+        3,
+        NULL);
+    doWriteRegion (
+        tempdir,
+        EXR_STORAGE_TILED,
+        EXR_COMPRESSION_PIZ,
+        EXR_LINEORDER_INCREASING_Y,
+        5,
+        NULL);
+    doWriteRegion (
+        tempdir,
+        EXR_STORAGE_TILED,
+        EXR_COMPRESSION_ZIPS,
+        EXR_LINEORDER_RANDOM_Y,
+        1,
+        NULL);
+
+    s_region_spawned = 0;
+    doWriteRegion (
+        tempdir,
+        EXR_STORAGE_SCANLINE,
+        EXR_COMPRESSION_ZIPS,
+        EXR_LINEORDER_INCREASING_Y,
+        3,
+        &inline_region_spawn);
+    EXRCORE_TEST (s_region_spawned > 0);
+
+    /* the calling thread writes everything, the tasks do nothing */
+    doWriteRegion (
+        tempdir,
+        EXR_STORAGE_TILED,
+        EXR_COMPRESSION_ZIP,
+        EXR_LINEORDER_DECREASING_Y,
+        4,
+        &deferred_region_spawn);
+    EXRCORE_TEST (!s_region_deferred.empty ());
+    for (auto& t: s_region_deferred)
+        t.first (t.second);
+    s_region_deferred.clear ();
+}
+
+static void
+doWriteZipTuning (
+    const std::string& tempdir,
+    exr_compression_t  comp,
+    exr_zip_tuning_t   mode,
+    float              target,
+    int                nthreads,
+    int                expectlevel)
+{
+    exr_context_t            f;
+    std::string              fn      = tempdir + "testziptuning.exr";
+    int                      partidx = 0;
+    int32_t                  w = s_region_dw.max.x - s_region_dw.min.x + 1;
+    exr_zip_tuning_t         gmode;
+    float                    gtarget;
+    int                      glevel;
+    std::vector<RegionPixel> src;
+
+    fillRegionSource (src, true);
+    startRegionFile (
+        &f,
+        fn,
+        "tuned",
+        EXR_STORAGE_SCANLINE,
+        comp,
+        EXR_LINEORDER_INCREASING_Y);
+    EXRCORE_TEST_RVAL (exr_set_zip_compression_level (f, partidx, 3));
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_set_zip_compression_tuning (
+            f, partidx, EXR_ZIP_TUNING_LAST_TYPE, 1.f));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_set_zip_compression_tuning (
+            f, partidx, EXR_ZIP_TUNING_RATIO, 0.f));
+    EXRCORE_TEST_RVAL (
+        exr_set_zip_compression_tuning (f, partidx, mode, target));
+    EXRCORE_TEST_RVAL (exr_get_zip_compression_tuning (
+        f, partidx, &gmode, &gtarget, &glevel));
+    EXRCORE_TEST (gmode == mode);
+    EXRCORE_TEST (gtarget == target);
+    EXRCORE_TEST (glevel == 3);
+
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NOT_OPEN_WRITE,
+        exr_set_zip_compression_tuning (f, partidx, mode, target));
+
+    std::vector<exr_region_channel_t> chans;
+    fillRegionChannels (chans, src.data (), w, false);
+    EXRCORE_TEST_RVAL (exr_encode_region (
+        f, 0, 0, 0, &s_region_dw, 3, chans.data (), nthreads, NULL, NULL));
+
+    /* the image has more chunks than are measured */
+    EXRCORE_TEST_RVAL (
+        exr_get_zip_compression_tuning (f, partidx, NULL, NULL, &glevel));
+    EXRCORE_TEST (glevel == expectlevel);
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+
+    checkRegionFile (fn, src, 1);
+}
+
+void
+testWriteZipTuning (const std::string& tempdir)
+{
+    doWriteZipTuning (
+        tempdir, EXR_COMPRESSION_ZIP, EXR_ZIP_TUNING_NONE, 0.f, 1, 3);
+    /* unreachable targets fall back to the fastest / smallest */
+    doWriteZipTuning (
+        tempdir, EXR_COMPRESSION_ZIP, EXR_ZIP_TUNING_THROUGHPUT, 1e9f, 1, 1);
+    doWriteZipTuning (
+        tempdir, EXR_COMPRESSION_ZIPS, EXR_ZIP_TUNING_RATIO, 1e9f, 4, 9);
+    /* trivially met targets pick the extremes */
+    doWriteZipTuning (
+        tempdir, EXR_COMPRESSION_ZIPS, EXR_ZIP_TUNING_THROUGHPUT, 1e-6f, 3, 9);
+    doWriteZipTuning (
+        tempdir, EXR_COMPRESSION_ZIP, EXR_ZIP_TUNING_RATIO, 1.f, 2, 1);
+}
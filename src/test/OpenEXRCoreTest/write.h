@@ -22,5 +22,7 @@ void testUpdateMeta (const std::string& tempdir);
 void testWriteScans (const std::string& tempdir);
 void testWriteTiles (const std::string& tempdir);
 void testWriteMultiPart (const std::string& tempdir);
+void testWriteRegion (const std::string& tempdir);
+void testWriteZipTuning (const std::string& tempdir);
 
 #endif // OPENEXR_CORE_TEST_WRITE_H
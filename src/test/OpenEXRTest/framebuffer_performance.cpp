@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright Contributors to the OpenEXR Project.
+
+#include <iomanip>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <Imath/half.h>
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfTiledInputFile.h>
+#include <ImfTiledOutputFile.h>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+
+//
+// Measures what a many-channel image costs to read beyond moving the
+// pixels: building a FrameBuffer, handing it to setFrameBuffer and
+// reading the image one small tile at a time, where every tile looks
+// up each file channel in the frame buffer.  The file is written
+// uncompressed with small tiles so that the name lookups are not
+// hidden behind decompression.
+//
+
+static std::string
+channelName (int c)
+{
+    static const char* layers[] = {"diffuse", "specular", "emission", "sss"};
+    static const char* comps[]  = {"R", "G", "B", "A"};
+
+    return std::string (layers[(c / 4) % 4]) + "_" + std::to_string (c / 16) +
+           "." + comps[c % 4];
+}
+
+static void
+buildFrameBuffer (
+    FrameBuffer& fb, int channels, int width, std::vector<half>& pixels)
+{
+    for (int c = 0; c < channels; ++c)
+    {
+        fb.insert (
+            channelName (c),
+            Slice (
+                HALF,
+                reinterpret_cast<char*> (pixels.data () + c),
+                sizeof (half) * channels,
+                sizeof (half) * channels * width));
+    }
+}
+
+static void
+writeImage (
+    const std::string& fn, int channels, int width, int height, int tileSize)
+{
+    Header hdr (width, height);
+    hdr.compression () = NO_COMPRESSION;
+    hdr.setTileDescription (TileDescription (tileSize, tileSize, ONE_LEVEL));
+    for (int c = 0; c < channels; ++c)
+        hdr.channels ().insert (channelName (c), Channel (HALF));
+
+    std::vector<half> pixels (size_t (width) * height * channels);
+    for (size_t i = 0; i < pixels.size (); ++i)
+        pixels[i] = half (float (i % 1024) / 1024.f);
+
+    FrameBuffer fb;
+    buildFrameBuffer (fb, channels, width, pixels);
+
+    TiledOutputFile out (fn.c_str (), hdr);
+    out.setFrameBuffer (fb);
+    out.writeTiles (0, out.numXTiles () - 1, 0, out.numYTiles () - 1);
+}
+
+static void
+timeImage (
+    const std::string& fn,
+    int                channels,
+    int                width,
+    int                height,
+    int                tileSize,
+    int                iters)
+{
+    writeImage (fn, channels, width, height, tileSize);
+
+    std::vector<half> pixels (size_t (width) * height * channels);
+    TiledInputFile    in (fn.c_str ());
+
+    double setSecs  = 0;
+    double readSecs = 0;
+    for (int i = 0; i < iters; ++i)
+    {
+        auto start = std::chrono::steady_clock::now ();
+
+        FrameBuffer fb;
+        buildFrameBuffer (fb, channels, width, pixels);
+        in.setFrameBuffer (fb);
+
+        auto mid = std::chrono::steady_clock::now ();
+
+        for (int ty = 0; ty < in.numYTiles (); ++ty)
+            for (int tx = 0; tx < in.numXTiles (); ++tx)
+                in.readTile (tx, ty);
+
+        auto end = std::chrono::steady_clock::now ();
+
+        setSecs += std::chrono::duration<double> (mid - start).count ();
+        readSecs += std::chrono::duration<double> (end - mid).count ();
+    }
+
+    int tiles = in.numXTiles () * in.numYTiles ();
+
+    std::cout << " " << std::setw (10) << std::left << channels
+              << std::setw (22) << std::fixed << std::setprecision (2)
+              << setSecs * 1e6 / iters << std::setw (22)
+              << readSecs * 1e6 / (double (iters) * tiles) << std::endl;
+}
+
+static int
+usageAndExit (const char* argv0, int ec)
+{
+    std::cerr << "Usage: " << argv0
+              << " [--file <name>] [--size <n>] [--tile <n>]"
+                 " [--iters <n>] [--channels <n> ...]"
+              << std::endl;
+    return ec;
+}
+
+int
+main (int argc, char* argv[])
+{
+    std::string      fn       = "framebuffer_perf.exr";
+    int              size     = 256;
+    int              tileSize = 16;
+    int              iters    = 20;
+    std::vector<int> counts;
+
+    for (int a = 1; a < argc; ++a)
+    {
+        if (!strcmp (argv[a], "-h") || !strcmp (argv[a], "--help") ||
+            !strcmp (argv[a], "-?"))
+        {
+            return usageAndExit (argv[0], 0);
+        }
+        else if (a + 1 < argc && !strcmp (argv[a], "--file"))
+            fn = argv[++a];
+        else if (a + 1 < argc && !strcmp (argv[a], "--size"))
+            size = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--tile"))
+            tileSize = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--iters"))
+            iters = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--channels"))
+            counts.push_back (atoi (argv[++a]));
+        else
+            return usageAndExit (argv[0], 1);
+    }
+
+    if (counts.empty ()) counts = {4, 16, 64, 256};
+
+    if (size <= 0 || tileSize <= 0 || iters <= 0)
+        return usageAndExit (argv[0], 1);
+    for (int n: counts)
+        if (n <= 0) return usageAndExit (argv[0], 1);
+
+    std::cout << size << "x" << size << " half image, " << tileSize << "x"
+              << tileSize << " tiles, " << iters << " iterations\n\n"
+              << std::setw (11) << std::left << " Channels" << std::setw (22)
+              << "setFrameBuffer (us)" << std::setw (22) << "readTile (us/tile)"
+              << std::endl;
+
+    try
+    {
+        for (int n: counts)
+            timeImage (fn, n, size, size, tileSize, iters);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what () << std::endl;
+        remove (fn.c_str ());
+        return 1;
+    }
+
+    remove (fn.c_str ());
+    return 0;
+}
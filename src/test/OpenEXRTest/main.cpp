@@ -21,6 +21,7 @@
 #include "testCopyDeepScanLine.h"
 #include "testCopyDeepTiled.h"
 #include "testCopyMultiPartFile.h"
+#include "testCopyIntoFrameBuffer.h"
 #include "testCopyPixels.h"
 #include "testCpuId.h"
 #include "testCustomAttributes.h"
@@ -28,11 +29,14 @@
 #include "testDeepScanLineHuge.h"
 #include "testDeepScanLineMultipleRead.h"
 #include "testDeepTiledBasic.h"
+#include "testDirectUnpack.h"
 #include "testDwaCompressorSimd.h"
 #include "testDwaLookups.h"
 #include "testExistingStreams.h"
+#include "testFrameBufferPlans.h"
 #include "testFutureProofing.h"
 #include "testHeader.h"
+#include "testHeaderOnlyOpen.h"
 #include "testHuf.h"
 #include "testIDManifest.h"
 #include "testInputPart.h"
@@ -60,6 +64,7 @@
 #include "testScanLineApi.h"
 #include "testSharedFrameBuffer.h"
 #include "testStandardAttributes.h"
+#include "testThreadPool.h"
 #include "testTiledCompression.h"
 #include "testTiledCopyPixels.h"
 #include "testTiledLineOrder.h"
@@ -185,12 +190,14 @@ main (int argc, char* argv[])
     TEST (testLargeDataWindowOffsets, "basic");
     TEST (testSharedFrameBuffer, "basic");
     TEST (testRgbaThreading, "basic");
+    TEST (testThreadPool, "basic");
     TEST (testChannels, "basic");
     TEST (testAttributes, "core");
     TEST (testCustomAttributes, "core");
     TEST (testLineOrder, "basic");
     TEST (testCompression, "basic");
     TEST (testCopyPixels, "basic");
+    TEST (testCopyIntoFrameBuffer, "core");
     TEST (testLut, "basic");
     TEST (testSampleImages, "basic");
     TEST (testPreviewImage, "basic");
@@ -200,6 +207,8 @@ main (int argc, char* argv[])
     TEST (testTiledCompression, "basic");
     TEST (testTiledLineOrder, "basic");
     TEST (testScanLineApi, "basic");
+    TEST (testFrameBufferPlans, "basic");
+    TEST (testDirectUnpack, "basic");
     TEST (testExistingStreams, "core");
     TEST (testStandardAttributes, "core");
     TEST (testOptimized, "basic");
@@ -224,6 +233,7 @@ main (int argc, char* argv[])
     TEST (testMultiPartThreading, "multi");
     TEST (testMultiPartApi, "multi");
     TEST (testMultiPartSharedAttributes, "multi");
+    TEST (testHeaderOnlyOpen, "multi");
     TEST (testCopyMultiPartFile, "multi");
     TEST (testBackwardCompatibility, "core");
     TEST (testFutureProofing, "core");
@@ -0,0 +1,208 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <ImathRandom.h>
+#include <ImfConvert.h>
+#include <ImfHeader.h>
+#include <ImfMisc.h>
+#include <ImfSystemSpecific.h>
+#include <Imath/half.h>
+#include <assert.h>
+#include <iostream>
+#include <string.h>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace IMATH_NAMESPACE;
+using namespace std;
+
+namespace
+{
+
+size_t
+typeSize (PixelType type)
+{
+    return type == HALF ? sizeof (half) : sizeof (float);
+}
+
+template <class T>
+T
+load (const char* ptr)
+{
+    T v;
+    memcpy (&v, ptr, sizeof (T));
+    return v;
+}
+
+template <class T>
+void
+store (char* ptr, T v)
+{
+    memcpy (ptr, &v, sizeof (T));
+}
+
+//
+// Reference conversion of a single pixel
+//
+
+void
+convertPixel (PixelType fileType, const char* in, PixelType fbType, char* out)
+{
+    switch (fbType)
+    {
+        case UINT:
+            if (fileType == UINT)
+                store (out, load<unsigned int> (in));
+            else if (fileType == HALF)
+                store (out, halfToUint (load<half> (in)));
+            else
+                store (out, floatToUint (load<float> (in)));
+            break;
+        case HALF:
+            if (fileType == UINT)
+                store (out, uintToHalf (load<unsigned int> (in)));
+            else if (fileType == HALF)
+                store (out, load<half> (in));
+            else
+                store (out, floatToHalf (load<float> (in)));
+            break;
+        default:
+            if (fileType == UINT)
+                store (out, float (load<unsigned int> (in)));
+            else if (fileType == HALF)
+                store (out, float (load<half> (in)));
+            else
+                store (out, load<float> (in));
+            break;
+    }
+}
+
+void
+testCopy (
+    Rand48&            rand,
+    PixelType          fileType,
+    PixelType          fbType,
+    size_t             xStride,
+    int                count,
+    Compressor::Format format)
+{
+    vector<char> in (count * typeSize (fileType));
+
+    for (int i = 0; i < count; ++i)
+    {
+        char* p = &in[i * typeSize (fileType)];
+        float f = float (rand.nextf (-70000.0, 70000.0));
+
+        if (fileType == UINT)
+            store (p, (unsigned int) rand.nexti ());
+        else if (fileType == HALF)
+            store (p, half (f));
+        else
+            store (p, f);
+    }
+
+    //
+    // Write to an odd address, the frame buffer may not be aligned
+    //
+
+    vector<char> out (count * xStride + 8, 0x55);
+    vector<char> expected (out);
+
+    for (int i = 0; i < count; ++i)
+    {
+        convertPixel (
+            fileType,
+            &in[i * typeSize (fileType)],
+            fbType,
+            &expected[1 + i * xStride]);
+    }
+
+    const char* readPtr  = in.data ();
+    char*       writePtr = &out[1];
+
+    copyIntoFrameBuffer (
+        readPtr,
+        writePtr,
+        writePtr + (count - 1) * xStride,
+        xStride,
+        false,
+        0.0,
+        format,
+        fbType,
+        fileType);
+
+    assert (readPtr == in.data () + in.size ());
+    assert (out == expected);
+}
+
+} // namespace
+
+void
+testCopyIntoFrameBuffer (const std::string&)
+{
+    try
+    {
+        cout << "Testing copyIntoFrameBuffer() kernels" << endl;
+
+        //
+        // Make sure the CPU specific kernels are selected
+        //
+
+        staticInitialize ();
+
+        Rand48    rand (0);
+        PixelType types[] = {UINT, HALF, FLOAT};
+
+        for (PixelType fileType: types)
+        {
+            for (PixelType fbType: types)
+            {
+                cout << "file type " << fileType << ", frame buffer type "
+                     << fbType << endl;
+
+                //
+                // Packed, and interleaved with 3 and 4 channels
+                //
+
+                size_t strides[] = {
+                    typeSize (fbType), 3 * typeSize (fbType), 16};
+
+                for (size_t xStride: strides)
+                {
+                    for (int count = 1; count < 80; ++count)
+                    {
+                        testCopy (
+                            rand,
+                            fileType,
+                            fbType,
+                            xStride,
+                            count,
+                            Compressor::NATIVE);
+
+                        if (GLOBAL_SYSTEM_LITTLE_ENDIAN)
+                            testCopy (
+                                rand,
+                                fileType,
+                                fbType,
+                                xStride,
+                                count,
+                                Compressor::XDR);
+                    }
+                }
+            }
+        }
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
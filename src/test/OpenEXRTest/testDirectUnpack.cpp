@@ -0,0 +1,722 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfInputFile.h>
+#include <ImfOutputFile.h>
+#include <ImfTiledInputFile.h>
+#include <ImfTiledOutputFile.h>
+#include <assert.h>
+#include <iostream>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "ImathFun.h"
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+using namespace IMATH_NAMESPACE;
+
+//
+// Where a line buffer holds exactly the requested scan lines, and for
+// every tile, the library lets OpenEXRCore unpack the pixels straight
+// into the frame buffer (ChunkDecoder).  Everywhere else the pixels go
+// through copyIntoFrameBuffer().  These tests read the same files through both
+// paths and check that the frame buffers end up holding the same
+// pixels, which are also the ones that were written.
+//
+
+namespace
+{
+
+const int W = 68;
+const int H = 44;
+
+const Box2i dataWindow (V2i (-4, -2), V2i (W - 5, H - 3));
+
+//
+// Pixel values are exact in every pixel type, distinct per channel
+// and level, and include a few infinities
+//
+
+int
+channelSeed (const string& name)
+{
+    int seed = 0;
+    for (size_t i = 0; i < name.size (); ++i)
+        seed += name[i];
+    return seed;
+}
+
+float
+pixelValue (PixelType type, const string& name, int level, int x, int y)
+{
+    int seed = channelSeed (name) + level * 29;
+    int v    = x * 3 + y * 7 + seed * 11;
+
+    if (type == UINT) return float (v & 0xfff);
+
+    if ((x * 5 + y * 3 + seed) % 61 == 0)
+    {
+        float inf = half::posInf ();
+        return (seed & 1) ? -inf : inf;
+    }
+
+    float f = float (v % 1024 - 512) / 8;
+
+    return (type == FLOAT) ? f + 1.0f / 1024 : f;
+}
+
+size_t
+pixelSize (PixelType type)
+{
+    return (type == HALF) ? sizeof (half) : sizeof (float);
+}
+
+void
+storeValue (PixelType type, char* ptr, float value)
+{
+    switch (type)
+    {
+        case UINT: *(unsigned int*) ptr = (unsigned int) value; break;
+        case HALF: *(half*) ptr = half (value); break;
+        case FLOAT: *(float*) ptr = value; break;
+        default: assert (false);
+    }
+}
+
+float
+loadValue (PixelType type, const char* ptr)
+{
+    switch (type)
+    {
+        case UINT: return float (*(const unsigned int*) ptr);
+        case HALF: return *(const half*) ptr;
+        case FLOAT: return *(const float*) ptr;
+        default: assert (false);
+    }
+    return 0;
+}
+
+//
+// Compare floats bit for bit, so that signs and infinities count
+//
+
+bool
+sameValue (float a, float b)
+{
+    return memcmp (&a, &b, sizeof (float)) == 0;
+}
+
+struct ChannelDesc
+{
+    const char* name;
+    PixelType   type;
+    int         sampling;
+};
+
+const ChannelDesc rgbaChannels[] = {
+    {"R", HALF, 1}, {"G", HALF, 1}, {"B", HALF, 1}, {"A", HALF, 1}};
+
+const ChannelDesc tiledChannels[] = {
+    {"Y", HALF, 1}, {"Z", FLOAT, 1}, {"id", UINT, 1}};
+
+const ChannelDesc mixedChannels[] = {
+    {"Y", HALF, 1},
+    {"RY", HALF, 2},
+    {"BY", HALF, 2},
+    {"Z", FLOAT, 1},
+    {"id", UINT, 1}};
+
+//
+// One planar buffer per channel, holding the pixels in their
+// own type
+//
+
+struct Plane
+{
+    vector<char> pixels;
+};
+
+typedef map<string, Plane> PlaneMap;
+
+FrameBuffer
+planarFrameBuffer (
+    const ChannelList& channels,
+    const Box2i&       dw,
+    PlaneMap&          planes,
+    bool               asFloat,
+    bool               padFirst)
+{
+    FrameBuffer fb;
+    bool        first = true;
+
+    for (ChannelList::ConstIterator i = channels.begin (); i != channels.end ();
+         ++i)
+    {
+        const Channel& ch   = i.channel ();
+        PixelType      type = asFloat ? FLOAT : ch.type;
+        size_t         size = (type == HALF) ? sizeof (half) : 4;
+        int            w    = (dw.max.x - dw.min.x + 1) / ch.xSampling;
+        int            h    = (dw.max.y - dw.min.y + 1) / ch.ySampling;
+        int            line = (first && padFirst) ? w + 1 : w;
+
+        Plane& plane = planes[i.name ()];
+        plane.pixels.assign (size * line * h, 0);
+
+        fb.insert (
+            i.name (),
+            Slice::Make (
+                type,
+                &plane.pixels[0],
+                dw,
+                size,
+                size * line,
+                ch.xSampling,
+                ch.ySampling));
+
+        first = false;
+    }
+
+    return fb;
+}
+
+//
+// Reading all of a scan line image, or one level of a tiled image
+//
+
+Box2i
+levelWindow (InputFile& in, int, int)
+{
+    return in.header ().dataWindow ();
+}
+
+Box2i
+levelWindow (TiledInputFile& in, int lx, int ly)
+{
+    return in.dataWindowForLevel (lx, ly);
+}
+
+void
+readLevel (InputFile& in, int, int)
+{
+    const Box2i& dw = in.header ().dataWindow ();
+    in.readPixels (dw.min.y, dw.max.y);
+}
+
+void
+readLevel (TiledInputFile& in, int lx, int ly)
+{
+    in.readTiles (0, in.numXTiles (lx) - 1, 0, in.numYTiles (ly) - 1, lx, ly);
+}
+
+//
+// The reference read: every channel goes to a FLOAT plane, and
+// the first plane's lines are padded.  With the line strides not
+// all the same, no chunk can be unpacked by OpenEXRCore, and every
+// pixel is converted by copyIntoFrameBuffer().
+//
+
+template <class File>
+void
+readReference (File& in, int lx, int ly, PlaneMap& planes)
+{
+    Box2i dw = levelWindow (in, lx, ly);
+
+    in.setFrameBuffer (
+        planarFrameBuffer (in.header ().channels (), dw, planes, true, true));
+    readLevel (in, lx, ly);
+}
+
+//
+// Check that every slice of a frame buffer holds the pixels in
+// the reference planes, or the slice's fill value for channels
+// that are not in the file
+//
+
+void
+compareWithReference (
+    const FrameBuffer& fb,
+    const ChannelList& channels,
+    const Box2i&       dw,
+    const PlaneMap&    planes)
+{
+    for (FrameBuffer::ConstIterator i = fb.begin (); i != fb.end (); ++i)
+    {
+        const Slice&   slice = i.slice ();
+        const Channel* ch    = channels.findChannel (i.name ());
+
+        const float* plane = 0;
+        int          line  = 0;
+
+        if (ch)
+        {
+            const Plane& p = planes.find (i.name ())->second;
+            plane          = (const float*) &p.pixels[0];
+            line = int (p.pixels.size () / sizeof (float)) /
+                   ((dw.max.y - dw.min.y + 1) / ch->ySampling);
+        }
+
+        for (int y = dw.min.y; y <= dw.max.y; ++y)
+        {
+            if (modp (y, slice.ySampling) != 0) continue;
+
+            for (int x = dw.min.x; x <= dw.max.x; ++x)
+            {
+                if (modp (x, slice.xSampling) != 0) continue;
+
+                int px = divp (x, slice.xSampling);
+                int py = divp (y, slice.ySampling);
+
+                float value = loadValue (
+                    slice.type,
+                    slice.base + intptr_t (py) * intptr_t (slice.yStride) +
+                        intptr_t (px) * intptr_t (slice.xStride));
+
+                float expected;
+
+                if (ch)
+                {
+                    int rx   = px - divp (dw.min.x, slice.xSampling);
+                    int ry   = py - divp (dw.min.y, slice.ySampling);
+                    expected = plane[ry * line + rx];
+                }
+                else if (slice.type == HALF)
+                    expected = half (float (slice.fillValue));
+                else
+                    expected = float (slice.fillValue);
+
+                if (!sameValue (value, expected))
+                {
+                    cerr << "channel " << i.name () << " pixel " << x << ","
+                         << y << ": read " << value << ", expected "
+                         << expected << endl;
+                    assert (false);
+                }
+            }
+        }
+    }
+}
+
+//
+// Check the reference planes against the pixels that were written
+//
+
+void
+checkReference (
+    const ChannelList& channels,
+    const Box2i&       dw,
+    int                level,
+    const PlaneMap&    planes)
+{
+    bool first = true;
+
+    for (ChannelList::ConstIterator i = channels.begin (); i != channels.end ();
+         ++i)
+    {
+        const Channel& ch    = i.channel ();
+        const float*   plane = (const float*) &planes.find (i.name ())
+                                 ->second.pixels[0];
+        int w    = (dw.max.x - dw.min.x + 1) / ch.xSampling;
+        int h    = (dw.max.y - dw.min.y + 1) / ch.ySampling;
+        int line = first ? w + 1 : w;
+
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                float expected = pixelValue (
+                    ch.type,
+                    i.name (),
+                    level,
+                    divp (dw.min.x, ch.xSampling) + x,
+                    divp (dw.min.y, ch.ySampling) + y);
+
+                assert (sameValue (plane[y * line + x], expected));
+            }
+        }
+
+        first = false;
+    }
+}
+
+void
+fillPlanes (FrameBuffer& fb, const Box2i& dw, int level)
+{
+    for (FrameBuffer::Iterator i = fb.begin (); i != fb.end (); ++i)
+    {
+        Slice& slice = i.slice ();
+
+        for (int y = divp (dw.min.y, slice.ySampling);
+             y <= divp (dw.max.y, slice.ySampling);
+             ++y)
+        {
+            for (int x = divp (dw.min.x, slice.xSampling);
+                 x <= divp (dw.max.x, slice.xSampling);
+                 ++x)
+            {
+                storeValue (
+                    slice.type,
+                    slice.base + intptr_t (y) * intptr_t (slice.yStride) +
+                        intptr_t (x) * intptr_t (slice.xStride),
+                    pixelValue (slice.type, i.name (), level, x, y));
+            }
+        }
+    }
+}
+
+void
+insertChannels (Header& hdr, const ChannelDesc* desc, int numChannels)
+{
+    for (int c = 0; c < numChannels; ++c)
+    {
+        hdr.channels ().insert (
+            desc[c].name,
+            Channel (desc[c].type, desc[c].sampling, desc[c].sampling));
+    }
+}
+
+void
+writeFile (
+    const string&      fileName,
+    const ChannelDesc* desc,
+    int                numChannels,
+    Compression        compression)
+{
+    Header hdr (dataWindow, dataWindow);
+    hdr.compression () = compression;
+    insertChannels (hdr, desc, numChannels);
+
+    PlaneMap    planes;
+    FrameBuffer fb = planarFrameBuffer (
+        hdr.channels (), dataWindow, planes, false, false);
+
+    fillPlanes (fb, dataWindow, 0);
+
+    OutputFile out (fileName.c_str (), hdr);
+    out.setFrameBuffer (fb);
+    out.writePixels (H);
+}
+
+//
+// 16 by 16 tiles, which leaves narrower tiles on the right and
+// bottom edges of most levels
+//
+
+void
+writeTiledFile (
+    const string&      fileName,
+    const ChannelDesc* desc,
+    int                numChannels,
+    Compression        compression,
+    LevelMode          levelMode,
+    LevelRoundingMode  roundingMode)
+{
+    Header hdr (dataWindow, dataWindow);
+    hdr.compression () = compression;
+    hdr.setTileDescription (
+        TileDescription (16, 16, levelMode, roundingMode));
+    insertChannels (hdr, desc, numChannels);
+
+    TiledOutputFile out (fileName.c_str (), hdr);
+
+    for (int ly = 0; ly < out.numYLevels (); ++ly)
+    {
+        for (int lx = 0; lx < out.numXLevels (); ++lx)
+        {
+            if (!out.isValidLevel (lx, ly)) continue;
+
+            Box2i       dw = out.dataWindowForLevel (lx, ly);
+            PlaneMap    planes;
+            FrameBuffer fb = planarFrameBuffer (
+                hdr.channels (), dw, planes, false, false);
+
+            fillPlanes (fb, dw, lx + ly * 8);
+
+            out.setFrameBuffer (fb);
+            out.writeTiles (
+                0, out.numXTiles (lx) - 1, 0, out.numYTiles (ly) - 1, lx, ly);
+        }
+    }
+}
+
+//
+// Interleaved pixels, with the named channels in memory in the given
+// order.  Names that are not in the file become fill slices.
+//
+
+FrameBuffer
+interleavedFrameBuffer (
+    vector<char>&      pixels,
+    const Box2i&       dw,
+    PixelType          type,
+    const char* const* names,
+    int                numNames)
+{
+    size_t size  = pixelSize (type);
+    int    w     = dw.max.x - dw.min.x + 1;
+    int    h     = dw.max.y - dw.min.y + 1;
+    size_t pixel = size * numNames;
+
+    pixels.assign (pixel * w * h, 0);
+
+    FrameBuffer fb;
+    for (int c = 0; c < numNames; ++c)
+    {
+        fb.insert (
+            names[c],
+            Slice::Make (
+                type,
+                &pixels[c * size],
+                dw,
+                pixel,
+                pixel * w,
+                1,
+                1,
+                0.5));
+    }
+
+    return fb;
+}
+
+template <class File>
+void
+readInterleaved (
+    File&              in,
+    int                lx,
+    int                ly,
+    const PlaneMap&    reference,
+    PixelType          type,
+    const char* const* names,
+    int                numNames)
+{
+    Box2i dw = levelWindow (in, lx, ly);
+
+    vector<char> pixels;
+    FrameBuffer  fb = interleavedFrameBuffer (pixels, dw, type, names, numNames);
+
+    in.setFrameBuffer (fb);
+    readLevel (in, lx, ly);
+
+    compareWithReference (fb, in.header ().channels (), dw, reference);
+}
+
+template <class File>
+void
+readPlanar (
+    File& in, int lx, int ly, const PlaneMap& reference, bool asFloat)
+{
+    Box2i dw = levelWindow (in, lx, ly);
+
+    PlaneMap    planes;
+    FrameBuffer fb = planarFrameBuffer (
+        in.header ().channels (), dw, planes, asFloat, false);
+
+    //
+    // A channel that is not in the file
+    //
+
+    vector<char> fill (sizeof (float) * W * H);
+    fb.insert (
+        "F",
+        Slice::Make (
+            asFloat ? FLOAT : HALF, &fill[0], dw, 0, 0, 1, 1, 0.25));
+
+    in.setFrameBuffer (fb);
+    readLevel (in, lx, ly);
+
+    compareWithReference (fb, in.header ().channels (), dw, reference);
+}
+
+const char* const rgba[]    = {"R", "G", "B", "A"};
+const char* const abgr[]    = {"A", "B", "G", "R"};
+const char* const rgbFill[] = {"R", "G", "B", "F"};
+const char* const gr[]      = {"G", "R"};
+const char* const yFill[]   = {"Y", "F"};
+const char* const zFill[]   = {"Z", "F"};
+
+void
+testScanLines (const string& fileName, Compression compression)
+{
+    //
+    // Four half channels, the layout with specialized unpackers.
+    // The channels are sorted A, B, G, R in the file, so interleaved
+    // RGBA takes the reversed ones, and ABGR the forward ones.
+    //
+
+    writeFile (fileName, rgbaChannels, 4, compression);
+
+    {
+        InputFile in (fileName.c_str ());
+        PlaneMap  reference;
+
+        readReference (in, 0, 0, reference);
+        checkReference (in.header ().channels (), dataWindow, 0, reference);
+
+        readInterleaved (in, 0, 0, reference, FLOAT, rgba, 4);
+        readInterleaved (in, 0, 0, reference, FLOAT, abgr, 4);
+        readInterleaved (in, 0, 0, reference, HALF, rgba, 4);
+        readInterleaved (in, 0, 0, reference, HALF, abgr, 4);
+        readPlanar (in, 0, 0, reference, true);
+        readPlanar (in, 0, 0, reference, false);
+
+        //
+        // Partial channel sets, with and without a fill slice
+        //
+
+        readInterleaved (in, 0, 0, reference, HALF, rgbFill, 4);
+        readInterleaved (in, 0, 0, reference, FLOAT, rgbFill, 4);
+        readInterleaved (in, 0, 0, reference, HALF, gr, 2);
+        readInterleaved (in, 0, 0, reference, FLOAT, gr, 2);
+    }
+
+    //
+    // Subsampled channels, and every pixel type
+    //
+
+    writeFile (fileName, mixedChannels, 5, compression);
+
+    {
+        InputFile in (fileName.c_str ());
+        PlaneMap  reference;
+
+        readReference (in, 0, 0, reference);
+        checkReference (in.header ().channels (), dataWindow, 0, reference);
+
+        readPlanar (in, 0, 0, reference, false);
+        readPlanar (in, 0, 0, reference, true);
+        readInterleaved (in, 0, 0, reference, HALF, yFill, 2);
+        readInterleaved (in, 0, 0, reference, FLOAT, yFill, 2);
+    }
+
+    remove (fileName.c_str ());
+}
+
+void
+testTiles (
+    const string&     fileName,
+    Compression       compression,
+    LevelMode         levelMode,
+    LevelRoundingMode roundingMode)
+{
+    writeTiledFile (
+        fileName, rgbaChannels, 4, compression, levelMode, roundingMode);
+
+    {
+        TiledInputFile in (fileName.c_str ());
+
+        for (int ly = 0; ly < in.numYLevels (); ++ly)
+        {
+            for (int lx = 0; lx < in.numXLevels (); ++lx)
+            {
+                if (!in.isValidLevel (lx, ly)) continue;
+
+                PlaneMap reference;
+
+                readReference (in, lx, ly, reference);
+                checkReference (
+                    in.header ().channels (),
+                    in.dataWindowForLevel (lx, ly),
+                    lx + ly * 8,
+                    reference);
+
+                readInterleaved (in, lx, ly, reference, FLOAT, rgba, 4);
+                readInterleaved (in, lx, ly, reference, FLOAT, abgr, 4);
+                readInterleaved (in, lx, ly, reference, HALF, rgba, 4);
+                readInterleaved (in, lx, ly, reference, HALF, abgr, 4);
+                readPlanar (in, lx, ly, reference, true);
+                readPlanar (in, lx, ly, reference, false);
+                readInterleaved (in, lx, ly, reference, FLOAT, rgbFill, 4);
+                readInterleaved (in, lx, ly, reference, HALF, gr, 2);
+            }
+        }
+    }
+
+    writeTiledFile (
+        fileName, tiledChannels, 3, compression, levelMode, roundingMode);
+
+    {
+        TiledInputFile in (fileName.c_str ());
+
+        for (int ly = 0; ly < in.numYLevels (); ++ly)
+        {
+            for (int lx = 0; lx < in.numXLevels (); ++lx)
+            {
+                if (!in.isValidLevel (lx, ly)) continue;
+
+                PlaneMap reference;
+
+                readReference (in, lx, ly, reference);
+                checkReference (
+                    in.header ().channels (),
+                    in.dataWindowForLevel (lx, ly),
+                    lx + ly * 8,
+                    reference);
+
+                readPlanar (in, lx, ly, reference, false);
+                readInterleaved (in, lx, ly, reference, FLOAT, zFill, 2);
+                readInterleaved (in, lx, ly, reference, HALF, yFill, 2);
+            }
+        }
+    }
+
+    remove (fileName.c_str ());
+}
+
+} // namespace
+
+void
+testDirectUnpack (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing unpacking straight into the frame buffer" << endl;
+
+        const Compression compressions[] = {
+            NO_COMPRESSION, ZIP_COMPRESSION, PIZ_COMPRESSION};
+
+        for (size_t i = 0; i < sizeof (compressions) / sizeof (compressions[0]);
+             ++i)
+        {
+            cout << "compression " << int (compressions[i]) << endl;
+
+            testScanLines (
+                tempDir + "imf_test_direct_unpack.exr", compressions[i]);
+
+            testTiles (
+                tempDir + "imf_test_direct_unpack_tiled.exr",
+                compressions[i],
+                ONE_LEVEL,
+                ROUND_DOWN);
+
+            testTiles (
+                tempDir + "imf_test_direct_unpack_tiled.exr",
+                compressions[i],
+                MIPMAP_LEVELS,
+                ROUND_DOWN);
+
+            testTiles (
+                tempDir + "imf_test_direct_unpack_tiled.exr",
+                compressions[i],
+                RIPMAP_LEVELS,
+                ROUND_UP);
+        }
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -0,0 +1,301 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <ImfArray.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfOutputFile.h>
+#include <ImfScanLineInputFile.h>
+#include <ImfStdIO.h>
+#include <ImfXdr.h>
+#include <assert.h>
+#include <iostream>
+#include <limits>
+#include <stdio.h>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+using namespace IMATH_NAMESPACE;
+
+namespace
+{
+
+const int W = 67;
+const int H = 43;
+
+//
+// Channel values are small integers, which half represents exactly
+//
+
+half
+halfValue (int c, int x, int y)
+{
+    return half (float ((x * 3 + y * 7 + c * 11) % 1024));
+}
+
+float
+floatValue (int x, int y)
+{
+    return float (x * 1000 + y);
+}
+
+void
+writeFile (const std::string& fileName)
+{
+    Header hdr (W, H);
+    hdr.compression () = ZIP_COMPRESSION;
+    hdr.channels ().insert ("R", Channel (HALF));
+    hdr.channels ().insert ("G", Channel (HALF));
+    hdr.channels ().insert ("B", Channel (HALF));
+    hdr.channels ().insert ("A", Channel (HALF));
+    hdr.channels ().insert ("Z", Channel (FLOAT));
+
+    Array2D<half>  rgba (H, W * 4);
+    Array2D<float> z (H, W);
+
+    for (int y = 0; y < H; ++y)
+    {
+        for (int x = 0; x < W; ++x)
+        {
+            for (int c = 0; c < 4; ++c)
+                rgba[y][x * 4 + c] = halfValue (c, x, y);
+            z[y][x] = floatValue (x, y);
+        }
+    }
+
+    const char* names[] = {"R", "G", "B", "A"};
+    FrameBuffer fb;
+    for (int c = 0; c < 4; ++c)
+    {
+        fb.insert (
+            names[c],
+            Slice (
+                HALF,
+                (char*) &rgba[0][c],
+                sizeof (half) * 4,
+                sizeof (half) * 4 * W));
+    }
+    fb.insert (
+        "Z",
+        Slice (FLOAT, (char*) &z[0][0], sizeof (float), sizeof (float) * W));
+
+    OutputFile out (fileName.c_str (), hdr);
+    out.setFrameBuffer (fb);
+    out.writePixels (H);
+}
+
+//
+// Interleaved RGBA, with the channels in memory in the given order
+//
+
+FrameBuffer
+interleavedFrameBuffer (Array2D<half>& pixels, const int order[4])
+{
+    const char* names[] = {"R", "G", "B", "A"};
+
+    FrameBuffer fb;
+    for (int c = 0; c < 4; ++c)
+    {
+        fb.insert (
+            names[c],
+            Slice (
+                HALF,
+                (char*) &pixels[0][order[c]],
+                sizeof (half) * 4,
+                sizeof (half) * 4 * W));
+    }
+
+    return fb;
+}
+
+void
+checkInterleaved (const Array2D<half>& pixels, const int order[4])
+{
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            for (int c = 0; c < 4; ++c)
+                assert (
+                    pixels[y][x * 4 + order[c]].bits () ==
+                    halfValue (c, x, y).bits ());
+}
+
+//
+// Planar G and Z, plus a channel that is not in the file
+//
+
+FrameBuffer
+planarFrameBuffer (
+    Array2D<half>& g, Array2D<float>& z, Array2D<half>& y, float fill)
+{
+    FrameBuffer fb;
+    fb.insert (
+        "G",
+        Slice (HALF, (char*) &g[0][0], sizeof (half), sizeof (half) * W));
+    fb.insert (
+        "Y",
+        Slice (
+            HALF,
+            (char*) &y[0][0],
+            sizeof (half),
+            sizeof (half) * W,
+            1,
+            1,
+            fill));
+    fb.insert (
+        "Z",
+        Slice (FLOAT, (char*) &z[0][0], sizeof (float), sizeof (float) * W));
+    return fb;
+}
+
+void
+checkPlanar (
+    const Array2D<half>&  g,
+    const Array2D<float>& z,
+    const Array2D<half>&  y,
+    float                 fill)
+{
+    for (int j = 0; j < H; ++j)
+    {
+        for (int i = 0; i < W; ++i)
+        {
+            assert (g[j][i].bits () == halfValue (1, i, j).bits ());
+            assert (z[j][i] == floatValue (i, j));
+            assert (y[j][i].bits () == half (fill).bits ());
+        }
+    }
+}
+
+void
+readFile (const std::string& fileName)
+{
+    StdIFStream is (fileName.c_str ());
+    Header      hdr;
+    int         magic, version;
+    Xdr::read<StreamIO> (is, magic);
+    Xdr::read<StreamIO> (is, version);
+    hdr.readFrom (is, version);
+
+    ScanLineInputFile in (hdr, &is);
+
+    const int rgba[4] = {0, 1, 2, 3};
+    const int bgra[4] = {2, 1, 0, 3};
+
+    Array2D<half>  pixels1 (H, W * 4);
+    Array2D<half>  pixels2 (H, W * 4);
+    Array2D<half>  g1 (H, W), g2 (H, W), y1 (H, W), y2 (H, W);
+    Array2D<float> z1 (H, W), z2 (H, W);
+
+    //
+    // The first frame buffer of each layout builds its tables
+    //
+
+    in.setFrameBuffer (interleavedFrameBuffer (pixels1, rgba));
+    in.readPixels (0, H - 1);
+    checkInterleaved (pixels1, rgba);
+    bool optimized = in.isOptimizationEnabled ();
+
+    in.setFrameBuffer (planarFrameBuffer (g1, z1, y1, 0.5f));
+    in.readPixels (0, H - 1);
+    checkPlanar (g1, z1, y1, 0.5f);
+
+    assert (in.frameBufferPlanHits () == 0);
+    assert (in.frameBufferPlanMisses () == 2);
+
+    //
+    // Frame buffers with the same layouts, but pointing elsewhere,
+    // find them again
+    //
+
+    in.setFrameBuffer (interleavedFrameBuffer (pixels2, rgba));
+    assert (in.isOptimizationEnabled () == optimized);
+    in.readPixels (0, H - 1);
+    checkInterleaved (pixels2, rgba);
+
+    in.setFrameBuffer (planarFrameBuffer (g2, z2, y2, 0.5f));
+    in.readPixels (0, H - 1);
+    checkPlanar (g2, z2, y2, 0.5f);
+
+    assert (in.frameBufferPlanHits () == 2);
+    assert (in.frameBufferPlanMisses () == 2);
+
+    //
+    // A different fill value is a different layout
+    //
+
+    in.setFrameBuffer (planarFrameBuffer (g1, z1, y1, 2.0f));
+    in.readPixels (0, H - 1);
+    checkPlanar (g1, z1, y1, 2.0f);
+
+    assert (in.frameBufferPlanHits () == 2);
+    assert (in.frameBufferPlanMisses () == 3);
+
+    //
+    // Swapping where R and B go keeps the types and strides, but
+    // changes the interleaving the optimized path depends on.
+    // Whichever way the tables are found, the pixels must land in
+    // the right place.
+    //
+
+    in.setFrameBuffer (interleavedFrameBuffer (pixels1, bgra));
+    in.readPixels (0, H - 1);
+    checkInterleaved (pixels1, bgra);
+
+    in.setFrameBuffer (interleavedFrameBuffer (pixels2, rgba));
+    assert (in.isOptimizationEnabled () == optimized);
+    in.readPixels (0, H - 1);
+    checkInterleaved (pixels2, rgba);
+
+    assert (in.frameBufferPlanHits () + in.frameBufferPlanMisses () == 7);
+    assert (in.frameBufferPlanHits () >= 3);
+
+    //
+    // A NaN fill value is never equal to itself, but the same
+    // layout with it must still find its plan
+    //
+
+    float nan = std::numeric_limits<float>::quiet_NaN ();
+
+    in.setFrameBuffer (planarFrameBuffer (g1, z1, y1, nan));
+    in.readPixels (0, H - 1);
+    checkPlanar (g1, z1, y1, nan);
+
+    uint64_t hits = in.frameBufferPlanHits ();
+
+    in.setFrameBuffer (planarFrameBuffer (g2, z2, y2, nan));
+    in.readPixels (0, H - 1);
+    checkPlanar (g2, z2, y2, nan);
+
+    assert (in.frameBufferPlanHits () == hits + 1);
+}
+
+} // namespace
+
+void
+testFrameBufferPlans (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing reuse of frame buffer slice tables" << endl;
+
+        std::string fileName = tempDir + "imf_test_framebuffer_plans.exr";
+
+        writeFile (fileName);
+        readFile (fileName);
+
+        remove (fileName.c_str ());
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -0,0 +1,135 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include "testHeaderOnlyOpen.h"
+
+#include <IexBaseExc.h>
+#include <ImfChannelList.h>
+#include <ImfHeader.h>
+#include <ImfInputPart.h>
+#include <ImfMultiPartInputFile.h>
+#include <ImfStdIO.h>
+
+#include <assert.h>
+#include <iostream>
+#include <string>
+
+#ifndef ILM_IMF_TEST_IMAGEDIR
+#    define ILM_IMF_TEST_IMAGEDIR
+#endif
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+
+namespace
+{
+
+void
+compareHeaders (const MultiPartInputFile& a, const MultiPartInputFile& b)
+{
+    assert (a.version () == b.version ());
+    assert (a.parts () == b.parts ());
+
+    for (int p = 0; p < a.parts (); ++p)
+    {
+        const Header& ha = a.header (p);
+        const Header& hb = b.header (p);
+
+        assert (ha.type () == hb.type ());
+        assert (ha.dataWindow () == hb.dataWindow ());
+        assert (ha.compression () == hb.compression ());
+        assert (ha.channels () == hb.channels ());
+
+        int na = 0, nb = 0;
+        for (Header::ConstIterator i = ha.begin (); i != ha.end (); ++i)
+            ++na;
+        for (Header::ConstIterator i = hb.begin (); i != hb.end (); ++i)
+            ++nb;
+        assert (na == nb);
+    }
+}
+
+void
+testFile (const char fileName[])
+{
+    cout << "   " << fileName << endl;
+
+    MultiPartInputFile full (fileName);
+    MultiPartInputFile headers (fileName, MultiPartInputFile::HEADER_ONLY);
+    compareHeaders (full, headers);
+
+    StdIFStream        is (fileName);
+    MultiPartInputFile streamed (is, MultiPartInputFile::HEADER_ONLY);
+    compareHeaders (full, streamed);
+
+    //
+    // There is no part data to create parts from
+    //
+
+    bool caught = false;
+    try
+    {
+        InputPart part (headers, 0);
+    }
+    catch (const IEX_NAMESPACE::LogicExc&)
+    {
+        caught = true;
+    }
+    assert (caught);
+
+    caught = false;
+    try
+    {
+        headers.partComplete (0);
+    }
+    catch (const IEX_NAMESPACE::LogicExc&)
+    {
+        caught = true;
+    }
+    assert (caught);
+}
+
+} // namespace
+
+void
+testHeaderOnlyOpen (const std::string&)
+{
+    try
+    {
+        cout << "Testing header-only open of MultiPartInputFile" << endl;
+
+        testFile (ILM_IMF_TEST_IMAGEDIR "comp_zips.exr");
+        testFile (ILM_IMF_TEST_IMAGEDIR "v1.7.test.tiled.exr");
+        testFile (ILM_IMF_TEST_IMAGEDIR "tiled_with_deeptile_type.exr");
+
+        //
+        // The header checks still apply
+        //
+
+        bool caught = false;
+        try
+        {
+            MultiPartInputFile file (
+                ILM_IMF_TEST_IMAGEDIR "invalid_shared_attrs_multipart.exr",
+                MultiPartInputFile::HEADER_ONLY);
+        }
+        catch (const IEX_NAMESPACE::InputExc&)
+        {
+            caught = true;
+        }
+        assert (caught);
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
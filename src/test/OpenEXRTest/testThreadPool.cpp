@@ -0,0 +1,323 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include <IlmThreadPool.h>
+#include <ImfArray.h>
+#include <ImfRgbaFile.h>
+#include <ImfThreading.h>
+#include <assert.h>
+#include <atomic>
+#include <iostream>
+#include <math.h>
+#include <memory>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace ILMTHREAD_NAMESPACE;
+using namespace std;
+
+namespace
+{
+
+class CountTask : public Task
+{
+public:
+    CountTask (
+        TaskGroup* group, ThreadPool& pool, atomic<int>& count, int children)
+        : Task (group)
+        , _pool (pool)
+        , _count (count)
+        , _children (children)
+    {}
+
+    void execute () override
+    {
+        //
+        // Tasks added from inside a worker take a different path
+        // through the work-stealing provider than the ones added
+        // from outside the pool.
+        //
+
+        for (int i = 0; i < _children; ++i)
+            _pool.addTask (new CountTask (_group, _pool, _count, 0));
+
+        ++_count;
+    }
+
+private:
+    ThreadPool&  _pool;
+    atomic<int>& _count;
+    int          _children;
+};
+
+void
+countTasks (ThreadPool& pool, int numTasks, int children)
+{
+    atomic<int> count (0);
+
+    {
+        TaskGroup group;
+        for (int i = 0; i < numTasks; ++i)
+            pool.addTask (new CountTask (&group, pool, count, children));
+    }
+
+    assert (count.load () == numTasks * (children + 1));
+}
+
+void
+countBatchedTasks (ThreadPool& pool, int numTasks)
+{
+    atomic<int> count (0);
+    int         expected = 0;
+
+    {
+        TaskGroup     group;
+        vector<Task*> tasks;
+        for (int i = 0; i < numTasks; ++i)
+        {
+            tasks.push_back (new CountTask (&group, pool, count, i % 3));
+            expected += 1 + i % 3;
+        }
+
+        pool.addTasks (tasks.data (), static_cast<int> (tasks.size ()));
+    }
+
+    assert (count.load () == expected);
+}
+
+void
+parallelForRange (ThreadPool& pool, int begin, int end)
+{
+    vector<atomic<int>> hits (static_cast<size_t> (max (end - begin, 0)));
+    for (auto& h: hits)
+        h = 0;
+
+    pool.parallelFor (begin, end, [&] (int i) {
+        assert (i >= begin && i < end);
+        ++hits[static_cast<size_t> (i - begin)];
+    });
+
+    for (auto& h: hits)
+        assert (h.load () == 1);
+
+    //
+    // The first exception is passed on to the caller.
+    //
+
+    if (end - begin > 1)
+    {
+        bool caught = false;
+        try
+        {
+            pool.parallelFor (begin, end, [&] (int i) {
+                if (i == begin + 1) throw runtime_error ("parallelFor");
+            });
+        }
+        catch (const runtime_error& e)
+        {
+            caught = (string (e.what ()) == "parallelFor");
+        }
+        assert (caught);
+    }
+}
+
+void
+testBatching (ThreadPool& pool)
+{
+    countBatchedTasks (pool, 1);
+    countBatchedTasks (pool, 5000);
+
+    parallelForRange (pool, 0, 0);
+    parallelForRange (pool, 7, 8);
+    parallelForRange (pool, -100, 10000);
+}
+
+class CountOnlyTask : public Task
+{
+public:
+    CountOnlyTask (TaskGroup* group, atomic<int>& count)
+        : Task (group), _count (count)
+    {}
+
+    void execute () override { ++_count; }
+
+private:
+    atomic<int>& _count;
+};
+
+void
+resizeWhileAdding (int rounds)
+{
+    //
+    // Tasks added while another thread restarts or stops the workers
+    // must neither be lost nor run against the data of a stopped
+    // pool.
+    //
+
+    unique_ptr<ThreadPoolProvider> provider (
+        ThreadPool::newWorkStealingProvider (2));
+    atomic<int>  count (0);
+    atomic<bool> adding (true);
+
+    thread resizer ([&] () {
+        for (int n = 0; adding.load (); ++n)
+        {
+            provider->setNumThreads (1 + n % 4);
+            if (n % 8 == 7) provider->finish ();
+        }
+    });
+
+    {
+        TaskGroup     group;
+        vector<Task*> tasks (4);
+        for (int r = 0; r < rounds; ++r)
+        {
+            provider->addTask (new CountOnlyTask (&group, count));
+
+            for (auto& t: tasks)
+                t = new CountOnlyTask (&group, count);
+            provider->addTasks (
+                tasks.data (), static_cast<int> (tasks.size ()));
+        }
+
+        adding = false;
+        resizer.join ();
+    }
+
+    assert (count.load () == rounds * 5);
+
+    //
+    // Once finished, tasks are run by the caller.
+    //
+
+    provider->finish ();
+    count = 0;
+    {
+        TaskGroup group;
+        provider->addTask (new CountOnlyTask (&group, count));
+    }
+    assert (count.load () == 1);
+}
+
+void
+writeReadRGBA (const string& fileName)
+{
+    const int W = 237;
+    const int H = 519;
+
+    Array2D<Rgba> p1 (H, W);
+    for (int y = 0; y < H; ++y)
+    {
+        for (int x = 0; x < W; ++x)
+        {
+            Rgba& p = p1[y][x];
+
+            p.r = 0.5 + 0.5 * sin (0.1 * x + 0.1 * y);
+            p.g = 0.5 + 0.5 * sin (0.1 * x + 0.2 * y);
+            p.b = 0.5 + 0.5 * sin (0.1 * x + 0.3 * y);
+            p.a = (p.r + p.b + p.g) / 3.0;
+        }
+    }
+
+    Header header (W, H);
+    header.compression () = ZIPS_COMPRESSION;
+
+    {
+        remove (fileName.c_str ());
+        RgbaOutputFile out (fileName.c_str (), header, WRITE_RGBA);
+        out.setFrameBuffer (&p1[0][0], 1, W);
+        out.writePixels (H);
+    }
+
+    {
+        RgbaInputFile in (fileName.c_str ());
+        Array2D<Rgba> p2 (H, W);
+        in.setFrameBuffer (&p2[0][0], 1, W);
+        in.readPixels (0, H - 1);
+
+        for (int y = 0; y < H; ++y)
+        {
+            for (int x = 0; x < W; ++x)
+            {
+                assert (p2[y][x].r == p1[y][x].r);
+                assert (p2[y][x].g == p1[y][x].g);
+                assert (p2[y][x].b == p1[y][x].b);
+                assert (p2[y][x].a == p1[y][x].a);
+            }
+        }
+    }
+
+    remove (fileName.c_str ());
+}
+
+} // namespace
+
+void
+testThreadPool (const string& tempDir)
+{
+#if ILMTHREAD_THREADING_ENABLED
+    try
+    {
+        cout << "Testing work-stealing thread pool provider" << endl;
+
+        for (int n = 1; n <= 8; n *= 2)
+        {
+            cout << "number of threads: " << n << endl;
+
+            ThreadPool pool (0);
+            pool.setThreadProvider (ThreadPool::newWorkStealingProvider (n));
+            assert (pool.numThreads () == n);
+
+            countTasks (pool, 1, 0);
+            countTasks (pool, 20000, 0);
+            countTasks (pool, 2000, 10);
+
+            pool.setNumThreads (n + 1);
+            assert (pool.numThreads () == n + 1);
+            countTasks (pool, 5000, 3);
+            testBatching (pool);
+        }
+
+        cout << "adding tasks while resizing" << endl;
+        resizeWhileAdding (20000);
+
+        cout << "Testing batched tasks" << endl;
+
+        for (int n = 0; n <= 4; n += 2)
+        {
+            cout << "number of threads: " << n << endl;
+
+            ThreadPool pool (n);
+            testBatching (pool);
+        }
+
+        cout << "global thread pool" << endl;
+
+        ThreadPool::globalThreadPool ().setThreadProvider (
+            ThreadPool::newWorkStealingProvider (4));
+        assert (globalThreadCount () == 4);
+        writeReadRGBA (tempDir + "imf_test_thread_pool.exr");
+
+        setGlobalThreadCount (0);
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+#else
+    cout << "threading disabled, skipping thread pool test\n" << endl;
+#endif
+}
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright Contributors to the OpenEXR Project.
+
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include <IlmThreadPool.h>
+
+using namespace ILMTHREAD_NAMESPACE;
+
+//
+// Measures how many small tasks per second a thread pool gets
+// through, for the default and work-stealing providers, as the
+// number of worker threads grows.  Tasks are either all added from
+// the main thread (like the C++ library does when decoding a file),
+// one at a time or in batches, or fanned out from inside the pool.
+//
+
+static std::atomic<uint64_t> gSink (0);
+
+class SpinTask : public Task
+{
+public:
+    SpinTask (TaskGroup* g, ThreadPool& pool, int work, int children)
+        : Task (g), _pool (pool), _work (work), _children (children)
+    {}
+
+    void execute () override
+    {
+        for (int i = 0; i < _children; ++i)
+            _pool.addTask (new SpinTask (_group, _pool, _work, 0));
+
+        // stand in for decoding a small chunk
+        uint64_t v = uint64_t (_work);
+        for (int i = 0; i < _work; ++i)
+            v = v * 6364136223846793005ULL + 1442695040888963407ULL;
+        gSink.fetch_add (v & 1, std::memory_order_relaxed);
+    }
+
+private:
+    ThreadPool& _pool;
+    int         _work;
+    int         _children;
+};
+
+static double
+runTasks (ThreadPool& pool, int numTasks, int work, int children, int batch)
+{
+    int roots = numTasks / (children + 1);
+
+    auto start = std::chrono::steady_clock::now ();
+    if (batch > 1)
+    {
+        TaskGroup          group;
+        std::vector<Task*> tasks;
+        for (int i = 0; i < roots; ++i)
+        {
+            tasks.push_back (new SpinTask (&group, pool, work, children));
+            if (int (tasks.size ()) == batch || i == roots - 1)
+            {
+                pool.addTasks (tasks.data (), int (tasks.size ()));
+                tasks.clear ();
+            }
+        }
+    }
+    else
+    {
+        TaskGroup group;
+        for (int i = 0; i < roots; ++i)
+            pool.addTask (new SpinTask (&group, pool, work, children));
+    }
+    auto end = std::chrono::steady_clock::now ();
+
+    double secs = std::chrono::duration<double> (end - start).count ();
+    return double (roots * (children + 1)) / secs;
+}
+
+static int
+usageAndExit (const char* argv0, int ec)
+{
+    std::cerr << "Usage: " << argv0
+              << " [--tasks <n>] [--work <n>] [--children <n>]"
+                 " [--batch <n>] [--max-threads <n>]"
+              << std::endl;
+    return ec;
+}
+
+int
+main (int argc, char* argv[])
+{
+    int numTasks   = 200000;
+    int work       = 256;
+    int children   = 0;
+    int batch      = 1;
+    int maxThreads = int (ThreadPool::estimateThreadCountForFileIO ());
+
+    for (int a = 1; a < argc; ++a)
+    {
+        if (!strcmp (argv[a], "-h") || !strcmp (argv[a], "--help") ||
+            !strcmp (argv[a], "-?"))
+        {
+            return usageAndExit (argv[0], 0);
+        }
+        else if (a + 1 < argc && !strcmp (argv[a], "--tasks"))
+            numTasks = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--work"))
+            work = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--children"))
+            children = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--batch"))
+            batch = atoi (argv[++a]);
+        else if (a + 1 < argc && !strcmp (argv[a], "--max-threads"))
+            maxThreads = atoi (argv[++a]);
+        else
+            return usageAndExit (argv[0], 1);
+    }
+
+    if (numTasks <= 0 || work < 0 || children < 0 || batch <= 0 ||
+        maxThreads <= 0)
+        return usageAndExit (argv[0], 1);
+
+    std::cout << numTasks << " tasks, " << work << " iterations each, "
+              << children << " added per task from inside the pool, "
+              << "added " << batch << " at a time\n\n"
+              << std::setw (9) << std::left << " Threads" << std::setw (18)
+              << "Default" << std::setw (18) << "WorkStealing"
+              << "Ratio\n"
+              << std::setw (9) << "" << std::setw (18) << "(tasks/sec)"
+              << std::setw (18) << "(tasks/sec)" << "\n";
+
+    std::vector<int> counts;
+    for (int n = 1; n < maxThreads; n *= 2)
+        counts.push_back (n);
+    counts.push_back (maxThreads);
+
+    for (int n: counts)
+    {
+        double rateD, rateW;
+        {
+            ThreadPool pool (n);
+            runTasks (pool, numTasks / 10, work, children, batch);
+            rateD = runTasks (pool, numTasks, work, children, batch);
+        }
+        {
+            ThreadPool pool (0);
+            pool.setThreadProvider (ThreadPool::newWorkStealingProvider (n));
+            runTasks (pool, numTasks / 10, work, children, batch);
+            rateW = runTasks (pool, numTasks, work, children, batch);
+        }
+
+        std::cout << " " << std::setw (8) << std::left << n << std::setw (18)
+                  << std::fixed << std::setprecision (0) << rateD
+                  << std::setw (18) << rateW << std::setprecision (2)
+                  << rateW / rateD << "x" << std::endl;
+    }
+
+    return 0;
+}